@@ -355,6 +355,7 @@ let package = Package(
         "connections/listeners_test.cc",
         "connections/strategy_test.cc",
         "connections/implementation/offline_frames_test.cc",
+        "connections/implementation/offline_frames_benchmark.cc",
         "connections/implementation/offline_service_controller_test.cc",
         "connections/implementation/encryption_runner_test.cc",
         "connections/implementation/p2p_cluster_pcp_handler_test.cc",
@@ -365,6 +366,8 @@ let package = Package(
         "connections/implementation/internal_payload_factory_test.cc",
         "connections/implementation/client_proxy_test.cc",
         "connections/implementation/payload_manager_test.cc",
+        "connections/implementation/payload_compression_test.cc",
+        "connections/implementation/write_behind_queue_test.cc",
         "connections/implementation/offline_frames_validator_test.cc",
         "connections/implementation/service_controller_router_test.cc",
         "connections/implementation/analytics/analytics_recorder_impl_test.cc",
@@ -390,6 +393,7 @@ let package = Package(
         "connections/implementation/mediums/bluetooth_classic_test.cc",
         "connections/implementation/mediums/bluetooth_radio_test.cc",
         "connections/implementation/mediums/lost_entity_tracker_test.cc",
+        "connections/implementation/mediums/service_id_identity_test.cc",
         "connections/implementation/mediums/webrtc_peer_id_test.cc",
         "connections/implementation/mediums/webrtc_test.cc",
         "connections/implementation/mediums/wifi_direct_bwu_handler_test.cc",
@@ -430,6 +434,8 @@ let package = Package(
         "internal/crypto_cros/signature_verifier_unittest.cc",
         "internal/crypto_cros/symmetric_key_unittest.cc",
         "internal/encoding/base85_test.cc",
+        "internal/encoding/codec_benchmark.cc",
+        "internal/encoding/codec_test.cc",
         "internal/data/leveldb_data_set_test.cc",
         "internal/flags/nearby_flags_test.cc",
         "internal/platform/feature_flags_test.cc",
@@ -535,6 +541,9 @@ let package = Package(
         .headerSearchPath("third_party/ukey2/ukey2/"),
         .headerSearchPath("third_party/ukey2/compiled_proto/src/main/proto"),
         .define("NO_WEBRTC"),
+      ],
+      linkerSettings: [
+        .linkedLibrary("z")
       ]
     ),
     .target(
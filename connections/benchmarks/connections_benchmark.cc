@@ -0,0 +1,499 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// End-to-end benchmark of Nearby Connections between simulated devices.
+//
+// Devices run the full offline stack (OfflineSimulationUser) on top of
+// MediumEnvironment, whose sockets emulate the links in kLinkModels. The
+// benchmark reports, as JSON on stdout:
+//   - connection_establishment: discovery and connection latency per medium;
+//   - payload_throughput: BYTES, FILE and STREAM throughput per chunk size;
+//   - fan_out: one payload sent to a growing number of endpoints;
+//   - bandwidth_upgrade: time to switch a Bluetooth connection to Wi-Fi LAN.
+// Every result also carries the process CPU time spent per MB delivered.
+// Results are medians over kRepetitions runs.
+//
+// Run it with the following, redirecting stdout to keep the report:
+//   bazel run -c opt //connections/benchmarks:connections_benchmark
+
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "connections/implementation/bwu_manager.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "connections/implementation/offline_simulation_user.h"
+#include "connections/listeners.h"
+#include "connections/medium_selector.h"
+#include "connections/payload.h"
+#include "internal/base/file_path.h"
+#include "internal/base/files.h"
+#include "internal/flags/nearby_flags.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/count_down_latch.h"
+#include "internal/platform/file.h"
+#include "internal/platform/medium_environment.h"
+#include "internal/platform/output_stream.h"
+#include "internal/platform/pipe.h"
+#include "internal/platform/single_thread_executor.h"
+#include "nlohmann/json.hpp"
+#include "proto/connections_enums.pb.h"
+
+namespace nearby::connections {
+namespace {
+
+using ::location::nearby::proto::connections::Medium_Name;
+using ::nlohmann::json;
+
+constexpr char kServiceId[] = "connections-benchmark";
+constexpr absl::Duration kTimeout = absl::Seconds(60);
+constexpr int kRepetitions = 3;
+constexpr std::int64_t kMegabyte = 1024 * 1024;
+constexpr std::int64_t kThroughputPayloadSize = 8 * kMegabyte;
+constexpr std::int64_t kFanOutPayloadSize = 2 * kMegabyte;
+constexpr std::int64_t kStreamWriteSize = 64 * 1024;
+// Chunk sizes stay below half of kMediumMaxAllowedReadBytes.
+constexpr std::int64_t kChunkSizes[] = {4 * 1024, 16 * 1024, 64 * 1024,
+                                        256 * 1024};
+constexpr int kFanOutEndpoints[] = {1, 2, 4, 8};
+
+// Rough figures for each medium, so that results depend on the protocol
+// rather than on how fast the simulation copies bytes.
+constexpr std::pair<SimulatedMedium, LinkModel> kLinkModels[] = {
+    {SimulatedMedium::kBluetoothClassic,
+     {.bandwidth_bytes_per_second = 250'000,
+      .latency = absl::Milliseconds(10),
+      .jitter = absl::Milliseconds(2),
+      .mtu_bytes = 1'000}},
+    {SimulatedMedium::kBle,
+     {.bandwidth_bytes_per_second = 40'000,
+      .latency = absl::Milliseconds(15),
+      .jitter = absl::Milliseconds(5),
+      .mtu_bytes = 512}},
+    {SimulatedMedium::kWifiLan,
+     {.bandwidth_bytes_per_second = 20'000'000,
+      .latency = absl::Milliseconds(2),
+      .jitter = absl::Milliseconds(1),
+      .mtu_bytes = 1'500}},
+};
+
+const char* SimulatedMediumName(SimulatedMedium medium) {
+  switch (medium) {
+    case SimulatedMedium::kBluetoothClassic:
+      return "BLUETOOTH";
+    case SimulatedMedium::kBle:
+      return "BLE";
+    case SimulatedMedium::kWifiLan:
+      return "WIFI_LAN";
+    case SimulatedMedium::kAwdl:
+      return "AWDL";
+    case SimulatedMedium::kWifiHotspot:
+      return "WIFI_HOTSPOT";
+    case SimulatedMedium::kWifiDirect:
+      return "WIFI_DIRECT";
+  }
+  return "UNKNOWN";
+}
+
+enum class PayloadKind { kBytes, kFile, kStream };
+
+const char* PayloadKindName(PayloadKind kind) {
+  switch (kind) {
+    case PayloadKind::kBytes:
+      return "BYTES";
+    case PayloadKind::kFile:
+      return "FILE";
+    case PayloadKind::kStream:
+      return "STREAM";
+  }
+  return "UNKNOWN";
+}
+
+// OfflineSimulationUser that connects to several endpoints at once.
+class BenchmarkUser : public OfflineSimulationUser {
+ public:
+  using OfflineSimulationUser::OfflineSimulationUser;
+
+  void DiscoverOn(const BooleanMediumSelector& mediums) {
+    discovery_options_.allowed = mediums;
+  }
+  void ExpectConnectionInitiated(CountDownLatch& latch) {
+    initiated_latch_ = &latch;
+  }
+  void SendPayloadTo(const std::vector<std::string>& endpoint_ids,
+                     Payload payload) {
+    ctrl_.SendPayload(&client_, endpoint_ids, std::move(payload));
+  }
+};
+
+// Starts MediumEnvironment for one run, and stops it when done.
+class ScopedEnvironment {
+ public:
+  ScopedEnvironment() {
+    EnvironmentConfig config;
+    for (const auto& [medium, link_model] : kLinkModels) {
+      config.link_models[medium] = link_model;
+    }
+    MediumEnvironment::Instance().Start(std::move(config));
+  }
+  ~ScopedEnvironment() { MediumEnvironment::Instance().Stop(); }
+};
+
+bool Await(CountDownLatch& latch) {
+  ExceptionOr<bool> result = latch.Await(kTimeout);
+  return result.ok() && result.result();
+}
+
+double Median(std::vector<double> samples) {
+  if (samples.empty()) return 0;
+  std::sort(samples.begin(), samples.end());
+  return samples[samples.size() / 2];
+}
+
+double ToMilliseconds(absl::Duration duration) {
+  return absl::ToDoubleMilliseconds(duration);
+}
+
+double GetCpuSeconds() {
+  return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+}
+
+struct ConnectResult {
+  absl::Duration discovery;
+  absl::Duration connection;
+  // The id under which `advertiser` knows the discoverer.
+  std::string endpoint_id;
+};
+
+// Makes `discoverer` find and connect to `advertiser`, which must be
+// advertising already.
+std::optional<ConnectResult> Connect(BenchmarkUser& advertiser,
+                                     BenchmarkUser& discoverer) {
+  CountDownLatch found(1);
+  absl::Time start = absl::Now();
+  if (!discoverer.StartDiscovery(kServiceId, &found).Ok() || !Await(found)) {
+    return std::nullopt;
+  }
+  ConnectResult result{.discovery = absl::Now() - start};
+
+  CountDownLatch initiated(2);
+  CountDownLatch accepted(2);
+  start = absl::Now();
+  advertiser.ExpectConnectionInitiated(initiated);
+  if (!discoverer.RequestConnection(&initiated).Ok() || !Await(initiated)) {
+    return std::nullopt;
+  }
+  advertiser.AcceptConnection(&accepted);
+  discoverer.AcceptConnection(&accepted);
+  if (!Await(accepted)) return std::nullopt;
+  result.connection = absl::Now() - start;
+  result.endpoint_id = advertiser.GetDiscovered().endpoint_id;
+  discoverer.StopDiscovery();
+  return result;
+}
+
+struct TransferResult {
+  absl::Duration elapsed;
+  double cpu_seconds;
+};
+
+// Sends a payload of `size` bytes from `sender` to every receiver, and waits
+// until all of them have received it completely.
+std::optional<TransferResult> Transfer(
+    BenchmarkUser& sender, const std::vector<std::string>& endpoint_ids,
+    absl::Span<BenchmarkUser* const> receivers, PayloadKind kind,
+    std::int64_t size, const FilePath& source_file) {
+  SingleThreadExecutor stream_writer;
+  Payload payload;
+  switch (kind) {
+    case PayloadKind::kBytes:
+      payload = Payload(ByteArray(std::string(size, 'b')));
+      break;
+    case PayloadKind::kFile:
+      payload = Payload("", "benchmark.bin", InputFile(source_file.ToString()));
+      break;
+    case PayloadKind::kStream: {
+      auto [input, output] = CreatePipe();
+      payload = Payload(std::move(input));
+      stream_writer.Execute([output = std::move(output), size]() mutable {
+        std::string block(kStreamWriteSize, 's');
+        for (std::int64_t written = 0; written < size;
+             written += kStreamWriteSize) {
+          if (output->Write(absl::string_view(block).substr(
+                  0, std::min(kStreamWriteSize, size - written)))
+                  .Raised()) {
+            break;
+          }
+        }
+        output->Close();
+      });
+      break;
+    }
+  }
+  Payload::Id payload_id = payload.GetId();
+
+  double cpu_start = GetCpuSeconds();
+  absl::Time start = absl::Now();
+  sender.SendPayloadTo(endpoint_ids, std::move(payload));
+  for (BenchmarkUser* receiver : receivers) {
+    bool received = receiver->WaitForProgress(
+        [payload_id, size](const PayloadProgressInfo& info) {
+          return info.payload_id == payload_id &&
+                 info.status == PayloadProgressInfo::Status::kSuccess &&
+                 info.bytes_transferred >= size;
+        },
+        kTimeout);
+    if (!received) return std::nullopt;
+  }
+  return TransferResult{.elapsed = absl::Now() - start,
+                        .cpu_seconds = GetCpuSeconds() - cpu_start};
+}
+
+json MeasureConnectionEstablishment(Medium medium,
+                                    const BooleanMediumSelector& mediums) {
+  std::vector<double> discovery_ms;
+  std::vector<double> connection_ms;
+  for (int i = 0; i < kRepetitions; ++i) {
+    ScopedEnvironment environment;
+    BenchmarkUser advertiser("advertiser", mediums);
+    BenchmarkUser discoverer("discoverer", mediums);
+    if (advertiser.StartAdvertising(kServiceId, nullptr).Ok()) {
+      if (std::optional<ConnectResult> result =
+              Connect(advertiser, discoverer)) {
+        discovery_ms.push_back(ToMilliseconds(result->discovery));
+        connection_ms.push_back(ToMilliseconds(result->connection));
+      }
+    }
+    advertiser.Stop();
+    discoverer.Stop();
+  }
+  return {
+      {"medium", Medium_Name(medium)},
+      {"samples", connection_ms.size()},
+      {"discovery_ms", Median(discovery_ms)},
+      {"connection_ms", Median(connection_ms)},
+  };
+}
+
+// Sends kThroughputPayloadSize bytes over Wi-Fi LAN with the given chunk size.
+json MeasureThroughput(PayloadKind kind, std::int64_t chunk_size,
+                       const FilePath& source_file) {
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kMediumDefaultMaxTransmitPacketSize,
+      chunk_size);
+  std::vector<double> seconds;
+  std::vector<double> cpu_seconds;
+  for (int i = 0; i < kRepetitions; ++i) {
+    ScopedEnvironment environment;
+    BooleanMediumSelector mediums{.wifi_lan = true};
+    BenchmarkUser sender("sender", mediums);
+    BenchmarkUser receiver("receiver", mediums);
+    receiver.SetCustomSavePath(source_file.GetParentPath().ToString());
+    std::optional<ConnectResult> connection;
+    if (sender.StartAdvertising(kServiceId, nullptr).Ok()) {
+      connection = Connect(sender, receiver);
+    }
+    if (connection.has_value()) {
+      BenchmarkUser* receivers[] = {&receiver};
+      if (std::optional<TransferResult> result =
+              Transfer(sender, {connection->endpoint_id}, receivers, kind,
+                       kThroughputPayloadSize, source_file)) {
+        seconds.push_back(absl::ToDoubleSeconds(result->elapsed));
+        cpu_seconds.push_back(result->cpu_seconds);
+      }
+    }
+    sender.Stop();
+    receiver.Stop();
+  }
+  double megabytes = static_cast<double>(kThroughputPayloadSize) / kMegabyte;
+  double median_seconds = Median(seconds);
+  return {
+      {"medium", Medium_Name(Medium::WIFI_LAN)},
+      {"payload_type", PayloadKindName(kind)},
+      {"chunk_size", chunk_size},
+      {"payload_bytes", kThroughputPayloadSize},
+      {"samples", seconds.size()},
+      {"mb_per_second", median_seconds > 0 ? megabytes / median_seconds : 0},
+      {"cpu_ms_per_mb", Median(cpu_seconds) * 1000 / megabytes},
+  };
+}
+
+// Sends one BYTES payload to `endpoints` receivers over Wi-Fi LAN.
+json MeasureFanOut(int endpoints) {
+  std::vector<double> seconds;
+  std::vector<double> cpu_seconds;
+  for (int i = 0; i < kRepetitions; ++i) {
+    ScopedEnvironment environment;
+    BooleanMediumSelector mediums{.wifi_lan = true};
+    BenchmarkUser sender("sender", mediums);
+    std::vector<std::unique_ptr<BenchmarkUser>> receivers;
+    std::vector<BenchmarkUser*> receiver_ptrs;
+    std::vector<std::string> endpoint_ids;
+    bool connected = sender.StartAdvertising(kServiceId, nullptr).Ok();
+    for (int j = 0; connected && j < endpoints; ++j) {
+      receivers.push_back(std::make_unique<BenchmarkUser>(
+          "receiver-" + std::to_string(j), mediums));
+      receiver_ptrs.push_back(receivers.back().get());
+      std::optional<ConnectResult> connection =
+          Connect(sender, *receivers.back());
+      connected = connection.has_value();
+      if (connected) endpoint_ids.push_back(connection->endpoint_id);
+    }
+    if (connected) {
+      if (std::optional<TransferResult> result =
+              Transfer(sender, endpoint_ids, receiver_ptrs, PayloadKind::kBytes,
+                       kFanOutPayloadSize, FilePath())) {
+        seconds.push_back(absl::ToDoubleSeconds(result->elapsed));
+        cpu_seconds.push_back(result->cpu_seconds);
+      }
+    }
+    sender.Stop();
+    for (auto& receiver : receivers) receiver->Stop();
+  }
+  double delivered_megabytes =
+      static_cast<double>(kFanOutPayloadSize) * endpoints / kMegabyte;
+  double median_seconds = Median(seconds);
+  return {
+      {"medium", Medium_Name(Medium::WIFI_LAN)},
+      {"endpoints", endpoints},
+      {"payload_bytes", kFanOutPayloadSize},
+      {"samples", seconds.size()},
+      {"completion_ms", median_seconds * 1000},
+      {"aggregate_mb_per_second",
+       median_seconds > 0 ? delivered_megabytes / median_seconds : 0},
+      {"cpu_ms_per_mb", Median(cpu_seconds) * 1000 / delivered_megabytes},
+  };
+}
+
+// Connects over Bluetooth and measures how long it takes until both sides
+// report the upgrade to Wi-Fi LAN.
+json MeasureBandwidthUpgrade() {
+  std::vector<double> switch_over_ms;
+  for (int i = 0; i < kRepetitions; ++i) {
+    ScopedEnvironment environment;
+    BooleanMediumSelector mediums{.bluetooth = true, .wifi_lan = true};
+    BwuManager::Config bwu_config{.allow_upgrade_to = {.wifi_lan = true}};
+    BenchmarkUser advertiser("advertiser", mediums, bwu_config);
+    BenchmarkUser discoverer("discoverer", mediums, bwu_config);
+    // Discovering over Bluetooth only makes the connection start there.
+    discoverer.DiscoverOn({.bluetooth = true});
+    CountDownLatch upgraded(2);
+    advertiser.ExpectBandwidthUpgrade(upgraded);
+    discoverer.ExpectBandwidthUpgrade(upgraded);
+    if (advertiser.StartAdvertising(kServiceId, nullptr).Ok() &&
+        Connect(advertiser, discoverer).has_value()) {
+      // The advertiser starts the upgrade as soon as the connection is
+      // accepted, which is where Connect() returns.
+      absl::Time start = absl::Now();
+      if (Await(upgraded) && discoverer.GetMedium() == Medium::WIFI_LAN) {
+        switch_over_ms.push_back(ToMilliseconds(absl::Now() - start));
+      }
+    }
+    advertiser.Stop();
+    discoverer.Stop();
+  }
+  return {
+      {"from", Medium_Name(Medium::BLUETOOTH)},
+      {"to", Medium_Name(Medium::WIFI_LAN)},
+      {"samples", switch_over_ms.size()},
+      {"switch_over_ms", Median(switch_over_ms)},
+  };
+}
+
+json LinkModelsToJson() {
+  json models = json::array();
+  for (const auto& [medium, link_model] : kLinkModels) {
+    models.push_back({
+        {"medium", SimulatedMediumName(medium)},
+        {"bandwidth_bytes_per_second", link_model.bandwidth_bytes_per_second},
+        {"latency_ms", ToMilliseconds(link_model.latency)},
+        {"jitter_ms", ToMilliseconds(link_model.jitter)},
+        {"mtu_bytes", link_model.mtu_bytes},
+    });
+  }
+  return models;
+}
+
+// Writes the file sent by the FILE payload runs.
+bool WriteSourceFile(const FilePath& path) {
+  std::ofstream file(path.ToString(), std::ios::binary | std::ios::trunc);
+  std::string block(kMegabyte, 'f');
+  for (std::int64_t i = 0; i < kThroughputPayloadSize / kMegabyte; ++i) {
+    file.write(block.data(), block.size());
+  }
+  return file.good();
+}
+
+int Run() {
+  FilePath work_directory = Files::GetTemporaryDirectory();
+  work_directory.append(FilePath("connections_benchmark"));
+  Files::RemoveDirectory(work_directory);
+  FilePath source_file = work_directory;
+  source_file.append(FilePath("source.bin"));
+  if (!Files::CreateDirectories(work_directory) ||
+      !WriteSourceFile(source_file)) {
+    std::cerr << "Cannot write " << source_file.ToString() << std::endl;
+    return 1;
+  }
+
+  json report = {
+      {"benchmark", "nearby_connections"},
+      {"repetitions", kRepetitions},
+      {"link_models", LinkModelsToJson()},
+  };
+
+  json& establishment = report["connection_establishment"] = json::array();
+  establishment.push_back(
+      MeasureConnectionEstablishment(Medium::BLUETOOTH, {.bluetooth = true}));
+  establishment.push_back(
+      MeasureConnectionEstablishment(Medium::BLE, {.ble = true}));
+  establishment.push_back(
+      MeasureConnectionEstablishment(Medium::WIFI_LAN, {.wifi_lan = true}));
+
+  json& throughput = report["payload_throughput"] = json::array();
+  for (PayloadKind kind :
+       {PayloadKind::kBytes, PayloadKind::kFile, PayloadKind::kStream}) {
+    for (std::int64_t chunk_size : kChunkSizes) {
+      throughput.push_back(MeasureThroughput(kind, chunk_size, source_file));
+    }
+  }
+  NearbyFlags::GetInstance().ResetOverridedValues();
+
+  json& fan_out = report["fan_out"] = json::array();
+  for (int endpoints : kFanOutEndpoints) {
+    fan_out.push_back(MeasureFanOut(endpoints));
+  }
+
+  report["bandwidth_upgrade"] = json::array({MeasureBandwidthUpgrade()});
+
+  Files::RemoveDirectory(work_directory);
+  std::cout << report.dump(2) << std::endl;
+  return 0;
+}
+
+}  // namespace
+}  // namespace nearby::connections
+
+int main() { return nearby::connections::Run(); }
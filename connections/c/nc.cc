@@ -791,6 +791,22 @@ int NcGetLocalEndpointId(NC_INSTANCE instance) {
   return convertStringToInt(endpoint_id);
 }
 
+void NcGetMetricsSnapshot(NC_INSTANCE instance,
+                          NcCallbackMetricsSnapshot snapshot_callback,
+                          CALLER_CONTEXT context) {
+  NcContext* nc_context = GetContext(instance);
+  if (nc_context == nullptr) {
+    return;
+  }
+
+  std::string json = nc_context->core->GetMetricsSnapshot().ToJson();
+  NC_DATA snapshot = NC_DATA{
+      .size = static_cast<uint64_t>(json.size()),
+      .data = json.data(),
+  };
+  snapshot_callback(&snapshot, context);
+}
+
 void NcEnableBleV2(NC_INSTANCE instance, bool enable,
                    NcCallbackResult result_callback, CALLER_CONTEXT context) {
   result_callback(NC_STATUS_SUCCESS, context);
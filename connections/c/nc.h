@@ -183,6 +183,15 @@ NC_API void NcInitiateBandwidthUpgrade(NC_INSTANCE instance, int endpoint_id,
 // Gets the local endpoint generated by Nearby Connections.
 NC_API int NcGetLocalEndpointId(NC_INSTANCE instance);
 
+// Gets the hot-path metrics of Nearby Connections: counters, gauges and latency
+// histograms, keyed by name, as a JSON object.
+//
+// instance - The returned instance by NcOpenService.
+// snapshot_callback - Called with the snapshot before this function returns.
+NC_API void NcGetMetricsSnapshot(NC_INSTANCE instance,
+                                 NcCallbackMetricsSnapshot snapshot_callback,
+                                 CALLER_CONTEXT context);
+
 // Enable/Disable BLE V2 advertising. The method is deprecated.  It's a no-op.
 NC_API void NcEnableBleV2(NC_INSTANCE instance, bool enable,
                           NcCallbackResult result_callback,
@@ -189,6 +189,10 @@ typedef struct NC_CONNECTION_RESPONSE_INFO {
 
 typedef void (*NcCallbackResult)(NC_STATUS status, CALLER_CONTEXT context);
 
+// `snapshot` is a JSON object, only valid during the call.
+typedef void (*NcCallbackMetricsSnapshot)(const NC_DATA* snapshot,
+                                          CALLER_CONTEXT context);
+
 typedef void (*NcCallbackConnectionInitiated)(
     NC_INSTANCE instance, int endpoint_id,
     const NC_CONNECTION_RESPONSE_INFO* info, CALLER_CONTEXT context);
@@ -40,6 +40,7 @@
 #include "connections/v3/listening_result.h"
 #include "internal/interop/device.h"
 #include "internal/interop/device_provider.h"
+#include "internal/platform/metrics_registry.h"
 
 namespace nearby {
 namespace connections {
@@ -258,6 +259,11 @@ class Core {
   // Gets the local endpoint generated by Nearby Connections.
   std::string GetLocalEndpointId() { return client_.GetLocalEndpointId(); }
 
+  // Gets the hot-path metrics collected by Nearby Connections.
+  MetricsSnapshot GetMetricsSnapshot() const {
+    return client_.GetMetricsSnapshot();
+  }
+
   std::string Dump();
 
   //******************************* V3 *******************************
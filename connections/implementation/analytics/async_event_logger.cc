@@ -0,0 +1,304 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/analytics/async_event_logger.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <system_error>  // NOLINT
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "internal/base/file_path.h"
+#include "internal/base/files.h"
+#include "internal/platform/logging.h"
+#include "internal/platform/mutex_lock.h"
+#include "location/nearby/analytics/cpp/proto/connections_log.pb.h"
+#include "location/nearby/analytics/cpp/proto/sharing_log.pb.h"
+
+namespace nearby::analytics {
+namespace {
+
+using ::location::nearby::analytics::proto::ConnectionsLog;
+using ::nearby::sharing::analytics::proto::SharingLog;
+
+constexpr absl::string_view kSpoolFilePrefix = "events_";
+constexpr absl::string_view kSpoolFileSuffix = ".spool";
+
+void AppendVarint(uint64_t value, std::string& out) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+bool ReadVarint(absl::string_view& data, uint64_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 64 && !data.empty(); shift += 7) {
+    uint8_t byte = static_cast<uint8_t>(data.front());
+    data.remove_prefix(1);
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns the number of the spool file `file_name`, or -1 if it isn't one.
+int64_t GetSpoolFileNumber(absl::string_view file_name) {
+  if (!absl::ConsumePrefix(&file_name, kSpoolFilePrefix) ||
+      !absl::ConsumeSuffix(&file_name, kSpoolFileSuffix)) {
+    return -1;
+  }
+  int64_t number;
+  if (!absl::SimpleAtoi(file_name, &number) || number < 0) {
+    return -1;
+  }
+  return number;
+}
+
+std::vector<std::pair<int64_t, FilePath>> ListSpoolFiles(
+    const FilePath& directory) {
+  std::vector<std::pair<int64_t, FilePath>> spool_files;
+  std::error_code error_code;
+  for (const auto& entry : std::filesystem::directory_iterator(
+           directory.GetPath(), error_code)) {
+    std::string file_name = entry.path().filename().string();
+    int64_t number = GetSpoolFileNumber(file_name);
+    if (number >= 0 && entry.is_regular_file(error_code)) {
+      spool_files.push_back(
+          {number, FilePath(directory).append(FilePath(file_name))});
+    }
+  }
+  std::sort(spool_files.begin(), spool_files.end());
+  return spool_files;
+}
+
+}  // namespace
+
+AsyncEventLogger::AsyncEventLogger(Options options, EventLogger* delegate)
+    : options_(std::move(options)), delegate_(delegate) {
+  if (!options_.spool_directory.IsEmpty()) {
+    Files::CreateDirectories(options_.spool_directory);
+    // Continue the numbering of an earlier session, and keep its files in
+    // the rotation.
+    for (auto& [number, path] : ListSpoolFiles(options_.spool_directory)) {
+      next_spool_file_number_ = number + 1;
+      spool_files_.push_back(std::move(path));
+    }
+  }
+  writer_.Execute("async-event-logger", [this]() { RunWriteLoop(); });
+}
+
+AsyncEventLogger::~AsyncEventLogger() {
+  {
+    MutexLock lock(&mutex_);
+    shutdown_ = true;
+    cond_.Notify();
+  }
+  writer_.Shutdown();
+}
+
+void AsyncEventLogger::Log(const ConnectionsLog& message) {
+  Enqueue(Message(std::in_place_index<0>, message));
+}
+
+void AsyncEventLogger::Log(const SharingLog& message) {
+  Enqueue(Message(std::in_place_index<1>, message));
+}
+
+void AsyncEventLogger::Enqueue(Message message) {
+  MutexLock lock(&mutex_);
+  if (shutdown_ ||
+      static_cast<int>(queue_.size()) >= options_.max_queued_messages) {
+    ++dropped_message_count_;
+    return;
+  }
+  queue_.push_back(std::move(message));
+  cond_.Notify();
+}
+
+void AsyncEventLogger::Flush() {
+  MutexLock lock(&mutex_);
+  int64_t request = ++flush_request_count_;
+  cond_.Notify();
+  while (flushed_count_ < request) cond_.Wait();
+}
+
+int64_t AsyncEventLogger::GetDroppedMessageCount() const {
+  MutexLock lock(&mutex_);
+  return dropped_message_count_;
+}
+
+void AsyncEventLogger::RunWriteLoop() {
+  while (true) {
+    std::vector<Message> messages;
+    int64_t flush_request_count;
+    bool flush;
+    bool shutdown;
+    {
+      MutexLock lock(&mutex_);
+      while (queue_.empty() && !shutdown_ &&
+             flush_request_count_ <= flushed_count_) {
+        if (batch_deadline_ == absl::InfiniteFuture()) {
+          cond_.Wait();
+          continue;
+        }
+        absl::Duration remaining = batch_deadline_ - absl::Now();
+        if (remaining <= absl::ZeroDuration()) break;
+        cond_.Wait(remaining);
+      }
+      messages.swap(queue_);
+      flush_request_count = flush_request_count_;
+      flush = flush_request_count_ > flushed_count_;
+      shutdown = shutdown_;
+    }
+
+    for (const Message& message : messages) {
+      AppendToBatch(message);
+    }
+    if (shutdown || flush || absl::Now() >= batch_deadline_) {
+      WriteBatch();
+    }
+
+    MutexLock lock(&mutex_);
+    flushed_count_ = flush_request_count;
+    cond_.Notify();
+    if (shutdown && queue_.empty()) {
+      return;
+    }
+  }
+}
+
+void AsyncEventLogger::AppendToBatch(const Message& message) {
+  RecordType type;
+  std::string serialized;
+  if (const auto* connections_log = std::get_if<0>(&message)) {
+    if (delegate_ != nullptr) delegate_->Log(*connections_log);
+    type = RecordType::kConnectionsLog;
+    serialized = connections_log->SerializeAsString();
+  } else {
+    const SharingLog& sharing_log = std::get<1>(message);
+    if (delegate_ != nullptr) delegate_->Log(sharing_log);
+    type = RecordType::kSharingLog;
+    serialized = sharing_log.SerializeAsString();
+  }
+  if (options_.spool_directory.IsEmpty()) {
+    return;
+  }
+  if (batch_.empty()) {
+    batch_deadline_ = absl::Now() + options_.flush_interval;
+  }
+  batch_.push_back(static_cast<char>(type));
+  AppendVarint(serialized.size(), batch_);
+  batch_.append(serialized);
+  if (batch_.size() >= options_.max_batch_bytes) {
+    WriteBatch();
+  }
+}
+
+void AsyncEventLogger::WriteBatch() {
+  if (batch_.empty()) {
+    return;
+  }
+  if ((!spool_file_.is_open() ||
+       spool_file_bytes_ + batch_.size() > options_.max_spool_file_bytes) &&
+      !OpenNextSpoolFile()) {
+    LOG(WARNING) << "Dropped " << batch_.size()
+                 << " bytes of events; failed to open a spool file.";
+  } else {
+    spool_file_.write(batch_.data(), batch_.size());
+    spool_file_.flush();
+    if (!spool_file_.good()) {
+      LOG(WARNING) << "Failed to write " << batch_.size()
+                   << " bytes of events to the spool file.";
+      spool_file_.close();
+    }
+    spool_file_bytes_ += batch_.size();
+  }
+  batch_.clear();
+  batch_deadline_ = absl::InfiniteFuture();
+}
+
+bool AsyncEventLogger::OpenNextSpoolFile() {
+  if (spool_file_.is_open()) {
+    spool_file_.close();
+  }
+  FilePath path = options_.spool_directory;
+  path.append(FilePath(absl::StrCat(kSpoolFilePrefix,
+                                    next_spool_file_number_++,
+                                    kSpoolFileSuffix)));
+  spool_file_.open(path.GetPath(), std::ios::binary | std::ios::trunc);
+  spool_file_bytes_ = 0;
+  if (!spool_file_.is_open()) {
+    return false;
+  }
+  spool_files_.push_back(std::move(path));
+  while (static_cast<int>(spool_files_.size()) >
+         std::max(options_.max_spool_files, 1)) {
+    Files::RemoveFile(spool_files_.front());
+    spool_files_.pop_front();
+  }
+  return true;
+}
+
+std::vector<FilePath> AsyncEventLogger::GetSpoolFiles(
+    const FilePath& directory) {
+  std::vector<FilePath> paths;
+  for (auto& [number, path] : ListSpoolFiles(directory)) {
+    paths.push_back(std::move(path));
+  }
+  return paths;
+}
+
+bool AsyncEventLogger::ReadSpoolFile(
+    const FilePath& path,
+    absl::AnyInvocable<void(RecordType type, absl::string_view message)>
+        callback) {
+  std::ifstream file(path.GetPath(), std::ios::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+  std::string contents((std::istreambuf_iterator<char>(file)),
+                       std::istreambuf_iterator<char>());
+  absl::string_view data = contents;
+  while (!data.empty()) {
+    auto type = static_cast<RecordType>(data.front());
+    data.remove_prefix(1);
+    uint64_t size;
+    if (!ReadVarint(data, size) || size > data.size()) {
+      return false;
+    }
+    callback(type, data.substr(0, size));
+    data.remove_prefix(size);
+  }
+  return true;
+}
+
+}  // namespace nearby::analytics
@@ -0,0 +1,137 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CONNECTIONS_IMPLEMENTATION_ANALYTICS_ASYNC_EVENT_LOGGER_H_
+#define CONNECTIONS_IMPLEMENTATION_ANALYTICS_ASYNC_EVENT_LOGGER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "internal/base/file_path.h"
+#include "internal/platform/condition_variable.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/single_thread_executor.h"
+#include "location/nearby/analytics/cpp/logging/event_logger.h"
+#include "location/nearby/analytics/cpp/proto/connections_log.pb.h"
+#include "location/nearby/analytics/cpp/proto/sharing_log.pb.h"
+
+namespace nearby::analytics {
+
+// An EventLogger that returns to the caller right away, and serializes and
+// stores the messages on a background thread.
+//
+// Messages are serialized in batches and appended to spool files in
+// `Options::spool_directory`. A batch is written once it reaches
+// `max_batch_bytes`, or `flush_interval` after its first message. Spool files
+// are rotated at `max_spool_file_bytes`, and the oldest ones are removed to
+// keep at most `max_spool_files`. Every record in a spool file is a RecordType
+// byte, the length of the serialized message as a varint, and the serialized
+// message.
+//
+// Messages that arrive while `max_queued_messages` messages wait for the
+// background thread are dropped and counted, so that logging never blocks or
+// grows without bound.
+class AsyncEventLogger : public EventLogger {
+ public:
+  struct Options {
+    // Nothing is spooled if empty.
+    FilePath spool_directory;
+    int max_queued_messages = 1024;
+    size_t max_batch_bytes = 64 * 1024;
+    absl::Duration flush_interval = absl::Seconds(5);
+    size_t max_spool_file_bytes = 1024 * 1024;
+    int max_spool_files = 4;
+  };
+
+  enum class RecordType : uint8_t {
+    kConnectionsLog = 1,
+    kSharingLog = 2,
+  };
+
+  // Every message is also passed to `delegate`, if set, on the background
+  // thread. `delegate` must outlive the AsyncEventLogger.
+  explicit AsyncEventLogger(Options options, EventLogger* delegate = nullptr);
+  // Writes the queued messages before returning.
+  ~AsyncEventLogger() override;
+
+  void Log(const location::nearby::analytics::proto::ConnectionsLog& message)
+      override ABSL_LOCKS_EXCLUDED(mutex_);
+  void Log(const nearby::sharing::analytics::proto::SharingLog& message)
+      override ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Blocks until the messages logged so far are written to the spool.
+  void Flush() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the number of messages dropped because the queue was full.
+  int64_t GetDroppedMessageCount() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the spool files in `directory`, oldest first.
+  static std::vector<FilePath> GetSpoolFiles(const FilePath& directory);
+
+  // Calls `callback` with every record of the spool file at `path`. Returns
+  // false if the file can't be read or ends with a truncated record.
+  static bool ReadSpoolFile(
+      const FilePath& path,
+      absl::AnyInvocable<void(RecordType type, absl::string_view message)>
+          callback);
+
+ private:
+  using Message =
+      std::variant<location::nearby::analytics::proto::ConnectionsLog,
+                   nearby::sharing::analytics::proto::SharingLog>;
+
+  void Enqueue(Message message) ABSL_LOCKS_EXCLUDED(mutex_);
+  void RunWriteLoop() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Only called on the background thread.
+  void AppendToBatch(const Message& message);
+  void WriteBatch();
+  bool OpenNextSpoolFile();
+
+  const Options options_;
+  EventLogger* const delegate_;
+
+  mutable Mutex mutex_;
+  // Signals the background thread of new work, and Flush() of its progress.
+  ConditionVariable cond_{&mutex_};
+  std::vector<Message> queue_ ABSL_GUARDED_BY(mutex_);
+  int64_t dropped_message_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Flush() waits until `flushed_count_` reaches its request.
+  int64_t flush_request_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t flushed_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+
+  // State of the background thread.
+  std::string batch_;
+  absl::Time batch_deadline_ = absl::InfiniteFuture();
+  std::ofstream spool_file_;
+  size_t spool_file_bytes_ = 0;
+  int64_t next_spool_file_number_ = 0;
+  std::deque<FilePath> spool_files_;
+
+  SingleThreadExecutor writer_;
+};
+
+}  // namespace nearby::analytics
+
+#endif  // CONNECTIONS_IMPLEMENTATION_ANALYTICS_ASYNC_EVENT_LOGGER_H_
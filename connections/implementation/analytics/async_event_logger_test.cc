@@ -0,0 +1,193 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/analytics/async_event_logger.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "internal/base/file_path.h"
+#include "internal/base/files.h"
+#include "location/nearby/analytics/cpp/logging/event_logger.h"
+#include "location/nearby/analytics/cpp/proto/connections_log.pb.h"
+#include "location/nearby/analytics/cpp/proto/sharing_log.pb.h"
+
+namespace nearby::analytics {
+namespace {
+
+using ::location::nearby::analytics::proto::ConnectionsLog;
+using ::nearby::sharing::analytics::proto::SharingLog;
+using RecordType = AsyncEventLogger::RecordType;
+
+constexpr absl::Duration kWaitTimeout = absl::Seconds(5);
+
+class CountingEventLogger : public EventLogger {
+ public:
+  void Log(const ConnectionsLog& message) override {
+    absl::MutexLock lock(&mutex_);
+    ++connections_log_count_;
+  }
+  void Log(const SharingLog& message) override {
+    absl::MutexLock lock(&mutex_);
+    ++sharing_log_count_;
+  }
+
+  int connections_log_count() const {
+    absl::MutexLock lock(&mutex_);
+    return connections_log_count_;
+  }
+  int sharing_log_count() const {
+    absl::MutexLock lock(&mutex_);
+    return sharing_log_count_;
+  }
+
+ private:
+  mutable absl::Mutex mutex_;
+  int connections_log_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int sharing_log_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+class AsyncEventLoggerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    directory_ = Files::GetTemporaryDirectory().append(FilePath(
+        ::testing::UnitTest::GetInstance()->current_test_info()->name()));
+    Files::RemoveDirectory(directory_);
+  }
+
+  void TearDown() override { Files::RemoveDirectory(directory_); }
+
+  std::vector<RecordType> ReadRecords() {
+    std::vector<RecordType> records;
+    for (const FilePath& path : AsyncEventLogger::GetSpoolFiles(directory_)) {
+      EXPECT_TRUE(AsyncEventLogger::ReadSpoolFile(
+          path, [&](RecordType type, absl::string_view message) {
+            records.push_back(type);
+          }));
+    }
+    return records;
+  }
+
+  FilePath directory_;
+};
+
+TEST_F(AsyncEventLoggerTest, SpoolsMessagesInOrder) {
+  CountingEventLogger delegate;
+  AsyncEventLogger logger({.spool_directory = directory_}, &delegate);
+
+  logger.Log(ConnectionsLog());
+  logger.Log(SharingLog());
+  logger.Log(ConnectionsLog());
+  logger.Flush();
+
+  EXPECT_EQ(ReadRecords(),
+            std::vector<RecordType>({RecordType::kConnectionsLog,
+                                     RecordType::kSharingLog,
+                                     RecordType::kConnectionsLog}));
+  EXPECT_EQ(delegate.connections_log_count(), 2);
+  EXPECT_EQ(delegate.sharing_log_count(), 1);
+  EXPECT_EQ(logger.GetDroppedMessageCount(), 0);
+}
+
+TEST_F(AsyncEventLoggerTest, WritesBatchAfterFlushInterval) {
+  AsyncEventLogger logger({.spool_directory = directory_,
+                           .flush_interval = absl::Milliseconds(10)});
+
+  logger.Log(SharingLog());
+
+  absl::Time deadline = absl::Now() + kWaitTimeout;
+  while (ReadRecords().empty() && absl::Now() < deadline) {
+    absl::SleepFor(absl::Milliseconds(10));
+  }
+  EXPECT_EQ(ReadRecords(), std::vector<RecordType>({RecordType::kSharingLog}));
+}
+
+TEST_F(AsyncEventLoggerTest, WritesQueuedMessagesOnDestruction) {
+  {
+    AsyncEventLogger logger({.spool_directory = directory_});
+    logger.Log(ConnectionsLog());
+  }
+
+  EXPECT_EQ(ReadRecords(),
+            std::vector<RecordType>({RecordType::kConnectionsLog}));
+}
+
+TEST_F(AsyncEventLoggerTest, RotatesSpoolFiles) {
+  {
+    // Every message is a batch, and every batch a spool file.
+    AsyncEventLogger logger({.spool_directory = directory_,
+                             .max_batch_bytes = 1,
+                             .max_spool_file_bytes = 1,
+                             .max_spool_files = 2});
+    for (int i = 0; i < 5; ++i) {
+      logger.Log(ConnectionsLog());
+    }
+  }
+  EXPECT_EQ(AsyncEventLogger::GetSpoolFiles(directory_).size(), 2);
+
+  // A new session continues the rotation.
+  {
+    AsyncEventLogger logger({.spool_directory = directory_,
+                             .max_batch_bytes = 1,
+                             .max_spool_file_bytes = 1,
+                             .max_spool_files = 2});
+    logger.Log(SharingLog());
+  }
+  std::vector<FilePath> spool_files =
+      AsyncEventLogger::GetSpoolFiles(directory_);
+  ASSERT_EQ(spool_files.size(), 2);
+  EXPECT_EQ(spool_files[1].GetFileName().ToString(), "events_5.spool");
+  EXPECT_EQ(ReadRecords(),
+            std::vector<RecordType>(
+                {RecordType::kConnectionsLog, RecordType::kSharingLog}));
+}
+
+TEST_F(AsyncEventLoggerTest, DropsMessagesWhenQueueIsFull) {
+  // Holds the background thread in the first Log() call.
+  class BlockingEventLogger : public CountingEventLogger {
+   public:
+    void Log(const ConnectionsLog& message) override {
+      entered_.Notify();
+      release_.WaitForNotification();
+      CountingEventLogger::Log(message);
+    }
+    using CountingEventLogger::Log;
+
+    absl::Notification entered_;
+    absl::Notification release_;
+  };
+  BlockingEventLogger delegate;
+  AsyncEventLogger logger({.max_queued_messages = 2}, &delegate);
+
+  logger.Log(ConnectionsLog());
+  ASSERT_TRUE(delegate.entered_.WaitForNotificationWithTimeout(kWaitTimeout));
+  logger.Log(SharingLog());
+  logger.Log(SharingLog());
+  logger.Log(SharingLog());
+  delegate.release_.Notify();
+  logger.Flush();
+
+  EXPECT_EQ(logger.GetDroppedMessageCount(), 1);
+  EXPECT_EQ(delegate.connections_log_count(), 1);
+  EXPECT_EQ(delegate.sharing_log_count(), 2);
+}
+
+}  // namespace
+}  // namespace nearby::analytics
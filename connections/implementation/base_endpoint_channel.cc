@@ -14,40 +14,108 @@
 
 #include "connections/implementation/base_endpoint_channel.h"
 
+#include <array>
 #include <cassert>
 #include <climits>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 
+#include "absl/functional/any_invocable.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "connections/implementation/analytics/analytics_recorder.h"
+#include "connections/implementation/chunk_size_controller.h"
 #include "connections/implementation/endpoint_channel_manager.h"
 #include "connections/implementation/flags/nearby_connections_feature_flags.h"
 #include "connections/implementation/offline_frames.h"
 #include "internal/flags/nearby_flags.h"
 #include "internal/platform/base64_utils.h"
+#include "internal/platform/bounded_blocking_queue.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/implementation/system_clock.h"
 #include "internal/platform/input_stream.h"
 #include "internal/platform/logging.h"
+#include "internal/platform/metrics_registry.h"
 #include "internal/platform/mutex.h"
 #include "internal/platform/mutex_lock.h"
 #include "internal/platform/output_stream.h"
+#include "internal/platform/single_thread_executor.h"
 
 namespace nearby::connections {
 
 namespace {
+using ::location::nearby::proto::connections::Medium;
 using ::location::nearby::proto::connections::Medium::BLE;
 using ::location::nearby::proto::connections::Medium::BLE_L2CAP;
 using ::nearby::analytics::SafeDisconnectionResult;
 using ::location::nearby::proto::connections::DisconnectionReason;
 
+// How long Close() waits for already queued frames (such as a disconnection
+// frame) to be written before tearing down the medium.
+constexpr absl::Duration kPendingWritesDrainTimeout = absl::Seconds(1);
+
+// Hot-path metrics shared by all channels of a medium.
+struct ChannelMetrics {
+  MetricsCounter* bytes_read = nullptr;
+  MetricsCounter* bytes_written = nullptr;
+  MetricsHistogram* write_latency_us = nullptr;
+};
+
+const ChannelMetrics& GetChannelMetrics(Medium medium) {
+  static const auto* metrics = []() {
+    auto* metrics = new std::array<ChannelMetrics,
+                                   location::nearby::proto::connections::
+                                       Medium_ARRAYSIZE>();
+    MetricsRegistry& registry = MetricsRegistry::GetInstance();
+    for (int i = 0; i < static_cast<int>(metrics->size()); ++i) {
+      std::string prefix = absl::StrCat(
+          "channel.",
+          location::nearby::proto::connections::Medium_IsValid(i)
+              ? location::nearby::proto::connections::Medium_Name(
+                    static_cast<Medium>(i))
+              : "UNKNOWN_MEDIUM",
+          ".");
+      (*metrics)[i] = {
+          .bytes_read =
+              &registry.GetCounter(absl::StrCat(prefix, "bytes_read")),
+          .bytes_written =
+              &registry.GetCounter(absl::StrCat(prefix, "bytes_written")),
+          .write_latency_us =
+              &registry.GetHistogram(absl::StrCat(prefix, "write_latency_us")),
+      };
+    }
+    return metrics;
+  }();
+  int index = static_cast<int>(medium);
+  return (*metrics)[index >= 0 && index < static_cast<int>(metrics->size())
+                        ? index
+                        : 0];
+}
+
+MetricsHistogram& GetEncryptLatencyHistogram() {
+  static MetricsHistogram& histogram =
+      MetricsRegistry::GetInstance().GetHistogram("channel.encrypt_us");
+  return histogram;
+}
+
+MetricsHistogram& GetDecryptLatencyHistogram() {
+  static MetricsHistogram& histogram =
+      MetricsRegistry::GetInstance().GetHistogram("channel.decrypt_us");
+  return histogram;
+}
+
+MetricsGauge& GetWriteQueueDepthGauge() {
+  static MetricsGauge& gauge =
+      MetricsRegistry::GetInstance().GetGauge("channel.write_queue_depth");
+  return gauge;
+}
+
 Exception WriteInt(OutputStream* writer, std::int32_t value) {
   return Base64Utils::WriteInt(writer, value);
 }
@@ -87,7 +155,30 @@ BaseEndpointChannel::BaseEndpointChannel(
       technology_(technology),
       band_(band),
       frequency_(frequency),
-      try_count_(try_count) {}
+      try_count_(try_count) {
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnablePipelinedPayloadSend)) {
+    write_queue_ = std::make_unique<BoundedBlockingQueue<QueuedFrame>>(
+        NearbyFlags::GetInstance().GetInt64Flag(
+            config_package_nearby::nearby_connections_feature::
+                kPayloadSendPipelineDepth));
+    write_executor_ = std::make_unique<SingleThreadExecutor>();
+    write_executor_->Execute("endpoint-channel-writer",
+                             [this]() { RunWriteLoop(); });
+  }
+}
+
+BaseEndpointChannel::~BaseEndpointChannel() {
+  if (write_executor_ == nullptr) return;
+  {
+    // The channel is going away without Close(); drop whatever is queued.
+    MutexLock lock(&pending_writes_mutex_);
+    if (write_error_.Ok()) write_error_ = {Exception::kIo};
+  }
+  write_queue_->Close();
+  write_executor_->Shutdown();
+}
 
 ExceptionOr<ByteArray> BaseEndpointChannel::Read() {
   ByteArray result;
@@ -130,6 +221,7 @@ ExceptionOr<ByteArray> BaseEndpointChannel::Read() {
     }
     result = std::move(read_bytes.result());
   }
+  GetChannelMetrics(GetMedium()).bytes_read->Increment(result.size());
 
   {
     MutexLock crypto_lock(&crypto_mutex_);
@@ -137,8 +229,11 @@ ExceptionOr<ByteArray> BaseEndpointChannel::Read() {
     if (IsEncryptionEnabledLocked()) {
       // If encryption is enabled, decode the message.
       std::string input(std::move(result));
+      absl::Time decrypt_start_time = SystemClock::ElapsedRealtime();
       std::unique_ptr<std::string> decrypted_data =
           crypto_context_->DecodeMessageFromPeer(input);
+      GetDecryptLatencyHistogram().RecordDuration(
+          SystemClock::ElapsedRealtime() - decrypt_start_time);
       if (decrypted_data) {
         result = ByteArray(std::move(*decrypted_data));
       } else {
@@ -182,6 +277,11 @@ ExceptionOr<ByteArray> BaseEndpointChannel::Read() {
 }
 
 Exception BaseEndpointChannel::Write(absl::string_view data) {
+  return WriteAndNotify(data, nullptr);
+}
+
+Exception BaseEndpointChannel::WriteAndNotify(
+    absl::string_view data, absl::AnyInvocable<void()> on_written) {
   {
     MutexLock pause_lock(&is_paused_mutex_);
     if (is_paused_) {
@@ -189,68 +289,200 @@ Exception BaseEndpointChannel::Write(absl::string_view data) {
     }
   }
 
+  if (write_queue_ != nullptr) {
+    return EnqueueWrite(data, std::move(on_written));
+  }
+
   absl::string_view  data_to_write = data;
   // Make sure encrypted message is value until end of function.
   std::unique_ptr<std::string> encrypted;
+  absl::Time write_start_time = SystemClock::ElapsedRealtime();
+  // Holding both mutexes is necessary to prevent the keep alive and payload
+  // threads from writing encrypted messages out of order which causes a
+  // failure to decrypt on the reader side. However we need to release the
+  // crypto lock after encrypting to ensure read decryption is not blocked.
+  MutexLock lock(&writer_mutex_);
   {
-    // Holding both mutexes is necessary to prevent the keep alive and payload
-    // threads from writing encrypted messages out of order which causes a
-    // failure to decrypt on the reader side. However we need to release the
-    // crypto lock after encrypting to ensure read decryption is not blocked.
-    MutexLock lock(&writer_mutex_);
-    {
-      MutexLock crypto_lock(&crypto_mutex_);
-      if (IsEncryptionEnabledLocked()) {
-        // If encryption is enabled, encode the message.
-        encrypted = crypto_context_->EncodeMessageToPeer(data);
-        if (!encrypted) {
-          LOG(WARNING) << __func__ << ": Failed to encrypt data.";
-          return {Exception::kIo};
-        }
-        data_to_write = *encrypted;
+    MutexLock crypto_lock(&crypto_mutex_);
+    if (IsEncryptionEnabledLocked()) {
+      // If encryption is enabled, encode the message.
+      absl::Time encrypt_start_time = SystemClock::ElapsedRealtime();
+      encrypted = crypto_context_->EncodeMessageToPeer(data);
+      GetEncryptLatencyHistogram().RecordDuration(
+          SystemClock::ElapsedRealtime() - encrypt_start_time);
+      if (!encrypted) {
+        LOG(WARNING) << __func__ << ": Failed to encrypt data.";
+        return {Exception::kIo};
       }
+      data_to_write = *encrypted;
     }
+  }
+  Exception exception = WriteFrameLocked(data_to_write, write_start_time);
+  if (exception.Ok() && on_written) on_written();
+  return exception;
+}
 
-    size_t data_size = data_to_write.size();
-    if (data_size < 0 || data_size > max_allowed_read_bytes_) {
-      LOG(WARNING) << __func__
-                   << ": Write an invalid number of bytes: " << data_size;
-      return {Exception::kIo};
-    }
+Exception BaseEndpointChannel::WriteFrameLocked(absl::string_view frame,
+                                                absl::Time write_start_time) {
+  size_t data_size = frame.size();
+  if (data_size > max_allowed_read_bytes_) {
+    LOG(WARNING) << __func__
+                 << ": Write an invalid number of bytes: " << data_size;
+    return {Exception::kIo};
+  }
 
-    Exception write_exception;
-    if (NearbyFlags::GetInstance().GetBoolFlag(
-            config_package_nearby::nearby_connections_feature::
-                kRefactorBleL2cap) &&
-        (GetMedium() == BLE || GetMedium() == BLE_L2CAP)) {
-      write_exception = WritePayloadLength(data_size);
+  ChunkSizeController* chunk_size_controller = GetChunkSizeController();
+  Exception write_exception;
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kRefactorBleL2cap) &&
+      (GetMedium() == BLE || GetMedium() == BLE_L2CAP)) {
+    write_exception = WritePayloadLength(data_size);
+  } else {
+    write_exception = WriteInt(writer_, static_cast<std::int32_t>(data_size));
+  }
+  if (write_exception.Raised()) {
+    LOG(WARNING) << __func__
+                 << ": Failed to write header: " << write_exception.value;
+    return write_exception;
+  }
+  write_exception = writer_->Write(frame);
+  if (write_exception.Raised()) {
+    LOG(WARNING) << __func__
+                 << ": Failed to write data: " << write_exception.value;
+    if (chunk_size_controller) chunk_size_controller->OnWriteFailed();
+    return write_exception;
+  }
+  Exception flush_exception = writer_->Flush();
+  if (flush_exception.Raised()) {
+    LOG(WARNING) << __func__
+                 << ": Failed to flush writer: " << flush_exception.value;
+    if (chunk_size_controller) chunk_size_controller->OnWriteFailed();
+    return flush_exception;
+  }
+
+  absl::Time write_end_time = SystemClock::ElapsedRealtime();
+  const ChannelMetrics& metrics = GetChannelMetrics(GetMedium());
+  metrics.bytes_written->Increment(data_size);
+  metrics.write_latency_us->RecordDuration(write_end_time - write_start_time);
+  if (chunk_size_controller) {
+    chunk_size_controller->OnWriteCompleted(data_size,
+                                            write_end_time - write_start_time);
+  }
+  {
+    MutexLock lock(&last_write_mutex_);
+    last_write_timestamp_ = write_end_time;
+  }
+  return {Exception::kSuccess};
+}
+
+Exception BaseEndpointChannel::EnqueueWrite(
+    absl::string_view data, absl::AnyInvocable<void()> on_written) {
+  MutexLock order_lock(&write_order_mutex_);
+  {
+    MutexLock lock(&pending_writes_mutex_);
+    if (write_error_.Raised()) return write_error_;
+  }
+
+  std::string frame;
+  {
+    MutexLock crypto_lock(&crypto_mutex_);
+    if (IsEncryptionEnabledLocked()) {
+      absl::Time encrypt_start_time = SystemClock::ElapsedRealtime();
+      std::unique_ptr<std::string> encrypted =
+          crypto_context_->EncodeMessageToPeer(data);
+      GetEncryptLatencyHistogram().RecordDuration(
+          SystemClock::ElapsedRealtime() - encrypt_start_time);
+      if (!encrypted) {
+        LOG(WARNING) << __func__ << ": Failed to encrypt data.";
+        return {Exception::kIo};
+      }
+      frame = std::move(*encrypted);
     } else {
-      write_exception = WriteInt(writer_, static_cast<std::int32_t>(data_size));
+      frame = std::string(data);
     }
-    if (write_exception.Raised()) {
-      LOG(WARNING) << __func__
-                   << ": Failed to write header: " << write_exception.value;
-      return write_exception;
+  }
+  if (frame.size() > max_allowed_read_bytes_) {
+    LOG(WARNING) << __func__
+                 << ": Write an invalid number of bytes: " << frame.size();
+    return {Exception::kIo};
+  }
+
+  {
+    MutexLock lock(&pending_writes_mutex_);
+    ++pending_writes_;
+  }
+  GetWriteQueueDepthGauge().Add(1);
+  // Blocks while the writer is `kPayloadSendPipelineDepth` frames behind,
+  // which is what throttles the payload thread to the medium's speed.
+  if (!write_queue_->Put(
+          QueuedFrame{std::move(frame), std::move(on_written)})) {
+    GetWriteQueueDepthGauge().Add(-1);
+    MutexLock lock(&pending_writes_mutex_);
+    --pending_writes_;
+    pending_writes_cond_.Notify();
+    return write_error_.Raised() ? write_error_ : Exception{Exception::kIo};
+  }
+  return {Exception::kSuccess};
+}
+
+void BaseEndpointChannel::RunWriteLoop() {
+  while (true) {
+    std::optional<QueuedFrame> frame = write_queue_->Take();
+    if (!frame.has_value()) return;
+
+    bool failed;
+    {
+      MutexLock lock(&pending_writes_mutex_);
+      failed = write_error_.Raised();
     }
-    write_exception = writer_->Write(data_to_write);
-    if (write_exception.Raised()) {
-      LOG(WARNING) << __func__
-                   << ": Failed to write data: " << write_exception.value;
-      return write_exception;
+    Exception exception = {Exception::kSuccess};
+    if (!failed) {
+      // Time spent queued is not write latency, so the chunk size controller
+      // only sees how fast the medium drains.
+      absl::Time write_start_time = SystemClock::ElapsedRealtime();
+      {
+        MutexLock lock(&writer_mutex_);
+        exception = WriteFrameLocked(frame->frame, write_start_time);
+      }
+      // Before the frame stops counting as pending, so WaitForPendingWrites()
+      // returning means every callback has run.
+      if (exception.Ok() && frame->on_written) frame->on_written();
     }
-    Exception flush_exception = writer_->Flush();
-    if (flush_exception.Raised()) {
-      LOG(WARNING) << __func__
-                   << ": Failed to flush writer: " << flush_exception.value;
-      return flush_exception;
+
+    GetWriteQueueDepthGauge().Add(-1);
+    MutexLock lock(&pending_writes_mutex_);
+    --pending_writes_;
+    if (exception.Raised() && write_error_.Ok()) {
+      write_error_ = exception;
+      // Fail blocked and future writers; frames still queued are dropped.
+      write_queue_->Close();
     }
+    pending_writes_cond_.Notify();
   }
+}
 
-  {
-    MutexLock lock(&last_write_mutex_);
-    last_write_timestamp_ = SystemClock::ElapsedRealtime();
+Exception BaseEndpointChannel::WaitForPendingWrites() {
+  if (write_queue_ == nullptr) return {Exception::kSuccess};
+  MutexLock lock(&pending_writes_mutex_);
+  while (pending_writes_ > 0 && write_error_.Ok()) {
+    pending_writes_cond_.Wait();
+  }
+  return write_error_;
+}
+
+void BaseEndpointChannel::DrainPendingWrites(absl::Duration timeout) {
+  absl::Time deadline = SystemClock::ElapsedRealtime() + timeout;
+  MutexLock lock(&pending_writes_mutex_);
+  while (pending_writes_ > 0 && write_error_.Ok()) {
+    absl::Duration remaining = deadline - SystemClock::ElapsedRealtime();
+    if (remaining <= absl::ZeroDuration()) {
+      LOG(WARNING) << __func__ << ": Dropping " << pending_writes_
+                   << " queued frame(s) on close.";
+      return;
+    }
+    pending_writes_cond_.Wait(remaining);
   }
-  return {Exception::kSuccess};
 }
 
 void BaseEndpointChannel::Close() {
@@ -264,7 +496,14 @@ void BaseEndpointChannel::Close() {
     is_closed_ = true;
     UnblockPausedWriter();
   }
+  if (write_queue_ != nullptr) {
+    DrainPendingWrites(kPendingWritesDrainTimeout);
+    write_queue_->Close();
+  }
   CloseIo();
+  // The writer thread exits once the queue is drained; writes still in
+  // flight fail now that the medium is closed.
+  if (write_executor_ != nullptr) write_executor_->Shutdown();
   CloseImpl();
 }
 
@@ -350,6 +589,55 @@ int BaseEndpointChannel::GetMaxTransmitPacketSize() const {
   return default_max_transmit_packet_size_;
 }
 
+int BaseEndpointChannel::GetChunkSize() const {
+  ChunkSizeController* chunk_size_controller = GetChunkSizeController();
+  if (chunk_size_controller == nullptr) {
+    return GetMaxTransmitPacketSize();
+  }
+  return chunk_size_controller->GetChunkSize();
+}
+
+double BaseEndpointChannel::GetThroughputBytesPerSecond() const {
+  ChunkSizeController* chunk_size_controller = GetChunkSizeController();
+  if (chunk_size_controller == nullptr) return 0;
+  return chunk_size_controller->GetThroughputBytesPerSecond();
+}
+
+absl::Duration BaseEndpointChannel::GetWriteLatency() const {
+  ChunkSizeController* chunk_size_controller = GetChunkSizeController();
+  if (chunk_size_controller == nullptr) return absl::ZeroDuration();
+  return chunk_size_controller->GetWriteLatency();
+}
+
+ChunkSizeController* BaseEndpointChannel::GetChunkSizeController() const {
+  bool adaptive_chunk_size = NearbyFlags::GetInstance().GetBoolFlag(
+      config_package_nearby::nearby_connections_feature::
+          kEnableAdaptiveChunkSize);
+  // Bandwidth-aware upgrades and multipath striping only need the
+  // measurements.
+  if (!adaptive_chunk_size &&
+      !NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableBandwidthAwareBwu) &&
+      !NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableMultipathTransfer)) {
+    return nullptr;
+  }
+  MutexLock lock(&chunk_size_mutex_);
+  if (chunk_size_controller_ == nullptr) {
+    ChunkSizeController::Bounds bounds =
+        ChunkSizeController::GetBoundsForMedium(
+            GetMedium(), GetMaxTransmitPacketSize(), max_allowed_read_bytes_);
+    if (!adaptive_chunk_size) {
+      bounds.min_chunk_size = bounds.max_chunk_size =
+          bounds.initial_chunk_size;
+    }
+    chunk_size_controller_ = std::make_unique<ChunkSizeController>(bounds);
+  }
+  return chunk_size_controller_.get();
+}
+
 void BaseEndpointChannel::EnableEncryption(
     std::shared_ptr<EncryptionContext> context) {
   MutexLock crypto_lock(&crypto_mutex_);
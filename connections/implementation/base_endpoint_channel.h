@@ -20,16 +20,20 @@
 #include <string>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "connections/implementation/analytics/analytics_recorder.h"
+#include "connections/implementation/chunk_size_controller.h"
 #include "connections/implementation/endpoint_channel.h"
+#include "internal/platform/bounded_blocking_queue.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/condition_variable.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/input_stream.h"
 #include "internal/platform/mutex.h"
 #include "internal/platform/output_stream.h"
+#include "internal/platform/single_thread_executor.h"
 
 namespace nearby::connections {
 
@@ -44,14 +48,21 @@ class BaseEndpointChannel : public EndpointChannel {
       location::nearby::proto::connections::ConnectionTechnology,
       location::nearby::proto::connections::ConnectionBand band, int frequency,
       int try_count);
-  ~BaseEndpointChannel() override = default;
+  ~BaseEndpointChannel() override;
 
   // EndpointChannel:
   ExceptionOr<ByteArray> Read()
       ABSL_LOCKS_EXCLUDED(reader_mutex_, crypto_mutex_,
                           last_read_mutex_) override;
   Exception Write(absl::string_view data)
-      ABSL_LOCKS_EXCLUDED(writer_mutex_, crypto_mutex_) override;
+      ABSL_LOCKS_EXCLUDED(writer_mutex_, crypto_mutex_,
+                          write_order_mutex_) override;
+  Exception WriteAndNotify(absl::string_view data,
+                           absl::AnyInvocable<void()> on_written)
+      ABSL_LOCKS_EXCLUDED(writer_mutex_, crypto_mutex_,
+                          write_order_mutex_) override;
+  Exception WaitForPendingWrites()
+      ABSL_LOCKS_EXCLUDED(pending_writes_mutex_) override;
   void Close() ABSL_LOCKS_EXCLUDED(is_paused_mutex_) override;
   void Close(location::nearby::proto::connections::DisconnectionReason reason)
       override;
@@ -67,6 +78,11 @@ class BaseEndpointChannel : public EndpointChannel {
   int GetFrequency() const override;
   int GetTryCount() const override;
   int GetMaxTransmitPacketSize() const override;
+  int GetChunkSize() const ABSL_LOCKS_EXCLUDED(chunk_size_mutex_) override;
+  double GetThroughputBytesPerSecond() const
+      ABSL_LOCKS_EXCLUDED(chunk_size_mutex_) override;
+  absl::Duration GetWriteLatency() const
+      ABSL_LOCKS_EXCLUDED(chunk_size_mutex_) override;
   void EnableEncryption(std::shared_ptr<EncryptionContext> context) override;
   void DisableEncryption() override;
   bool IsEncrypted() override;
@@ -111,6 +127,40 @@ class BaseEndpointChannel : public EndpointChannel {
   // Gets the default maximum transmit unit/packet size.
   int GetDefaultMaxTransmitPacketSize() const;
 
+  // Returns the chunk size controller, creating it on first use, or null if
+  // neither adaptive chunk sizing nor bandwidth-aware upgrades are enabled.
+  // With only the latter, the controller just measures and the chunk size
+  // stays fixed.
+  ChunkSizeController* GetChunkSizeController() const
+      ABSL_LOCKS_EXCLUDED(chunk_size_mutex_);
+
+  // Writes the length header and `frame` to the medium and flushes it.
+  // `write_start_time` is when the frame was handed to the channel; the time
+  // spent until the flush completes feeds the chunk size controller.
+  Exception WriteFrameLocked(absl::string_view frame,
+                             absl::Time write_start_time)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(writer_mutex_);
+
+  // A frame waiting for the writer thread, and what to call once it has been
+  // written.
+  struct QueuedFrame {
+    std::string frame;
+    absl::AnyInvocable<void()> on_written;
+  };
+
+  // Pipelined mode: encrypts `data` and hands it to the writer thread.
+  Exception EnqueueWrite(absl::string_view data,
+                         absl::AnyInvocable<void()> on_written)
+      ABSL_LOCKS_EXCLUDED(write_order_mutex_, crypto_mutex_,
+                          pending_writes_mutex_);
+
+  // Pipelined mode: body of the writer thread.
+  void RunWriteLoop() ABSL_LOCKS_EXCLUDED(writer_mutex_, pending_writes_mutex_);
+
+  // Pipelined mode: waits up to `timeout` for queued frames to be written.
+  void DrainPendingWrites(absl::Duration timeout)
+      ABSL_LOCKS_EXCLUDED(pending_writes_mutex_);
+
   bool IsEncryptionEnabledLocked() const
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(crypto_mutex_);
   void UnblockPausedWriter() ABSL_EXCLUSIVE_LOCKS_REQUIRED(is_paused_mutex_);
@@ -164,6 +214,29 @@ class BaseEndpointChannel : public EndpointChannel {
   int frequency_;
   int try_count_;
 
+  // Created lazily because the bounds depend on the (virtual) medium and
+  // packet size of the concrete channel.
+  mutable Mutex chunk_size_mutex_;
+  mutable std::unique_ptr<ChunkSizeController> chunk_size_controller_
+      ABSL_GUARDED_BY(chunk_size_mutex_);
+
+  // Pipelined mode only (see kEnablePipelinedPayloadSend): Write() encrypts
+  // on the calling thread and queues the frame, and `write_executor_` writes
+  // queued frames to the medium. Encryption assigns sequence numbers, so
+  // `write_order_mutex_` keeps encryption and queueing in one critical
+  // section and frames reach the medium in the order they were encrypted.
+  Mutex write_order_mutex_;
+  std::unique_ptr<BoundedBlockingQueue<QueuedFrame>> write_queue_;
+  std::unique_ptr<SingleThreadExecutor> write_executor_;
+
+  // Number of queued frames not yet written, and the first write error. Once
+  // a write fails, every later Write() fails with the same error.
+  mutable Mutex pending_writes_mutex_;
+  ConditionVariable pending_writes_cond_{&pending_writes_mutex_};
+  int pending_writes_ ABSL_GUARDED_BY(pending_writes_mutex_) = 0;
+  Exception write_error_ ABSL_GUARDED_BY(pending_writes_mutex_) = {
+      Exception::kSuccess};
+
   analytics::AnalyticsRecorder* analytics_recorder_ = nullptr;
   std::string endpoint_id_ = "";
 };
@@ -19,11 +19,13 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "securegcm/ukey2_handshake.h"
 #include "gmock/gmock.h"
 #include "protobuf-matchers/protocol-buffer-matchers.h"
 #include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
@@ -50,6 +52,7 @@ namespace {
 
 using ::location::nearby::proto::connections::DisconnectionReason;
 using ::location::nearby::proto::connections::Medium;
+using ::testing::ElementsAre;
 using EncryptionContext = BaseEndpointChannel::EncryptionContext;
 constexpr size_t kChunkSize = 64 * 1024;
 
@@ -537,6 +540,122 @@ TEST_F(BaseEndpointChannelTest, ReadUnencryptedFrameOnEncryptedChannel) {
   channel_b->Close(DisconnectionReason::REMOTE_DISCONNECTION);
 }
 
+TEST_F(BaseEndpointChannelTest, PipelinedWritesArriveInOrder) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnablePipelinedPayloadSend,
+      true);
+  auto pipe_a = CreatePipe();  // channel_a writes to pipe_a, reads from pipe_b.
+  auto pipe_b = CreatePipe();  // channel_b writes to pipe_b, reads from pipe_a.
+  TestEndpointChannel channel_a(pipe_b.first.get(), pipe_a.second.get());
+  TestEndpointChannel channel_b(pipe_a.first.get(), pipe_b.second.get());
+  EXPECT_CALL(channel_a, CloseImpl);
+  EXPECT_CALL(channel_b, CloseImpl);
+
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(channel_a.Write(absl::StrCat("message ", i)).Ok());
+  }
+  EXPECT_TRUE(channel_a.WaitForPendingWrites().Ok());
+
+  for (int i = 0; i < 10; ++i) {
+    ExceptionOr<ByteArray> result = channel_b.Read();
+    ASSERT_TRUE(result.ok());
+    EXPECT_EQ(result.result().AsStringView(), absl::StrCat("message ", i));
+  }
+  channel_a.Close();
+  channel_b.Close();
+}
+
+TEST_F(BaseEndpointChannelTest, PipelinedWriteErrorFailsLaterWrites) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnablePipelinedPayloadSend,
+      true);
+  auto [input, output] = CreatePipe();
+  TestEndpointChannel channel(input.get(), output.get());
+  EXPECT_CALL(channel, CloseImpl);
+  input->Close();
+
+  // The first write is only queued; the failure shows up once it is flushed.
+  EXPECT_TRUE(channel.Write(kTestData).Ok());
+  EXPECT_EQ(channel.WaitForPendingWrites(), Exception{Exception::kIo});
+  EXPECT_EQ(channel.Write(kTestData), Exception{Exception::kIo});
+  channel.Close();
+}
+
+TEST_F(BaseEndpointChannelTest, PipelinedWriteNotifiesOnceWritten) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnablePipelinedPayloadSend,
+      true);
+  auto pipe_a = CreatePipe();
+  auto pipe_b = CreatePipe();
+  TestEndpointChannel channel_a(pipe_b.first.get(), pipe_a.second.get());
+  TestEndpointChannel channel_b(pipe_a.first.get(), pipe_b.second.get());
+  EXPECT_CALL(channel_a, CloseImpl);
+  EXPECT_CALL(channel_b, CloseImpl);
+  absl::Mutex mutex;
+  std::vector<int> written;
+
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(channel_a
+                    .WriteAndNotify(absl::StrCat("message ", i),
+                                    [&mutex, &written, i]() {
+                                      absl::MutexLock lock(&mutex);
+                                      written.push_back(i);
+                                    })
+                    .Ok());
+  }
+  EXPECT_TRUE(channel_a.WaitForPendingWrites().Ok());
+
+  {
+    absl::MutexLock lock(&mutex);
+    EXPECT_THAT(written, ElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9));
+  }
+  channel_a.Close();
+  channel_b.Close();
+}
+
+TEST_F(BaseEndpointChannelTest, PipelinedFailedWriteDoesNotNotify) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnablePipelinedPayloadSend,
+      true);
+  auto [input, output] = CreatePipe();
+  TestEndpointChannel channel(input.get(), output.get());
+  EXPECT_CALL(channel, CloseImpl);
+  input->Close();
+  bool notified = false;
+
+  EXPECT_TRUE(
+      channel.WriteAndNotify(kTestData, [&notified]() { notified = true; })
+          .Ok());
+  EXPECT_EQ(channel.WaitForPendingWrites(), Exception{Exception::kIo});
+  EXPECT_FALSE(notified);
+  channel.Close();
+}
+
+TEST_F(BaseEndpointChannelTest, PipelinedCloseFlushesQueuedWrites) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnablePipelinedPayloadSend,
+      true);
+  auto pipe_a = CreatePipe();
+  auto pipe_b = CreatePipe();
+  TestEndpointChannel channel_a(pipe_b.first.get(), pipe_a.second.get());
+  TestEndpointChannel channel_b(pipe_a.first.get(), pipe_b.second.get());
+  EXPECT_CALL(channel_a, CloseImpl);
+  EXPECT_CALL(channel_b, CloseImpl);
+
+  EXPECT_TRUE(channel_a.Write(kTestData).Ok());
+  channel_a.Close();
+
+  ExceptionOr<ByteArray> result = channel_b.Read();
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(result.result().AsStringView(), kTestData);
+  channel_b.Close();
+}
+
 }  // namespace
 }  // namespace connections
 }  // namespace nearby
@@ -95,6 +95,7 @@ using ::location::nearby::connections::ConnectionsDevice;
 using ::location::nearby::connections::MediumMetadata;
 using ::location::nearby::connections::OfflineFrame;
 using ::location::nearby::connections::OsInfo;
+using ::location::nearby::connections::PayloadTransferFrame;
 using ::location::nearby::connections::PresenceDevice;
 using ::location::nearby::connections::V1Frame;
 using ::location::nearby::proto::connections::OperationResultCode;
@@ -1724,6 +1725,15 @@ void BasePcpHandler::OnIncomingFrame(
           client->SetRemoteSafeToDisconnectVersion(
               endpoint_id, connection_response.safe_to_disconnect_version());
         }
+        const auto& compressions =
+            connection_response.supported_payload_compressions();
+        client->SetRemoteSupportsPayloadCompression(
+            endpoint_id,
+            std::find(compressions.begin(), compressions.end(),
+                      PayloadTransferFrame::PayloadHeader::DEFLATE) !=
+                compressions.end());
+        client->SetRemoteSupportsMultiChunkBytes(
+            endpoint_id, connection_response.supports_multi_chunk_bytes());
         channel_manager_->UpdateSafeToDisconnectForEndpoint(
             endpoint_id, client->IsSafeToDisconnectEnabled(endpoint_id));
         EvaluateConnectionResult(client, endpoint_id,
@@ -33,6 +33,7 @@
 #include "connections/implementation/endpoint_channel_manager.h"
 #include "connections/implementation/endpoint_manager.h"
 #include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "connections/implementation/medium_bandwidth_tracker.h"
 #include "connections/implementation/mediums/mediums.h"
 #include "connections/implementation/offline_frames.h"
 #include "connections/implementation/service_id_constants.h"
@@ -44,6 +45,7 @@
 #include "internal/platform/feature_flags.h"
 #include "internal/platform/implementation/system_clock.h"
 #include "internal/platform/logging.h"
+#include "internal/platform/metrics_registry.h"
 #include "internal/platform/runnable.h"
 #include "proto/connections_enums.pb.h"
 
@@ -64,6 +66,25 @@ using ::location::nearby::proto::connections::DisconnectionReason;
 using ::location::nearby::proto::connections::OperationResultCode;
 using ::nearby::analytics::AnalyticsRecorder;
 
+// Hot-path metrics of bandwidth upgrades.
+struct BwuMetrics {
+  MetricsCounter& started;
+  MetricsCounter& succeeded;
+  MetricsCounter& failed;
+  MetricsHistogram& duration_us;
+};
+
+const BwuMetrics& GetBwuMetrics() {
+  static const BwuMetrics* metrics = new BwuMetrics{
+      .started = MetricsRegistry::GetInstance().GetCounter("bwu.started"),
+      .succeeded = MetricsRegistry::GetInstance().GetCounter("bwu.succeeded"),
+      .failed = MetricsRegistry::GetInstance().GetCounter("bwu.failed"),
+      .duration_us =
+          MetricsRegistry::GetInstance().GetHistogram("bwu.duration_us"),
+  };
+  return *metrics;
+}
+
 }  // namespace
 
 BwuManager::BwuManager(
@@ -214,7 +235,7 @@ void BwuManager::InitiateBwuForEndpoint(ClientProxy* client,
   Medium proposed_medium =
       new_medium == Medium::UNKNOWN_MEDIUM
           ? ChooseBestUpgradeMedium(
-                endpoint_id,
+                client, endpoint_id,
                 client->GetUpgradeMediums(endpoint_id).GetMediums(true))
           : new_medium;
 
@@ -277,6 +298,8 @@ void BwuManager::InitiateBwuForEndpoint(ClientProxy* client,
       return;
     }
 
+    GetBwuMetrics().started.Increment();
+    upgrade_start_times_[endpoint_id] = SystemClock::ElapsedRealtime();
     client->GetAnalyticsRecorder().OnBandwidthUpgradeStarted(
         endpoint_id, channel_medium, proposed_medium,
         location::nearby::proto::connections::INCOMING,
@@ -287,6 +310,7 @@ void BwuManager::InitiateBwuForEndpoint(ClientProxy* client,
           << "BwuManager couldn't complete the upgrade for endpoint "
           << endpoint_id
           << " because it couldn't find an existing EndpointChannel for it.";
+      GetBwuMetrics().failed.Increment();
       client->GetAnalyticsRecorder().OnBandwidthUpgradeError(
           endpoint_id, BandwidthUpgradeResult::CHANNEL_ERROR,
           BandwidthUpgradeErrorStage::NETWORK_AVAILABLE,
@@ -310,6 +334,7 @@ void BwuManager::InitiateBwuForEndpoint(ClientProxy* client,
                      << " because it failed to write the "
                         "BWU_NEGOTIATION.UPGRADE_PATH_REQUEST OfflineFrame.";
 
+          GetBwuMetrics().failed.Increment();
           client->GetAnalyticsRecorder().OnBandwidthUpgradeError(
               endpoint_id, BandwidthUpgradeResult::RESULT_IO_ERROR,
               BandwidthUpgradeErrorStage::NETWORK_AVAILABLE,
@@ -348,6 +373,7 @@ void BwuManager::InitiateBwuForEndpoint(ClientProxy* client,
           /*record_analytic=*/false,
           OperationResultCode::CONNECTIVITY_GENERIC_WRITING_CHANNEL_IO_ERROR);
 
+      GetBwuMetrics().failed.Increment();
       client->GetAnalyticsRecorder().OnBandwidthUpgradeError(
           endpoint_id, BandwidthUpgradeResult::MEDIUM_ERROR,
           BandwidthUpgradeErrorStage::NETWORK_AVAILABLE,
@@ -369,6 +395,7 @@ void BwuManager::InitiateBwuForEndpoint(ClientProxy* client,
           /*record_analytic=*/false,
           OperationResultCode::CONNECTIVITY_GENERIC_WRITING_CHANNEL_IO_ERROR);
 
+      GetBwuMetrics().failed.Increment();
       client->GetAnalyticsRecorder().OnBandwidthUpgradeError(
           endpoint_id, BandwidthUpgradeResult::RESULT_IO_ERROR,
           BandwidthUpgradeErrorStage::NETWORK_AVAILABLE,
@@ -398,7 +425,15 @@ void BwuManager::OnIncomingFrame(OfflineFrame& frame,
                    bwu_frame.event_type())
             << ", endpoint_id=" << endpoint_id << ", medium="
             << location::nearby::proto::connections::Medium_Name(medium);
-  if (FeatureFlags::GetInstance().GetFlags().enable_async_bandwidth_upgrade) {
+  // With multipath, the prior channel switches its encryption context when
+  // SAFE_TO_CLOSE_PRIOR_CHANNEL is processed, which must happen before the
+  // next frame is read from it.
+  bool must_process_in_order =
+      is_multipath_enabled_ &&
+      bwu_frame.event_type() ==
+          BandwidthUpgradeNegotiationFrame::SAFE_TO_CLOSE_PRIOR_CHANNEL;
+  if (FeatureFlags::GetInstance().GetFlags().enable_async_bandwidth_upgrade &&
+      !must_process_in_order) {
     RunOnBwuManagerThread(
         "bwu-on-incoming-frame", [this, client, endpoint_id, bwu_frame]() {
           OnBwuNegotiationFrame(client, bwu_frame, endpoint_id);
@@ -431,6 +466,14 @@ void BwuManager::OnEndpointDisconnect(ClientProxy* client,
       handler->OnEndpointDisconnect(client, endpoint_id);
     }
 
+    if (is_bandwidth_aware_bwu_enabled_) {
+      std::shared_ptr<EndpointChannel> channel =
+          channel_manager_->GetChannelForEndpoint(endpoint_id);
+      if (channel != nullptr) {
+        RecordChannelBandwidth(client, endpoint_id, *channel);
+      }
+    }
+
     auto item = previous_endpoint_channels_.extract(endpoint_id);
     if (!item.empty()) {
       auto old_channel = item.mapped();
@@ -439,9 +482,11 @@ void BwuManager::OnEndpointDisconnect(ClientProxy* client,
       }
     }
     in_progress_upgrades_.erase(endpoint_id);
+    upgrade_start_times_.erase(endpoint_id);
     retry_delays_.erase(endpoint_id);
     CancelRetryUpgradeAlarm(endpoint_id);
     successfully_upgraded_endpoints_.erase(endpoint_id);
+    completed_upgrades_.erase(endpoint_id);
 
     // Note(nohle): I'm skeptical of the "<= 1", which seems like it should be
     // "== 0". Luckily, we will enable the flag by default, and it won't matter.
@@ -585,7 +630,9 @@ void BwuManager::OnBwuNegotiationFrame(
                    << endpoint_id << " but no upgrade is in progress.";
         return;
       }
-      ProcessSafeToClosePriorChannelEvent(client, endpoint_id);
+      ProcessSafeToClosePriorChannelEvent(
+          client, endpoint_id,
+          frame.safe_to_close_prior_channel().supports_multipath());
       break;
     default:
       LOG(WARNING)
@@ -730,6 +777,7 @@ void BwuManager::RunUpgradeProtocol(
         << endpoint_id
         << " when registering the new EndpointChannel, short-circuiting the "
            "upgrade protocol.";
+    GetBwuMetrics().failed.Increment();
     client->GetAnalyticsRecorder().OnBandwidthUpgradeError(
         endpoint_id, BandwidthUpgradeResult::CHANNEL_ERROR,
         BandwidthUpgradeErrorStage::PRIOR_ENDPOINT_CHANNEL,
@@ -747,6 +795,7 @@ void BwuManager::RunUpgradeProtocol(
                   "BWU_NEGOTIATION.LAST_WRITE_TO_PRIOR_CHANNEL OfflineFrame to "
                   "endpoint "
                << endpoint_id << ", short-circuiting the upgrade protocol.";
+    GetBwuMetrics().failed.Increment();
     client->GetAnalyticsRecorder().OnBandwidthUpgradeError(
         endpoint_id, BandwidthUpgradeResult::RESULT_IO_ERROR,
         BandwidthUpgradeErrorStage::LAST_WRITE_TO_PRIOR_CHANNEL,
@@ -857,6 +906,8 @@ void BwuManager::ProcessBwuPathAvailableEvent(
   auto current_channel = channel_manager_->GetChannelForEndpoint(endpoint_id);
   Medium current_medium =
       current_channel ? current_channel->GetMedium() : Medium::UNKNOWN_MEDIUM;
+  GetBwuMetrics().started.Increment();
+  upgrade_start_times_[endpoint_id] = SystemClock::ElapsedRealtime();
   client->GetAnalyticsRecorder().OnBandwidthUpgradeStarted(
       endpoint_id, current_medium, upgrade_medium,
       location::nearby::proto::connections::OUTGOING,
@@ -875,6 +926,7 @@ void BwuManager::ProcessBwuPathAvailableEvent(
   } else if (client->GetCancellationFlag(endpoint_id)->Cancelled()) {
     connection_attempt_result =
         location::nearby::proto::connections::RESULT_CANCELLED;
+    GetBwuMetrics().failed.Increment();
     client->GetAnalyticsRecorder().OnBandwidthUpgradeError(
         endpoint_id, BandwidthUpgradeResult::RESULT_REMOTE_ERROR,
         BandwidthUpgradeErrorStage::UPGRADE_CANCEL,
@@ -1003,6 +1055,7 @@ BwuManager::ProcessBwuPathAvailableEventInternal(
     LOG(ERROR) << "BwuManager failed to create an endpoint "
                   "channel to endpoint"
                << endpoint_id << ", aborting upgrade.";
+    GetBwuMetrics().failed.Increment();
     client->GetAnalyticsRecorder().OnBandwidthUpgradeError(
         endpoint_id, BandwidthUpgradeResult::RESULT_IO_ERROR,
         BandwidthUpgradeErrorStage::SOCKET_CREATION,
@@ -1026,6 +1079,7 @@ BwuManager::ProcessBwuPathAvailableEventInternal(
         << "BwuManager failed to write BWU_NEGOTIATION.CLIENT_INTRODUCTION "
            "OfflineFrame to newly-created EndpointChannel "
         << new_channel->GetName() << ", aborting upgrade.";
+    GetBwuMetrics().failed.Increment();
     client->GetAnalyticsRecorder().OnBandwidthUpgradeError(
         endpoint_id, BandwidthUpgradeResult::RESULT_IO_ERROR,
         BandwidthUpgradeErrorStage::CLIENT_INTRODUCTION,
@@ -1083,6 +1137,7 @@ void BwuManager::RunUpgradeFailedProtocol(
         << endpoint_id
         << " when sending an upgrade failure frame, short-circuiting the "
            "upgrade protocol.";
+    GetBwuMetrics().failed.Increment();
     client->GetAnalyticsRecorder().OnBandwidthUpgradeError(
         endpoint_id, BandwidthUpgradeResult::CHANNEL_ERROR,
         BandwidthUpgradeErrorStage::NETWORK_AVAILABLE,
@@ -1097,6 +1152,7 @@ void BwuManager::RunUpgradeFailedProtocol(
     LOG(ERROR) << "BwuManager failed to write BWU_NEGOTIATION.UPGRADE_FAILURE "
                   "OfflineFrame to endpoint "
                << endpoint_id << ", short-circuiting the upgrade protocol.";
+    GetBwuMetrics().failed.Increment();
     client->GetAnalyticsRecorder().OnBandwidthUpgradeError(
         endpoint_id, BandwidthUpgradeResult::RESULT_IO_ERROR,
         BandwidthUpgradeErrorStage::NETWORK_AVAILABLE,
@@ -1237,7 +1293,9 @@ void BwuManager::ProcessLastWriteToPriorChannelEvent(
             << location::nearby::proto::connections::Medium_Name(
                    previous_endpoint_channel->GetMedium());
 
-  if (!previous_endpoint_channel->Write(parser::ForBwuSafeToClose()).Ok()) {
+  if (!previous_endpoint_channel
+           ->Write(parser::ForBwuSafeToClose(is_multipath_enabled_))
+           .Ok()) {
     previous_endpoint_channel->Close(DisconnectionReason::IO_ERROR);
     // Remove this prior EndpointChannel from previous_endpoint_channels to
     // avoid leaks.
@@ -1247,6 +1305,7 @@ void BwuManager::ProcessLastWriteToPriorChannelEvent(
                   "BWU_NEGOTIATION.SAFE_TO_CLOSE_PRIOR_CHANNEL "
                   "OfflineFrame to endpoint "
                << endpoint_id << ", short-circuiting the upgrade protocol.";
+    GetBwuMetrics().failed.Increment();
     client->GetAnalyticsRecorder().OnBandwidthUpgradeError(
         endpoint_id, BandwidthUpgradeResult::RESULT_IO_ERROR,
         BandwidthUpgradeErrorStage::SAFE_TO_CLOSE_PRIOR_CHANNEL,
@@ -1265,7 +1324,8 @@ void BwuManager::ProcessLastWriteToPriorChannelEvent(
 }
 
 void BwuManager::ProcessSafeToClosePriorChannelEvent(
-    ClientProxy* client, const std::string& endpoint_id) {
+    ClientProxy* client, const std::string& endpoint_id,
+    bool remote_supports_multipath) {
   LOG(INFO) << "ProcessSafeToClosePriorChannelEvent for endpoint "
             << endpoint_id;
   // By this point in the upgrade protocol, there's no more writes happening
@@ -1301,29 +1361,51 @@ void BwuManager::ProcessSafeToClosePriorChannelEvent(
             << "BWU_NEGOTIATION.SAFE_TO_CLOSE_PRIOR_CHANNEL OfflineFrame while "
             << "trying to upgrade endpoint " << endpoint_id;
 
-  // Each encrypted message includes the key to decrypt the next message. The
-  // disconnect message is optional and may not be received under normal
-  // circumstances so it is necessary to send it unencrypted. This way the
-  // serial crypto context does not increment here.
-  previous_endpoint_channel->DisableEncryption();
-  LOG(INFO) << "[safe-to-disconnect] Sending "
-               "DISCONNECTION frame with request 0, ack 0";
-  previous_endpoint_channel->Write(
-      parser::ForDisconnection(/* request_safe_to_disconnect */ false,
-                               /* ack_safe_to_disconnect */ false));
-
-  // Attempt to read the disconnect message from the previous channel. We don't
-  // care whether we successfully read it or whether we get an exception here.
-  // The idea is just to make sure the other side has had a chance to receive
-  // the full SAFE_TO_CLOSE_PRIOR_CHANNEL message before we actually close the
-  // channel. See b/172380349 for more context.
-  previous_endpoint_channel->Read();
-  previous_endpoint_channel->Close(DisconnectionReason::UPGRADED);
-
-  VLOG(1) << "BwuManager cleanly shut down prior "
-          << previous_endpoint_channel->GetType()
-          << " EndpointChannel to conclude upgrade protocol for endpoint "
-          << endpoint_id;
+  if (is_bandwidth_aware_bwu_enabled_) {
+    RecordChannelBandwidth(client, endpoint_id, *previous_endpoint_channel);
+  }
+
+  int upgrade_count = ++completed_upgrades_[endpoint_id];
+  // Both devices have written their last frame encrypted with the endpoint's
+  // context, so the prior channel can now switch to a context of its own and
+  // carry payload chunks next to the new channel.
+  bool kept_as_path =
+      is_multipath_enabled_ && remote_supports_multipath &&
+      endpoint_manager_->AddPathForEndpoint(
+          client, endpoint_id, previous_endpoint_channel,
+          absl::StrCat(location::nearby::proto::connections::Medium_Name(
+                           previous_endpoint_channel->GetMedium()),
+                       ":", upgrade_count));
+  if (kept_as_path) {
+    LOG(INFO) << "BwuManager kept prior "
+              << previous_endpoint_channel->GetType()
+              << " EndpointChannel as an additional path for endpoint "
+              << endpoint_id;
+  } else {
+    // Each encrypted message includes the key to decrypt the next message. The
+    // disconnect message is optional and may not be received under normal
+    // circumstances so it is necessary to send it unencrypted. This way the
+    // serial crypto context does not increment here.
+    previous_endpoint_channel->DisableEncryption();
+    LOG(INFO) << "[safe-to-disconnect] Sending "
+                 "DISCONNECTION frame with request 0, ack 0";
+    previous_endpoint_channel->Write(
+        parser::ForDisconnection(/* request_safe_to_disconnect */ false,
+                                 /* ack_safe_to_disconnect */ false));
+
+    // Attempt to read the disconnect message from the previous channel. We
+    // don't care whether we successfully read it or whether we get an
+    // exception here. The idea is just to make sure the other side has had a
+    // chance to receive the full SAFE_TO_CLOSE_PRIOR_CHANNEL message before we
+    // actually close the channel. See b/172380349 for more context.
+    previous_endpoint_channel->Read();
+    previous_endpoint_channel->Close(DisconnectionReason::UPGRADED);
+
+    VLOG(1) << "BwuManager cleanly shut down prior "
+            << previous_endpoint_channel->GetType()
+            << " EndpointChannel to conclude upgrade protocol for endpoint "
+            << endpoint_id;
+  }
 
   // Now the upgrade protocol has completed, record analytics for this new
   // upgraded bandwidth connection...
@@ -1332,6 +1414,12 @@ void BwuManager::ProcessSafeToClosePriorChannelEvent(
       client->GetConnectionToken(endpoint_id));
   // ...and the success of the upgrade itself.
   client->GetAnalyticsRecorder().OnBandwidthUpgradeSuccess(endpoint_id);
+  GetBwuMetrics().succeeded.Increment();
+  auto start_time = upgrade_start_times_.extract(endpoint_id);
+  if (!start_time.empty()) {
+    GetBwuMetrics().duration_us.RecordDuration(SystemClock::ElapsedRealtime() -
+                                               start_time.mapped());
+  }
 
   // Now that the old channel has been drained, we can unpause the new channel
   std::shared_ptr<EndpointChannel> channel =
@@ -1388,6 +1476,7 @@ void BwuManager::ProcessUpgradeFailureEvent(
         << endpoint_id
         << " because we have other connected endpoints and can't try a new "
            "upgrade medium.";
+    GetBwuMetrics().failed.Increment();
     client->GetAnalyticsRecorder().OnBandwidthUpgradeError(
         endpoint_id, BandwidthUpgradeResult::CHANNEL_ERROR,
         BandwidthUpgradeErrorStage::NETWORK_AVAILABLE, operation_result_code);
@@ -1407,6 +1496,7 @@ void BwuManager::ProcessUpgradeFailureEvent(
   }
 
   if (record_analytic) {
+    GetBwuMetrics().failed.Increment();
     client->GetAnalyticsRecorder().OnBandwidthUpgradeError(
         endpoint_id, result, BandwidthUpgradeErrorStage::NETWORK_AVAILABLE,
         operation_result_code);
@@ -1432,7 +1522,15 @@ void BwuManager::ProcessUpgradeFailureEvent(
 void BwuManager::TryNextBestUpgradeMediums(
     ClientProxy* client, const std::string& endpoint_id,
     std::vector<Medium> upgrade_mediums) {
-  Medium next_medium = ChooseBestUpgradeMedium(endpoint_id, upgrade_mediums);
+  if (is_bandwidth_aware_bwu_enabled_) {
+    std::shared_ptr<EndpointChannel> channel =
+        channel_manager_->GetChannelForEndpoint(endpoint_id);
+    if (channel != nullptr) {
+      RecordChannelBandwidth(client, endpoint_id, *channel);
+    }
+  }
+  Medium next_medium =
+      ChooseBestUpgradeMedium(client, endpoint_id, upgrade_mediums);
   LOG(INFO) << "Try Next Best Medium for endpoint " << endpoint_id
             << " after ChooseBestUpgradeMedium: "
             << location::nearby::proto::connections::Medium_Name(next_medium);
@@ -1516,9 +1614,20 @@ std::vector<Medium> BwuManager::StripOutUnavailableMediums(
 // way to prevent mediums, like Wifi Hotspot, from interfering with active
 // connections (although it's suboptimal for bandwidth throughput). When all
 // endpoints disconnect, we reset the bandwidth upgrade medium.
+//
+// With kEnableBandwidthAwareBwu, mediums that were measured to be faster move
+// ahead of slower ones when the upgrade medium is picked. Once picked, it is
+// kept like any other: a medium that slows down is not traded for a faster one
+// while endpoints are still upgraded to it, since that would break the rule
+// above. Its measurements only steer the pick after all endpoints disconnect.
 Medium BwuManager::ChooseBestUpgradeMedium(
-    const std::string& endpoint_id, const std::vector<Medium>& mediums) const {
+    ClientProxy* client, const std::string& endpoint_id,
+    const std::vector<Medium>& mediums) const {
   auto available_mediums = StripOutUnavailableMediums(mediums);
+  if (is_bandwidth_aware_bwu_enabled_) {
+    available_mediums = bandwidth_tracker_.RankMediums(
+        GetBandwidthPeerId(client, endpoint_id), std::move(available_mediums));
+  }
   Medium current_medium = GetBwuMediumForEndpoint(endpoint_id);
   if (current_medium == Medium::UNKNOWN_MEDIUM) {
     if (!available_mediums.empty()) {
@@ -1562,6 +1671,21 @@ Medium BwuManager::ChooseBestUpgradeMedium(
   return Medium::UNKNOWN_MEDIUM;
 }
 
+std::string BwuManager::GetBandwidthPeerId(ClientProxy* client,
+                                           const std::string& endpoint_id) {
+  std::string endpoint_info = client->GetRemoteEndpointInfo(endpoint_id);
+  return endpoint_info.empty() ? endpoint_id : endpoint_info;
+}
+
+void BwuManager::RecordChannelBandwidth(ClientProxy* client,
+                                        const std::string& endpoint_id,
+                                        const EndpointChannel& channel) {
+  bandwidth_tracker_.RecordMeasurement(GetBandwidthPeerId(client, endpoint_id),
+                                       channel.GetMedium(),
+                                       channel.GetThroughputBytesPerSecond(),
+                                       channel.GetWriteLatency());
+}
+
 void BwuManager::RetryUpgradesAfterDelay(ClientProxy* client,
                                          const std::string& endpoint_id) {
   absl::Duration delay = CalculateNextRetryDelay(endpoint_id);
@@ -1599,6 +1723,7 @@ void BwuManager::AttemptToRecordBandwidthUpgradeErrorForUnknownEndpoint(
     // them if they want to repeatedly attempt to connect or if they want to
     // give up and have us try a different medium. This isn't a decision we can
     // make for them.
+    GetBwuMetrics().failed.Increment();
     client->GetAnalyticsRecorder().OnBandwidthUpgradeError(
         endpoint_id, result, error_stage, operation_result_code);
     LOG(INFO) << "BwuManager got error " << BandwidthUpgradeResult_Name(result)
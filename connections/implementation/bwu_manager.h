@@ -28,6 +28,7 @@
 #include "connections/implementation/endpoint_channel.h"
 #include "connections/implementation/endpoint_channel_manager.h"
 #include "connections/implementation/endpoint_manager.h"
+#include "connections/implementation/medium_bandwidth_tracker.h"
 #include "connections/implementation/mediums/ble.h"
 #include "connections/implementation/mediums/mediums.h"
 #include "connections/medium_selector.h"
@@ -132,9 +133,22 @@ class BwuManager : public EndpointManager::FrameProcessor {
   void RunOnBwuManagerThread(const std::string& name, Runnable runnable);
   std::vector<Medium> StripOutUnavailableMediums(
       const std::vector<Medium>& mediums) const;
-  Medium ChooseBestUpgradeMedium(const std::string& endpoint_id,
+  Medium ChooseBestUpgradeMedium(ClientProxy* client,
+                                 const std::string& endpoint_id,
                                  const std::vector<Medium>& mediums) const;
 
+  // Returns the id `bandwidth_tracker_` knows the remote device of
+  // `endpoint_id` by: its endpoint info, which is the same across
+  // connections, or the endpoint id if there is none.
+  static std::string GetBandwidthPeerId(ClientProxy* client,
+                                        const std::string& endpoint_id);
+
+  // Records what the current channel of `endpoint_id` has delivered so far,
+  // to be used by later upgrade decisions.
+  void RecordChannelBandwidth(ClientProxy* client,
+                              const std::string& endpoint_id,
+                              const EndpointChannel& channel);
+
   // BaseBwuHandler
 
   // Processes the
@@ -186,7 +200,8 @@ class BwuManager : public EndpointManager::FrameProcessor {
   void ProcessLastWriteToPriorChannelEvent(ClientProxy* client,
                                            const std::string& endpoint_id);
   void ProcessSafeToClosePriorChannelEvent(ClientProxy* client,
-                                           const std::string& endpoint_id);
+                                           const std::string& endpoint_id,
+                                           bool remote_supports_multipath);
   bool ReadClientIntroductionFrame(
       EndpointChannel* endpoint_channel,
       location::nearby::connections::BandwidthUpgradeNegotiationFrame::
@@ -256,6 +271,9 @@ class BwuManager : public EndpointManager::FrameProcessor {
   // initiateBwuForEndpoint() has been called but which have not
   // yet completed the upgrade via onIncomingConnection().
   absl::flat_hash_map<std::string, ClientProxy*> in_progress_upgrades_;
+  // Maps endpointId -> when the in-progress upgrade started, for the metrics
+  // registry.
+  absl::flat_hash_map<std::string, absl::Time> upgrade_start_times_;
   // Maps endpointId -> timestamp of when the SAFE_TO_CLOSE message was written.
   absl::flat_hash_map<std::string, absl::Time> safe_to_close_write_timestamps_;
   absl::flat_hash_map<
@@ -267,6 +285,22 @@ class BwuManager : public EndpointManager::FrameProcessor {
   // using a different map to keep track of the delays per endpoint.
   absl::flat_hash_map<std::string, absl::Duration> retry_delays_;
 
+  // Observed bandwidth per medium and per remote device. Only consulted if
+  // kEnableBandwidthAwareBwu is enabled.
+  MediumBandwidthTracker bandwidth_tracker_;
+  bool is_bandwidth_aware_bwu_enabled_ = NearbyFlags::GetInstance().GetBoolFlag(
+      config_package_nearby::nearby_connections_feature::
+          kEnableBandwidthAwareBwu);
+
+  // Whether prior channels are kept as additional paths after an upgrade, if
+  // the remote device agrees.
+  bool is_multipath_enabled_ = NearbyFlags::GetInstance().GetBoolFlag(
+      config_package_nearby::nearby_connections_feature::
+          kEnableMultipathTransfer);
+  // Maps endpointId -> number of completed upgrades. Both devices count the
+  // same way, which makes the ids of additional paths unique and agreed upon.
+  absl::flat_hash_map<std::string, int> completed_upgrades_;
+
   // Whether the dynamic role switch feature is enabled.
   bool is_dynamic_role_switch_enabled_ = NearbyFlags::GetInstance().GetBoolFlag(
       config_package_nearby::nearby_connections_feature::
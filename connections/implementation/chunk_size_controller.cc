@@ -0,0 +1,141 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/chunk_size_controller.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#include "absl/time/time.h"
+#include "internal/platform/logging.h"
+#include "internal/platform/mutex_lock.h"
+#include "proto/connections_enums.pb.h"
+
+namespace nearby::connections {
+
+namespace {
+using ::location::nearby::proto::connections::Medium;
+
+// Upper bound for high bandwidth mediums, independent of the read limit.
+constexpr int kMaxHighBandwidthChunkSize = 512 * 1024;
+// Never shrink below this, whatever the medium reports.
+constexpr int kMinChunkSize = 128;
+
+bool IsHighBandwidthMedium(Medium medium) {
+  switch (medium) {
+    case Medium::WIFI_LAN:
+    case Medium::WIFI_HOTSPOT:
+    case Medium::WIFI_DIRECT:
+    case Medium::WIFI_AWARE:
+    case Medium::WEB_RTC:
+    case Medium::WEB_RTC_NON_CELLULAR:
+    case Medium::AWDL:
+    case Medium::USB:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+ChunkSizeController::Bounds ChunkSizeController::GetBoundsForMedium(
+    Medium medium, int max_transmit_packet_size, int max_allowed_read_bytes) {
+  int initial = std::max(max_transmit_packet_size, kMinChunkSize);
+  if (IsHighBandwidthMedium(medium)) {
+    int max_chunk_size = std::max(
+        initial, std::min(kMaxHighBandwidthChunkSize, max_allowed_read_bytes / 2));
+    return {
+        .min_chunk_size = std::max(initial / 8, kMinChunkSize),
+        .initial_chunk_size = initial,
+        .max_chunk_size = max_chunk_size,
+        .increase_step = std::max(initial / 4, kMinChunkSize),
+        .target_write_latency = absl::Milliseconds(50),
+    };
+  }
+  // Bluetooth, BLE and anything unknown: the medium's packet size is already
+  // tuned for its MTU, so only allow shrinking for fairness.
+  return {
+      .min_chunk_size = std::max(initial / 4, kMinChunkSize),
+      .initial_chunk_size = initial,
+      .max_chunk_size = initial,
+      .increase_step = std::max(initial / 8, kMinChunkSize / 2),
+      .target_write_latency = absl::Milliseconds(250),
+  };
+}
+
+ChunkSizeController::ChunkSizeController(const Bounds& bounds)
+    : bounds_(bounds),
+      chunk_size_(std::clamp(bounds.initial_chunk_size, bounds.min_chunk_size,
+                             bounds.max_chunk_size)) {}
+
+int ChunkSizeController::GetChunkSize() const {
+  MutexLock lock(&mutex_);
+  return chunk_size_;
+}
+
+double ChunkSizeController::GetThroughputBytesPerSecond() const {
+  MutexLock lock(&mutex_);
+  return throughput_bytes_per_second_;
+}
+
+absl::Duration ChunkSizeController::GetWriteLatency() const {
+  MutexLock lock(&mutex_);
+  return write_latency_;
+}
+
+void ChunkSizeController::OnWriteCompleted(size_t num_bytes,
+                                           absl::Duration elapsed) {
+  MutexLock lock(&mutex_);
+  write_latency_ = write_latency_ == absl::ZeroDuration()
+                       ? elapsed
+                       : (1 - kSmoothingFactor) * write_latency_ +
+                             kSmoothingFactor * elapsed;
+
+  // Small frames say little about the bandwidth; ignore them for sizing.
+  if (num_bytes < static_cast<size_t>(chunk_size_) / 2) return;
+
+  double seconds =
+      std::max(absl::ToDoubleSeconds(elapsed), 1e-6 /* 1 microsecond */);
+  double sample = static_cast<double>(num_bytes) / seconds;
+  throughput_bytes_per_second_ =
+      throughput_bytes_per_second_ == 0
+          ? sample
+          : (1 - kSmoothingFactor) * throughput_bytes_per_second_ +
+                kSmoothingFactor * sample;
+
+  int previous = chunk_size_;
+  if (elapsed > bounds_.target_write_latency) {
+    DecreaseLocked();
+  } else {
+    chunk_size_ =
+        std::min(chunk_size_ + bounds_.increase_step, bounds_.max_chunk_size);
+  }
+  if (chunk_size_ != previous) {
+    VLOG(1) << "ChunkSizeController: chunk size " << previous << " -> "
+            << chunk_size_ << ", throughput=" << throughput_bytes_per_second_
+            << " B/s, latency=" << elapsed;
+  }
+}
+
+void ChunkSizeController::OnWriteFailed() {
+  MutexLock lock(&mutex_);
+  DecreaseLocked();
+}
+
+void ChunkSizeController::DecreaseLocked() {
+  chunk_size_ = std::max(chunk_size_ / 2, bounds_.min_chunk_size);
+}
+
+}  // namespace nearby::connections
@@ -0,0 +1,100 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_CHUNK_SIZE_CONTROLLER_H_
+#define CORE_INTERNAL_CHUNK_SIZE_CONTROLLER_H_
+
+#include <cstddef>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/time/time.h"
+#include "internal/platform/mutex.h"
+#include "proto/connections_enums.pb.h"
+
+namespace nearby::connections {
+
+// Picks the payload chunk size for one EndpointChannel based on how fast the
+// channel actually drains writes.
+//
+// The controller follows an AIMD (additive increase, multiplicative decrease)
+// scheme: every data-sized write that completes within the medium's target
+// latency grows the chunk size by a fixed step, and every write that exceeds
+// it (or fails) halves the chunk size. The result is always clamped to the
+// per-medium bounds, so fast mediums such as WiFi can use large chunks while
+// constrained mediums such as BLE stay small enough to keep the channel fair
+// for control frames and keep-alives.
+//
+// The controller is thread-safe.
+class ChunkSizeController {
+ public:
+  struct Bounds {
+    int min_chunk_size;
+    int initial_chunk_size;
+    int max_chunk_size;
+    // Chunk size grows by this many bytes after each fast write.
+    int increase_step;
+    // Writes slower than this are treated as congestion.
+    absl::Duration target_write_latency;
+  };
+
+  // Weight of the newest sample in the throughput/latency moving averages.
+  static constexpr double kSmoothingFactor = 0.25;
+
+  // Returns the bounds to use for `medium`. `max_transmit_packet_size` is the
+  // medium's nominal packet size and `max_allowed_read_bytes` the largest
+  // frame this device accepts (kMediumMaxAllowedReadBytes). Both sides are
+  // assumed to use the same limit, so chunks never grow past half of it, to
+  // leave room for frame and encryption overhead.
+  static Bounds GetBoundsForMedium(
+      location::nearby::proto::connections::Medium medium,
+      int max_transmit_packet_size, int max_allowed_read_bytes);
+
+  explicit ChunkSizeController(const Bounds& bounds);
+
+  // Returns the chunk size the next outgoing payload chunk should use.
+  int GetChunkSize() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the smoothed write throughput in bytes per second, or 0 if no
+  // write has been measured yet.
+  double GetThroughputBytesPerSecond() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the smoothed write latency, or zero if no write has been measured
+  // yet.
+  absl::Duration GetWriteLatency() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Records a completed write of `num_bytes` that took `elapsed`. Writes much
+  // smaller than the current chunk size (keep-alives, control frames) only
+  // update the latency estimate and don't move the chunk size.
+  void OnWriteCompleted(size_t num_bytes, absl::Duration elapsed)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Records a failed write; treated like congestion.
+  void OnWriteFailed() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  const Bounds& bounds() const { return bounds_; }
+
+ private:
+  void DecreaseLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const Bounds bounds_;
+
+  mutable Mutex mutex_;
+  int chunk_size_ ABSL_GUARDED_BY(mutex_);
+  double throughput_bytes_per_second_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::Duration write_latency_ ABSL_GUARDED_BY(mutex_) = absl::ZeroDuration();
+};
+
+}  // namespace nearby::connections
+
+#endif  // CORE_INTERNAL_CHUNK_SIZE_CONTROLLER_H_
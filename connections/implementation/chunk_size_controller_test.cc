@@ -0,0 +1,192 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/chunk_size_controller.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+#include "internal/platform/logging.h"
+#include "proto/connections_enums.pb.h"
+
+namespace nearby::connections {
+namespace {
+
+using ::location::nearby::proto::connections::Medium;
+
+constexpr int kDefaultPacketSize = 64 * 1024;
+constexpr int kMaxAllowedReadBytes = 1024 * 1024;
+
+// A simulated link: every write costs a fixed latency plus serialization time.
+struct SimulatedLink {
+  double bandwidth_bytes_per_second;
+  absl::Duration latency;
+
+  absl::Duration WriteTime(int64_t num_bytes) const {
+    return latency +
+           absl::Seconds(static_cast<double>(num_bytes) /
+                         bandwidth_bytes_per_second);
+  }
+};
+
+// Pushes `total_bytes` through `controller` over `link` and returns the
+// simulated transfer time.
+absl::Duration Transfer(ChunkSizeController& controller,
+                        const SimulatedLink& link, int64_t total_bytes) {
+  absl::Duration elapsed = absl::ZeroDuration();
+  while (total_bytes > 0) {
+    int64_t chunk = std::min<int64_t>(controller.GetChunkSize(), total_bytes);
+    absl::Duration write_time = link.WriteTime(chunk);
+    controller.OnWriteCompleted(chunk, write_time);
+    elapsed += write_time;
+    total_bytes -= chunk;
+  }
+  return elapsed;
+}
+
+TEST(ChunkSizeControllerTest, StartsAtInitialChunkSize) {
+  ChunkSizeController controller(ChunkSizeController::GetBoundsForMedium(
+      Medium::WIFI_LAN, kDefaultPacketSize, kMaxAllowedReadBytes));
+
+  EXPECT_EQ(controller.GetChunkSize(), kDefaultPacketSize);
+  EXPECT_EQ(controller.GetThroughputBytesPerSecond(), 0);
+}
+
+TEST(ChunkSizeControllerTest, HighBandwidthBoundsAllowGrowth) {
+  ChunkSizeController::Bounds bounds = ChunkSizeController::GetBoundsForMedium(
+      Medium::WIFI_LAN, kDefaultPacketSize, kMaxAllowedReadBytes);
+
+  EXPECT_LT(bounds.min_chunk_size, kDefaultPacketSize);
+  EXPECT_GT(bounds.max_chunk_size, kDefaultPacketSize);
+  EXPECT_LE(bounds.max_chunk_size, kMaxAllowedReadBytes / 2);
+}
+
+TEST(ChunkSizeControllerTest, ConstrainedMediumNeverGrowsPastPacketSize) {
+  ChunkSizeController::Bounds bounds =
+      ChunkSizeController::GetBoundsForMedium(Medium::BLE, 512,
+                                              kMaxAllowedReadBytes);
+
+  EXPECT_EQ(bounds.max_chunk_size, 512);
+  EXPECT_LT(bounds.min_chunk_size, 512);
+}
+
+TEST(ChunkSizeControllerTest, GrowsOnFastLink) {
+  ChunkSizeController controller(ChunkSizeController::GetBoundsForMedium(
+      Medium::WIFI_LAN, kDefaultPacketSize, kMaxAllowedReadBytes));
+  SimulatedLink wifi{.bandwidth_bytes_per_second = 50.0 * 1024 * 1024,
+                     .latency = absl::Milliseconds(1)};
+
+  Transfer(controller, wifi, 64 * 1024 * 1024);
+
+  EXPECT_EQ(controller.GetChunkSize(), controller.bounds().max_chunk_size);
+  EXPECT_GT(controller.GetThroughputBytesPerSecond(), 40.0 * 1024 * 1024);
+}
+
+TEST(ChunkSizeControllerTest, ShrinksOnSlowWrites) {
+  ChunkSizeController controller(ChunkSizeController::GetBoundsForMedium(
+      Medium::BLUETOOTH, 1980, kMaxAllowedReadBytes));
+  // ~4 KB/s with a long scheduling delay: every write misses the target.
+  SimulatedLink congested{.bandwidth_bytes_per_second = 4 * 1024,
+                          .latency = absl::Milliseconds(300)};
+
+  Transfer(controller, congested, 64 * 1024);
+
+  EXPECT_EQ(controller.GetChunkSize(), controller.bounds().min_chunk_size);
+}
+
+TEST(ChunkSizeControllerTest, SmallWritesDoNotChangeChunkSize) {
+  ChunkSizeController controller(ChunkSizeController::GetBoundsForMedium(
+      Medium::WIFI_LAN, kDefaultPacketSize, kMaxAllowedReadBytes));
+
+  for (int i = 0; i < 100; ++i) {
+    controller.OnWriteCompleted(32, absl::Seconds(1));
+  }
+
+  EXPECT_EQ(controller.GetChunkSize(), kDefaultPacketSize);
+  EXPECT_EQ(controller.GetThroughputBytesPerSecond(), 0);
+  EXPECT_GT(controller.GetWriteLatency(), absl::ZeroDuration());
+}
+
+TEST(ChunkSizeControllerTest, FailureHalvesChunkSize) {
+  ChunkSizeController controller(ChunkSizeController::GetBoundsForMedium(
+      Medium::WIFI_LAN, kDefaultPacketSize, kMaxAllowedReadBytes));
+
+  controller.OnWriteFailed();
+
+  EXPECT_EQ(controller.GetChunkSize(), kDefaultPacketSize / 2);
+}
+
+TEST(ChunkSizeControllerTest, RecoversAfterCongestion) {
+  ChunkSizeController controller(ChunkSizeController::GetBoundsForMedium(
+      Medium::WIFI_DIRECT, kDefaultPacketSize, kMaxAllowedReadBytes));
+  SimulatedLink fast{.bandwidth_bytes_per_second = 20.0 * 1024 * 1024,
+                     .latency = absl::Milliseconds(2)};
+  SimulatedLink stalled{.bandwidth_bytes_per_second = 20.0 * 1024 * 1024,
+                        .latency = absl::Milliseconds(200)};
+
+  Transfer(controller, fast, 16 * 1024 * 1024);
+  int grown = controller.GetChunkSize();
+  Transfer(controller, stalled, 2 * 1024 * 1024);
+  int shrunk = controller.GetChunkSize();
+  Transfer(controller, fast, 16 * 1024 * 1024);
+
+  EXPECT_LT(shrunk, grown);
+  EXPECT_GT(controller.GetChunkSize(), shrunk);
+}
+
+// Compares the simulated transfer time of the adaptive controller against the
+// fixed default chunk size on mediums with differing bandwidth and latency.
+TEST(ChunkSizeControllerTest, BenchmarkAgainstFixedChunkSize) {
+  struct Scenario {
+    const char* name;
+    Medium medium;
+    int packet_size;
+    SimulatedLink link;
+  };
+  const Scenario kScenarios[] = {
+      {"wifi_lan_fast", Medium::WIFI_LAN, kDefaultPacketSize,
+       {.bandwidth_bytes_per_second = 80.0 * 1024 * 1024,
+        .latency = absl::Milliseconds(2)}},
+      {"wifi_direct_lossy", Medium::WIFI_DIRECT, kDefaultPacketSize,
+       {.bandwidth_bytes_per_second = 10.0 * 1024 * 1024,
+        .latency = absl::Milliseconds(10)}},
+      {"bluetooth", Medium::BLUETOOTH, 1980,
+       {.bandwidth_bytes_per_second = 150.0 * 1024,
+        .latency = absl::Milliseconds(15)}},
+  };
+  constexpr int64_t kTotalBytes = 32 * 1024 * 1024;
+
+  for (const auto& scenario : kScenarios) {
+    ChunkSizeController adaptive(ChunkSizeController::GetBoundsForMedium(
+        scenario.medium, scenario.packet_size, kMaxAllowedReadBytes));
+    ChunkSizeController::Bounds fixed_bounds = adaptive.bounds();
+    fixed_bounds.min_chunk_size = fixed_bounds.max_chunk_size =
+        scenario.packet_size;
+    ChunkSizeController fixed(fixed_bounds);
+
+    absl::Duration adaptive_time =
+        Transfer(adaptive, scenario.link, kTotalBytes);
+    absl::Duration fixed_time = Transfer(fixed, scenario.link, kTotalBytes);
+    LOG(INFO) << scenario.name << ": adaptive=" << adaptive_time
+              << " (chunk=" << adaptive.GetChunkSize()
+              << "), fixed=" << fixed_time;
+
+    EXPECT_LE(adaptive_time, fixed_time) << scenario.name;
+  }
+}
+
+}  // namespace
+}  // namespace nearby::connections
@@ -255,6 +255,11 @@ ClientProxy::ClientProxy(std::unique_ptr<AnalyticsRecorder> analytics_recorder)
 
   is_dct_enabled_ = NearbyFlags::GetInstance().GetBoolFlag(
       config_package_nearby::nearby_connections_feature::kEnableDct);
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableAsyncListenerDispatch)) {
+    listener_dispatcher_ = std::make_unique<ListenerDispatcher>();
+  }
   error_code_recorder_ = std::make_unique<ErrorCodeRecorder>(
       [this](const ErrorCodeParams& params) {
         analytics_recorder_->OnErrorCode(params);
@@ -551,7 +556,8 @@ void ClientProxy::StartedDiscovery(
         operation_result_with_mediums,
     const DiscoveryOptions& discovery_options) {
   MutexLock lock(&mutex_);
-  discovery_info_ = DiscoveryInfo{service_id, std::move(listener)};
+  discovery_info_ = DiscoveryInfo{
+      service_id, std::make_shared<DiscoveryListener>(std::move(listener))};
   discovery_options_ = discovery_options;
 
   const std::vector<location::nearby::proto::connections::Medium> medium_vector(
@@ -619,8 +625,10 @@ void ClientProxy::OnEndpointFound(
   }
 
   discovered_endpoint_ids_.insert(endpoint_id);
-  discovery_info_.listener.endpoint_found_cb(endpoint_id, endpoint_info,
-                                             service_id);
+  DispatchToListener([listener = discovery_info_.listener, endpoint_id,
+                      endpoint_info, service_id]() {
+    listener->endpoint_found_cb(endpoint_id, endpoint_info, service_id);
+  });
   analytics_recorder_->OnEndpointFound(medium);
 }
 
@@ -645,7 +653,9 @@ void ClientProxy::OnEndpointLost(const std::string& service_id,
   }
 
   discovered_endpoint_ids_.erase(it);
-  discovery_info_.listener.endpoint_lost_cb(endpoint_id);
+  DispatchToListener([listener = discovery_info_.listener, endpoint_id]() {
+    listener->endpoint_lost_cb(endpoint_id);
+  });
 }
 
 void ClientProxy::OnRequestConnection(
@@ -671,12 +681,14 @@ void ClientProxy::OnConnectionInitiated(
                            .connection_listener = listener,
                            .connection_options = connection_options,
                            .connection_token = connection_token,
+                           .remote_endpoint_info =
+                               std::string(info.remote_endpoint_info),
                        },
-                       PayloadListener{
+                       std::make_shared<PayloadListener>(PayloadListener{
                            .payload_cb = [](absl::string_view, Payload) {},
                            .payload_progress_cb = [](absl::string_view,
                                                      PayloadProgressInfo) {},
-                       }));
+                       })));
   // Instead of using structured binding which is nice, but banned
   // (can not use c++17 features, until chromium does) we unpack manually.
   auto& pair_iter = result.first;
@@ -690,7 +702,9 @@ void ClientProxy::OnConnectionInitiated(
   //
   // Note: we allow devices to connect to an advertiser even after it stops
   // advertising, so no need to check IsAdvertising() here.
-  item.first.connection_listener.initiated_cb(endpoint_id, info);
+  DispatchToListener(
+      [initiated_cb = item.first.connection_listener.initiated_cb, endpoint_id,
+       info]() { initiated_cb(endpoint_id, info); });
 
   if (info.is_incoming_connection) {
     // Add CancellationFlag for advertisers once encryption succeeds.
@@ -715,7 +729,9 @@ void ClientProxy::OnConnectionAccepted(const std::string& endpoint_id) {
   // Notify the client.
   ConnectionPair* item = LookupConnection(endpoint_id);
   if (item != nullptr) {
-    item->first.connection_listener.accepted_cb(endpoint_id);
+    DispatchToListener(
+        [accepted_cb = item->first.connection_listener.accepted_cb,
+         endpoint_id]() { accepted_cb(endpoint_id); });
     item->first.status = Connection::kConnected;
   }
 }
@@ -735,7 +751,9 @@ void ClientProxy::OnConnectionRejected(const std::string& endpoint_id,
   // Notify the client.
   const ConnectionPair* item = LookupConnection(endpoint_id);
   if (item != nullptr) {
-    item->first.connection_listener.rejected_cb(endpoint_id, status);
+    DispatchToListener(
+        [rejected_cb = item->first.connection_listener.rejected_cb,
+         endpoint_id, status]() { rejected_cb(endpoint_id, status); });
     OnDisconnected(endpoint_id, false /* notify */);
   }
 }
@@ -748,8 +766,12 @@ void ClientProxy::OnBandwidthChanged(const std::string& endpoint_id,
   ConnectionPair* item = LookupConnection(endpoint_id);
   if (item != nullptr) {
     item->first.connected_medium = new_medium;
-    item->first.connection_listener.bandwidth_changed_cb(endpoint_id,
-                                                         new_medium);
+    DispatchToListener(
+        [bandwidth_changed_cb =
+             item->first.connection_listener.bandwidth_changed_cb,
+         endpoint_id, new_medium]() {
+          bandwidth_changed_cb(endpoint_id, new_medium);
+        });
     LOG(INFO) << "ClientProxy [reporting onBandwidthChanged]: client="
               << GetClientId() << "; endpoint_id=" << endpoint_id;
   }
@@ -762,7 +784,9 @@ void ClientProxy::OnDisconnected(const std::string& endpoint_id, bool notify) {
   const ConnectionPair* item = LookupConnection(endpoint_id);
   if (item != nullptr) {
     if (notify) {
-      item->first.connection_listener.disconnected_cb({endpoint_id});
+      DispatchToListener(
+          [disconnected_cb = item->first.connection_listener.disconnected_cb,
+           endpoint_id]() { disconnected_cb(endpoint_id); });
     }
     connections_.erase(endpoint_id);
     OnSessionComplete();
@@ -953,7 +977,7 @@ void ClientProxy::LocalEndpointAcceptedConnection(
   LOG(INFO) << "ClientProxy [Local Accepted]: id=" << endpoint_id;
   ConnectionPair* item = LookupConnection(endpoint_id);
   if (item != nullptr) {
-    item->second = std::move(listener);
+    item->second = std::make_shared<PayloadListener>(std::move(listener));
   }
   analytics_recorder_->OnLocalEndpointAccepted(endpoint_id);
 }
@@ -1118,6 +1142,16 @@ std::optional<OsInfo> ClientProxy::GetRemoteOsInfo(
   return std::nullopt;
 }
 
+std::string ClientProxy::GetRemoteEndpointInfo(
+    absl::string_view endpoint_id) const {
+  MutexLock lock(&mutex_);
+  const ConnectionPair* item = LookupConnection(endpoint_id);
+  if (item != nullptr) {
+    return item->first.remote_endpoint_info;
+  }
+  return {};
+}
+
 void ClientProxy::SetLocalOsType(
     const location::nearby::connections::OsInfo::OsType& os_type) {
   MutexLock lock(&mutex_);
@@ -1187,14 +1221,16 @@ void ClientProxy::OnPayload(const std::string& endpoint_id, Payload payload) {
   MutexLock lock(&mutex_);
 
   if (IsConnectedToEndpoint(endpoint_id)) {
-    const std::pair<ClientProxy::Connection, PayloadListener>* item =
-        LookupConnection(endpoint_id);
+    const ConnectionPair* item = LookupConnection(endpoint_id);
     if (item != nullptr) {
       LOG(INFO) << "ClientProxy [reporting onPayloadReceived]: client="
                 << GetClientId() << "; endpoint_id=" << endpoint_id
                 << " ; payload {id:" << payload.GetId()
                 << ", type:" << payload.GetType() << "}";
-      item->second.payload_cb(endpoint_id, std::move(payload));
+      DispatchToListener([listener = item->second, endpoint_id,
+                          payload = std::move(payload)]() mutable {
+        listener->payload_cb(endpoint_id, std::move(payload));
+      });
     }
   }
 }
@@ -1216,10 +1252,22 @@ void ClientProxy::OnPayloadProgress(const std::string& endpoint_id,
   MutexLock lock(&mutex_);
 
   if (IsConnectedToEndpoint(endpoint_id)) {
-    std::pair<ClientProxy::Connection, PayloadListener>* item =
-        LookupConnection(endpoint_id);
+    ConnectionPair* item = LookupConnection(endpoint_id);
     if (item != nullptr) {
-      item->second.payload_progress_cb(endpoint_id, info);
+      if (listener_dispatcher_ == nullptr) {
+        item->second->payload_progress_cb(endpoint_id, info);
+      } else if (info.status == PayloadProgressInfo::Status::kInProgress) {
+        listener_dispatcher_->PostProgress(
+            endpoint_id, info.payload_id,
+            [listener = item->second, endpoint_id, info]() {
+              listener->payload_progress_cb(endpoint_id, info);
+            });
+      } else {
+        listener_dispatcher_->Post(
+            [listener = item->second, endpoint_id, info]() {
+              listener->payload_progress_cb(endpoint_id, info);
+            });
+      }
 
       if (info.status == PayloadProgressInfo::Status::kInProgress) {
         VLOG(1) << "ClientProxy [reporting onPayloadProgress]: client="
@@ -1377,6 +1425,49 @@ void ClientProxy::SetRemoteMultiplexSocketBitmask(
   }
 }
 
+void ClientProxy::SetRemoteSupportsPayloadCompression(
+    absl::string_view endpoint_id, bool supports_payload_compression) {
+  MutexLock lock(&mutex_);
+  ConnectionPair* item = LookupConnection(endpoint_id);
+  if (item != nullptr) {
+    item->first.remote_supports_payload_compression =
+        supports_payload_compression;
+  }
+}
+
+bool ClientProxy::IsPayloadCompressionEnabled(
+    absl::string_view endpoint_id) const {
+  if (!NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnablePayloadCompression)) {
+    return false;
+  }
+  MutexLock lock(&mutex_);
+  const ConnectionPair* item = LookupConnection(endpoint_id);
+  return item != nullptr && item->first.remote_supports_payload_compression;
+}
+
+void ClientProxy::SetRemoteSupportsMultiChunkBytes(
+    absl::string_view endpoint_id, bool supports_multi_chunk_bytes) {
+  MutexLock lock(&mutex_);
+  ConnectionPair* item = LookupConnection(endpoint_id);
+  if (item != nullptr) {
+    item->first.remote_supports_multi_chunk_bytes = supports_multi_chunk_bytes;
+  }
+}
+
+bool ClientProxy::IsMultiChunkBytesEnabled(
+    absl::string_view endpoint_id) const {
+  if (!NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableChunkedBytesPayloads)) {
+    return false;
+  }
+  MutexLock lock(&mutex_);
+  const ConnectionPair* item = LookupConnection(endpoint_id);
+  return item != nullptr && item->first.remote_supports_multi_chunk_bytes;
+}
+
 bool ClientProxy::GetWebRtcNonCellular() {
   MutexLock lock(&mutex_);
   return webrtc_non_cellular_;
@@ -33,6 +33,7 @@
 #include "connections/discovery_options.h"
 #include "connections/implementation/analytics/analytics_recorder.h"
 #include "connections/implementation/analytics/operation_result_with_medium.h"
+#include "connections/implementation/listener_dispatcher.h"
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
 #include "connections/listeners.h"
 #include "connections/medium_selector.h"
@@ -51,6 +52,7 @@
 #include "internal/platform/implementation/app_lifecycle_monitor.h"
 #include "internal/platform/implementation/preferences_manager.h"
 #include "internal/platform/mac_address.h"
+#include "internal/platform/metrics_registry.h"
 #include "internal/platform/mutex.h"
 #include "internal/platform/os_name.h"
 #include "internal/platform/scheduled_executor.h"
@@ -76,6 +78,12 @@ class ClientProxy final {
   std::string GetLocalEndpointId();
   std::string GetLocalEndpointInfo() { return local_endpoint_info_; }
 
+  // Returns the hot-path metrics (bytes moved per medium, encryption, frame
+  // parsing and executor latencies, ...) of the process.
+  MetricsSnapshot GetMetricsSnapshot() const {
+    return MetricsRegistry::GetInstance().GetSnapshot();
+  }
+
   // Override the base for received file attachments from a specific endpoint.
   // Returns true if the endpoint is found and the path is overridden.
   bool OverrideSavePath(absl::string_view endpoint_id, absl::string_view path);
@@ -282,6 +290,9 @@ class ClientProxy final {
   virtual const location::nearby::connections::OsInfo& GetLocalOsInfo() const;
   std::optional<location::nearby::connections::OsInfo> GetRemoteOsInfo(
       absl::string_view endpoint_id) const;
+  // Returns the endpoint info the remote device connected with, which, unlike
+  // its endpoint id, stays the same across connections. Empty if unknown.
+  std::string GetRemoteEndpointInfo(absl::string_view endpoint_id) const;
   void SetLocalOsType(
       const location::nearby::connections::OsInfo::OsType& os_type);
   void SetRemoteOsInfo(
@@ -313,6 +324,20 @@ class ClientProxy final {
   void SetRemoteMultiplexSocketBitmask(absl::string_view endpoint_id,
                                        int remote_multiplex_socket_bitmask);
 
+  // Sets whether the remote device can decompress DEFLATE payloads.
+  void SetRemoteSupportsPayloadCompression(absl::string_view endpoint_id,
+                                           bool supports_payload_compression);
+  // Returns true if payloads sent to `endpoint_id` may be compressed.
+  bool IsPayloadCompressionEnabled(absl::string_view endpoint_id) const;
+
+  // Sets whether the remote device can receive BYTES payloads in several
+  // chunks.
+  void SetRemoteSupportsMultiChunkBytes(absl::string_view endpoint_id,
+                                        bool supports_multi_chunk_bytes);
+  // Returns true if BYTES payloads sent to `endpoint_id` may be split into
+  // several chunks.
+  bool IsMultiChunkBytesEnabled(absl::string_view endpoint_id) const;
+
   // Gets the WebRTC non cellular network status.
   bool GetWebRtcNonCellular();
 
@@ -368,12 +393,18 @@ class ClientProxy final {
     DiscoveryOptions discovery_options;
     AdvertisingOptions advertising_options;
     std::string connection_token;
+    std::string remote_endpoint_info;
     std::optional<location::nearby::connections::OsInfo> os_info;
     std::int32_t safe_to_disconnect_version;
     std::int32_t remote_multiplex_socket_bitmask;
+    bool remote_supports_payload_compression = false;
+    bool remote_supports_multi_chunk_bytes = false;
     std::string save_path;
   };
-  using ConnectionPair = std::pair<Connection, PayloadListener>;
+  // The PayloadListener is shared with callbacks queued on
+  // `listener_dispatcher_`.
+  using ConnectionPair =
+      std::pair<Connection, std::shared_ptr<PayloadListener>>;
 
   struct AdvertisingInfo {
     std::string service_id;
@@ -384,7 +415,7 @@ class ClientProxy final {
 
   struct DiscoveryInfo {
     std::string service_id;
-    DiscoveryListener listener;
+    std::shared_ptr<DiscoveryListener> listener;
     void Clear() { service_id.clear(); }
     bool IsEmpty() const { return service_id.empty(); }
   };
@@ -430,6 +461,18 @@ class ClientProxy final {
   void InitializePreferencesManager();
   void LoadClientInfoFromPreferences();
 
+  // Runs `callback`, which calls a client listener, right away or, if
+  // kEnableAsyncListenerDispatch is enabled, on `listener_dispatcher_`. The
+  // callback must own everything it uses.
+  template <typename Callback>
+  void DispatchToListener(Callback callback) {
+    if (listener_dispatcher_ == nullptr) {
+      callback();
+      return;
+    }
+    listener_dispatcher_->Post(std::move(callback));
+  }
+
   // The device name used for DCT advertising.
   std::string dct_device_name_;
   // The dedup value used for DCT advertising.
@@ -523,6 +566,10 @@ class ClientProxy final {
   bool webrtc_non_cellular_ = false;
   // Whether DCT is enabled.
   bool is_dct_enabled_ = false;
+  // Calls client listeners off-lock; null unless kEnableAsyncListenerDispatch
+  // is enabled. Declared last so that it delivers the callbacks still queued
+  // before anything else is destroyed.
+  std::unique_ptr<ListenerDispatcher> listener_dispatcher_;
 };
 
 }  // namespace nearby::connections
@@ -27,6 +27,7 @@
 #include "gtest/gtest.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/notification.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
@@ -690,6 +691,59 @@ TEST_F(ClientProxyTest, OnPayloadProgressChangesState) {
   OnPayloadProgress(client2(), advertising_endpoint);
 }
 
+TEST_F(ClientProxyTest, AsyncListenerDispatchIsNotBlockedBySlowListener) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableAsyncListenerDispatch,
+      true);
+  client2_ = std::make_unique<ClientProxy>();
+  Endpoint advertising_endpoint =
+      StartAdvertising(client1(), advertising_connection_listener_);
+  StartDiscovery(client2(), GetDiscoveryListener());
+  OnDiscoveryEndpointFound(client2(), advertising_endpoint);
+  OnDiscoveryConnectionInitiated(client2(), advertising_endpoint);
+  absl::Notification release;
+  CountDownLatch finished(1);
+  std::vector<std::int64_t> delivered;
+  client2()->LocalEndpointAcceptedConnection(
+      advertising_endpoint.id,
+      {
+          .payload_progress_cb =
+              [&](absl::string_view, const PayloadProgressInfo& info) {
+                release.WaitForNotification();
+                delivered.push_back(info.bytes_transferred);
+                if (info.status == PayloadProgressInfo::Status::kSuccess) {
+                  finished.CountDown();
+                }
+              },
+      });
+  OnDiscoveryConnectionRemoteAccepted(client2(), advertising_endpoint);
+  OnDiscoveryConnectionAccepted(client2(), advertising_endpoint);
+
+  for (int i = 1; i <= 5; ++i) {
+    client2()->OnPayloadProgress(
+        advertising_endpoint.id,
+        {.payload_id = 1,
+         .status = PayloadProgressInfo::Status::kInProgress,
+         .total_bytes = 5,
+         .bytes_transferred = i});
+  }
+  client2()->OnPayloadProgress(advertising_endpoint.id,
+                               {.payload_id = 1,
+                                .status = PayloadProgressInfo::Status::kSuccess,
+                                .total_bytes = 5,
+                                .bytes_transferred = 5});
+  // Neither the updates above nor this call waited for the blocked listener.
+  EXPECT_TRUE(client2()->IsConnectedToEndpoint(advertising_endpoint.id));
+  release.Notify();
+  finished.Await();
+
+  // At most the update being delivered when the others were posted, the
+  // latest in-progress update and the final one.
+  EXPECT_LE(delivered.size(), 3);
+  EXPECT_EQ(delivered.back(), 5);
+}
+
 TEST_F(ClientProxyTest,
        EndpointIdCacheWhenHighVizAdvertisementAgainImmediately) {
   BooleanMediumSelector booleanMediumSelector;
@@ -1367,6 +1421,56 @@ TEST_F(ClientProxyTest, SetRemoteInfoCorrect) {
       nearby_connections_version);
 }
 
+TEST_F(ClientProxyTest, PayloadCompressionNeedsFlagAndRemoteSupport) {
+  Endpoint advertising_endpoint =
+      StartAdvertising(client1(), advertising_connection_listener_);
+  OnAdvertisingConnectionInitiated(client1(), advertising_endpoint);
+  client1()->SetRemoteSupportsPayloadCompression(advertising_endpoint.id,
+                                                 true);
+
+  EXPECT_FALSE(client1()->IsPayloadCompressionEnabled(advertising_endpoint.id));
+
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnablePayloadCompression,
+      true);
+  EXPECT_TRUE(client1()->IsPayloadCompressionEnabled(advertising_endpoint.id));
+
+  client1()->SetRemoteSupportsPayloadCompression(advertising_endpoint.id,
+                                                 false);
+  EXPECT_FALSE(client1()->IsPayloadCompressionEnabled(advertising_endpoint.id));
+}
+
+TEST_F(ClientProxyTest, MultiChunkBytesNeedsFlagAndRemoteSupport) {
+  Endpoint advertising_endpoint =
+      StartAdvertising(client1(), advertising_connection_listener_);
+  OnAdvertisingConnectionInitiated(client1(), advertising_endpoint);
+  client1()->SetRemoteSupportsMultiChunkBytes(advertising_endpoint.id, true);
+
+  EXPECT_FALSE(client1()->IsMultiChunkBytesEnabled(advertising_endpoint.id));
+
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableChunkedBytesPayloads,
+      true);
+  EXPECT_TRUE(client1()->IsMultiChunkBytesEnabled(advertising_endpoint.id));
+
+  client1()->SetRemoteSupportsMultiChunkBytes(advertising_endpoint.id, false);
+  EXPECT_FALSE(client1()->IsMultiChunkBytesEnabled(advertising_endpoint.id));
+}
+
+TEST_F(ClientProxyTest, KeepsRemoteEndpointInfoOfConnection) {
+  Endpoint advertising_endpoint =
+      StartAdvertising(client1(), advertising_connection_listener_);
+
+  EXPECT_EQ(client1()->GetRemoteEndpointInfo(advertising_endpoint.id), "");
+
+  OnAdvertisingConnectionInitiated(client1(), advertising_endpoint);
+
+  EXPECT_EQ(client1()->GetRemoteEndpointInfo(advertising_endpoint.id),
+            std::string(advertising_endpoint.info));
+}
+
 // Test ClientProxy::AddCancellationFlag, where if a flag is already in the map,
 // uncancel it. This addresses the case when users use NS to share/receive a
 // file, then cancel in the middle because the wrong file was selected, and then
@@ -28,7 +28,9 @@
 #include "internal/platform/byte_array.h"
 #include "internal/platform/cancelable_alarm.h"
 #include "internal/platform/exception.h"
+#include "internal/platform/implementation/system_clock.h"
 #include "internal/platform/logging.h"
+#include "internal/platform/metrics_registry.h"
 #include "internal/platform/scheduled_executor.h"
 
 namespace nearby {
@@ -68,6 +70,44 @@ bool HandleEncryptionSuccess(const std::string& endpoint_id,
   return true;
 }
 
+// Wraps `listener`, so that the outcome and duration of the handshake are
+// recorded in the metrics registry.
+EncryptionRunner::ResultListener MeasureHandshake(
+    EncryptionRunner::ResultListener listener) {
+  static MetricsCounter& succeeded = MetricsRegistry::GetInstance().GetCounter(
+      "encryption.handshakes_succeeded");
+  static MetricsCounter& failed = MetricsRegistry::GetInstance().GetCounter(
+      "encryption.handshakes_failed");
+  static MetricsHistogram& duration_us =
+      MetricsRegistry::GetInstance().GetHistogram(
+          "encryption.handshake_duration_us");
+  absl::Time start_time = SystemClock::ElapsedRealtime();
+  return {
+      .on_success_cb =
+          [start_time, on_success_cb = std::move(listener.on_success_cb)](
+              const std::string& endpoint_id,
+              std::unique_ptr<securegcm::UKey2Handshake> ukey2,
+              const std::string& auth_token,
+              const ByteArray& raw_auth_token) mutable {
+            duration_us.RecordDuration(SystemClock::ElapsedRealtime() -
+                                       start_time);
+            succeeded.Increment();
+            if (on_success_cb) {
+              std::move(on_success_cb)(endpoint_id, std::move(ukey2),
+                                       auth_token, raw_auth_token);
+            }
+          },
+      .on_failure_cb =
+          [start_time, on_failure_cb = std::move(listener.on_failure_cb)](
+              const std::string& endpoint_id) mutable {
+            duration_us.RecordDuration(SystemClock::ElapsedRealtime() -
+                                       start_time);
+            failed.Increment();
+            if (on_failure_cb) on_failure_cb(endpoint_id);
+          },
+  };
+}
+
 void CancelableAlarmRunnable(
     ClientProxy* client, const std::string& endpoint_id,
     std::shared_ptr<EndpointChannel> endpoint_channel) {
@@ -378,7 +418,8 @@ void EncryptionRunner::StartServer(
     std::shared_ptr<EndpointChannel> endpoint_channel,
     EncryptionRunner::ResultListener listener) {
   ServerRunnable runnable(client, &alarm_executor_, endpoint_id,
-                          endpoint_channel, std::move(listener));
+                          endpoint_channel,
+                          MeasureHandshake(std::move(listener)));
   server_executor_.Execute("encryption-server", std::move(runnable));
 }
 
@@ -387,7 +428,8 @@ void EncryptionRunner::StartClient(
     std::shared_ptr<EndpointChannel> endpoint_channel,
     EncryptionRunner::ResultListener listener) {
   ClientRunnable runnable(client, &alarm_executor_, endpoint_id,
-                          endpoint_channel, std::move(listener));
+                          endpoint_channel,
+                          MeasureHandshake(std::move(listener)));
   client_executor_.Execute("encryption-client", std::move(runnable));
 }
 
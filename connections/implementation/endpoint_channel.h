@@ -20,6 +20,7 @@
 #include <string>
 
 #include "securegcm/d2d_connection_context_v1.h"
+#include "absl/functional/any_invocable.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "connections/implementation/analytics/analytics_recorder.h"
@@ -39,6 +40,21 @@ class EndpointChannel {
 
   virtual Exception Write(absl::string_view data) = 0;  // throws Exception::IO
 
+  // Same as Write(), and calls `on_written` once `data` has reached the
+  // medium. Channels that queue writes call it later, on their writer thread.
+  // It is not called if the write fails.
+  virtual Exception WriteAndNotify(absl::string_view data,
+                                   absl::AnyInvocable<void()> on_written) {
+    Exception exception = Write(data);
+    if (exception.Ok() && on_written) on_written();
+    return exception;
+  }
+
+  // Blocks until every frame accepted by Write() has reached the medium.
+  // Channels that write synchronously return success right away; channels
+  // that queue writes return the first write error, if any.
+  virtual Exception WaitForPendingWrites() { return {Exception::kSuccess}; }
+
   // Closes this EndpointChannel, without tracking the closure in analytics.
   virtual void Close() = 0;
 
@@ -86,6 +102,21 @@ class EndpointChannel {
   // transport.
   virtual int GetMaxTransmitPacketSize() const = 0;
 
+  // Returns the payload chunk size currently preferred by this channel. This
+  // may adapt to the measured write throughput and latency; by default it is
+  // the maximum transmit packet size.
+  virtual int GetChunkSize() const { return GetMaxTransmitPacketSize(); }
+
+  // Returns the smoothed write throughput measured on this channel in bytes
+  // per second, or 0 if nothing has been measured.
+  virtual double GetThroughputBytesPerSecond() const { return 0; }
+
+  // Returns the smoothed time a write takes on this channel, or zero if
+  // nothing has been measured.
+  virtual absl::Duration GetWriteLatency() const {
+    return absl::ZeroDuration();
+  }
+
   // Enables encryption on the EndpointChannel.
   virtual void EnableEncryption(std::shared_ptr<EncryptionContext> context) = 0;
 
@@ -14,15 +14,21 @@
 
 #include "connections/implementation/endpoint_channel_manager.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "connections/implementation/client_proxy.h"
 #include "connections/implementation/endpoint_channel.h"
 #include "connections/implementation/offline_frames.h"
 #include "connections/medium_selector.h"
+#include "internal/crypto_cros/hkdf.h"
 #include "internal/platform/condition_variable.h"
 #include "internal/platform/implementation/system_clock.h"
 #include "internal/platform/logging.h"
@@ -32,8 +38,46 @@
 namespace nearby::connections {
 namespace {
 const absl::Duration kDataTransferDelay = absl::Milliseconds(500);
+
+// Layout of D2DConnectionContextV1::SaveSession(): the protocol version (1
+// byte), the encode and decode sequence numbers (4 bytes each), and the encode
+// and decode keys (32 bytes each). ukey2 offers no other way to get at the
+// keys; SavedSessionLayoutIsUnchanged in endpoint_channel_manager_test.cc
+// fails if the layout changes.
+constexpr size_t kSavedSessionSequenceNumbersOffset = 1;
+constexpr size_t kSavedSessionKeysOffset = 9;
+constexpr size_t kSavedSessionKeySize = 32;
+constexpr size_t kSavedSessionSize =
+    kSavedSessionKeysOffset + 2 * kSavedSessionKeySize;
+constexpr absl::string_view kPathKeySalt = "NearbyConnectionsMultipath";
+
+// Returns a context with keys derived from the keys of `context` and both
+// sequence numbers reset. Our encode key is the remote decode key and vice
+// versa, so both devices derive matching contexts for the same `path_id`.
+std::unique_ptr<EndpointChannelManager::EncryptionContext>
+DerivePathEncryptionContext(EndpointChannelManager::EncryptionContext& context,
+                            absl::string_view path_id) {
+  std::unique_ptr<std::string> session = context.SaveSession();
+  if (session == nullptr || session->size() != kSavedSessionSize) {
+    return nullptr;
+  }
+  std::string path_session = session->substr(0, kSavedSessionKeysOffset);
+  std::fill(path_session.begin() + kSavedSessionSequenceNumbersOffset,
+            path_session.end(), '\0');
+  for (size_t offset = kSavedSessionKeysOffset; offset < kSavedSessionSize;
+       offset += kSavedSessionKeySize) {
+    absl::StrAppend(
+        &path_session,
+        nearby::crypto::HkdfSha256(
+            absl::string_view(*session).substr(offset, kSavedSessionKeySize),
+            kPathKeySalt, path_id, kSavedSessionKeySize));
+  }
+  return EndpointChannelManager::EncryptionContext::FromSavedSession(
+      path_session);
 }
 
+}  // namespace
+
 EndpointChannelManager::~EndpointChannelManager() {
   LOG(INFO) << "Initiating shutdown of EndpointChannelManager.";
   MutexLock lock(&mutex_);
@@ -101,6 +145,94 @@ std::shared_ptr<EndpointChannel> EndpointChannelManager::GetChannelForEndpoint(
   return endpoint->channel;
 }
 
+bool EndpointChannelManager::AddPathForEndpoint(
+    ClientProxy* client, const std::string& endpoint_id,
+    std::shared_ptr<EndpointChannel> channel, absl::string_view path_id) {
+  MutexLock lock(&mutex_);
+
+  auto* endpoint = channel_state_.LookupEndpointData(endpoint_id);
+  if (endpoint == nullptr || endpoint->channel == nullptr) {
+    LOG(INFO) << "No channel info for endpoint " << endpoint_id
+              << ", can't add a path.";
+    return false;
+  }
+  if (static_cast<int>(endpoint->paths.size()) + 1 >= kMaxPathsPerEndpoint) {
+    LOG(INFO) << "Endpoint " << endpoint_id << " already has "
+              << kMaxPathsPerEndpoint << " paths.";
+    return false;
+  }
+  if (endpoint->IsEncrypted()) {
+    std::shared_ptr<EncryptionContext> path_context =
+        DerivePathEncryptionContext(*endpoint->context, path_id);
+    if (path_context == nullptr) {
+      LOG(WARNING) << "Failed to derive encryption context for path "
+                   << path_id << " of endpoint " << endpoint_id;
+      return false;
+    }
+    channel->EnableEncryption(std::move(path_context));
+  }
+  channel->SetAnalyticsRecorder(&client->GetAnalyticsRecorder(), endpoint_id);
+  LOG(INFO) << "EndpointChannelManager added path " << path_id << " of type "
+            << channel->GetType() << " to endpoint " << endpoint_id;
+  endpoint->paths.push_back(std::move(channel));
+  return true;
+}
+
+bool EndpointChannelManager::RemovePathForEndpoint(
+    const std::string& endpoint_id, const EndpointChannel* channel,
+    DisconnectionReason reason) {
+  std::shared_ptr<EndpointChannel> path;
+  {
+    MutexLock lock(&mutex_);
+    auto* endpoint = channel_state_.LookupEndpointData(endpoint_id);
+    if (endpoint == nullptr) return false;
+    auto it = std::find_if(
+        endpoint->paths.begin(), endpoint->paths.end(),
+        [channel](const auto& path) { return path.get() == channel; });
+    if (it == endpoint->paths.end()) return false;
+    path = std::move(*it);
+    endpoint->paths.erase(it);
+  }
+  LOG(INFO) << "EndpointChannelManager removed path of type "
+            << path->GetType() << " from endpoint " << endpoint_id;
+  // Closing may block on pending writes, so do it outside of the lock.
+  path->Close(reason);
+  return true;
+}
+
+std::vector<std::shared_ptr<EndpointChannel>>
+EndpointChannelManager::GetPathsForEndpoint(const std::string& endpoint_id) {
+  MutexLock lock(&mutex_);
+
+  auto* endpoint = channel_state_.LookupEndpointData(endpoint_id);
+  if (endpoint == nullptr || endpoint->channel == nullptr) return {};
+
+  std::vector<std::shared_ptr<EndpointChannel>> paths;
+  paths.reserve(endpoint->paths.size() + 1);
+  paths.push_back(endpoint->channel);
+  paths.insert(paths.end(), endpoint->paths.begin(), endpoint->paths.end());
+  return paths;
+}
+
+bool EndpointChannelManager::HasPathsForEndpoint(
+    const std::string& endpoint_id) {
+  MutexLock lock(&mutex_);
+
+  auto* endpoint = channel_state_.LookupEndpointData(endpoint_id);
+  return endpoint != nullptr && !endpoint->paths.empty();
+}
+
+bool EndpointChannelManager::IsPathForEndpoint(const std::string& endpoint_id,
+                                               const EndpointChannel* channel) {
+  MutexLock lock(&mutex_);
+
+  auto* endpoint = channel_state_.LookupEndpointData(endpoint_id);
+  if (endpoint == nullptr) return false;
+  return std::any_of(
+      endpoint->paths.begin(), endpoint->paths.end(),
+      [channel](const auto& path) { return path.get() == channel; });
+}
+
 void EndpointChannelManager::SetActiveEndpointChannel(
     ClientProxy* client, const std::string& endpoint_id,
     std::shared_ptr<EndpointChannel> channel, bool enable_encryption) {
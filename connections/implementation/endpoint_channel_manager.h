@@ -17,9 +17,11 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "connections/implementation/analytics/analytics_recorder.h"
 #include "connections/implementation/client_proxy.h"
@@ -50,6 +52,9 @@ class EndpointChannelManager final {
  public:
   using EncryptionContext = EndpointChannel::EncryptionContext;
 
+  // The active EndpointChannel included.
+  static constexpr int kMaxPathsPerEndpoint = 3;
+
   ~EndpointChannelManager();
 
   // Registers the initial EndpointChannel to be associated with an endpoint;
@@ -93,6 +98,39 @@ class EndpointChannelManager final {
   std::shared_ptr<EndpointChannel> GetChannelForEndpoint(
       const std::string& endpoint_id) ABSL_LOCKS_EXCLUDED(mutex_);
 
+  // Adds `channel` as an additional path to an endpoint that already has a
+  // registered EndpointChannel (see kEnableMultipathTransfer). If the endpoint
+  // is encrypted, the path gets its own encryption context derived from the
+  // endpoint's context and `path_id`, so that frames on different paths don't
+  // share sequence numbers; both devices must use the same `path_id`.
+  // Returns false, leaving `channel` untouched, if the endpoint is unknown or
+  // already has kMaxPathsPerEndpoint channels.
+  bool AddPathForEndpoint(ClientProxy* client, const std::string& endpoint_id,
+                          std::shared_ptr<EndpointChannel> channel,
+                          absl::string_view path_id)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Removes and closes an additional path of the endpoint. Returns false if
+  // `channel` is not (or no longer) an additional path of `endpoint_id`.
+  bool RemovePathForEndpoint(const std::string& endpoint_id,
+                             const EndpointChannel* channel,
+                             DisconnectionReason reason)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns every channel of the endpoint: the active EndpointChannel first,
+  // followed by the additional paths. Empty if the endpoint is unknown.
+  std::vector<std::shared_ptr<EndpointChannel>> GetPathsForEndpoint(
+      const std::string& endpoint_id) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // True if the endpoint has at least one additional path.
+  bool HasPathsForEndpoint(const std::string& endpoint_id)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // True if `channel` is an additional path of `endpoint_id`.
+  bool IsPathForEndpoint(const std::string& endpoint_id,
+                         const EndpointChannel* channel)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
   // Returns true if 'endpoint_id' actually had a registered EndpointChannel.
   // IOW, a return of false signifies a no-op.
   bool UnregisterChannelForEndpoint(const std::string& endpoint_id,
@@ -133,12 +171,17 @@ class EndpointChannelManager final {
         if (channel != nullptr) {
           channel->Close(disconnect_reason);
         }
+        for (auto& path : paths) {
+          path->Close(disconnect_reason);
+        }
       }
 
       // True if we have a 'context' for the endpoint.
       bool IsEncrypted() const { return context != nullptr; }
 
       std::shared_ptr<EndpointChannel> channel;
+      // Additional paths next to `channel`; see AddPathForEndpoint().
+      std::vector<std::shared_ptr<EndpointChannel>> paths;
       std::shared_ptr<EncryptionContext> context;
       DisconnectionReason disconnect_reason =
           DisconnectionReason::UNKNOWN_DISCONNECTION_REASON;
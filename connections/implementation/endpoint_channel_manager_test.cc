@@ -20,10 +20,12 @@
 #include <string>
 #include <utility>
 
+#include "securegcm/d2d_connection_context_v1.h"
 #include "securegcm/ukey2_handshake.h"
 #include "gmock/gmock.h"
 #include "protobuf-matchers/protocol-buffer-matchers.h"
 #include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
@@ -57,6 +59,19 @@ constexpr absl::string_view kMonitorB = "MonitorB";
 constexpr absl::string_view kPumpA = "PumpA";
 constexpr absl::string_view kPumpB = "PumpB";
 
+// The D2DConnectionContextV1::SaveSession() layout that
+// AddPathForEndpoint() derives path keys from: the protocol version (1 byte),
+// the encode and decode sequence numbers (4 bytes each), and the encode and
+// decode keys (32 bytes each).
+constexpr size_t kSavedSessionKeySize = 32;
+constexpr size_t kSavedSessionKeysOffset = 9;
+
+std::string MakeSavedSession(absl::string_view encode_key,
+                             absl::string_view decode_key) {
+  return absl::StrCat(std::string(1, '\x01'), std::string(8, '\0'),
+                      encode_key, decode_key);
+}
+
 class MockEndpointChannel : public BaseEndpointChannel {
  public:
   explicit MockEndpointChannel(InputStream* input, OutputStream* output)
@@ -316,5 +331,93 @@ TEST(BaseEndpointChannelManagerTest, ReplaceChannelNoEncrypted) {
       SafeDisconnectionResult::kSafeDisconnection);
 }
 
+TEST(BaseEndpointChannelManagerTest, SavedSessionLayoutIsUnchanged) {
+  std::string key_a(kSavedSessionKeySize, 'a');
+  std::string key_b(kSavedSessionKeySize, 'b');
+  std::string session_a = MakeSavedSession(key_a, key_b);
+  std::unique_ptr<EncryptionContext> context_a =
+      EncryptionContext::FromSavedSession(session_a);
+  std::unique_ptr<EncryptionContext> context_b =
+      EncryptionContext::FromSavedSession(MakeSavedSession(key_b, key_a));
+  ASSERT_NE(context_a, nullptr);
+  ASSERT_NE(context_b, nullptr);
+
+  // The session round-trips unchanged.
+  EXPECT_EQ(*context_a->SaveSession(), session_a);
+  // The encode key of one context is the decode key of its peer.
+  std::unique_ptr<std::string> encoded =
+      context_a->EncodeMessageToPeer("message");
+  ASSERT_NE(encoded, nullptr);
+  std::unique_ptr<std::string> decoded =
+      context_b->DecodeMessageFromPeer(*encoded);
+  ASSERT_NE(decoded, nullptr);
+  EXPECT_EQ(*decoded, "message");
+  // Encoding only advances the sequence numbers, ahead of the keys.
+  std::unique_ptr<std::string> saved = context_a->SaveSession();
+  ASSERT_EQ(saved->size(), session_a.size());
+  EXPECT_NE(saved->substr(0, kSavedSessionKeysOffset),
+            session_a.substr(0, kSavedSessionKeysOffset));
+  EXPECT_EQ(saved->substr(kSavedSessionKeysOffset),
+            session_a.substr(kSavedSessionKeysOffset));
+}
+
+TEST(BaseEndpointChannelManagerTest, AddPathDerivesMatchingEncryption) {
+  ClientProxy proxy_a;
+  ClientProxy proxy_b;
+  std::string key_a(kSavedSessionKeySize, 'a');
+  std::string key_b(kSavedSessionKeySize, 'b');
+  auto primary_a = CreatePipe();
+  auto primary_b = CreatePipe();
+  auto path_a_to_b = CreatePipe();
+  auto path_b_to_a = CreatePipe();
+  auto channel_a = std::make_shared<MockEndpointChannel>(
+      primary_b.first.get(), primary_a.second.get());
+  auto channel_b = std::make_shared<MockEndpointChannel>(
+      primary_a.first.get(), primary_b.second.get());
+  auto path_a = std::make_shared<MockEndpointChannel>(
+      path_b_to_a.first.get(), path_a_to_b.second.get());
+  auto path_b = std::make_shared<MockEndpointChannel>(
+      path_a_to_b.first.get(), path_b_to_a.second.get());
+  auto path_a_raw = path_a.get();
+  auto path_b_raw = path_b.get();
+  for (auto* channel :
+       {channel_a.get(), channel_b.get(), path_a_raw, path_b_raw}) {
+    ON_CALL(*channel, GetMedium).WillByDefault([]() {
+      return Medium::WIFI_LAN;
+    });
+  }
+
+  EndpointChannelManager ecm_a;
+  ecm_a.EncryptChannelForEndpoint(
+      std::string(kEndpointId),
+      EncryptionContext::FromSavedSession(MakeSavedSession(key_a, key_b)));
+  ecm_a.RegisterChannelForEndpoint(&proxy_a, std::string(kEndpointId),
+                                   channel_a);
+  EndpointChannelManager ecm_b;
+  ecm_b.EncryptChannelForEndpoint(
+      std::string(kEndpointId),
+      EncryptionContext::FromSavedSession(MakeSavedSession(key_b, key_a)));
+  ecm_b.RegisterChannelForEndpoint(&proxy_b, std::string(kEndpointId),
+                                   channel_b);
+
+  ASSERT_TRUE(ecm_a.AddPathForEndpoint(&proxy_a, std::string(kEndpointId),
+                                       std::move(path_a), "path"));
+  ASSERT_TRUE(ecm_b.AddPathForEndpoint(&proxy_b, std::string(kEndpointId),
+                                       std::move(path_b), "path"));
+
+  EXPECT_EQ(path_a_raw->GetType(), "ENCRYPTED_WIFI_LAN");
+  ASSERT_TRUE(path_a_raw->Write("path message").Ok());
+  ExceptionOr<ByteArray> rx_message = path_b_raw->Read();
+  ASSERT_TRUE(rx_message.ok());
+  EXPECT_EQ(rx_message.result().AsStringView(), "path message");
+
+  ecm_a.UnregisterChannelForEndpoint(
+      std::string(kEndpointId), DisconnectionReason::LOCAL_DISCONNECTION,
+      SafeDisconnectionResult::kSafeDisconnection);
+  ecm_b.UnregisterChannelForEndpoint(
+      std::string(kEndpointId), DisconnectionReason::REMOTE_DISCONNECTION,
+      SafeDisconnectionResult::kSafeDisconnection);
+}
+
 }  // namespace
 }  // namespace nearby::connections
@@ -15,30 +15,39 @@
 #include "connections/implementation/endpoint_manager.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/functional/any_invocable.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "connections/connection_options.h"
 #include "connections/implementation/analytics/analytics_recorder.h"
 #include "connections/implementation/client_proxy.h"
 #include "connections/implementation/endpoint_channel.h"
 #include "connections/implementation/endpoint_channel_manager.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "connections/implementation/multipath_scheduler.h"
 #include "connections/implementation/offline_frames.h"
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
 #include "connections/implementation/service_id_constants.h"
 #include "connections/listeners.h"
 #include "connections/medium_selector.h"
+#include "google/protobuf/arena.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/count_down_latch.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/feature_flags.h"
 #include "internal/platform/implementation/system_clock.h"
 #include "internal/platform/logging.h"
+#include "internal/platform/metrics_registry.h"
 #include "internal/platform/mutex.h"
 #include "internal/platform/mutex_lock.h"
 #include "internal/platform/runnable.h"
@@ -64,21 +73,85 @@ constexpr absl::Time kInvalidTimestamp = absl::InfinitePast();
 // The maximum time we will wait for the encryption setup during negotiating a
 // connection.
 constexpr absl::Duration kDecryptRetryTimeout = absl::Seconds(3);
+// Size of the first block of a reader's frame arena. Enough for any frame but
+// those carrying a payload chunk body, which is not parsed onto the arena.
+constexpr size_t kFrameArenaBlockSize = 4 * 1024;
+
+// Adapts `on_written` to EndpointChannel::WriteAndNotify() for one endpoint.
+absl::AnyInvocable<void()> BindChunkWrittenCallback(
+    const EndpointManager::ChunkWrittenCallback& on_written,
+    const std::string& endpoint_id) {
+  if (!on_written) return nullptr;
+  return [on_written, endpoint_id]() { on_written(endpoint_id); };
+}
 }  // namespace
 
 class EndpointManager::LockedFrameProcessor {
  public:
-  explicit LockedFrameProcessor(FrameProcessorWithMutex* fp)
-      : lock_{std::make_unique<MutexLock>(&fp->mutex_)},
-        frame_processor_with_mutex_{fp} {}
+  enum class Mode {
+    // For changing the processor or notifying it of a disconnection.
+    kExclusive,
+    // For dispatching a frame. Processors that allow concurrent dispatch are
+    // shared with other readers; the others are still used one at a time.
+    kDispatch,
+  };
+
+  LockedFrameProcessor(FrameProcessorWithMutex* fp, Mode mode)
+      : frame_processor_with_mutex_{fp} {
+    fp->mutex_.Lock();
+    if (mode == Mode::kExclusive) {
+      ++fp->exclusive_waiters_;
+      while (fp->dispatching_ > 0) fp->mutex_cond_.Wait();
+      --fp->exclusive_waiters_;
+      return;
+    }
+    while (fp->exclusive_waiters_ > 0) fp->mutex_cond_.Wait();
+    ++fp->dispatching_;
+    is_shared_ = true;
+    bool allows_concurrent_dispatch =
+        fp->frame_processor_ == nullptr ||
+        fp->frame_processor_->AllowsConcurrentDispatch();
+    fp->mutex_.Unlock();
+    if (!allows_concurrent_dispatch) {
+      fp->dispatch_mutex_.Lock();
+      holds_dispatch_mutex_ = true;
+    }
+  }
 
   // Constructor of a no-op object.
   LockedFrameProcessor() = default;
 
+  LockedFrameProcessor(LockedFrameProcessor&& other)
+      : frame_processor_with_mutex_{std::exchange(
+            other.frame_processor_with_mutex_, nullptr)},
+        is_shared_{other.is_shared_},
+        holds_dispatch_mutex_{other.holds_dispatch_mutex_} {}
+  LockedFrameProcessor& operator=(LockedFrameProcessor&&) = delete;
+
+  ~LockedFrameProcessor() {
+    if (frame_processor_with_mutex_ == nullptr) return;
+    if (holds_dispatch_mutex_) {
+      frame_processor_with_mutex_->dispatch_mutex_.Unlock();
+    }
+    if (is_shared_) {
+      MutexLock lock(&frame_processor_with_mutex_->mutex_);
+      if (--frame_processor_with_mutex_->dispatching_ == 0) {
+        frame_processor_with_mutex_->mutex_cond_.Notify();
+      }
+    } else {
+      // Readers may be waiting for this thread to be done.
+      frame_processor_with_mutex_->mutex_cond_.Notify();
+      frame_processor_with_mutex_->mutex_.Unlock();
+    }
+  }
+
   explicit operator bool() const { return get() != nullptr; }
 
   FrameProcessor* operator->() const { return get(); }
 
+  // True if other readers may use the processor at the same time.
+  bool IsConcurrent() const { return is_shared_ && !holds_dispatch_mutex_; }
+
   void set(FrameProcessor* frame_processor) {
     if (frame_processor_with_mutex_)
       frame_processor_with_mutex_->frame_processor_ = frame_processor;
@@ -96,8 +169,9 @@ class EndpointManager::LockedFrameProcessor {
   }
 
  private:
-  std::unique_ptr<MutexLock> lock_;
   FrameProcessorWithMutex* frame_processor_with_mutex_ = nullptr;
+  bool is_shared_ = false;
+  bool holds_dispatch_mutex_ = false;
 };
 
 // A Runnable that continuously grabs the most recent EndpointChannel available
@@ -222,14 +296,33 @@ ExceptionOr<OfflineFrame> EndpointManager::TryDecryptFrame(
 
 ExceptionOr<bool> EndpointManager::HandleData(
     const std::string& endpoint_id, ClientProxy* client,
-    EndpointChannel* endpoint_channel) {
+    EndpointChannel* endpoint_channel, Mutex* dispatch_mutex) {
   bool try_decrypting = !endpoint_channel->IsEncrypted();
+  bool is_path = is_multipath_enabled_ && channel_manager_->IsPathForEndpoint(
+                                              endpoint_id, endpoint_channel);
+  // With kEnableLazyFrameParsing, frames are parsed on `arena`, which is reset
+  // before each read; once the first block covers a frame, parsing the next
+  // one does not allocate.
+  std::vector<char> arena_block(
+      is_lazy_frame_parsing_enabled_ ? kFrameArenaBlockSize : 0);
+  google::protobuf::ArenaOptions arena_options;
+  arena_options.initial_block = arena_block.data();
+  arena_options.initial_block_size = arena_block.size();
+  google::protobuf::Arena arena(arena_options);
+  // DATA frames read from an additional path so far, and the frames and bytes
+  // read since the remote device was last sent a PATH_ACK for them.
+  std::int64_t path_data_frames = 0;
+  int unacked_path_frames = 0;
+  size_t unacked_path_bytes = 0;
+  static MetricsHistogram& frame_parse_us =
+      MetricsRegistry::GetInstance().GetHistogram("frame.parse_us");
   // Read as much as we can from the healthy EndpointChannel - when it is no
   // longer in good shape (i.e. our read from it throws an Exception), our
   // super class will loop back around and try our luck in case there's been
   // a replacement for this endpoint since we last checked with the
   // EndpointChannelManager.
   while (true) {
+    arena.Reset();
     ExceptionOr<ByteArray> bytes = endpoint_channel->Read();
     if (!bytes.ok()) {
       LOG(INFO) << "Stop reading on read-time exception: " << bytes.exception();
@@ -239,9 +332,26 @@ ExceptionOr<bool> EndpointManager::HandleData(
       }
       return ExceptionOr<bool>(bytes.exception());
     }
-    ExceptionOr<OfflineFrame> wrapped_frame =
-        parser::FromBytes(bytes.result().AsStringView());
-    if (!wrapped_frame.ok() && try_decrypting) {
+    absl::Time parse_start_time = SystemClock::ElapsedRealtime();
+    ExceptionOr<OfflineFrame> wrapped_frame;
+    OfflineFrame* parsed_frame = nullptr;
+    // Set for DATA frames parsed on the arena; points into `bytes`.
+    std::optional<absl::string_view> data_body;
+    if (is_lazy_frame_parsing_enabled_) {
+      ExceptionOr<parser::ArenaOfflineFrame> arena_frame =
+          parser::FromBytes(bytes.result().AsStringView(), &arena);
+      if (arena_frame.ok()) {
+        parsed_frame = arena_frame.result().frame;
+        data_body = arena_frame.result().data_body;
+      } else {
+        wrapped_frame = ExceptionOr<OfflineFrame>(arena_frame.GetException());
+      }
+    } else {
+      wrapped_frame = parser::FromBytes(bytes.result().AsStringView());
+    }
+    frame_parse_us.RecordDuration(SystemClock::ElapsedRealtime() -
+                                  parse_start_time);
+    if (parsed_frame == nullptr && !wrapped_frame.ok() && try_decrypting) {
       // Workaround for a race condition where the remote party has sent an
       // encrypted message but our end was still configured as unencrypted when
       // the message was received. The workaround is to wait until the
@@ -258,23 +368,27 @@ ExceptionOr<bool> EndpointManager::HandleData(
         wrapped_frame = std::move(decrypted);
       }
     }
-    if (!wrapped_frame.ok()) {
-      if (wrapped_frame.GetException().Raised(
-              Exception::kInvalidProtocolBuffer)) {
-        LOG(INFO) << "Failed to decode; endpoint=" << endpoint_id
-                  << "; channel=" << endpoint_channel->GetType() << "; skip";
-        continue;
-      } else {
-        LOG(INFO) << "Stop reading on parse-time exception: "
-                  << wrapped_frame.exception();
-        return ExceptionOr<bool>(wrapped_frame.exception());
+    if (parsed_frame == nullptr) {
+      if (!wrapped_frame.ok()) {
+        if (wrapped_frame.GetException().Raised(
+                Exception::kInvalidProtocolBuffer)) {
+          LOG(INFO) << "Failed to decode; endpoint=" << endpoint_id
+                    << "; channel=" << endpoint_channel->GetType() << "; skip";
+          continue;
+        } else {
+          LOG(INFO) << "Stop reading on parse-time exception: "
+                    << wrapped_frame.exception();
+          return ExceptionOr<bool>(wrapped_frame.exception());
+        }
       }
+      parsed_frame = &wrapped_frame.result();
     }
-    OfflineFrame& frame = wrapped_frame.result();
+    OfflineFrame& frame = *parsed_frame;
 
     // Route the incoming offlineFrame to its registered processor.
     V1Frame::FrameType frame_type = parser::GetFrameType(frame);
-    LockedFrameProcessor frame_processor = GetFrameProcessor(frame_type);
+    LockedFrameProcessor frame_processor =
+        GetFrameProcessorForDispatch(frame_type);
     if (!frame_processor) {
       // report messages without handlers, except KEEP_ALIVE, which has
       // no explicit handler.
@@ -303,6 +417,10 @@ ExceptionOr<bool> EndpointManager::HandleData(
         LOG(INFO) << "Disconnect message from endpoint " << endpoint_id
                   << " on channel " << endpoint_channel->GetType();
         ProcessDisconnectionFrame(client, endpoint_id, endpoint_channel, frame);
+      } else if (frame_type == V1Frame::PATH_ACK) {
+        multipath_scheduler_.OnPathAck(
+            endpoint_id, endpoint_channel,
+            frame.v1().path_ack().received_data_frames());
       } else {
         LOG(ERROR) << "Unhandled message: endpoint_id=" << endpoint_id
                    << ", frame type=" << V1Frame::FrameType_Name(frame_type);
@@ -310,11 +428,100 @@ ExceptionOr<bool> EndpointManager::HandleData(
       continue;
     }
 
-    frame_processor->OnIncomingFrame(frame, endpoint_id, client,
-                                     endpoint_channel->GetMedium());
+    {
+      // Keeps frames of this endpoint, which may be read from several paths,
+      // from being processed at the same time.
+      std::optional<MutexLock> endpoint_lock;
+      if (frame_processor.IsConcurrent()) endpoint_lock.emplace(dispatch_mutex);
+      if (data_body.has_value()) {
+        frame_processor->OnIncomingDataFrame(frame, *data_body, endpoint_id,
+                                             client,
+                                             endpoint_channel->GetMedium());
+      } else {
+        frame_processor->OnIncomingFrame(frame, endpoint_id, client,
+                                         endpoint_channel->GetMedium());
+      }
+    }
+    if (is_path && frame_type == V1Frame::PAYLOAD_TRANSFER &&
+        frame.v1().payload_transfer().packet_type() ==
+            PayloadTransferFrame::DATA) {
+      // Lets the remote device release the chunks it retained for this path.
+      ++path_data_frames;
+      ++unacked_path_frames;
+      unacked_path_bytes += bytes.result().size();
+      if (unacked_path_frames >= MultipathScheduler::kPathAckIntervalFrames ||
+          unacked_path_bytes >= MultipathScheduler::kPathAckIntervalBytes) {
+        Exception write_exception =
+            endpoint_channel->Write(parser::ForPathAck(path_data_frames));
+        if (!write_exception.Ok()) {
+          LOG(ERROR) << "Failed to send PATH_ACK to endpoint " << endpoint_id
+                     << " on channel " << endpoint_channel->GetType();
+          return ExceptionOr<bool>(write_exception);
+        }
+        unacked_path_frames = 0;
+        unacked_path_bytes = 0;
+      }
+    }
+    if (is_multipath_enabled_ && !is_path &&
+        frame_type == V1Frame::BANDWIDTH_UPGRADE_NEGOTIATION &&
+        channel_manager_->IsPathForEndpoint(endpoint_id, endpoint_channel)) {
+      // The upgrade kept this channel as an additional path, which has a
+      // reader of its own now. Move on to the new primary channel.
+      LOG(INFO) << "Handing channel " << endpoint_channel->GetType()
+                << " of endpoint " << endpoint_id << " over to a path reader.";
+      return ExceptionOr<bool>(true);
+    }
   }
 }
 
+void EndpointManager::PathReaderRunnable(
+    ClientProxy* client, const std::string& endpoint_id,
+    std::shared_ptr<EndpointChannel> path,
+    std::shared_ptr<Mutex> dispatch_mutex) {
+  LOG(INFO) << "Started path reader; endpoint=" << endpoint_id
+            << ", channel=" << path->GetType();
+  ExceptionOr<bool> result =
+      HandleData(endpoint_id, client, path.get(), dispatch_mutex.get());
+  LOG(INFO) << "Path reader going down; endpoint=" << endpoint_id
+            << ", channel=" << path->GetType()
+            << ", exception=" << result.exception();
+  DropPath(endpoint_id, path.get());
+}
+
+bool EndpointManager::DropPath(const std::string& endpoint_id,
+                               EndpointChannel* path) {
+  channel_manager_->RemovePathForEndpoint(endpoint_id, path,
+                                          DisconnectionReason::IO_ERROR);
+  std::vector<std::string> frames =
+      multipath_scheduler_.RemovePath(endpoint_id, path);
+  if (frames.empty()) return true;
+
+  std::shared_ptr<EndpointChannel> channel =
+      channel_manager_->GetChannelForEndpoint(endpoint_id);
+  if (channel == nullptr) return false;
+  LOG(INFO) << "Resending " << frames.size() << " chunks of a dropped path to "
+            << "endpoint " << endpoint_id << " over " << channel->GetType();
+  for (const std::string& frame : frames) {
+    if (!channel->Write(frame).Ok()) return false;
+  }
+  return true;
+}
+
+bool EndpointManager::FlushPendingWrites(const std::string& endpoint_id) {
+  std::vector<std::shared_ptr<EndpointChannel>> paths =
+      channel_manager_->GetPathsForEndpoint(endpoint_id);
+  if (paths.empty()) return false;
+  // Additional paths first: chunks of a failed one are resent over the primary
+  // channel, which is flushed last.
+  for (size_t i = 1; i < paths.size(); ++i) {
+    if (!paths[i]->WaitForPendingWrites().Ok() &&
+        !DropPath(endpoint_id, paths[i].get())) {
+      return false;
+    }
+  }
+  return paths[0]->WaitForPendingWrites().Ok();
+}
+
 void EndpointManager::ProcessDisconnectionFrame(
     ClientProxy* client, const std::string& endpoint_id,
     EndpointChannel* endpoint_channel, OfflineFrame& frame) {
@@ -509,7 +716,19 @@ EndpointManager::LockedFrameProcessor EndpointManager::GetFrameProcessor(
   MutexLock lock(&frame_processors_lock_);
   auto it = frame_processors_.find(frame_type);
   if (it != frame_processors_.end()) {
-    return LockedFrameProcessor(&it->second);
+    return LockedFrameProcessor(&it->second,
+                                LockedFrameProcessor::Mode::kExclusive);
+  }
+  return LockedFrameProcessor();
+}
+
+EndpointManager::LockedFrameProcessor
+EndpointManager::GetFrameProcessorForDispatch(V1Frame::FrameType frame_type) {
+  MutexLock lock(&frame_processors_lock_);
+  auto it = frame_processors_.find(frame_type);
+  if (it != frame_processors_.end()) {
+    return LockedFrameProcessor(&it->second,
+                                LockedFrameProcessor::Mode::kDispatch);
   }
   return LockedFrameProcessor();
 }
@@ -526,6 +745,7 @@ void EndpointManager::RemoveEndpointState(const std::string& endpoint_id) {
   } else {
     LOG(INFO) << "EndpointState not found for endpoint " << endpoint_id;
   }
+  multipath_scheduler_.ForgetEndpoint(endpoint_id);
 }
 
 void EndpointManager::RegisterEndpoint(
@@ -575,13 +795,17 @@ void EndpointManager::RegisterEndpoint(
     // for the next frame. If the handler fails its read and no other
     // EndpointChannels are available for this endpoint, a disconnection
     // will be initiated.
-    endpoint_state.StartEndpointReader([this, client, endpoint_id]() {
-      EndpointChannelLoopRunnable(
-          "Read", client, endpoint_id,
-          [this, client, endpoint_id](EndpointChannel* channel) {
-            return HandleData(endpoint_id, client, channel);
-          });
-    });
+    endpoint_state.StartEndpointReader(
+        [this, client, endpoint_id,
+         dispatch_mutex = endpoint_state.GetDispatchMutex()]() {
+          EndpointChannelLoopRunnable(
+              "Read", client, endpoint_id,
+              [this, client, endpoint_id,
+               dispatch_mutex](EndpointChannel* channel) {
+                return HandleData(endpoint_id, client, channel,
+                                  dispatch_mutex.get());
+              });
+        });
 
     // For every endpoint, there's only one KeepAliveManager instance
     // running on a dedicated thread. This instance will periodically send
@@ -637,6 +861,38 @@ void EndpointManager::UnregisterEndpoint(ClientProxy* client,
   latch.Await();
 }
 
+bool EndpointManager::AddPathForEndpoint(
+    ClientProxy* client, const std::string& endpoint_id,
+    std::shared_ptr<EndpointChannel> channel, absl::string_view path_id) {
+  if (!channel_manager_->AddPathForEndpoint(client, endpoint_id, channel,
+                                            path_id)) {
+    return false;
+  }
+  // Not waited for: the caller may run on a thread the EndpointManager thread
+  // waits for.
+  RunOnEndpointManagerThread(
+      "start-path-reader",
+      [this, client, endpoint_id, channel = std::move(channel)]() mutable {
+        auto item = endpoints_.find(endpoint_id);
+        if (item == endpoints_.end()) {
+          channel_manager_->RemovePathForEndpoint(
+              endpoint_id, channel.get(), DisconnectionReason::SHUTDOWN);
+          return;
+        }
+        item->second.StartPathReader(
+            [this, client, endpoint_id, channel = std::move(channel),
+             dispatch_mutex = item->second.GetDispatchMutex()]() mutable {
+              PathReaderRunnable(client, endpoint_id, std::move(channel),
+                                 std::move(dispatch_mutex));
+            });
+      });
+  return true;
+}
+
+bool EndpointManager::HasPathsForEndpoint(const std::string& endpoint_id) {
+  return channel_manager_->HasPathsForEndpoint(endpoint_id);
+}
+
 int EndpointManager::GetMaxTransmitPacketSize(const std::string& endpoint_id) {
   std::shared_ptr<EndpointChannel> channel =
       channel_manager_->GetChannelForEndpoint(endpoint_id);
@@ -647,18 +903,68 @@ int EndpointManager::GetMaxTransmitPacketSize(const std::string& endpoint_id) {
   return channel->GetMaxTransmitPacketSize();
 }
 
+int EndpointManager::GetChunkSize(const std::string& endpoint_id) {
+  std::shared_ptr<EndpointChannel> channel =
+      channel_manager_->GetChannelForEndpoint(endpoint_id);
+  if (channel == nullptr) {
+    // Callers read chunks of this size; 0 would end the payload early.
+    return NearbyFlags::GetInstance().GetInt64Flag(
+        config_package_nearby::nearby_connections_feature::
+            kMediumDefaultMaxTransmitPacketSize);
+  }
+
+  return channel->GetChunkSize();
+}
+
+double EndpointManager::GetThroughputBytesPerSecond(
+    const std::string& endpoint_id) {
+  std::shared_ptr<EndpointChannel> channel =
+      channel_manager_->GetChannelForEndpoint(endpoint_id);
+  if (channel == nullptr) {
+    return 0;
+  }
+
+  return channel->GetThroughputBytesPerSecond();
+}
+
 std::vector<std::string> EndpointManager::SendPayloadChunk(
     const PayloadTransferFrame::PayloadHeader& payload_header,
     const PayloadTransferFrame::PayloadChunk& payload_chunk,
-    const std::vector<std::string>& endpoint_ids) {
+    const std::vector<std::string>& endpoint_ids,
+    ChunkWrittenCallback on_chunk_written) {
   std::string bytes =
       parser::ForDataPayloadTransfer(payload_header, payload_chunk);
 
-  return SendTransferFrameBytes(
-      endpoint_ids, bytes, payload_header.id(),
-      /*offset=*/payload_chunk.offset(),
-      /*packet_type=*/
-      PayloadTransferFrame::PacketType_Name(PayloadTransferFrame::DATA));
+  std::vector<std::string> failed_endpoint_ids =
+      is_multipath_enabled_
+          ? SendPayloadChunkOverPaths(endpoint_ids, bytes, payload_header.id(),
+                                      /*offset=*/payload_chunk.offset(),
+                                      on_chunk_written)
+          : SendTransferFrameBytes(
+                endpoint_ids, bytes, payload_header.id(),
+                /*offset=*/payload_chunk.offset(),
+                /*packet_type=*/
+                PayloadTransferFrame::PacketType_Name(
+                    PayloadTransferFrame::DATA),
+                on_chunk_written);
+
+  if ((payload_chunk.flags() &
+       PayloadTransferFrame::PayloadChunk::LAST_CHUNK) != 0) {
+    // Channels may queue writes (see kEnablePipelinedPayloadSend). Only report
+    // the payload as sent once its last chunk has reached the medium.
+    for (const std::string& endpoint_id : endpoint_ids) {
+      if (std::find(failed_endpoint_ids.begin(), failed_endpoint_ids.end(),
+                    endpoint_id) != failed_endpoint_ids.end()) {
+        continue;
+      }
+      if (!FlushPendingWrites(endpoint_id)) {
+        LOG(INFO) << "Failed to flush last chunk of Payload "
+                  << payload_header.id() << "; endpoint_id=" << endpoint_id;
+        failed_endpoint_ids.push_back(endpoint_id);
+      }
+    }
+  }
+  return failed_endpoint_ids;
 }
 
 // Designed to run asynchronously. It is called from IO thread pools, and
@@ -880,7 +1186,8 @@ CountDownLatch EndpointManager::NotifyFrameProcessorsOnEndpointDisconnect(
 
   int valid = 0;
   for (auto& item : frame_processors_) {
-    LockedFrameProcessor processor(&item.second);
+    LockedFrameProcessor processor(&item.second,
+                                   LockedFrameProcessor::Mode::kExclusive);
     LOG(INFO) << "processor=" << processor.get()
               << "; frame type=" << V1Frame::FrameType_Name(item.first);
     if (processor) {
@@ -914,7 +1221,7 @@ std::vector<std::string> EndpointManager::SendPayloadAck(
 std::vector<std::string> EndpointManager::SendTransferFrameBytes(
     const std::vector<std::string>& endpoint_ids, const std::string& bytes,
     std::int64_t payload_id, std::int64_t offset,
-    const std::string& packet_type) {
+    const std::string& packet_type, const ChunkWrittenCallback& on_written) {
   std::vector<std::string> failed_endpoint_ids;
   for (const std::string& endpoint_id : endpoint_ids) {
     std::shared_ptr<EndpointChannel> channel =
@@ -933,7 +1240,8 @@ std::vector<std::string> EndpointManager::SendTransferFrameBytes(
       continue;
     }
 
-    Exception write_exception = channel->Write(bytes);
+    Exception write_exception = channel->WriteAndNotify(
+        bytes, BindChunkWrittenCallback(on_written, endpoint_id));
     if (!write_exception.Ok()) {
       failed_endpoint_ids.push_back(endpoint_id);
       LOG(INFO) << "Failed to send packet; endpoint_id=" << endpoint_id;
@@ -944,6 +1252,54 @@ std::vector<std::string> EndpointManager::SendTransferFrameBytes(
   return failed_endpoint_ids;
 }
 
+std::vector<std::string> EndpointManager::SendPayloadChunkOverPaths(
+    const std::vector<std::string>& endpoint_ids, const std::string& bytes,
+    std::int64_t payload_id, std::int64_t offset,
+    const ChunkWrittenCallback& on_written) {
+  std::vector<std::string> failed_endpoint_ids;
+  for (const std::string& endpoint_id : endpoint_ids) {
+    std::vector<std::shared_ptr<EndpointChannel>> paths =
+        channel_manager_->GetPathsForEndpoint(endpoint_id);
+    EndpointChannel* path = multipath_scheduler_.PickPath(endpoint_id, paths);
+    if (path == nullptr) {
+      LOG(ERROR) << "EndpointManager failed to find EndpointChannel over which "
+                    "to write DATA at offset "
+                 << offset << " of Payload " << payload_id << " to endpoint "
+                 << endpoint_id;
+      failed_endpoint_ids.push_back(endpoint_id);
+      continue;
+    }
+
+    if (path == paths[0].get()) {
+      if (path->WriteAndNotify(bytes,
+                               BindChunkWrittenCallback(on_written, endpoint_id))
+              .Ok()) {
+        continue;
+      }
+    } else {
+      if (multipath_scheduler_
+              .WriteToPath(endpoint_id, path, bytes,
+                           BindChunkWrittenCallback(on_written, endpoint_id))
+              .Ok()) {
+        continue;
+      }
+      // The failed chunk was not retained; the ones written before it are
+      // resent by dropping the path.
+      if (DropPath(endpoint_id, path) &&
+          paths[0]
+              ->WriteAndNotify(bytes,
+                               BindChunkWrittenCallback(on_written, endpoint_id))
+              .Ok()) {
+        continue;
+      }
+    }
+    failed_endpoint_ids.push_back(endpoint_id);
+    LOG(INFO) << "Failed to send packet; endpoint_id=" << endpoint_id;
+  }
+
+  return failed_endpoint_ids;
+}
+
 EndpointManager::EndpointState::~EndpointState() {
   // We must unregister the endpoint first to signal the runnables that they
   // should exit their loops. SingleThreadExecutor destructors will wait for
@@ -968,6 +1324,11 @@ void EndpointManager::EndpointState::StartEndpointReader(Runnable&& runnable) {
   reader_thread_.Execute("reader", std::move(runnable));
 }
 
+void EndpointManager::EndpointState::StartPathReader(Runnable&& runnable) {
+  path_reader_threads_.push_back(std::make_unique<SingleThreadExecutor>());
+  path_reader_threads_.back()->Execute("path-reader", std::move(runnable));
+}
+
 void EndpointManager::EndpointState::StartEndpointKeepAliveManager(
     absl::AnyInvocable<void(Mutex*, ConditionVariable*)> runnable) {
   keep_alive_thread_.Execute(
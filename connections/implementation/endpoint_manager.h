@@ -16,6 +16,7 @@
 #define CORE_INTERNAL_ENDPOINT_MANAGER_H_
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
@@ -23,14 +24,19 @@
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/node_hash_map.h"
 #include "absl/functional/any_invocable.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "connections/connection_options.h"
 #include "connections/implementation/client_proxy.h"
 #include "connections/implementation/endpoint_channel.h"
 #include "connections/implementation/endpoint_channel_manager.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "connections/implementation/multipath_scheduler.h"
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
 #include "connections/listeners.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/condition_variable.h"
 #include "internal/platform/count_down_latch.h"
@@ -81,6 +87,32 @@ class EndpointManager {
         const std::string& from_endpoint_id, ClientProxy* to_client,
         location::nearby::proto::connections::Medium current_medium) = 0;
 
+    // @EndpointManagerReaderThread
+    // Called instead of OnIncomingFrame() for PAYLOAD_TRANSFER DATA frames that
+    // were parsed without copying the chunk body (see kEnableLazyFrameParsing).
+    // The chunk body of `offline_frame` is empty; `body` points into the read
+    // buffer and is valid for the duration of the call only.
+    // By default, the body is copied into the frame, which is then passed to
+    // OnIncomingFrame().
+    virtual void OnIncomingDataFrame(
+        location::nearby::connections::OfflineFrame& offline_frame,
+        absl::string_view body, const std::string& from_endpoint_id,
+        ClientProxy* to_client,
+        location::nearby::proto::connections::Medium current_medium) {
+      offline_frame.mutable_v1()
+          ->mutable_payload_transfer()
+          ->mutable_payload_chunk()
+          ->set_body(body);
+      OnIncomingFrame(offline_frame, from_endpoint_id, to_client,
+                      current_medium);
+    }
+
+    // Returns true if frames may be dispatched to this processor from the
+    // readers of several endpoints at the same time. Frames of one endpoint,
+    // even if read from several paths, are still dispatched one at a time.
+    // By default, frames are dispatched one at a time across all endpoints.
+    virtual bool AllowsConcurrentDispatch() const { return false; }
+
     // Implementations must call barrier.CountDown() once
     // they're done. This parallelizes the disconnection event across all frame
     // processors.
@@ -120,11 +152,38 @@ class EndpointManager {
   // this case, we do not notify the client of onDisconnected().
   void UnregisterEndpoint(ClientProxy* client, const std::string& endpoint_id);
 
+  // Adds `channel` as an additional path of a registered endpoint and starts
+  // a reader for it (see kEnableMultipathTransfer). Payload chunks are then
+  // striped across all paths of the endpoint. Both devices must pass the same
+  // `path_id`. Returns false if the path was not added.
+  bool AddPathForEndpoint(ClientProxy* client, const std::string& endpoint_id,
+                          std::shared_ptr<EndpointChannel> channel,
+                          absl::string_view path_id);
+
+  // True if the endpoint has additional paths, i.e. its frames may arrive out
+  // of order.
+  bool HasPathsForEndpoint(const std::string& endpoint_id);
+
   // Returns the maximum supported transmit packet size(MTU) for the underlying
   // transport.
   int GetMaxTransmitPacketSize(const std::string& endpoint_id);
 
-  // Returns the list of endpoints to which sending this chunk failed.
+  // Returns the payload chunk size the endpoint's channel currently prefers,
+  // or the default packet size if the endpoint has no channel.
+  int GetChunkSize(const std::string& endpoint_id);
+
+  // Returns the write throughput measured on the endpoint's channel, or 0 if
+  // the endpoint has no channel or it hasn't been measured.
+  double GetThroughputBytesPerSecond(const std::string& endpoint_id);
+
+  // Called with the endpoint id once a chunk has reached that endpoint's
+  // medium. May run on a channel's writer thread.
+  using ChunkWrittenCallback =
+      std::function<void(const std::string& endpoint_id)>;
+
+  // Returns the list of endpoints to which sending this chunk failed. Channels
+  // may still be writing the chunk when this returns, except for the last
+  // chunk of a payload; `on_chunk_written` tells when it has been written.
   //
   // Invoked from the PayloadManager's sendPayload() method.
   std::vector<std::string> SendPayloadChunk(
@@ -132,7 +191,8 @@ class EndpointManager {
           payload_header,
       const location::nearby::connections::PayloadTransferFrame::PayloadChunk&
           payload_chunk,
-      const std::vector<std::string>& endpoint_ids);
+      const std::vector<std::string>& endpoint_ids,
+      ChunkWrittenCallback on_chunk_written = nullptr);
   std::vector<std::string> SendControlMessage(
       const location::nearby::connections::PayloadTransferFrame::PayloadHeader&
           payload_header,
@@ -173,7 +233,8 @@ class EndpointManager {
           channel_manager_{channel_manager},
           keep_alive_waiter_mutex_{std::make_unique<Mutex>()},
           keep_alive_waiter_{std::make_unique<ConditionVariable>(
-              keep_alive_waiter_mutex_.get())} {}
+              keep_alive_waiter_mutex_.get())},
+          dispatch_mutex_{std::make_shared<Mutex>()} {}
 
     EndpointState(const EndpointState&) = delete;
     // The default move constructor would not reset |channel_manager_|, for
@@ -186,7 +247,9 @@ class EndpointManager {
           keep_alive_waiter_mutex_{
               std::exchange(other.keep_alive_waiter_mutex_, nullptr)},
           keep_alive_waiter_{std::exchange(other.keep_alive_waiter_, nullptr)},
-          keep_alive_thread_{std::move(other.keep_alive_thread_)} {}
+          keep_alive_thread_{std::move(other.keep_alive_thread_)},
+          path_reader_threads_{std::move(other.path_reader_threads_)},
+          dispatch_mutex_{std::move(other.dispatch_mutex_)} {}
     EndpointState& operator=(const EndpointState&) = delete;
     EndpointState&& operator=(EndpointState&&) = delete;
     ~EndpointState();
@@ -194,6 +257,10 @@ class EndpointManager {
     void StartEndpointReader(Runnable&& runnable);
     void StartEndpointKeepAliveManager(
         absl::AnyInvocable<void(Mutex*, ConditionVariable*)> runnable);
+    void StartPathReader(Runnable&& runnable);
+    // Held by the readers of the endpoint while they dispatch a frame to a
+    // processor that allows concurrent dispatch.
+    std::shared_ptr<Mutex> GetDispatchMutex() const { return dispatch_mutex_; }
 
    private:
     const std::string endpoint_id_;
@@ -208,6 +275,9 @@ class EndpointManager {
     mutable std::unique_ptr<Mutex> keep_alive_waiter_mutex_;
     std::unique_ptr<ConditionVariable> keep_alive_waiter_;
     SingleThreadExecutor keep_alive_thread_;
+    // One reader per additional path; see AddPathForEndpoint().
+    std::vector<std::unique_ptr<SingleThreadExecutor>> path_reader_threads_;
+    std::shared_ptr<Mutex> dispatch_mutex_;
   };
 
   // RAII accessor for FrameProcessor
@@ -222,16 +292,33 @@ class EndpointManager {
 
    private:
     FrameProcessor* frame_processor_;
+    // Held to change `frame_processor_` or to notify it of a disconnection.
+    // Dispatching frames only holds it to register in `dispatching_`, so
+    // several readers can dispatch at once.
     Mutex mutex_;
+    ConditionVariable mutex_cond_{&mutex_};
+    // Number of readers dispatching frames to `frame_processor_`, which
+    // holders of `mutex_` wait for before using it.
+    int dispatching_ ABSL_GUARDED_BY(mutex_) = 0;
+    // Number of threads waiting for `dispatching_` to drop to 0. New readers
+    // wait for them, so a busy endpoint doesn't starve them.
+    int exclusive_waiters_ ABSL_GUARDED_BY(mutex_) = 0;
+    // Serializes dispatching to processors that do not allow concurrent
+    // dispatch.
+    Mutex dispatch_mutex_;
     friend class LockedFrameProcessor;
   };
 
   LockedFrameProcessor GetFrameProcessor(
       location::nearby::connections::V1Frame::FrameType frame_type);
+  LockedFrameProcessor GetFrameProcessorForDispatch(
+      location::nearby::connections::V1Frame::FrameType frame_type);
 
+  // `dispatch_mutex` is the endpoint's EndpointState::GetDispatchMutex().
   ExceptionOr<bool> HandleData(const std::string& endpoint_id,
                                ClientProxy* client_proxy,
-                               EndpointChannel* endpoint_channel);
+                               EndpointChannel* endpoint_channel,
+                               Mutex* dispatch_mutex);
 
   ExceptionOr<bool> HandleKeepAlive(EndpointChannel* endpoint_channel,
                                     absl::Duration keep_alive_interval,
@@ -251,6 +338,21 @@ class EndpointManager {
       const std::string& endpoint_id,
       absl::AnyInvocable<ExceptionOr<bool>(EndpointChannel*)> handler);
 
+  // Reads from an additional path of the endpoint until the path fails, and
+  // then drops it. Unlike the primary channel, a failed path does not
+  // disconnect the endpoint.
+  void PathReaderRunnable(ClientProxy* client, const std::string& endpoint_id,
+                          std::shared_ptr<EndpointChannel> path,
+                          std::shared_ptr<Mutex> dispatch_mutex);
+
+  // Removes a failed additional path and resends the chunks it may not have
+  // delivered over the primary channel. Returns false if resending failed.
+  bool DropPath(const std::string& endpoint_id, EndpointChannel* path);
+
+  // Blocks until all paths of the endpoint have written their queued frames.
+  // Returns false if the primary channel failed.
+  bool FlushPendingWrites(const std::string& endpoint_id);
+
   static void WaitForLatch(const std::string& method_name,
                            CountDownLatch* latch);
   static void WaitForLatch(const std::string& method_name,
@@ -282,7 +384,15 @@ class EndpointManager {
   std::vector<std::string> SendTransferFrameBytes(
       const std::vector<std::string>& endpoint_ids,
       const std::string& payload_transfer_frame_bytes, std::int64_t payload_id,
-      std::int64_t offset, const std::string& packet_type);
+      std::int64_t offset, const std::string& packet_type,
+      const ChunkWrittenCallback& on_written = nullptr);
+
+  // Like SendTransferFrameBytes(), but writes the chunk to the path picked by
+  // `multipath_scheduler_` for each endpoint.
+  std::vector<std::string> SendPayloadChunkOverPaths(
+      const std::vector<std::string>& endpoint_ids,
+      const std::string& payload_transfer_frame_bytes, std::int64_t payload_id,
+      std::int64_t offset, const ChunkWrittenCallback& on_written);
 
   // Executes all jobs sequentially, on a serial_executor_.
   void RunOnEndpointManagerThread(const std::string& name, Runnable runnable);
@@ -292,13 +402,23 @@ class EndpointManager {
   EndpointChannelManager* channel_manager_;
 
   RecursiveMutex frame_processors_lock_;
-  absl::flat_hash_map<location::nearby::connections::V1Frame::FrameType,
+  // A node map, since FrameProcessorWithMutex can be neither moved nor copied.
+  absl::node_hash_map<location::nearby::connections::V1Frame::FrameType,
                       FrameProcessorWithMutex>
       frame_processors_ ABSL_GUARDED_BY(frame_processors_lock_);
 
   // We keep track of all registered channel endpoints here.
   absl::flat_hash_map<std::string, EndpointState> endpoints_;
 
+  MultipathScheduler multipath_scheduler_;
+  const bool is_multipath_enabled_ = NearbyFlags::GetInstance().GetBoolFlag(
+      config_package_nearby::nearby_connections_feature::
+          kEnableMultipathTransfer);
+  const bool is_lazy_frame_parsing_enabled_ =
+      NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableLazyFrameParsing);
+
   // Indicates whether the destructor has been called yet. If `is_shutdown_`
   // is true, assume any `ClientProxy` pointers are invalid, and should not
   // be used.
@@ -77,6 +77,11 @@ class MockFrameProcessor : public EndpointManager::FrameProcessor {
               (override));
 };
 
+class ConcurrentFrameProcessor : public MockFrameProcessor {
+ public:
+  bool AllowsConcurrentDispatch() const override { return true; }
+};
+
 class SetSafeToDisconnect {
  public:
   SetSafeToDisconnect(bool safe_to_disconnect,
@@ -171,6 +176,13 @@ class EndpointManagerTest : public ::testing::Test {
 
 TEST_F(EndpointManagerTest, ConstructorDestructorWorks) { SUCCEED(); }
 
+TEST_F(EndpointManagerTest, GetChunkSizeWithoutChannelReturnsDefault) {
+  EXPECT_EQ(em_.GetChunkSize("unknown"),
+            NearbyFlags::GetInstance().GetInt64Flag(
+                config_package_nearby::nearby_connections_feature::
+                    kMediumDefaultMaxTransmitPacketSize));
+}
+
 TEST_F(EndpointManagerTest, RegisterEndpointCallsOnConnectionInitiated) {
   auto endpoint_channel = std::make_unique<MockEndpointChannel>();
   EXPECT_CALL(*endpoint_channel, Read())
@@ -238,6 +250,118 @@ TEST_F(EndpointManagerTest, RegisterFrameProcessorWorks) {
   RegisterEndpoint(std::move(endpoint_channel));
 }
 
+TEST_F(EndpointManagerTest, LazyFrameParsingPassesDataBodyToFrameProcessor) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableLazyFrameParsing,
+      true);
+  auto payload_processor = std::make_unique<MockFrameProcessor>();
+  EndpointChannelManager ecm;
+  // Reads the flag on construction.
+  EndpointManager em(&ecm);
+  auto endpoint_channel = std::make_unique<MockEndpointChannel>();
+  PayloadTransferFrame::PayloadHeader header;
+  PayloadTransferFrame::PayloadChunk chunk;
+  header.set_id(12345);
+  header.set_type(PayloadTransferFrame::PayloadHeader::FILE);
+  header.set_total_size(1024);
+  chunk.set_body("payload data");
+  chunk.set_offset(0);
+  chunk.set_flags(0);
+
+  // The default OnIncomingDataFrame() puts the body back into the frame.
+  EXPECT_CALL(*payload_processor, OnIncomingFrame)
+      .WillOnce([](OfflineFrame& offline_frame, const std::string&,
+                   ClientProxy*, Medium) {
+        EXPECT_EQ(offline_frame.v1().payload_transfer().payload_chunk().body(),
+                  "payload data");
+      });
+  EXPECT_CALL(*payload_processor, OnEndpointDisconnect);
+  CountDownLatch done(1);
+  EXPECT_CALL(*endpoint_channel, Read())
+      .WillOnce(Return(ExceptionOr<ByteArray>(
+          ByteArray(parser::ForDataPayloadTransfer(header, chunk)))))
+      .WillRepeatedly(Return(ExceptionOr<ByteArray>(Exception::kIo)));
+  EXPECT_CALL(*endpoint_channel, Write(_))
+      .WillRepeatedly(Return(Exception{Exception::kSuccess}));
+  ON_CALL(*endpoint_channel, Close(_))
+      .WillByDefault([&done](DisconnectionReason reason) { done.CountDown(); });
+  EXPECT_CALL(*endpoint_channel, GetMedium())
+      .WillRepeatedly(Return(Medium::BLE));
+  EXPECT_CALL(*endpoint_channel, GetLastReadTimestamp())
+      .WillRepeatedly(Return(start_time_));
+  EXPECT_CALL(*endpoint_channel, GetLastWriteTimestamp())
+      .WillRepeatedly(Return(start_time_));
+  EXPECT_CALL(mock_listener_.initiated_cb, Call).Times(1);
+
+  em.RegisterFrameProcessor(V1Frame::PAYLOAD_TRANSFER,
+                            payload_processor.get());
+  em.RegisterEndpoint(client_.get(), endpoint_id_, info_, connection_options_,
+                      std::move(endpoint_channel), listener_,
+                      connection_token_);
+  EXPECT_TRUE(done.Await(absl::Milliseconds(1000)).result());
+
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableLazyFrameParsing,
+      false);
+}
+
+TEST_F(EndpointManagerTest, ConcurrentFrameProcessorGetsFramesInParallel) {
+  auto processor = std::make_unique<ConcurrentFrameProcessor>();
+  PayloadTransferFrame::PayloadHeader header;
+  PayloadTransferFrame::ControlMessage control;
+  header.set_id(12345);
+  header.set_type(PayloadTransferFrame::PayloadHeader::FILE);
+  header.set_total_size(1024);
+  control.set_event(PayloadTransferFrame::ControlMessage::PAYLOAD_CANCELED);
+  control.set_offset(150);
+  std::string read_data = parser::ForControlPayloadTransfer(header, control);
+
+  CountDownLatch both_dispatched(2);
+  EXPECT_CALL(*processor, OnIncomingFrame)
+      .Times(2)
+      .WillRepeatedly([&both_dispatched](OfflineFrame&, const std::string&,
+                                         ClientProxy*, Medium) {
+        both_dispatched.CountDown();
+        // Only returns once the other endpoint's frame is being processed as
+        // well.
+        EXPECT_TRUE(both_dispatched.Await(absl::Seconds(5)).result());
+      });
+  EXPECT_CALL(*processor, OnEndpointDisconnect)
+      .Times(2)
+      .WillRepeatedly([](ClientProxy*, const std::string&, const std::string&,
+                         CountDownLatch barrier,
+                         DisconnectionReason) { barrier.CountDown(); });
+  em_.RegisterFrameProcessor(V1Frame::PAYLOAD_TRANSFER, processor.get());
+  processors_.emplace_back(std::move(processor));
+  EXPECT_CALL(mock_listener_.initiated_cb, Call).Times(2);
+
+  CountDownLatch closed(2);
+  for (const std::string endpoint_id : {"endpoint_a", "endpoint_b"}) {
+    auto endpoint_channel = std::make_unique<MockEndpointChannel>();
+    EXPECT_CALL(*endpoint_channel, Read())
+        .WillOnce(Return(ExceptionOr<ByteArray>(ByteArray(read_data))))
+        .WillRepeatedly(Return(ExceptionOr<ByteArray>(Exception::kIo)));
+    EXPECT_CALL(*endpoint_channel, Write(_))
+        .WillRepeatedly(Return(Exception{Exception::kSuccess}));
+    ON_CALL(*endpoint_channel, Close(_))
+        .WillByDefault(
+            [&closed](DisconnectionReason reason) { closed.CountDown(); });
+    EXPECT_CALL(*endpoint_channel, GetMedium())
+        .WillRepeatedly(Return(Medium::BLE));
+    EXPECT_CALL(*endpoint_channel, GetLastReadTimestamp())
+        .WillRepeatedly(Return(start_time_));
+    EXPECT_CALL(*endpoint_channel, GetLastWriteTimestamp())
+        .WillRepeatedly(Return(start_time_));
+    em_.RegisterEndpoint(client_.get(), endpoint_id, info_,
+                         connection_options_, std::move(endpoint_channel),
+                         listener_, connection_token_);
+  }
+
+  EXPECT_TRUE(closed.Await(absl::Seconds(10)).result());
+}
+
 TEST_F(EndpointManagerTest, UnregisterFrameProcessorWorks) {
   auto endpoint_channel = std::make_unique<MockEndpointChannel>();
   EXPECT_CALL(*endpoint_channel, Read())
@@ -31,18 +31,39 @@ namespace nearby_connections_feature {
 // The timeout in millis to report peripheral device lost.
 constexpr auto kBlePeripheralLostTimeoutMillis =
     flags::Flag<int64_t>(kConfigPackage, "45411439", 12000);
+// When true, payload chunk size adapts to the measured channel throughput.
+constexpr auto kEnableAdaptiveChunkSize =
+    flags::Flag<bool>(kConfigPackage, "45790001", false);
 // When true, enable advertising for instant on lost feature.
 constexpr auto kEnableAdvertisingForInstantOnLost =
     flags::Flag<bool>(kConfigPackage, "45708614", true);
+// When true, client listeners are called on a dedicated thread per client,
+// without holding ClientProxy's lock.
+constexpr auto kEnableAsyncListenerDispatch =
+    flags::Flag<bool>(kConfigPackage, "45790006", false);
 // Enable/Disable AWDL in Nearby connections SDK.
 constexpr auto kEnableAwdl =
     flags::Flag<bool>(kConfigPackage, "45690762", false);
+// When true, bandwidth upgrades prefer the mediums measured to be fastest.
+// This only affects the choice of a new upgrade medium; a slow medium that is
+// in use is not replaced until all endpoints disconnect.
+constexpr auto kEnableBandwidthAwareBwu =
+    flags::Flag<bool>(kConfigPackage, "45790004", false);
 // Disable/Enable BLE L2CAP in Nearby Connections SDK.
 constexpr auto kEnableBleL2cap =
     flags::Flag<bool>(kConfigPackage, "45685706", false);
 // Enable/Disable BLE medium injection.
 constexpr auto kEnableBleMediumInjection =
     flags::Flag<bool>(kConfigPackage, "45743128", false);
+// When true, BYTES payloads larger than a chunk are sent in several chunks to
+// endpoints that said in their ConnectionResponse that they can reassemble
+// them.
+constexpr auto kEnableChunkedBytesPayloads =
+    flags::Flag<bool>(kConfigPackage, "45790009", false);
+// When true, PayloadManager processes frames of different endpoints at the
+// same time instead of one frame at a time.
+constexpr auto kEnableConcurrentFrameProcessing =
+    flags::Flag<bool>(kConfigPackage, "45790008", false);
 // Enable/Disable DCT advertising/scanning specification.
 constexpr auto kEnableDct =
     flags::Flag<bool>(kConfigPackage, "45697202", false);
@@ -52,15 +73,38 @@ constexpr auto kEnableDynamicRoleSwitch =
 // Enable/Disable GATT client disconnection.
 constexpr auto kEnableGattClientDisconnection =
     flags::Flag<bool>(kConfigPackage, "45698964", false);
+// When true, incoming frames are parsed on a per-channel arena, and the
+// bodies of DATA frames are passed on without being copied out of the read
+// buffer.
+constexpr auto kEnableLazyFrameParsing =
+    flags::Flag<bool>(kConfigPackage, "45790007", false);
+// When true, the prior channel is kept as an additional path after a
+// bandwidth upgrade, if the remote device agrees, and payload chunks are
+// striped across all paths of an endpoint.
+constexpr auto kEnableMultipathTransfer =
+    flags::Flag<bool>(kConfigPackage, "45790005", false);
 // When true, enable multiplexing in NC for Bluetooth.
 constexpr auto kEnableMultiplexBluetooth =
     flags::Flag<bool>(kConfigPackage, "45676646", false);
+// When true, connections to a WifiLan device that is already connected are
+// opened as virtual sockets on the existing physical connection.
+constexpr auto kEnableMultiplexWifiLan =
+    flags::Flag<bool>(kConfigPackage, "45790011", false);
 // Enable/Disable preferences for Nearby Connections.
 constexpr auto kEnableNearbyConnectionsPreferences =
     flags::Flag<bool>(kConfigPackage, "45732423", false);
+// When true, this device offers DEFLATE payload compression in its connection
+// response, and compresses outgoing payloads that look compressible on low
+// bandwidth connections to devices that offered it too.
+constexpr auto kEnablePayloadCompression =
+    flags::Flag<bool>(kConfigPackage, "45790013", false);
 // Enable/Disable payload-received-ack feature.
 constexpr auto kEnablePayloadReceivedAck =
     flags::Flag<bool>(kConfigPackage, "45425840", false);
+// When true, outgoing payload chunks are read ahead and written to the medium
+// by a per-channel writer thread.
+constexpr auto kEnablePipelinedPayloadSend =
+    flags::Flag<bool>(kConfigPackage, "45790002", false);
 // Enable/Disable safe-to-disconnect feature.
 constexpr auto kEnableSafeToDisconnect =
     flags::Flag<bool>(kConfigPackage, "45425789", false);
@@ -83,12 +127,34 @@ constexpr auto kEnableWifiHotspotClient =
 // When true, fix the BleServerSocket deadlock/use-after-free (b/494335036).
 constexpr auto kFixBleServerSocketDeadlock =
     flags::Flag<bool>(kConfigPackage, "45782647", true);
+// How long GATT advertisements read from a peripheral are kept, by
+// advertisement header hash, across discovery sessions. 0 disables the cache.
+constexpr auto kGattAdvertisementCacheTtlMillis =
+    flags::Flag<int64_t>(kConfigPackage, "45790010", 600000);
+// Incoming files are synced and their progress journaled every this many
+// bytes, so that an interrupted transfer can resume from the journaled offset.
+// 0 disables the journal.
+constexpr auto kIncomingFileJournalIntervalBytes =
+    flags::Flag<int64_t>(kConfigPackage, "45790012", 0);
+// Incoming file chunks are written to disk on a worker thread, and the
+// endpoint reader only waits for the disk once this many bytes are queued. 0
+// writes them on the reader thread.
+constexpr auto kIncomingFileWriteBehindBytes =
+    flags::Flag<int64_t>(kConfigPackage, "45790015", 4 * 1024 * 1024);
 // Default max transmit packet size for medium.
 constexpr auto kMediumDefaultMaxTransmitPacketSize =
     flags::Flag<int64_t>(kConfigPackage, "45669529", 65536);
 // Default max allowed read bytes for medium.
 constexpr auto kMediumMaxAllowedReadBytes =
     flags::Flag<int64_t>(kConfigPackage, "45669530", 1048576);
+// Payloads are only compressed on connections whose measured write throughput
+// is below this many bytes per second. Connections that haven't been measured
+// yet count as low bandwidth if they are over BLE or Bluetooth.
+constexpr auto kPayloadCompressionMaxThroughputBytesPerSecond =
+    flags::Flag<int64_t>(kConfigPackage, "45790014", 262144);
+// Max number of chunks buffered between stages of the pipelined payload send.
+constexpr auto kPayloadSendPipelineDepth =
+    flags::Flag<int64_t>(kConfigPackage, "45790003", 4);
 // Disable/Enable refactor of BLE/L2CAP in Nearby Connections SDK.
 constexpr auto kRefactorBleL2cap =
     flags::Flag<bool>(kConfigPackage, "45737079", false);
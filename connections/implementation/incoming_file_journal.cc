@@ -0,0 +1,154 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/incoming_file_journal.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/strings/escaping.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "internal/base/file_path.h"
+#include "internal/base/files.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/crypto.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/file.h"
+#include "internal/platform/logging.h"
+
+namespace nearby::connections {
+namespace {
+
+constexpr absl::string_view kJournalDirectory = "nearby_connections_journals";
+constexpr std::int64_t kCopyChunkSize = 64 * 1024;
+
+}  // namespace
+
+IncomingFileJournal::IncomingFileJournal(const FileId& file_id,
+                                         std::string file_path)
+    : journal_path_(GetJournalPath(file_id)),
+      file_path_(std::move(file_path)) {}
+
+bool IncomingFileJournal::Record(std::int64_t offset) {
+  // The new entry is synced before it replaces the previous one, so that the
+  // rename can't be on disk before the entry is.
+  FilePath temp_path(absl::StrCat(journal_path_.ToString(), ".tmp"));
+  OutputFile journal(temp_path.ToString());
+  bool written = journal.IsValid() &&
+                 journal.Write(absl::StrCat(offset, "\n", file_path_)).Ok() &&
+                 journal.Sync().Ok();
+  journal.Close();
+  if (!written) {
+    LOG(WARNING) << "Failed to write the journal of " << file_path_;
+    Files::RemoveFile(temp_path);
+    return false;
+  }
+  return Files::Rename(temp_path, journal_path_);
+}
+
+void IncomingFileJournal::Remove() { Files::RemoveFile(journal_path_); }
+
+std::optional<IncomingFileJournal::Entry> IncomingFileJournal::Read(
+    const FileId& file_id) {
+  FilePath journal_path = GetJournalPath(file_id);
+  std::ifstream journal(journal_path.GetPath(), std::ios::binary);
+  if (!journal.is_open()) {
+    return std::nullopt;
+  }
+  std::string offset;
+  Entry entry;
+  if (!std::getline(journal, offset) ||
+      !std::getline(journal, entry.file_path) ||
+      !absl::SimpleAtoi(offset, &entry.durable_offset) ||
+      entry.durable_offset <= 0 || entry.durable_offset > file_id.file_size) {
+    return std::nullopt;
+  }
+  std::optional<std::uintmax_t> partial_size =
+      Files::GetFileSize(FilePath(entry.file_path));
+  if (!partial_size.has_value() ||
+      static_cast<std::int64_t>(*partial_size) < entry.durable_offset) {
+    return std::nullopt;
+  }
+  return entry;
+}
+
+std::int64_t IncomingFileJournal::GetDurableOffset(const FileId& file_id) {
+  std::optional<Entry> entry = Read(file_id);
+  return entry.has_value() ? entry->durable_offset : 0;
+}
+
+std::optional<IncomingFileJournal::Entry> IncomingFileJournal::TakePartialFile(
+    const FileId& file_id, std::int64_t offset) {
+  std::optional<Entry> entry = Read(file_id);
+  if (!entry.has_value() || entry->durable_offset < offset) {
+    return std::nullopt;
+  }
+  FilePath journal_path = GetJournalPath(file_id);
+  FilePath partial_path(absl::StrCat(journal_path.ToString(), ".partial"));
+  if (!Files::Rename(FilePath(entry->file_path), partial_path)) {
+    return std::nullopt;
+  }
+  Files::RemoveFile(journal_path);
+  entry->file_path = partial_path.ToString();
+  return entry;
+}
+
+bool IncomingFileJournal::ResumeFrom(const Entry& entry, std::int64_t offset,
+                                     OutputFile& output_file) {
+  InputFile partial_file(entry.file_path);
+  std::int64_t copied = 0;
+  while (copied < std::min(offset, entry.durable_offset)) {
+    ExceptionOr<ByteArray> chunk =
+        partial_file.Read(std::min(kCopyChunkSize, offset - copied));
+    if (!chunk.ok() || chunk.result().Empty()) {
+      break;
+    }
+    if (!output_file.Write(absl::string_view(chunk.result().data(),
+                                             chunk.result().size()))
+             .Ok()) {
+      break;
+    }
+    copied += chunk.result().size();
+  }
+  partial_file.Close();
+  Files::RemoveFile(FilePath(entry.file_path));
+  if (copied != offset) {
+    LOG(WARNING) << "Failed to resume from " << entry.file_path << ", copied "
+                 << copied << " of " << offset << " bytes.";
+    return false;
+  }
+  return true;
+}
+
+FilePath IncomingFileJournal::GetJournalPath(const FileId& file_id) {
+  FilePath directory = Files::GetTemporaryDirectory();
+  directory.append(FilePath(kJournalDirectory));
+  Files::CreateDirectories(directory);
+  // Each part is length-prefixed, so that no two ids share a key.
+  std::string key = std::string(Crypto::Sha256(absl::StrCat(
+      file_id.endpoint_id.size(), ":", file_id.endpoint_id, "/",
+      file_id.payload_id, "/", file_id.parent_folder.size(), ":",
+      file_id.parent_folder, "/", file_id.file_name.size(), ":",
+      file_id.file_name, "/", file_id.file_size)));
+  return directory.append(
+      FilePath(absl::StrCat(absl::BytesToHexString(key), ".journal")));
+}
+
+}  // namespace nearby::connections
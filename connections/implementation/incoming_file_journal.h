@@ -0,0 +1,91 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_INCOMING_FILE_JOURNAL_H_
+#define CORE_INTERNAL_INCOMING_FILE_JOURNAL_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "internal/base/file_path.h"
+#include "internal/platform/file.h"
+
+namespace nearby::connections {
+
+// Records how much of an incoming file has been written to disk, so that an
+// interrupted transfer of the same file can resume from there.
+//
+// A file is identified by the endpoint sending it, its payload id, its parent
+// folder, its name and its full size. Everything but the endpoint id is up to
+// the sender, so a partial file is only ever resumed by the endpoint that sent
+// it, never spliced into a file from another one. Its journal holds the durable
+// offset and the path of the partially received file, and is replaced
+// atomically on every update, so that a crash leaves either the previous or the
+// new entry.
+class IncomingFileJournal {
+ public:
+  struct FileId {
+    std::string endpoint_id;
+    std::int64_t payload_id = 0;
+    std::string parent_folder;
+    std::string file_name;
+    std::int64_t file_size = 0;
+  };
+
+  struct Entry {
+    std::int64_t durable_offset = 0;
+    std::string file_path;
+  };
+
+  IncomingFileJournal(const FileId& file_id, std::string file_path);
+
+  // Records that the first `offset` bytes of the file are on disk. The caller
+  // syncs them first. Returns false if the journal can't be written.
+  bool Record(std::int64_t offset);
+
+  // Removes the journal, once the file is complete.
+  void Remove();
+
+  // Returns the offset an interrupted transfer of the file can resume from,
+  // or 0. No frame carries it to the sender yet: a transfer resumes only if
+  // the sending client passes this offset to Payload::SetOffset() and sends
+  // the payload again under the same id.
+  static std::int64_t GetDurableOffset(const FileId& file_id);
+
+  // Moves the partial file of an interrupted transfer aside, so that the
+  // file can be created again, if it holds at least `offset` journaled bytes.
+  // Returns its entry, with the new path of the partial file.
+  static std::optional<Entry> TakePartialFile(const FileId& file_id,
+                                              std::int64_t offset);
+
+  // Copies the first `offset` bytes of the partial file of `entry` to
+  // `output_file`, and removes the partial file. Returns false if they can't
+  // be copied.
+  static bool ResumeFrom(const Entry& entry, std::int64_t offset,
+                         OutputFile& output_file);
+
+ private:
+  // Returns the journal entry of the file, if an interrupted transfer left
+  // one and its partial file still holds the journaled bytes.
+  static std::optional<Entry> Read(const FileId& file_id);
+  static FilePath GetJournalPath(const FileId& file_id);
+
+  const FilePath journal_path_;
+  const std::string file_path_;
+};
+
+}  // namespace nearby::connections
+
+#endif  // CORE_INTERNAL_INCOMING_FILE_JOURNAL_H_
@@ -90,6 +90,11 @@ class InternalPayload {
   // `chunk` is the next chunk.
   virtual Exception AttachNextChunk(absl::string_view chunk) = 0;
 
+  // Whether this is a BYTES payload sent in several chunks (see
+  // kEnableChunkedBytesPayloads). Incoming ones are handed to the client once
+  // complete rather than when the first chunk arrives.
+  virtual bool IsMultiChunkBytes() const { return false; }
+
   // Skips current stream pointer to the offset.
   //
   // Used when this is a resume outgoing transfer, so we want to skip
@@ -14,9 +14,12 @@
 
 #include "connections/implementation/internal_payload_factory.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 
@@ -24,10 +27,14 @@
 #include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "connections/implementation/incoming_file_journal.h"
 #include "connections/implementation/internal_payload.h"
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
+#include "connections/implementation/write_behind_queue.h"
 #include "connections/payload.h"
 #include "connections/payload_type.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/expected.h"
@@ -46,6 +53,10 @@ namespace {
 using ::location::nearby::connections::PayloadTransferFrame;
 using ::location::nearby::proto::connections::OperationResultCode;
 
+// Chunks queued for an incoming file are joined into writes of up to this
+// size.
+constexpr std::size_t kWriteBehindMaxBatchBytes = 1024 * 1024;
+
 // if custom_save_path is empty, default download path is used
 std::string make_path(const std::string& custom_save_path,
                       const std::string& parent_folder,
@@ -59,10 +70,13 @@ std::string make_path(const std::string& custom_save_path,
 
 class BytesInternalPayload : public InternalPayload {
  public:
-  explicit BytesInternalPayload(Payload payload)
+  // With `is_chunked`, payloads larger than a chunk are sent in several
+  // chunks.
+  explicit BytesInternalPayload(Payload payload, bool is_chunked = false)
       : InternalPayload(std::move(payload)),
         total_size_(payload_.AsBytes().size()),
-        detached_only_chunk_(false) {}
+        detached_only_chunk_(false),
+        is_chunked_(is_chunked) {}
 
   location::nearby::connections::PayloadTransferFrame::PayloadHeader::
       PayloadType
@@ -73,15 +87,29 @@ class BytesInternalPayload : public InternalPayload {
 
   std::int64_t GetTotalSize() const override { return total_size_; }
 
+  bool IsMultiChunkBytes() const override { return is_chunked_; }
+
   // Relinquishes ownership of the payload_; retrieves and returns the stored
-  // ByteArray.
+  // ByteArray. When chunked, payloads larger than `chunk_size` are instead
+  // returned one chunk at a time; the stored ByteArray stays in place and each
+  // chunk is copied out of it once.
   ByteArray DetachNextChunk(int chunk_size) override {
     if (detached_only_chunk_) {
       return {};
     }
 
-    detached_only_chunk_ = true;
-    return std::move(payload_).AsBytes();
+    if (!is_chunked_ || chunk_size <= 0 || total_size_ <= chunk_size) {
+      detached_only_chunk_ = true;
+      return std::move(payload_).AsBytes();
+    }
+
+    const ByteArray& bytes = payload_.AsBytes();
+    std::int64_t size = std::min<std::int64_t>(chunk_size,
+                                               total_size_ - next_offset_);
+    ByteArray chunk(bytes.data() + next_offset_, size);
+    next_offset_ += size;
+    if (next_offset_ == total_size_) detached_only_chunk_ = true;
+    return chunk;
   }
 
   // Does nothing.
@@ -100,6 +128,70 @@ class BytesInternalPayload : public InternalPayload {
   // InternalPayload.
   const std::int64_t total_size_;
   bool detached_only_chunk_;
+  const bool is_chunked_;
+  // Offset of the next chunk, when sending in several chunks.
+  std::int64_t next_offset_ = 0;
+};
+
+// An incoming BYTES payload that arrives in several chunks (see
+// kEnableChunkedBytesPayloads). The buffer is allocated once from the size in
+// the payload header, and chunks are copied into place as they arrive. The
+// Payload is only handed out once the last chunk is in.
+class IncomingChunkedBytesInternalPayload : public InternalPayload {
+ public:
+  IncomingChunkedBytesInternalPayload(Payload::Id payload_id,
+                                      std::int64_t total_size)
+      : InternalPayload(Payload(payload_id, ByteArray())),
+        total_size_(total_size),
+        buffer_(total_size, '\0') {}
+
+  location::nearby::connections::PayloadTransferFrame::PayloadHeader::
+      PayloadType
+      GetType() const override {
+    return location::nearby::connections::PayloadTransferFrame::PayloadHeader::
+        BYTES;
+  }
+
+  std::int64_t GetTotalSize() const override { return total_size_; }
+
+  bool IsMultiChunkBytes() const override { return true; }
+
+  ByteArray DetachNextChunk(int chunk_size) override { return {}; }
+
+  Exception AttachNextChunk(absl::string_view chunk) override {
+    if (is_complete_) return {Exception::kIo};
+    if (chunk.empty()) {
+      // The last chunk; the payload must be complete by now.
+      if (received_ != buffer_.size()) {
+        LOG(WARNING) << "Bytes payload " << payload_id_ << " ended after "
+                     << received_ << " of " << buffer_.size() << " bytes";
+        return {Exception::kIo};
+      }
+      is_complete_ = true;
+      payload_ = Payload(payload_id_, ByteArray(std::move(buffer_)));
+      return {Exception::kSuccess};
+    }
+    if (chunk.size() > buffer_.size() - received_) {
+      LOG(WARNING) << "Bytes payload " << payload_id_
+                   << " is larger than announced: " << buffer_.size();
+      return {Exception::kIo};
+    }
+    std::memcpy(buffer_.data() + received_, chunk.data(), chunk.size());
+    received_ += chunk.size();
+    return {Exception::kSuccess};
+  }
+
+  ExceptionOr<size_t> SkipToOffset(size_t offset) override {
+    LOG(WARNING) << "Bytes payload does not support offsets";
+    return {Exception::kIo};
+  }
+
+ private:
+  const std::int64_t total_size_;
+  // Moved into the Payload once complete.
+  std::string buffer_;
+  size_t received_ = 0;
+  bool is_complete_ = false;
 };
 
 class OutgoingStreamInternalPayload : public InternalPayload {
@@ -278,13 +370,33 @@ class OutgoingFileInternalPayload : public InternalPayload {
 
 class IncomingFileInternalPayload : public InternalPayload {
  public:
-  IncomingFileInternalPayload(Payload payload, OutputFile output_file,
-                              absl::Time last_modified_time,
-                              std::int64_t total_size)
+  // `total_size` is the size of the chunks to receive. With a `journal`, the
+  // progress of the file is recorded every `journal_interval_bytes`, after the
+  // `offset` bytes of an earlier transfer that are already in the file.
+  IncomingFileInternalPayload(
+      Payload payload, OutputFile output_file, absl::Time last_modified_time,
+      std::int64_t total_size,
+      std::unique_ptr<IncomingFileJournal> journal = nullptr,
+      std::int64_t offset = 0, std::int64_t journal_interval_bytes = 0)
       : InternalPayload(std::move(payload)),
         output_file_(std::move(output_file)),
         last_modified_time_(last_modified_time),
-        total_size_(total_size) {}
+        total_size_(total_size),
+        journal_(std::move(journal)),
+        journal_interval_bytes_(journal_interval_bytes),
+        file_size_(offset + total_size),
+        written_offset_(offset),
+        journaled_offset_(offset) {
+    std::int64_t write_behind_bytes = NearbyFlags::GetInstance().GetInt64Flag(
+        config_package_nearby::nearby_connections_feature::
+            kIncomingFileWriteBehindBytes);
+    // A file of one chunk gains nothing from a worker thread.
+    if (write_behind_bytes > 0 && total_size > kWriteBehindMaxBatchBytes) {
+      write_behind_queue_ = std::make_unique<WriteBehindQueue>(
+          write_behind_bytes, kWriteBehindMaxBatchBytes,
+          [this](absl::string_view data) { return WriteChunk(data); });
+    }
+  }
 
   location::nearby::connections::PayloadTransferFrame::PayloadHeader::
       PayloadType
@@ -299,12 +411,19 @@ class IncomingFileInternalPayload : public InternalPayload {
 
   Exception AttachNextChunk(absl::string_view chunk) override {
     if (chunk.empty()) {
-      // Received null last chunk for incoming payload.
+      // Received null last chunk for incoming payload. The file must be
+      // complete before the payload is reported as received.
+      Exception exception = write_behind_queue_ != nullptr
+                                ? write_behind_queue_->Flush()
+                                : Exception{Exception::kSuccess};
       Close();
-      return {Exception::kSuccess};
+      return exception;
     }
 
-    return output_file_.Write(chunk);
+    if (write_behind_queue_ != nullptr) {
+      return write_behind_queue_->Write(chunk);
+    }
+    return WriteChunk(chunk);
   }
 
   ExceptionOr<size_t> SkipToOffset(size_t offset) override {
@@ -313,14 +432,64 @@ class IncomingFileInternalPayload : public InternalPayload {
   }
 
   void Close() override {
+    // May be called on another thread than AttachNextChunk(), e.g. when the
+    // endpoint disconnects, and with PayloadManager's lock held. The queue
+    // fails the reader's pending write and closes the file once the write in
+    // progress, if any, is done, without waiting for the disk here.
+    if (write_behind_queue_ != nullptr) {
+      write_behind_queue_->Close([this]() { CloseFile(); });
+      return;
+    }
+    CloseFile();
+  }
+
+ private:
+  void CloseFile() {
+    if (journal_ != nullptr) {
+      if (written_offset_ >= file_size_) {
+        journal_->Remove();
+      } else {
+        Journal();
+      }
+      journal_.reset();
+    }
     output_file_.SetLastModifiedTime(last_modified_time_);
     output_file_.Close();
   }
 
- private:
+  Exception WriteChunk(absl::string_view chunk) {
+    Exception exception = output_file_.Write(chunk);
+    if (!exception.Ok() || journal_ == nullptr) {
+      return exception;
+    }
+    written_offset_ += chunk.size();
+    if (written_offset_ - journaled_offset_ >= journal_interval_bytes_) {
+      Journal();
+    }
+    return exception;
+  }
+
+  void Journal() {
+    // Makes sure the bytes are on disk before the journal says they are
+    // there.
+    if (output_file_.Sync().Ok() &&
+        journal_->Record(written_offset_)) {
+      journaled_offset_ = written_offset_;
+    }
+  }
+
   OutputFile output_file_;
   absl::Time last_modified_time_;
   const std::int64_t total_size_;
+  std::unique_ptr<IncomingFileJournal> journal_;
+  const std::int64_t journal_interval_bytes_;
+  // The size of the whole file, and how much of it is written and journaled.
+  const std::int64_t file_size_;
+  std::int64_t written_offset_;
+  std::int64_t journaled_offset_;
+  // Writes the chunks on a worker thread if set. Declared last, so that it is
+  // destroyed, and its writes are done, before the file.
+  std::unique_ptr<WriteBehindQueue> write_behind_queue_;
 };
 
 }  // namespace
@@ -329,10 +498,11 @@ using ::nearby::api::ImplementationPlatform;
 using ::nearby::api::OSName;
 
 ErrorOr<std::unique_ptr<InternalPayload>> CreateOutgoingInternalPayload(
-    Payload payload) {
+    Payload payload, bool send_bytes_in_chunks) {
   switch (payload.GetType()) {
     case PayloadType::kBytes:
-      return {std::make_unique<BytesInternalPayload>(std::move(payload))};
+      return {std::make_unique<BytesInternalPayload>(std::move(payload),
+                                                     send_bytes_in_chunks)};
 
     case PayloadType::kFile: {
       return {
@@ -351,7 +521,7 @@ ErrorOr<std::unique_ptr<InternalPayload>> CreateOutgoingInternalPayload(
 
 ErrorOr<std::unique_ptr<InternalPayload>> CreateIncomingInternalPayload(
     const location::nearby::connections::PayloadTransferFrame& frame,
-    const std::string& custom_save_path) {
+    const std::string& endpoint_id, const std::string& custom_save_path) {
   if (frame.packet_type() !=
       location::nearby::connections::PayloadTransferFrame::DATA) {
     return {Error(
@@ -361,8 +531,19 @@ ErrorOr<std::unique_ptr<InternalPayload>> CreateIncomingInternalPayload(
   const Payload::Id payload_id = frame.payload_header().id();
   switch (frame.payload_header().type()) {
     case PayloadTransferFrame::PayloadHeader::BYTES: {
-      return {std::make_unique<BytesInternalPayload>(
-          Payload(payload_id, ByteArray(frame.payload_chunk().body())))};
+      if (!frame.payload_header().is_multi_chunk()) {
+        return {std::make_unique<BytesInternalPayload>(
+            Payload(payload_id, ByteArray(frame.payload_chunk().body())))};
+      }
+      // The body of the first chunk is attached by the caller.
+      std::int64_t total_size = frame.payload_header().total_size();
+      if (total_size < 0 || total_size > kMaxIncomingBytesPayloadSize) {
+        LOG(ERROR) << "Bytes payload " << payload_id
+                   << " has an unsupported size: " << total_size;
+        return {Error(OperationResultCode::DETAIL_UNKNOWN)};
+      }
+      return {std::make_unique<IncomingChunkedBytesInternalPayload>(
+          payload_id, total_size)};
     }
 
     case PayloadTransferFrame::PayloadHeader::STREAM: {
@@ -425,15 +606,58 @@ ErrorOr<std::unique_ptr<InternalPayload>> CreateIncomingInternalPayload(
             Payload(payload_id, InputFile(payload_id)),
             std::move(output_file), last_modified_time, total_size)};
       } else {
+        std::int64_t journal_interval_bytes =
+            NearbyFlags::GetInstance().GetInt64Flag(
+                config_package_nearby::nearby_connections_feature::
+                    kIncomingFileJournalIntervalBytes);
+        // A resumed transfer only sends the rest of the file; the bytes before
+        // come from the partial file of the interrupted one, which is moved
+        // aside before the file is created again.
+        std::int64_t resume_offset =
+            std::max<std::int64_t>(frame.payload_header().resume_offset(), 0);
+        IncomingFileJournal::FileId file_id{
+            .endpoint_id = endpoint_id,
+            .payload_id = payload_id,
+            .parent_folder = parent_folder,
+            .file_name = file_name,
+            .file_size = resume_offset + total_size};
+        std::int64_t file_size = file_id.file_size;
+        std::optional<IncomingFileJournal::Entry> partial_file;
+        if (journal_interval_bytes > 0 && resume_offset > 0) {
+          partial_file =
+              IncomingFileJournal::TakePartialFile(file_id, resume_offset);
+        }
+
         OutputFile output_file(file_path);
         if (!output_file.IsValid()) {
           LOG(ERROR) << "Output file payload path is not valid: " << file_path;
           return {Error(OperationResultCode::IO_FILE_OPENING_ERROR)};
         }
+        bool resumed = partial_file.has_value() &&
+                       IncomingFileJournal::ResumeFrom(
+                           *partial_file, resume_offset, output_file);
+        if (resume_offset > 0 && !resumed) {
+          LOG(WARNING) << "Can't resume file payload " << payload_id
+                       << " from offset " << resume_offset;
+        }
+        // Without the journal, or the start of a resumed file, the file only
+        // gets the chunks it receives.
+        if (journal_interval_bytes <= 0 || (resume_offset > 0 && !resumed)) {
+          return {std::make_unique<IncomingFileInternalPayload>(
+              Payload(payload_id, parent_folder, file_name,
+                      InputFile(file_path)),
+              std::move(output_file), last_modified_time, total_size)};
+        }
+        if (!output_file.Preallocate(file_size).Ok()) {
+          VLOG(1) << "Failed to preallocate " << file_size << " bytes for "
+                  << file_path;
+        }
         return {std::make_unique<IncomingFileInternalPayload>(
             Payload(payload_id, parent_folder, file_name,
                     InputFile(file_path)),
-            std::move(output_file), last_modified_time, total_size)};
+            std::move(output_file), last_modified_time, total_size,
+            std::make_unique<IncomingFileJournal>(file_id, file_path),
+            resume_offset, journal_interval_bytes)};
       }
     }
     default:
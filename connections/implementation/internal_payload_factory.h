@@ -15,6 +15,7 @@
 #ifndef CORE_INTERNAL_INTERNAL_PAYLOAD_FACTORY_H_
 #define CORE_INTERNAL_INTERNAL_PAYLOAD_FACTORY_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -25,15 +26,21 @@
 namespace nearby {
 namespace connections {
 
-// Creates an InternalPayload representing an outgoing Payload.
+// Incoming BYTES payloads are held in memory; larger ones are rejected rather
+// than allocated.
+inline constexpr std::int64_t kMaxIncomingBytesPayloadSize = 256 * 1024 * 1024;
+
+// Creates an InternalPayload representing an outgoing Payload. With
+// `send_bytes_in_chunks`, a BYTES payload larger than a chunk is sent in
+// several chunks; only set it if every receiver supports that.
 ErrorOr<std::unique_ptr<InternalPayload>> CreateOutgoingInternalPayload(
-    Payload payload);
+    Payload payload, bool send_bytes_in_chunks = false);
 
-// Creates an InternalPayload representing an incoming Payload from a remote
-// endpoint.
+// Creates an InternalPayload representing an incoming Payload from the remote
+// endpoint `endpoint_id`.
 ErrorOr<std::unique_ptr<InternalPayload>> CreateIncomingInternalPayload(
     const location::nearby::connections::PayloadTransferFrame& frame,
-    const std::string& custom_save_path);
+    const std::string& endpoint_id, const std::string& custom_save_path);
 
 }  // namespace connections
 }  // namespace nearby
@@ -25,10 +25,13 @@
 #include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "connections/implementation/incoming_file_journal.h"
 #include "connections/implementation/internal_payload.h"
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
 #include "connections/payload.h"
 #include "connections/payload_type.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/expected.h"
@@ -41,7 +44,9 @@ namespace connections {
 namespace {
 
 using ::location::nearby::connections::PayloadTransferFrame;
+constexpr char kEndpointId[] = "ABCD";
 constexpr char kText[] = "data chunk";
+constexpr std::int64_t kTextSize = sizeof(kText) - 1;
 
 TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromBytePayload) {
   ByteArray data(kText);
@@ -100,7 +105,7 @@ TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromByteMessage) {
   header.set_total_size(512);
   *frame.mutable_payload_chunk() = std::move(payload_chunk);
   ErrorOr<std::unique_ptr<InternalPayload>> result =
-      CreateIncomingInternalPayload(frame, path);
+      CreateIncomingInternalPayload(frame, kEndpointId, path);
   ASSERT_FALSE(result.has_error());
   std::unique_ptr<InternalPayload> internal_payload = std::move(result.value());
   EXPECT_NE(internal_payload, nullptr);
@@ -110,6 +115,81 @@ TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromByteMessage) {
   EXPECT_EQ(payload.AsBytes(), ByteArray(kText));
 }
 
+TEST(InternalPayloadFactoryTest, OutgoingBytesPayloadIsSentInChunks) {
+  ErrorOr<std::unique_ptr<InternalPayload>> result =
+      CreateOutgoingInternalPayload(Payload{ByteArray(kText)},
+                                    /*send_bytes_in_chunks=*/true);
+  ASSERT_FALSE(result.has_error());
+  std::unique_ptr<InternalPayload> internal_payload = std::move(result.value());
+  EXPECT_TRUE(internal_payload->IsMultiChunkBytes());
+  EXPECT_EQ(internal_payload->GetTotalSize(), kTextSize);
+  EXPECT_EQ(internal_payload->DetachNextChunk(4), ByteArray("data"));
+  EXPECT_EQ(internal_payload->DetachNextChunk(4), ByteArray(" chu"));
+  EXPECT_EQ(internal_payload->DetachNextChunk(4), ByteArray("nk"));
+  EXPECT_TRUE(internal_payload->DetachNextChunk(4).Empty());
+}
+
+TEST(InternalPayloadFactoryTest, OutgoingBytesPayloadIsOneChunkByDefault) {
+  ErrorOr<std::unique_ptr<InternalPayload>> result =
+      CreateOutgoingInternalPayload(Payload{ByteArray(kText)});
+  ASSERT_FALSE(result.has_error());
+  std::unique_ptr<InternalPayload> internal_payload = std::move(result.value());
+  EXPECT_FALSE(internal_payload->IsMultiChunkBytes());
+  EXPECT_EQ(internal_payload->DetachNextChunk(4), ByteArray(kText));
+  EXPECT_TRUE(internal_payload->DetachNextChunk(4).Empty());
+}
+
+PayloadTransferFrame CreateMultiChunkBytesFrame(std::int64_t total_size) {
+  PayloadTransferFrame frame;
+  frame.set_packet_type(PayloadTransferFrame::DATA);
+  auto& header = *frame.mutable_payload_header();
+  header.set_type(PayloadTransferFrame::PayloadHeader::BYTES);
+  header.set_id(12345);
+  header.set_total_size(total_size);
+  header.set_is_multi_chunk(true);
+  frame.mutable_payload_chunk()->set_offset(0);
+  return frame;
+}
+
+TEST(InternalPayloadFactoryTest, IncomingMultiChunkBytesPayloadIsReassembled) {
+  ErrorOr<std::unique_ptr<InternalPayload>> result =
+      CreateIncomingInternalPayload(CreateMultiChunkBytesFrame(kTextSize),
+                                    kEndpointId, ::testing::TempDir());
+  ASSERT_FALSE(result.has_error());
+  std::unique_ptr<InternalPayload> internal_payload = std::move(result.value());
+  EXPECT_TRUE(internal_payload->IsMultiChunkBytes());
+  EXPECT_EQ(internal_payload->GetTotalSize(), kTextSize);
+
+  EXPECT_TRUE(internal_payload->AttachNextChunk("data ").Ok());
+  EXPECT_TRUE(internal_payload->AttachNextChunk("chunk").Ok());
+  EXPECT_TRUE(internal_payload->AttachNextChunk("").Ok());
+
+  Payload payload = internal_payload->ReleasePayload();
+  EXPECT_EQ(payload.GetId(), 12345);
+  EXPECT_EQ(payload.AsBytes(), ByteArray(kText));
+}
+
+TEST(InternalPayloadFactoryTest,
+     IncomingMultiChunkBytesPayloadFailsOnSizeMismatch) {
+  ErrorOr<std::unique_ptr<InternalPayload>> truncated =
+      CreateIncomingInternalPayload(CreateMultiChunkBytesFrame(kTextSize),
+                                    kEndpointId, ::testing::TempDir());
+  ASSERT_FALSE(truncated.has_error());
+  EXPECT_TRUE(truncated.value()->AttachNextChunk("data").Ok());
+  EXPECT_TRUE(truncated.value()->AttachNextChunk("").Raised());
+
+  ErrorOr<std::unique_ptr<InternalPayload>> too_long =
+      CreateIncomingInternalPayload(CreateMultiChunkBytesFrame(4),
+                                    kEndpointId, ::testing::TempDir());
+  ASSERT_FALSE(too_long.has_error());
+  EXPECT_TRUE(too_long.value()->AttachNextChunk(kText).Raised());
+
+  EXPECT_TRUE(CreateIncomingInternalPayload(
+                  CreateMultiChunkBytesFrame(std::int64_t{1} << 40),
+                  kEndpointId, ::testing::TempDir())
+                  .has_error());
+}
+
 TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromStreamMessage) {
   PayloadTransferFrame frame;
   std::string path = ::testing::TempDir();
@@ -119,7 +199,7 @@ TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromStreamMessage) {
   header.set_id(12345);
   header.set_total_size(0);
   ErrorOr<std::unique_ptr<InternalPayload>> result =
-      CreateIncomingInternalPayload(frame, path);
+      CreateIncomingInternalPayload(frame, kEndpointId, path);
   ASSERT_FALSE(result.has_error());
   std::unique_ptr<InternalPayload> internal_payload = std::move(result.value());
   EXPECT_NE(internal_payload, nullptr);
@@ -144,7 +224,7 @@ TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromFileMessage) {
   header.set_id(12345);
   header.set_total_size(512);
   ErrorOr<std::unique_ptr<InternalPayload>> result =
-      CreateIncomingInternalPayload(frame, path);
+      CreateIncomingInternalPayload(frame, kEndpointId, path);
   ASSERT_FALSE(result.has_error());
   std::unique_ptr<InternalPayload> internal_payload = std::move(result.value());
   EXPECT_NE(internal_payload, nullptr);
@@ -164,7 +244,7 @@ TEST(InternalPayloadFactoryTest,
   header.set_type(PayloadTransferFrame::PayloadHeader::FILE);
   header.set_total_size(512);
   ErrorOr<std::unique_ptr<InternalPayload>> result =
-      CreateIncomingInternalPayload(frame, path);
+      CreateIncomingInternalPayload(frame, kEndpointId, path);
   EXPECT_TRUE(result.has_error());
 }
 
@@ -178,7 +258,7 @@ TEST(InternalPayloadFactoryTest,
   header.set_id(12345);
   header.set_total_size(512);
   ErrorOr<std::unique_ptr<InternalPayload>> result =
-      CreateIncomingInternalPayload(frame, path);
+      CreateIncomingInternalPayload(frame, kEndpointId, path);
   ASSERT_FALSE(result.has_error());
   std::unique_ptr<InternalPayload> internal_payload = std::move(result.value());
   EXPECT_NE(internal_payload, nullptr);
@@ -197,7 +277,7 @@ TEST(InternalPayloadFactoryTest,
   header.set_total_size(512);
   header.set_file_name("test.file.name");
   ErrorOr<std::unique_ptr<InternalPayload>> result =
-      CreateIncomingInternalPayload(frame, path);
+      CreateIncomingInternalPayload(frame, kEndpointId, path);
   ASSERT_FALSE(result.has_error());
   std::unique_ptr<InternalPayload> internal_payload = std::move(result.value());
   EXPECT_NE(internal_payload, nullptr);
@@ -220,7 +300,7 @@ TEST(InternalPayloadFactoryTest,
   int64_t time_millis = absl::ToUnixMillis(absl::Now());
   header.set_last_modified_timestamp_millis(time_millis);
   ErrorOr<std::unique_ptr<InternalPayload>> result =
-      CreateIncomingInternalPayload(frame, path);
+      CreateIncomingInternalPayload(frame, kEndpointId, path);
   ASSERT_FALSE(result.has_error());
   std::unique_ptr<InternalPayload> internal_payload = std::move(result.value());
   EXPECT_NE(internal_payload, nullptr);
@@ -247,7 +327,7 @@ TEST(InternalPayloadFactoryTest,
   header.set_file_name("test.file.name");
   header.set_parent_folder("Downloads2");
   ErrorOr<std::unique_ptr<InternalPayload>> result =
-      CreateIncomingInternalPayload(frame, path);
+      CreateIncomingInternalPayload(frame, kEndpointId, path);
   ASSERT_TRUE(result.has_error());
 }
 
@@ -342,7 +422,7 @@ TEST(InternalPayloadFactoryTest, IncomingFilePayloadBehavesCorrectly) {
   header.set_parent_folder("test_parent_folder");
   header.set_last_modified_timestamp_millis(1234567890);
   ErrorOr<std::unique_ptr<InternalPayload>> result =
-      CreateIncomingInternalPayload(frame, path);
+      CreateIncomingInternalPayload(frame, kEndpointId, path);
   ASSERT_FALSE(result.has_error());
   std::unique_ptr<InternalPayload> internal_payload = std::move(result.value());
   ASSERT_NE(internal_payload, nullptr);
@@ -378,6 +458,149 @@ TEST(InternalPayloadFactoryTest, IncomingFilePayloadBehavesCorrectly) {
   EXPECT_EQ(file_content.result(), expected_content);
 }
 
+TEST(InternalPayloadFactoryTest, IncomingFilePayloadResumesFromJournal) {
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kIncomingFileJournalIntervalBytes,
+      4);
+  const std::string path = ::testing::TempDir();
+  const std::string chunk1 = "chunk1";
+  const std::string chunk2 = "chunk2";
+  const IncomingFileJournal::FileId file_id{
+      .endpoint_id = kEndpointId,
+      .payload_id = 12345,
+      .parent_folder = "resume_parent_folder",
+      .file_name = "resume_file_name",
+      .file_size = static_cast<std::int64_t>(chunk1.size() + chunk2.size())};
+  PayloadTransferFrame frame;
+  frame.set_packet_type(PayloadTransferFrame::DATA);
+  auto& header = *frame.mutable_payload_header();
+  header.set_type(PayloadTransferFrame::PayloadHeader::FILE);
+  header.set_id(file_id.payload_id);
+  header.set_total_size(file_id.file_size);
+  header.set_file_name(file_id.file_name);
+  header.set_parent_folder(file_id.parent_folder);
+
+  // The first transfer is interrupted after the first chunk.
+  ErrorOr<std::unique_ptr<InternalPayload>> result =
+      CreateIncomingInternalPayload(frame, kEndpointId, path);
+  ASSERT_FALSE(result.has_error());
+  ASSERT_TRUE(result.value()->AttachNextChunk(chunk1).Ok());
+  result.value()->Close();
+  EXPECT_EQ(IncomingFileJournal::GetDurableOffset(file_id), chunk1.size());
+
+  // The second one only sends the rest of the file.
+  header.set_total_size(chunk2.size());
+  header.set_resume_offset(chunk1.size());
+  result = CreateIncomingInternalPayload(frame, kEndpointId, path);
+  ASSERT_FALSE(result.has_error());
+  std::unique_ptr<InternalPayload> internal_payload = std::move(result.value());
+  EXPECT_EQ(internal_payload->GetTotalSize(), chunk2.size());
+  ASSERT_TRUE(internal_payload->AttachNextChunk(chunk2).Ok());
+  ASSERT_TRUE(internal_payload->AttachNextChunk("").Ok());
+  EXPECT_EQ(IncomingFileJournal::GetDurableOffset(file_id), 0);
+
+  Payload payload = internal_payload->ReleasePayload();
+  InputFile* input_file = payload.AsFile();
+  ASSERT_NE(input_file, nullptr);
+  ExceptionOr<ByteArray> file_content = input_file->Read(1024);
+  input_file->Close();
+  ASSERT_TRUE(file_content.ok());
+  EXPECT_EQ(file_content.result(), ByteArray(chunk1 + chunk2));
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST(InternalPayloadFactoryTest,
+     IncomingFilePayloadDoesNotResumeFromAnotherEndpoint) {
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kIncomingFileJournalIntervalBytes,
+      4);
+  const std::string path = ::testing::TempDir();
+  const std::string chunk1 = "chunk1";
+  const std::string chunk2 = "chunk2";
+  const IncomingFileJournal::FileId file_id{
+      .endpoint_id = kEndpointId,
+      .payload_id = 23456,
+      .parent_folder = "other_parent_folder",
+      .file_name = "other_file_name",
+      .file_size = static_cast<std::int64_t>(chunk1.size() + chunk2.size())};
+  PayloadTransferFrame frame;
+  frame.set_packet_type(PayloadTransferFrame::DATA);
+  auto& header = *frame.mutable_payload_header();
+  header.set_type(PayloadTransferFrame::PayloadHeader::FILE);
+  header.set_id(file_id.payload_id);
+  header.set_total_size(file_id.file_size);
+  header.set_file_name(file_id.file_name);
+  header.set_parent_folder(file_id.parent_folder);
+  ErrorOr<std::unique_ptr<InternalPayload>> result =
+      CreateIncomingInternalPayload(frame, kEndpointId, path);
+  ASSERT_FALSE(result.has_error());
+  ASSERT_TRUE(result.value()->AttachNextChunk(chunk1).Ok());
+  result.value()->Close();
+
+  // Another endpoint claims to resume the same file.
+  IncomingFileJournal::FileId other_file_id = file_id;
+  other_file_id.endpoint_id = "WXYZ";
+  EXPECT_EQ(IncomingFileJournal::GetDurableOffset(other_file_id), 0);
+  header.set_total_size(chunk2.size());
+  header.set_resume_offset(chunk1.size());
+  result = CreateIncomingInternalPayload(frame, other_file_id.endpoint_id, path);
+  ASSERT_FALSE(result.has_error());
+  std::unique_ptr<InternalPayload> internal_payload = std::move(result.value());
+  ASSERT_TRUE(internal_payload->AttachNextChunk(chunk2).Ok());
+  ASSERT_TRUE(internal_payload->AttachNextChunk("").Ok());
+
+  // It only gets the bytes it sent.
+  Payload payload = internal_payload->ReleasePayload();
+  InputFile* input_file = payload.AsFile();
+  ASSERT_NE(input_file, nullptr);
+  ExceptionOr<ByteArray> file_content = input_file->Read(1024);
+  input_file->Close();
+  ASSERT_TRUE(file_content.ok());
+  EXPECT_EQ(file_content.result(), ByteArray(chunk2));
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST(InternalPayloadFactoryTest, IncomingFilePayloadWritesBehindReader) {
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kIncomingFileWriteBehindBytes,
+      256 * 1024);
+  const std::int64_t chunk_size = 64 * 1024;
+  const std::int64_t file_size = 48 * chunk_size;
+  PayloadTransferFrame frame;
+  frame.set_packet_type(PayloadTransferFrame::DATA);
+  auto& header = *frame.mutable_payload_header();
+  header.set_type(PayloadTransferFrame::PayloadHeader::FILE);
+  header.set_id(12347);
+  header.set_total_size(file_size);
+  header.set_file_name("write_behind_file_name");
+  header.set_parent_folder("write_behind_parent_folder");
+  ErrorOr<std::unique_ptr<InternalPayload>> result =
+      CreateIncomingInternalPayload(frame, kEndpointId, ::testing::TempDir());
+  ASSERT_FALSE(result.has_error());
+  std::unique_ptr<InternalPayload> internal_payload = std::move(result.value());
+
+  std::string expected_content;
+  for (std::int64_t offset = 0; offset < file_size; offset += chunk_size) {
+    std::string chunk(chunk_size, static_cast<char>('a' + offset % 26));
+    ASSERT_TRUE(internal_payload->AttachNextChunk(chunk).Ok());
+    expected_content += chunk;
+  }
+  // The file is complete once the last chunk is attached.
+  ASSERT_TRUE(internal_payload->AttachNextChunk("").Ok());
+
+  Payload payload = internal_payload->ReleasePayload();
+  InputFile* input_file = payload.AsFile();
+  ASSERT_NE(input_file, nullptr);
+  ExceptionOr<ByteArray> file_content = input_file->Read(file_size + 1);
+  input_file->Close();
+  ASSERT_TRUE(file_content.ok());
+  EXPECT_EQ(std::string(file_content.result()), expected_content);
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
 TEST(InternalPayloadFactoryTest, IncomingStreamPayloadBehavesCorrectly) {
   PayloadTransferFrame frame;
   std::string path = ::testing::TempDir();
@@ -387,7 +610,7 @@ TEST(InternalPayloadFactoryTest, IncomingStreamPayloadBehavesCorrectly) {
   header.set_id(12345);
   header.set_total_size(0);
   ErrorOr<std::unique_ptr<InternalPayload>> result =
-      CreateIncomingInternalPayload(frame, path);
+      CreateIncomingInternalPayload(frame, kEndpointId, path);
   ASSERT_FALSE(result.has_error());
   std::unique_ptr<InternalPayload> internal_payload = std::move(result.value());
   ASSERT_NE(internal_payload, nullptr);
@@ -0,0 +1,78 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/listener_dispatcher.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "absl/functional/any_invocable.h"
+#include "internal/platform/mutex_lock.h"
+
+namespace nearby::connections {
+
+void ListenerDispatcher::Post(absl::AnyInvocable<void()> callback) {
+  MutexLock lock(&mutex_);
+  Enqueue(Entry{.callback = std::move(callback)});
+}
+
+void ListenerDispatcher::PostProgress(const std::string& endpoint_id,
+                                      std::int64_t payload_id,
+                                      absl::AnyInvocable<void()> callback) {
+  ProgressKey key{endpoint_id, payload_id};
+  MutexLock lock(&mutex_);
+  auto it = queued_progress_.find(key);
+  if (it != queued_progress_.end()) {
+    it->second->callback = std::move(callback);
+    ++coalesced_count_;
+    return;
+  }
+  Enqueue(Entry{.callback = std::move(callback),
+                .is_progress = true,
+                .progress_key = key});
+  queued_progress_.emplace(std::move(key), &queue_.back());
+}
+
+std::int64_t ListenerDispatcher::GetCoalescedCount() const {
+  MutexLock lock(&mutex_);
+  return coalesced_count_;
+}
+
+void ListenerDispatcher::Enqueue(Entry entry) {
+  queue_.push_back(std::move(entry));
+  if (is_draining_) return;
+  is_draining_ = true;
+  executor_.Execute("listener-dispatch", [this]() { Drain(); });
+}
+
+void ListenerDispatcher::Drain() {
+  while (true) {
+    absl::AnyInvocable<void()> callback;
+    {
+      MutexLock lock(&mutex_);
+      if (queue_.empty()) {
+        is_draining_ = false;
+        return;
+      }
+      Entry& entry = queue_.front();
+      if (entry.is_progress) queued_progress_.erase(entry.progress_key);
+      callback = std::move(entry.callback);
+      queue_.pop_front();
+    }
+    callback();
+  }
+}
+
+}  // namespace nearby::connections
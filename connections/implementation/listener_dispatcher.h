@@ -0,0 +1,88 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_LISTENER_DISPATCHER_H_
+#define CORE_INTERNAL_LISTENER_DISPATCHER_H_
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/single_thread_executor.h"
+
+namespace nearby::connections {
+
+// Delivers client listener callbacks on a dedicated thread, so that the
+// threads reporting events never wait for the client
+// (see kEnableAsyncListenerDispatch).
+//
+// Callbacks run one at a time, in the order they were posted; in particular,
+// all callbacks for an endpoint are delivered in order. In-progress payload
+// updates are coalesced while the client lags behind: only the latest queued
+// update of a payload is delivered.
+//
+// The destructor delivers the callbacks that are still queued.
+class ListenerDispatcher {
+ public:
+  ListenerDispatcher() = default;
+  ListenerDispatcher(const ListenerDispatcher&) = delete;
+  ListenerDispatcher& operator=(const ListenerDispatcher&) = delete;
+  ~ListenerDispatcher() = default;
+
+  // Queues `callback` behind all callbacks posted before.
+  void Post(absl::AnyInvocable<void()> callback) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Queues an in-progress update of a payload. If an earlier update of the
+  // same payload for the same endpoint has not been delivered yet, `callback`
+  // takes its place in the queue instead.
+  void PostProgress(const std::string& endpoint_id, std::int64_t payload_id,
+                    absl::AnyInvocable<void()> callback)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns how many updates were dropped in favor of a later one.
+  std::int64_t GetCoalescedCount() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  using ProgressKey = std::pair<std::string, std::int64_t>;
+  struct Entry {
+    absl::AnyInvocable<void()> callback;
+    // Set for updates posted with PostProgress().
+    bool is_progress = false;
+    ProgressKey progress_key;
+  };
+
+  void Enqueue(Entry entry) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void Drain() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  mutable Mutex mutex_;
+  // Elements of a deque keep their address when others are added at the back
+  // or removed from the front, which `queued_progress_` relies on.
+  std::deque<Entry> queue_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<ProgressKey, Entry*> queued_progress_
+      ABSL_GUARDED_BY(mutex_);
+  bool is_draining_ ABSL_GUARDED_BY(mutex_) = false;
+  std::int64_t coalesced_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Declared last, so that it is shut down, and delivers what is left, before
+  // the queue is destroyed.
+  SingleThreadExecutor executor_;
+};
+
+}  // namespace nearby::connections
+
+#endif  // CORE_INTERNAL_LISTENER_DISPATCHER_H_
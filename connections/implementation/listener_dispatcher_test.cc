@@ -0,0 +1,137 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/listener_dispatcher.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "internal/platform/count_down_latch.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/mutex_lock.h"
+
+namespace nearby::connections {
+namespace {
+
+using ::testing::ElementsAre;
+
+constexpr absl::Duration kTimeout = absl::Seconds(5);
+
+// Records delivered events; thread-safe.
+class EventLog {
+ public:
+  void Add(const std::string& event) {
+    MutexLock lock(&mutex_);
+    events_.push_back(event);
+  }
+  std::vector<std::string> Get() {
+    MutexLock lock(&mutex_);
+    return events_;
+  }
+
+ private:
+  Mutex mutex_;
+  std::vector<std::string> events_;
+};
+
+TEST(ListenerDispatcherTest, DeliversInPostOrder) {
+  EventLog log;
+  CountDownLatch done(1);
+  {
+    ListenerDispatcher dispatcher;
+    dispatcher.Post([&log]() { log.Add("initiated"); });
+    dispatcher.Post([&log]() { log.Add("accepted"); });
+    dispatcher.Post([&log]() { log.Add("payload"); });
+    dispatcher.Post([&done]() { done.CountDown(); });
+    EXPECT_TRUE(done.Await(kTimeout).result());
+  }
+
+  EXPECT_THAT(log.Get(), ElementsAre("initiated", "accepted", "payload"));
+}
+
+TEST(ListenerDispatcherTest, DoesNotBlockTheCaller) {
+  absl::Notification release;
+  CountDownLatch done(1);
+  ListenerDispatcher dispatcher;
+
+  dispatcher.Post([&release]() { release.WaitForNotification(); });
+  // Returns although the callback above is still blocked.
+  dispatcher.Post([&done]() { done.CountDown(); });
+  release.Notify();
+
+  EXPECT_TRUE(done.Await(kTimeout).result());
+}
+
+TEST(ListenerDispatcherTest, CoalescesQueuedProgressOfSamePayload) {
+  EventLog log;
+  absl::Notification release;
+  CountDownLatch done(1);
+  ListenerDispatcher dispatcher;
+
+  dispatcher.Post([&release]() { release.WaitForNotification(); });
+  dispatcher.PostProgress("A", 1, [&log]() { log.Add("A1:10"); });
+  dispatcher.PostProgress("B", 1, [&log]() { log.Add("B1:10"); });
+  dispatcher.PostProgress("A", 1, [&log]() { log.Add("A1:20"); });
+  dispatcher.PostProgress("A", 2, [&log]() { log.Add("A2:10"); });
+  dispatcher.PostProgress("A", 1, [&log]() { log.Add("A1:30"); });
+  dispatcher.Post([&log]() { log.Add("A1:success"); });
+  dispatcher.Post([&done]() { done.CountDown(); });
+  release.Notify();
+
+  ASSERT_TRUE(done.Await(kTimeout).result());
+  EXPECT_THAT(log.Get(), ElementsAre("A1:30", "B1:10", "A2:10", "A1:success"));
+  EXPECT_EQ(dispatcher.GetCoalescedCount(), 2);
+}
+
+TEST(ListenerDispatcherTest, DeliveredProgressIsNotReplaced) {
+  EventLog log;
+  ListenerDispatcher dispatcher;
+
+  CountDownLatch first(1);
+  dispatcher.PostProgress("A", 1, [&log, &first]() {
+    log.Add("A1:10");
+    first.CountDown();
+  });
+  ASSERT_TRUE(first.Await(kTimeout).result());
+  CountDownLatch second(1);
+  dispatcher.PostProgress("A", 1, [&log, &second]() {
+    log.Add("A1:20");
+    second.CountDown();
+  });
+  ASSERT_TRUE(second.Await(kTimeout).result());
+
+  EXPECT_THAT(log.Get(), ElementsAre("A1:10", "A1:20"));
+  EXPECT_EQ(dispatcher.GetCoalescedCount(), 0);
+}
+
+TEST(ListenerDispatcherTest, DestructorDeliversQueuedCallbacks) {
+  EventLog log;
+  absl::Notification release;
+  {
+    ListenerDispatcher dispatcher;
+    dispatcher.Post([&release]() { release.WaitForNotification(); });
+    dispatcher.Post([&log]() { log.Add("disconnected"); });
+    release.Notify();
+  }
+
+  EXPECT_THAT(log.Get(), ElementsAre("disconnected"));
+}
+
+}  // namespace
+}  // namespace nearby::connections
@@ -0,0 +1,121 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/medium_bandwidth_tracker.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/escaping.h"
+#include "absl/time/time.h"
+#include "internal/platform/logging.h"
+#include "internal/platform/mutex_lock.h"
+#include "proto/connections_enums.pb.h"
+
+namespace nearby::connections {
+
+namespace {
+
+using Measurement = MediumBandwidthTracker::Measurement;
+
+void Accumulate(Measurement& measurement, double throughput_bytes_per_second,
+                absl::Duration write_latency) {
+  constexpr double kWeight = MediumBandwidthTracker::kSmoothingFactor;
+  if (measurement.num_samples == 0) {
+    measurement.throughput_bytes_per_second = throughput_bytes_per_second;
+    measurement.write_latency = write_latency;
+  } else {
+    measurement.throughput_bytes_per_second =
+        (1 - kWeight) * measurement.throughput_bytes_per_second +
+        kWeight * throughput_bytes_per_second;
+    measurement.write_latency =
+        (1 - kWeight) * measurement.write_latency + kWeight * write_latency;
+  }
+  ++measurement.num_samples;
+}
+
+}  // namespace
+
+void MediumBandwidthTracker::RecordMeasurement(
+    const std::string& peer_id, Medium medium,
+    double throughput_bytes_per_second, absl::Duration write_latency) {
+  if (throughput_bytes_per_second <= 0) return;
+  VLOG(1) << "MediumBandwidthTracker: peer " << absl::BytesToHexString(peer_id)
+          << " over "
+          << location::nearby::proto::connections::Medium_Name(medium) << ": "
+          << throughput_bytes_per_second << " B/s, latency=" << write_latency;
+  MutexLock lock(&mutex_);
+  Accumulate(medium_measurements_[medium], throughput_bytes_per_second,
+             write_latency);
+  if (!peer_measurements_.contains(peer_id) &&
+      static_cast<int>(peer_measurements_.size()) >= kMaxPeers) {
+    auto oldest = std::min_element(
+        peer_measurements_.begin(), peer_measurements_.end(),
+        [](const auto& a, const auto& b) {
+          return a.second.last_record < b.second.last_record;
+        });
+    peer_measurements_.erase(oldest);
+  }
+  PeerMeasurements& peer = peer_measurements_[peer_id];
+  peer.last_record = next_record_++;
+  Accumulate(peer.mediums[medium], throughput_bytes_per_second, write_latency);
+}
+
+std::optional<Measurement> MediumBandwidthTracker::GetMeasurement(
+    const std::string& peer_id, Medium medium) const {
+  MutexLock lock(&mutex_);
+  return GetMeasurementLocked(peer_id, medium);
+}
+
+std::optional<Measurement> MediumBandwidthTracker::GetMeasurementLocked(
+    const std::string& peer_id, Medium medium) const {
+  auto peer_it = peer_measurements_.find(peer_id);
+  if (peer_it != peer_measurements_.end()) {
+    auto it = peer_it->second.mediums.find(medium);
+    if (it != peer_it->second.mediums.end()) return it->second;
+  }
+  auto medium_it = medium_measurements_.find(medium);
+  if (medium_it != medium_measurements_.end()) return medium_it->second;
+  return std::nullopt;
+}
+
+std::vector<MediumBandwidthTracker::Medium> MediumBandwidthTracker::RankMediums(
+    const std::string& peer_id, std::vector<Medium> mediums) const {
+  MutexLock lock(&mutex_);
+  std::vector<size_t> measured_slots;
+  std::vector<std::pair<double, Medium>> measured;
+  for (size_t i = 0; i < mediums.size(); ++i) {
+    std::optional<Measurement> measurement =
+        GetMeasurementLocked(peer_id, mediums[i]);
+    if (!measurement.has_value()) continue;
+    measured_slots.push_back(i);
+    measured.emplace_back(measurement->throughput_bytes_per_second,
+                          mediums[i]);
+  }
+  // Stable, so that equally fast mediums keep their preference order.
+  std::stable_sort(
+      measured.begin(), measured.end(),
+      [](const auto& a, const auto& b) { return a.first > b.first; });
+  for (size_t i = 0; i < measured_slots.size(); ++i) {
+    mediums[measured_slots[i]] = measured[i].second;
+  }
+  return mediums;
+}
+
+}  // namespace nearby::connections
@@ -0,0 +1,101 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_MEDIUM_BANDWIDTH_TRACKER_H_
+#define CORE_INTERNAL_MEDIUM_BANDWIDTH_TRACKER_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/time/time.h"
+#include "internal/platform/mutex.h"
+#include "proto/connections_enums.pb.h"
+
+namespace nearby::connections {
+
+// Remembers the bandwidth that upgrade mediums actually delivered, both per
+// medium and per remote device, so that BwuManager can prefer the fastest
+// real path over the nominally preferred one. The measurements are only used
+// when a new upgrade medium is picked, never to move endpoints off a medium
+// they are already upgraded to.
+//
+// Remote devices are told apart by a `peer_id` that outlives a connection
+// (endpoint ids don't), so that a device that reconnects is judged by its own
+// history. Only the `kMaxPeers` most recently measured devices are kept.
+//
+// Measurements come from the write throughput of live EndpointChannels (see
+// EndpointChannel::GetThroughputBytesPerSecond()). The tracker is
+// thread-safe.
+class MediumBandwidthTracker {
+ public:
+  using Medium = ::location::nearby::proto::connections::Medium;
+
+  struct Measurement {
+    double throughput_bytes_per_second = 0;
+    absl::Duration write_latency = absl::ZeroDuration();
+    int num_samples = 0;
+  };
+
+  // Weight of the newest sample in the moving averages.
+  static constexpr double kSmoothingFactor = 0.5;
+  // Remote devices with measurements of their own.
+  static constexpr int kMaxPeers = 64;
+
+  // Records that `medium` delivered `throughput_bytes_per_second` to
+  // `peer_id`. Samples without a throughput are ignored.
+  void RecordMeasurement(const std::string& peer_id, Medium medium,
+                         double throughput_bytes_per_second,
+                         absl::Duration write_latency)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the measurement of `medium` for `peer_id` if there is one, or else
+  // the measurement of `medium` across all peers.
+  std::optional<Measurement> GetMeasurement(const std::string& peer_id,
+                                            Medium medium) const
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns `mediums` with the measured ones sorted by throughput, fastest
+  // first. Mediums without a measurement keep their position, so the static
+  // preference order still decides wherever there is no data.
+  std::vector<Medium> RankMediums(const std::string& peer_id,
+                                  std::vector<Medium> mediums) const
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+
+ private:
+  struct PeerMeasurements {
+    absl::flat_hash_map<Medium, Measurement> mediums;
+    // Value of `next_record_` when the peer was last measured.
+    std::int64_t last_record = 0;
+  };
+
+  std::optional<Measurement> GetMeasurementLocked(const std::string& peer_id,
+                                                  Medium medium) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  mutable Mutex mutex_;
+  absl::flat_hash_map<Medium, Measurement> medium_measurements_
+      ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, PeerMeasurements> peer_measurements_
+      ABSL_GUARDED_BY(mutex_);
+  std::int64_t next_record_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace nearby::connections
+
+#endif  // CORE_INTERNAL_MEDIUM_BANDWIDTH_TRACKER_H_
@@ -0,0 +1,130 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/medium_bandwidth_tracker.h"
+
+#include <optional>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "proto/connections_enums.pb.h"
+
+namespace nearby::connections {
+namespace {
+
+using ::location::nearby::proto::connections::Medium;
+using ::testing::ElementsAre;
+
+constexpr char kPeerId[] = "peer";
+constexpr char kOtherPeerId[] = "other peer";
+constexpr double kMegabyte = 1024 * 1024;
+
+TEST(MediumBandwidthTrackerTest, NoMeasurementByDefault) {
+  MediumBandwidthTracker tracker;
+
+  EXPECT_EQ(tracker.GetMeasurement(kPeerId, Medium::WIFI_LAN),
+            std::nullopt);
+}
+
+TEST(MediumBandwidthTrackerTest, IgnoresEmptySamples) {
+  MediumBandwidthTracker tracker;
+
+  tracker.RecordMeasurement(kPeerId, Medium::WIFI_LAN, 0,
+                            absl::Milliseconds(1));
+
+  EXPECT_EQ(tracker.GetMeasurement(kPeerId, Medium::WIFI_LAN),
+            std::nullopt);
+}
+
+TEST(MediumBandwidthTrackerTest, SmoothsSamples) {
+  MediumBandwidthTracker tracker;
+
+  tracker.RecordMeasurement(kPeerId, Medium::WIFI_LAN, 10 * kMegabyte,
+                            absl::Milliseconds(2));
+  tracker.RecordMeasurement(kPeerId, Medium::WIFI_LAN, 20 * kMegabyte,
+                            absl::Milliseconds(4));
+
+  std::optional<MediumBandwidthTracker::Measurement> measurement =
+      tracker.GetMeasurement(kPeerId, Medium::WIFI_LAN);
+  ASSERT_TRUE(measurement.has_value());
+  EXPECT_DOUBLE_EQ(measurement->throughput_bytes_per_second, 15 * kMegabyte);
+  EXPECT_EQ(measurement->write_latency, absl::Milliseconds(3));
+  EXPECT_EQ(measurement->num_samples, 2);
+}
+
+TEST(MediumBandwidthTrackerTest, PrefersPerPeerMeasurement) {
+  MediumBandwidthTracker tracker;
+  tracker.RecordMeasurement(kOtherPeerId, Medium::WIFI_LAN, 1 * kMegabyte,
+                            absl::Milliseconds(1));
+  tracker.RecordMeasurement(kPeerId, Medium::WIFI_LAN, 9 * kMegabyte,
+                            absl::Milliseconds(1));
+
+  EXPECT_DOUBLE_EQ(tracker.GetMeasurement(kOtherPeerId, Medium::WIFI_LAN)
+                       ->throughput_bytes_per_second,
+                   1 * kMegabyte);
+  // A peer without its own numbers gets the medium-wide average.
+  EXPECT_DOUBLE_EQ(tracker.GetMeasurement("new peer", Medium::WIFI_LAN)
+                       ->throughput_bytes_per_second,
+                   5 * kMegabyte);
+}
+
+TEST(MediumBandwidthTrackerTest, DropsLeastRecentlyMeasuredPeer) {
+  MediumBandwidthTracker tracker;
+  tracker.RecordMeasurement(kPeerId, Medium::WIFI_LAN, 1 * kMegabyte,
+                            absl::Milliseconds(1));
+  tracker.RecordMeasurement(kOtherPeerId, Medium::WIFI_LAN, 1 * kMegabyte,
+                            absl::Milliseconds(1));
+  for (int i = 0; i < MediumBandwidthTracker::kMaxPeers - 2; ++i) {
+    tracker.RecordMeasurement(absl::StrCat("peer ", i), Medium::WIFI_LAN,
+                              1 * kMegabyte, absl::Milliseconds(1));
+  }
+  // Measuring `kPeerId` again makes `kOtherPeerId` the least recent one.
+  tracker.RecordMeasurement(kPeerId, Medium::WIFI_LAN, 1 * kMegabyte,
+                            absl::Milliseconds(1));
+
+  tracker.RecordMeasurement("new peer", Medium::WIFI_LAN, 1 * kMegabyte,
+                            absl::Milliseconds(1));
+
+  EXPECT_EQ(tracker.GetMeasurement(kPeerId, Medium::WIFI_LAN)->num_samples, 2);
+  // Falls back to the medium-wide measurement.
+  EXPECT_EQ(tracker.GetMeasurement(kOtherPeerId, Medium::WIFI_LAN)->num_samples,
+            MediumBandwidthTracker::kMaxPeers + 2);
+}
+
+TEST(MediumBandwidthTrackerTest, RankMediumsOnlyReordersMeasuredMediums) {
+  MediumBandwidthTracker tracker;
+  tracker.RecordMeasurement(kPeerId, Medium::WIFI_HOTSPOT, 1 * kMegabyte,
+                            absl::Milliseconds(1));
+  tracker.RecordMeasurement(kPeerId, Medium::BLUETOOTH, 5 * kMegabyte,
+                            absl::Milliseconds(1));
+
+  EXPECT_THAT(tracker.RankMediums(kPeerId,
+                                  {Medium::WIFI_HOTSPOT, Medium::WIFI_LAN,
+                                   Medium::BLUETOOTH}),
+              ElementsAre(Medium::BLUETOOTH, Medium::WIFI_LAN,
+                          Medium::WIFI_HOTSPOT));
+}
+
+TEST(MediumBandwidthTrackerTest, RankMediumsKeepsOrderWithoutMeasurements) {
+  MediumBandwidthTracker tracker;
+
+  EXPECT_THAT(
+      tracker.RankMediums(kPeerId, {Medium::WIFI_LAN, Medium::BLUETOOTH}),
+      ElementsAre(Medium::WIFI_LAN, Medium::BLUETOOTH));
+}
+
+}  // namespace
+}  // namespace nearby::connections
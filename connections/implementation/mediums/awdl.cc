@@ -21,11 +21,10 @@
 #include <utility>
 
 #include "absl/strings/str_cat.h"
-#include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "connections/implementation/bwu_handler.h"
 #include "connections/implementation/mediums/awdl_bwu_handler.h"
-#include "connections/implementation/mediums/utils.h"
+#include "connections/implementation/mediums/service_id_identity.h"
 #include "internal/platform/awdl.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/cancellation_flag.h"
@@ -327,29 +326,12 @@ Awdl::AwdlCredential Awdl::GetCredentials(const std::string& service_id) {
 }
 
 std::string Awdl::GenerateServiceType(const std::string& service_id) {
-  std::string service_id_hash_string;
-
-  const ByteArray service_id_hash = Utils::Sha256Hash(
-      service_id, NsdServiceInfo::kTypeFromServiceIdHashLength);
-  for (auto byte : std::string(service_id_hash)) {
-    absl::StrAppend(&service_id_hash_string, absl::StrFormat("%02X", byte));
-  }
-
-  return absl::StrFormat(NsdServiceInfo::kNsdTypeFormat,
-                         service_id_hash_string);
+  return ServiceIdIdentity::Get(service_id).GetNsdServiceType();
 }
 
 int Awdl::GeneratePort(const std::string& service_id,
                        std::pair<std::int32_t, std::int32_t> port_range) {
-  const std::string service_id_hash =
-      std::string(Utils::Sha256Hash(service_id, 4));
-
-  std::uint32_t uint_of_service_id_hash =
-      service_id_hash[0] << 24 | service_id_hash[1] << 16 |
-      service_id_hash[2] << 8 | service_id_hash[3];
-
-  return port_range.first +
-         (uint_of_service_id_hash % (port_range.second - port_range.first));
+  return ServiceIdIdentity::Get(service_id).GetPort(port_range);
 }
 
 ErrorOr<bool> Awdl::InternalStartAcceptingConnections(
@@ -29,6 +29,7 @@
 #include "connections/implementation/endpoint_channel.h"
 #include "connections/implementation/mediums/awdl.h"
 #include "connections/implementation/mediums/awdl_endpoint_channel.h"
+#include "connections/implementation/mediums/service_id_identity.h"
 #include "connections/implementation/mediums/utils.h"
 #include "connections/implementation/offline_frames.h"
 #include "connections/implementation/service_id_constants.h"
@@ -274,16 +275,7 @@ void AwdlBwuHandler::OnIncomingAwdlConnection(
 }
 
 std::string AwdlBwuHandler::GenerateServiceType(const std::string& service_id) {
-  std::string service_id_hash_string;
-
-  const ByteArray service_id_hash = Utils::Sha256Hash(
-      service_id, NsdServiceInfo::kTypeFromServiceIdHashLength);
-  for (auto byte : std::string(service_id_hash)) {
-    absl::StrAppend(&service_id_hash_string, absl::StrFormat("%02X", byte));
-  }
-
-  return absl::StrFormat(NsdServiceInfo::kNsdTypeFormat,
-                         service_id_hash_string);
+  return ServiceIdIdentity::Get(service_id).GetNsdServiceType();
 }
 
 std::string AwdlBwuHandler::GenerateServiceName() {
@@ -40,6 +40,7 @@
 #include "connections/implementation/mediums/ble/bloom_filter.h"
 #include "connections/implementation/mediums/ble/discovered_peripheral_tracker.h"
 #include "connections/implementation/mediums/bluetooth_radio.h"
+#include "connections/implementation/mediums/service_id_identity.h"
 #include "connections/implementation/mediums/utils.h"
 #include "connections/implementation/pcp.h"
 #include "connections/power_level.h"
@@ -181,8 +182,8 @@ ErrorOr<bool> Ble::StartAdvertising(const std::string& service_id,
   }
 
   // Wrap the connections advertisement to the medium advertisement.
-  ByteArray service_id_hash = mediums::bleutils::GenerateHash(
-      service_id, mediums::BleAdvertisement::kServiceIdHashLength);
+  ByteArray service_id_hash = ServiceIdIdentity::Get(service_id).GetHash(
+      mediums::BleAdvertisement::kServiceIdHashLength);
   int psm = mediums::BleAdvertisementHeader::kDefaultPsmValue;
   const auto it = l2cap_server_sockets_.find(service_id);
   if (it != l2cap_server_sockets_.end()) {
@@ -806,8 +807,7 @@ ErrorOr<bool> Ble::StartAcceptingConnections(
             if (callback) {
               auto ble_socket = mediums::BleSocket::CreateWithBleSocket(
                   std::move(client_socket),
-                  mediums::bleutils::GenerateHash(
-                      service_id,
+                  ServiceIdIdentity::Get(service_id).GetHash(
                       mediums::BleAdvertisement::kServiceIdHashLength));
               callback(std::move(ble_socket), service_id);
             }
@@ -899,8 +899,7 @@ ErrorOr<int> Ble::StartAcceptingL2capConnections(
           if (callback) {
             auto ble_socket = mediums::BleSocket::CreateWithL2capSocket(
                 std::move(client_socket),
-                mediums::bleutils::GenerateHash(
-                    service_id,
+                ServiceIdIdentity::Get(service_id).GetHash(
                     mediums::BleAdvertisement::kServiceIdHashLength));
             Exception exception =
                 ble_socket->ProcessIncomingL2capPacketValidation();
@@ -1111,8 +1110,8 @@ ErrorOr<std::unique_ptr<mediums::BleSocket>> Ble::Connect2(
 
   auto ble_socket = mediums::BleSocket::CreateWithBleSocket(
       std::move(socket),
-      mediums::bleutils::GenerateHash(
-          service_id, mediums::BleAdvertisement::kServiceIdHashLength));
+      ServiceIdIdentity::Get(service_id).GetHash(
+          mediums::BleAdvertisement::kServiceIdHashLength));
   Exception send_introduction_result = ble_socket->SendIntroduction();
   if (!send_introduction_result.Ok()) {
     LOG(WARNING) << "Failed to send introduction packet on BLE socket: "
@@ -1159,8 +1158,8 @@ ErrorOr<std::unique_ptr<mediums::BleSocket>> Ble::ConnectOverL2cap2(
 
   auto ble_socket = mediums::BleSocket::CreateWithL2capSocket(
       std::move(socket),
-      mediums::bleutils::GenerateHash(
-          service_id, mediums::BleAdvertisement::kServiceIdHashLength));
+      ServiceIdIdentity::Get(service_id).GetHash(
+          mediums::BleAdvertisement::kServiceIdHashLength));
   Exception result = ble_socket->ProcessOutgoingL2capPacketValidation();
   if (!result.Ok()) {
     LOG(WARNING) << "Failed to process outgoing L2CAP packet validation: "
@@ -1411,7 +1410,8 @@ ByteArray Ble::CreateAdvertisementHeader(
   for (const auto& item : gatt_advertisements_) {
     const std::string& service_id = item.second.first;
     const ByteArray& gatt_advertisement = item.second.second;
-    bloom_filter.Add(service_id);
+    bloom_filter.Add(
+        ServiceIdIdentity::Get(service_id).GetBloomFilterHashes());
 
     // Compute the next hash.
     std::string advertisement_bodies = absl::StrCat(
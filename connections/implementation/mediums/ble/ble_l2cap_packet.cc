@@ -22,7 +22,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "connections/implementation/mediums/ble/ble_advertisement.h"
-#include "connections/implementation/mediums/utils.h"
+#include "connections/implementation/mediums/service_id_identity.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/input_stream.h"
@@ -260,7 +260,8 @@ ByteArray BleL2capPacket::ByteArrayForDataConnectionFailure() {
 }
 
 ByteArray BleL2capPacket::GenerateServiceIdHash(const std::string& service_id) {
-  return Utils::Sha256Hash(service_id, BleAdvertisement::kServiceIdHashLength);
+  return ServiceIdIdentity::Get(service_id).GetHash(
+      BleAdvertisement::kServiceIdHashLength);
 }
 
 ByteArray BleL2capPacket::ByteArrayForCommand(BleL2capPacket::Command command,
@@ -25,6 +25,7 @@
 #include "connections/implementation/mediums/ble/ble_advertisement.h"
 #include "connections/implementation/mediums/ble/ble_advertisement_header.h"
 #include "connections/implementation/mediums/ble/ble_packet.h"
+#include "connections/implementation/mediums/service_id_identity.h"
 #include "connections/implementation/mediums/utils.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/prng.h"
@@ -96,7 +97,8 @@ ByteArray GenerateServiceIdHash(const std::string& service_id,
       [[fallthrough]];
     default:
       // Use the latest known hashing scheme.
-      return Utils::Sha256Hash(service_id, BlePacket::kServiceIdHashLength);
+      return ServiceIdIdentity::Get(service_id).GetHash(
+          BlePacket::kServiceIdHashLength);
   }
 }
 
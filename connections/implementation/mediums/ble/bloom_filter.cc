@@ -23,10 +23,6 @@ namespace nearby {
 namespace connections {
 namespace mediums {
 
-namespace {
-constexpr int kHasherNumberOfRepetitions = 5;
-}
-
 BloomFilter::BloomFilter(std::unique_ptr<BitSet> bit_set,
                          const ByteArray& bytes)
     : bit_set_(std::move(bit_set)) {
@@ -70,8 +66,9 @@ BloomFilter::operator ByteArray() const {
   return result_bytes;
 }
 
-void BloomFilter::Add(const std::string& s) {
-  std::vector<std::int32_t> hashes = GetHashes(s);
+void BloomFilter::Add(const std::string& s) { Add(GetHashes(s)); }
+
+void BloomFilter::Add(const Hashes& hashes) {
   for (int32_t hash : hashes) {
     size_t position = static_cast<size_t>(hash) % bit_set_->Size();
     bit_set_->Set(position, true);
@@ -79,7 +76,10 @@ void BloomFilter::Add(const std::string& s) {
 }
 
 bool BloomFilter::PossiblyContains(const std::string& s) {
-  std::vector<std::int32_t> hashes = GetHashes(s);
+  return PossiblyContains(GetHashes(s));
+}
+
+bool BloomFilter::PossiblyContains(const Hashes& hashes) {
   for (int32_t hash : hashes) {
     size_t position = static_cast<size_t>(hash) % bit_set_->Size();
     if (!bit_set_->Test(position)) {
@@ -89,8 +89,8 @@ bool BloomFilter::PossiblyContains(const std::string& s) {
   return true;
 }
 
-std::vector<std::int32_t> BloomFilter::GetHashes(const std::string& s) {
-  std::vector<std::int32_t> hashes(kHasherNumberOfRepetitions, 0);
+BloomFilter::Hashes BloomFilter::GetHashes(const std::string& s) {
+  Hashes hashes = {};
 
   absl::uint128 hash128;
   MurmurHash3_x64_128(s.data(), s.size(), 0, &hash128);
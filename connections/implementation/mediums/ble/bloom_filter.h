@@ -15,13 +15,13 @@
 #ifndef CORE_INTERNAL_MEDIUMS_BLE_BLOOM_FILTER_H_
 #define CORE_INTERNAL_MEDIUMS_BLE_BLOOM_FILTER_H_
 
+#include <array>
 #include <bitset>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
-#include <vector>
 
 #include "internal/platform/byte_array.h"
 
@@ -70,11 +70,20 @@ class BloomFilter {
 
   explicit operator ByteArray() const;
 
+  static constexpr int kHasherNumberOfRepetitions = 5;
+  using Hashes = std::array<std::int32_t, kHasherNumberOfRepetitions>;
+
+  // Returns the hashes of `s`, which don't depend on the size of the filter.
+  // Callers that check the same string often can keep them and use the
+  // overloads below.
+  static Hashes GetHashes(const std::string& s);
+
   void Add(const std::string& s);
+  void Add(const Hashes& hashes);
   bool PossiblyContains(const std::string& s);
+  bool PossiblyContains(const Hashes& hashes);
 
  private:
-  std::vector<std::int32_t> GetHashes(const std::string& s);
   int GetMinBytesForBits() const { return (bit_set_->Size() + 7) >> 3; }
 
   std::unique_ptr<BitSet> bit_set_;
@@ -38,6 +38,7 @@
 #include "connections/implementation/mediums/ble/discovered_peripheral_callback.h"
 #include "connections/implementation/mediums/ble/instant_on_lost_advertisement.h"
 #include "connections/implementation/mediums/lost_entity_tracker.h"
+#include "connections/implementation/mediums/service_id_identity.h"
 #include "connections/implementation/pcp.h"
 #include "connections/implementation/webrtc_state.h"
 #include "internal/flags/nearby_flags.h"
@@ -61,6 +62,13 @@ constexpr int kGattThreadCount = 1;
 constexpr absl::Duration kInstantLostAdvertisementTimeout = absl::Seconds(60);
 constexpr absl::Duration kExtendedAdvertisementHeaderDelay = absl::Seconds(3);
 constexpr absl::Duration kAdvertisementHeaderExpiry = absl::Seconds(15);
+constexpr int kMaxGattAdvertisementCacheSize = 256;
+
+absl::Duration GetGattAdvertisementCacheTtl() {
+  return absl::Milliseconds(NearbyFlags::GetInstance().GetInt64Flag(
+      config_package_nearby::nearby_connections_feature::
+          kGattAdvertisementCacheTtlMillis));
+}
 }  // namespace
 
 // Private c'tor for testing.
@@ -136,8 +144,7 @@ void DiscoveredPeripheralTracker::StartTracking(
   // Add service id hash to service id map for dct advertisement.
   if (include_dct_advertisement) {
     dct_service_id_hash_to_service_id_map_.insert_or_assign(
-        advertisements::ble::DctAdvertisement::ComputeServiceIdHash(service_id),
-        service_id);
+        ServiceIdIdentity::Get(service_id).GetDctServiceIdHash(), service_id);
   }
 
   // Clear all of the GATT read results. With this cleared, we will now attempt
@@ -154,7 +161,7 @@ void DiscoveredPeripheralTracker::StopTracking(const std::string& service_id) {
   MutexLock lock(&mutex_);
 
   dct_service_id_hash_to_service_id_map_.erase(
-      advertisements::ble::DctAdvertisement::ComputeServiceIdHash(service_id));
+      ServiceIdIdentity::Get(service_id).GetDctServiceIdHash());
   service_id_infos_.erase(service_id);
 }
 
@@ -765,6 +772,11 @@ void DiscoveredPeripheralTracker::HandleAdvertisementHeader(
     return;
   }
 
+  if (HandleCachedGattAdvertisements(peripheral, advertisement_header)) {
+    UpdateCommonStateForFoundBleAdvertisement(advertisement_header);
+    return;
+  }
+
   {
     MutexLock lock(&task_mutex_);
     // Check if the advertisement header is already in progress.
@@ -836,7 +848,8 @@ bool DiscoveredPeripheralTracker::IsInterestingAdvertisementHeader(
 
   for (const auto& item : service_id_infos_) {
     const std::string& service_id = item.first;
-    if (bloom_filter.PossiblyContains(service_id)) {
+    if (bloom_filter.PossiblyContains(
+            ServiceIdIdentity::Get(service_id).GetBloomFilterHashes())) {
       return true;
     }
   }
@@ -895,6 +908,81 @@ bool DiscoveredPeripheralTracker::ShouldReadRawAdvertisementFromServer(
   return true;
 }
 
+bool DiscoveredPeripheralTracker::HandleCachedGattAdvertisements(
+    BlePeripheral peripheral,
+    const BleAdvertisementHeader& advertisement_header) {
+  const auto it = gatt_advertisement_cache_.find(
+      std::string(advertisement_header.GetAdvertisementHash()));
+  if (it == gatt_advertisement_cache_.end()) {
+    return false;
+  }
+  if (SystemClock::ElapsedRealtime() - it->second.read_time >=
+      GetGattAdvertisementCacheTtl()) {
+    gatt_advertisement_cache_.erase(it);
+    return false;
+  }
+
+  // Replay the read. Slot numbers only matter for retrying a partial read,
+  // and cached reads were successful.
+  auto result = std::make_unique<mediums::AdvertisementReadResult>();
+  int slot = 0;
+  for (const ByteArray& gatt_advertisement :
+       it->second.gatt_advertisements) {
+    result->AddAdvertisement(slot++, gatt_advertisement);
+  }
+  result->RecordLastReadStatus(/*is_success=*/true);
+  std::vector<const ByteArray*> gatt_advertisement_bytes_list =
+      result->GetAdvertisements();
+  if (ParseRawGattAdvertisements(gatt_advertisement_bytes_list,
+                                 /*service_uuid=*/{})
+          .empty()) {
+    return false;
+  }
+
+  LOG(INFO) << "Using cached GATT advertisements for advertisement header "
+               "with hash "
+            << absl::BytesToHexString(
+                   advertisement_header.GetAdvertisementHash().AsStringView());
+  advertisement_read_results_.insert_or_assign(advertisement_header,
+                                               std::move(result));
+  HandleRawGattAdvertisements(peripheral, advertisement_header,
+                              gatt_advertisement_bytes_list,
+                              /*service_uuid=*/{});
+  return true;
+}
+
+void DiscoveredPeripheralTracker::CacheGattAdvertisements(
+    const BleAdvertisementHeader& advertisement_header,
+    const std::vector<const ByteArray*>& gatt_advertisement_bytes_list) {
+  absl::Duration ttl = GetGattAdvertisementCacheTtl();
+  if (ttl <= absl::ZeroDuration()) {
+    return;
+  }
+  absl::Time now = SystemClock::ElapsedRealtime();
+  if (gatt_advertisement_cache_.size() >= kMaxGattAdvertisementCacheSize) {
+    // Drop the expired entries, or the oldest one if none has expired.
+    absl::erase_if(gatt_advertisement_cache_, [now, ttl](const auto& entry) {
+      return now - entry.second.read_time >= ttl;
+    });
+    if (gatt_advertisement_cache_.size() >= kMaxGattAdvertisementCacheSize) {
+      gatt_advertisement_cache_.erase(std::min_element(
+          gatt_advertisement_cache_.begin(), gatt_advertisement_cache_.end(),
+          [](const auto& a, const auto& b) {
+            return a.second.read_time < b.second.read_time;
+          }));
+    }
+  }
+
+  CachedGattAdvertisements& cached =
+      gatt_advertisement_cache_[std::string(
+          advertisement_header.GetAdvertisementHash())];
+  cached.gatt_advertisements.clear();
+  for (const ByteArray* gatt_advertisement : gatt_advertisement_bytes_list) {
+    cached.gatt_advertisements.push_back(*gatt_advertisement);
+  }
+  cached.read_time = now;
+}
+
 std::vector<const ByteArray*>
 DiscoveredPeripheralTracker::FetchRawAdvertisements(
     BlePeripheral peripheral,
@@ -946,6 +1034,13 @@ void DiscoveredPeripheralTracker::FetchRawAdvertisementsInThread(
                         advertisement_header.GetPsm(), service_ids, *result);
   {
     MutexLock lock(&mutex_);
+    // The read is valid whatever is tracked now, so cache it first.
+    if (result->EvaluateRetryStatus() ==
+        AdvertisementReadResult::RetryStatus::kPreviouslySucceeded) {
+      CacheGattAdvertisements(advertisement_header,
+                              result->GetAdvertisements());
+    }
+
     // The fetching process might take a few seconds, and tracking settings
     // could change during that time. We need to double-check if the result
     // is still valid afterward.
@@ -277,6 +277,21 @@ class DiscoveredPeripheralTracker {
   //
   // advertisement_fetcher : a fetcher passed from BLE medium to read the
   // advertisement from BLE characteristics by GATT server.
+  // Handles the GATT advertisements cached for `advertisement_header` as if
+  // they were just read. Returns false if there are none, or none of them
+  // belong to a tracked service ID, in which case they must be read again.
+  bool HandleCachedGattAdvertisements(
+      BlePeripheral peripheral,
+      const BleAdvertisementHeader& advertisement_header)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Caches the GATT advertisements of a successful read of
+  // `advertisement_header`.
+  void CacheGattAdvertisements(
+      const BleAdvertisementHeader& advertisement_header,
+      const std::vector<const ByteArray*>& gatt_advertisement_bytes_list)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   std::vector<const ByteArray*> FetchRawAdvertisements(
       BlePeripheral peripheral,
       const BleAdvertisementHeader& advertisement_header,
@@ -382,6 +397,19 @@ class DiscoveredPeripheralTracker {
   std::optional<BleAdvertisementHeader> fetch_in_progress_header_
       ABSL_GUARDED_BY(task_mutex_);
 
+  // Maps an advertisement header's hash to the GATT advertisements read for
+  // it. The hash covers the advertisements, so they stay valid for as long as
+  // the header is seen. Unlike the maps above, entries survive StopTracking()
+  // and StartTracking(), so that rediscovering a peripheral does not need
+  // another GATT connection. Entries expire after
+  // kGattAdvertisementCacheTtlMillis.
+  struct CachedGattAdvertisements {
+    std::vector<ByteArray> gatt_advertisements;
+    absl::Time read_time;
+  };
+  absl::flat_hash_map<std::string, CachedGattAdvertisements>
+      gatt_advertisement_cache_ ABSL_GUARDED_BY(mutex_);
+
   // Maps an advertisement header's hash with the time it's reported lost.
   // Ignores subsequent discovery events for the same advertisement header.
   absl::flat_hash_map<std::string, absl::Time> lost_advertisment_infos_
@@ -30,6 +30,7 @@
 #include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
 #include "connections/implementation/mediums/advertisements/dct_advertisement.h"
 #include "connections/implementation/mediums/ble/advertisement_read_result.h"
 #include "connections/implementation/mediums/ble/ble_advertisement.h"
@@ -1613,6 +1614,100 @@ TEST_P(DiscoveredPeripheralTrackerTest, FetchGattAdvertisementInThread) {
   EXPECT_EQ(GetFetchAdvertisementCallbackCount(), 1);
 }
 
+TEST_P(DiscoveredPeripheralTrackerTest,
+       RediscoveryAfterRestartUsesCachedGattAdvertisements) {
+  std::vector<std::string> service_ids = {std::string(kServiceIdA)};
+  ByteArray advertisement_header_bytes = CreateBleAdvertisementHeader(
+      GenerateRandomAdvertisementHash(), service_ids);
+  ByteArray advertisement_bytes = CreateBleAdvertisement(
+      std::string(kServiceIdA), ByteArray(std::string(kData)),
+      ByteArray(std::string(kDeviceToken)));
+  CountDownLatch fetch_latch(1);
+  auto start_tracking = [&](CountDownLatch& latch) {
+    discovered_peripheral_tracker_->StartTracking(
+        std::string(kServiceIdA), false, Pcp::kP2pPointToPoint,
+        {
+            .peripheral_discovered_cb =
+                [&latch](BlePeripheral peripheral,
+                         const std::string& service_id,
+                         const ByteArray& advertisement_bytes,
+                         bool fast_advertisement) {
+                  EXPECT_EQ(advertisement_bytes,
+                            ByteArray(std::string(kData)));
+                  latch.CountDown();
+                },
+        },
+        {});
+  };
+  CountDownLatch found_latch(1);
+  start_tracking(found_latch);
+  discovered_peripheral_tracker_->StartFetchExecutorForTesting();
+
+  api::ble::BleAdvertisementData advertisement_data{};
+  advertisement_data.service_data.insert(
+      {bleutils::kCopresenceServiceUuid, advertisement_header_bytes});
+  FindAdvertisement(advertisement_data, {advertisement_bytes}, fetch_latch);
+  EXPECT_TRUE(fetch_latch.Await(kWaitDuration).ok());
+  EXPECT_TRUE(found_latch.Await(kWaitDuration).result());
+
+  // Restart discovery. The peripheral is reported again without reading its
+  // GATT advertisements.
+  discovered_peripheral_tracker_->StopTracking(std::string(kServiceIdA));
+  CountDownLatch refound_latch(1);
+  start_tracking(refound_latch);
+  FindAdvertisement(advertisement_data, {advertisement_bytes}, fetch_latch);
+
+  EXPECT_TRUE(refound_latch.Await(kWaitDuration).result());
+  EXPECT_EQ(GetFetchAdvertisementCallbackCount(), 1);
+}
+
+TEST_P(DiscoveredPeripheralTrackerTest,
+       RediscoveryAfterRestartReadsGattAdvertisementsIfCacheDisabled) {
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kGattAdvertisementCacheTtlMillis,
+      0);
+  std::vector<std::string> service_ids = {std::string(kServiceIdA)};
+  ByteArray advertisement_header_bytes = CreateBleAdvertisementHeader(
+      GenerateRandomAdvertisementHash(), service_ids);
+  ByteArray advertisement_bytes = CreateBleAdvertisement(
+      std::string(kServiceIdA), ByteArray(std::string(kData)),
+      ByteArray(std::string(kDeviceToken)));
+  CountDownLatch fetch_latch(2);
+  auto start_tracking = [&](CountDownLatch& latch) {
+    discovered_peripheral_tracker_->StartTracking(
+        std::string(kServiceIdA), false, Pcp::kP2pPointToPoint,
+        {
+            .peripheral_discovered_cb =
+                [&latch](BlePeripheral peripheral,
+                         const std::string& service_id,
+                         const ByteArray& advertisement_bytes,
+                         bool fast_advertisement) {
+                  latch.CountDown();
+                },
+        },
+        {});
+  };
+  CountDownLatch found_latch(1);
+  start_tracking(found_latch);
+  discovered_peripheral_tracker_->StartFetchExecutorForTesting();
+
+  api::ble::BleAdvertisementData advertisement_data{};
+  advertisement_data.service_data.insert(
+      {bleutils::kCopresenceServiceUuid, advertisement_header_bytes});
+  FindAdvertisement(advertisement_data, {advertisement_bytes}, fetch_latch);
+  EXPECT_TRUE(found_latch.Await(kWaitDuration).result());
+
+  discovered_peripheral_tracker_->StopTracking(std::string(kServiceIdA));
+  CountDownLatch refound_latch(1);
+  start_tracking(refound_latch);
+  FindAdvertisement(advertisement_data, {advertisement_bytes}, fetch_latch);
+
+  EXPECT_TRUE(fetch_latch.Await(kWaitDuration).ok());
+  EXPECT_TRUE(refound_latch.Await(kWaitDuration).result());
+  EXPECT_EQ(GetFetchAdvertisementCallbackCount(), 2);
+}
+
 TEST_P(DiscoveredPeripheralTrackerTest,
        IgnoreGattAdvertisementResultWhentrackingStoppedInThread) {
   std::vector<std::string> service_ids = {std::string(kServiceIdA)};
@@ -0,0 +1,116 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/mediums/multiplex/multiplex_frames.h"
+
+#include <string>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "connections/implementation/mediums/utils.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+#include "proto/mediums/multiplex_frames.pb.h"
+
+namespace nearby {
+namespace connections {
+namespace multiplex {
+
+namespace {
+
+MultiplexFrame CreateFrame(absl::string_view salted_service_id_hash,
+                           MultiplexFrame::MultiplexFrameType frame_type) {
+  MultiplexFrame frame;
+  frame.mutable_header()->set_salted_service_id_hash(
+      std::string(salted_service_id_hash));
+  frame.set_frame_type(frame_type);
+  return frame;
+}
+
+MultiplexControlFrame* CreateControlFrame(
+    MultiplexFrame& frame,
+    MultiplexControlFrame::MultiplexControlFrameType control_frame_type) {
+  MultiplexControlFrame* control_frame = frame.mutable_control_frame();
+  control_frame->set_control_frame_type(control_frame_type);
+  return control_frame;
+}
+
+}  // namespace
+
+std::string GenerateSaltedServiceIdHash(absl::string_view service_id,
+                                        absl::string_view salt) {
+  return std::string(Utils::Sha256Hash(absl::StrCat(service_id, salt),
+                                       kSaltedServiceIdHashLength));
+}
+
+std::string ForConnectionRequest(absl::string_view salted_service_id_hash,
+                                 absl::string_view salt) {
+  MultiplexFrame frame =
+      CreateFrame(salted_service_id_hash, MultiplexFrame::CONTROL_FRAME);
+  frame.mutable_header()->set_service_id_hash_salt(std::string(salt));
+  CreateControlFrame(frame, MultiplexControlFrame::CONNECTION_REQUEST)
+      ->mutable_connection_request_frame();
+  return frame.SerializeAsString();
+}
+
+std::string ForConnectionResponse(
+    absl::string_view salted_service_id_hash,
+    ConnectionResponseFrame::ConnectionResponseCode response_code) {
+  MultiplexFrame frame =
+      CreateFrame(salted_service_id_hash, MultiplexFrame::CONTROL_FRAME);
+  CreateControlFrame(frame, MultiplexControlFrame::CONNECTION_RESPONSE)
+      ->mutable_connection_response_frame()
+      ->set_connection_response_code(response_code);
+  return frame.SerializeAsString();
+}
+
+std::string ForDisconnection(absl::string_view salted_service_id_hash) {
+  MultiplexFrame frame =
+      CreateFrame(salted_service_id_hash, MultiplexFrame::CONTROL_FRAME);
+  CreateControlFrame(frame, MultiplexControlFrame::DISCONNECTION)
+      ->mutable_disconnect_frame();
+  return frame.SerializeAsString();
+}
+
+std::string ForWindowUpdate(absl::string_view salted_service_id_hash,
+                            int window_increment) {
+  MultiplexFrame frame =
+      CreateFrame(salted_service_id_hash, MultiplexFrame::CONTROL_FRAME);
+  CreateControlFrame(frame, MultiplexControlFrame::WINDOW_UPDATE)
+      ->mutable_window_update_frame()
+      ->set_window_increment(window_increment);
+  return frame.SerializeAsString();
+}
+
+std::string ForData(absl::string_view salted_service_id_hash,
+                    absl::string_view data) {
+  MultiplexFrame frame =
+      CreateFrame(salted_service_id_hash, MultiplexFrame::DATA_FRAME);
+  frame.mutable_data_frame()->set_data(std::string(data));
+  return frame.SerializeAsString();
+}
+
+ExceptionOr<MultiplexFrame> FromBytes(const ByteArray& bytes) {
+  MultiplexFrame frame;
+  if (!frame.ParseFromArray(bytes.data(), bytes.size()) ||
+      !frame.header().has_salted_service_id_hash()) {
+    return ExceptionOr<MultiplexFrame>(Exception::kInvalidProtocolBuffer);
+  }
+  return ExceptionOr<MultiplexFrame>(std::move(frame));
+}
+
+}  // namespace multiplex
+}  // namespace connections
+}  // namespace nearby
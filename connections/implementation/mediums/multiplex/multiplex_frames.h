@@ -0,0 +1,64 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_MEDIUMS_MULTIPLEX_MULTIPLEX_FRAMES_H_
+#define CORE_INTERNAL_MEDIUMS_MULTIPLEX_MULTIPLEX_FRAMES_H_
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+#include "proto/mediums/multiplex_frames.pb.h"
+
+namespace nearby {
+namespace connections {
+namespace multiplex {
+
+using ::location::nearby::mediums::ConnectionResponseFrame;
+using ::location::nearby::mediums::MultiplexControlFrame;
+using ::location::nearby::mediums::MultiplexFrame;
+
+// Length of the salted service id hash that identifies a virtual socket in
+// every frame.
+inline constexpr int kSaltedServiceIdHashLength = 32;
+
+// Returns the hash that identifies the virtual socket opened for `service_id`
+// with `salt`. A new salt is generated for every virtual socket, so that
+// several virtual sockets can be opened for the same service id.
+std::string GenerateSaltedServiceIdHash(absl::string_view service_id,
+                                        absl::string_view salt);
+
+// Serialized MultiplexFrames, ready to be written to the physical socket.
+std::string ForConnectionRequest(absl::string_view salted_service_id_hash,
+                                 absl::string_view salt);
+std::string ForConnectionResponse(
+    absl::string_view salted_service_id_hash,
+    ConnectionResponseFrame::ConnectionResponseCode response_code);
+std::string ForDisconnection(absl::string_view salted_service_id_hash);
+std::string ForWindowUpdate(absl::string_view salted_service_id_hash,
+                            int window_increment);
+std::string ForData(absl::string_view salted_service_id_hash,
+                    absl::string_view data);
+
+// Parses a MultiplexFrame. Returns Exception::kInvalidProtocolBuffer if
+// `bytes` is not a valid frame, or if the frame has no salted service id
+// hash.
+ExceptionOr<MultiplexFrame> FromBytes(const ByteArray& bytes);
+
+}  // namespace multiplex
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_MEDIUMS_MULTIPLEX_MULTIPLEX_FRAMES_H_
@@ -0,0 +1,542 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/mediums/multiplex/multiplex_socket.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "connections/implementation/mediums/multiplex/multiplex_frames.h"
+#include "connections/implementation/mediums/utils.h"
+#include "internal/platform/base64_utils.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/feature_flags.h"
+#include "internal/platform/input_stream.h"
+#include "internal/platform/logging.h"
+#include "internal/platform/mutex_lock.h"
+#include "internal/platform/output_stream.h"
+#include "internal/platform/socket.h"
+
+namespace nearby {
+namespace connections {
+namespace multiplex {
+
+std::unique_ptr<MultiplexSocket> MultiplexSocket::CreateOutgoing(
+    std::unique_ptr<MediumSocket> physical_socket) {
+  std::unique_ptr<MultiplexSocket> multiplex_socket(
+      new MultiplexSocket(std::move(physical_socket), /*is_outgoing=*/true,
+                          /*resolver=*/nullptr, /*callback=*/nullptr));
+  multiplex_socket->Start();
+  return multiplex_socket;
+}
+
+std::unique_ptr<MultiplexSocket> MultiplexSocket::CreateIncoming(
+    std::unique_ptr<MediumSocket> physical_socket, ServiceIdResolver resolver,
+    IncomingSocketCallback callback) {
+  std::unique_ptr<MultiplexSocket> multiplex_socket(new MultiplexSocket(
+      std::move(physical_socket), /*is_outgoing=*/false, std::move(resolver),
+      std::move(callback)));
+  multiplex_socket->Start();
+  return multiplex_socket;
+}
+
+MultiplexSocket::MultiplexSocket(std::unique_ptr<MediumSocket> physical_socket,
+                                 bool is_outgoing, ServiceIdResolver resolver,
+                                 IncomingSocketCallback callback)
+    : is_outgoing_(is_outgoing),
+      resolver_(std::move(resolver)),
+      incoming_socket_callback_(std::move(callback)),
+      physical_socket_(std::move(physical_socket)) {}
+
+MultiplexSocket::~MultiplexSocket() {
+  Shutdown();
+  reader_.Shutdown();
+  writer_.Shutdown();
+}
+
+void MultiplexSocket::Start() {
+  reader_.Execute("multiplex-read", [this]() { RunReadLoop(); });
+  writer_.Execute("multiplex-write", [this]() { RunWriteLoop(); });
+}
+
+std::shared_ptr<MediumSocket> MultiplexSocket::EstablishVirtualSocket(
+    const std::string& service_id) {
+  std::string salt = Utils::GenerateSalt();
+  std::string salted_service_id_hash =
+      GenerateSaltedServiceIdHash(service_id, salt);
+
+  MutexLock lock(&mutex_);
+  if (closed_) {
+    return nullptr;
+  }
+  close_when_drained_ = false;
+  pending_requests_[salted_service_id_hash] = PendingRequest();
+  QueueControlFrameLocked(ForConnectionRequest(salted_service_id_hash, salt));
+
+  absl::Time deadline =
+      absl::Now() + FeatureFlags::GetInstance()
+                        .GetFlags()
+                        .multiplex_socket_connection_response_timeout_millis;
+  while (!closed_ && !pending_requests_[salted_service_id_hash].responded) {
+    absl::Duration timeout = deadline - absl::Now();
+    if (timeout <= absl::ZeroDuration()) {
+      break;
+    }
+    cond_.Wait(timeout);
+  }
+  bool accepted = pending_requests_[salted_service_id_hash].accepted;
+  pending_requests_.erase(salted_service_id_hash);
+  if (closed_ || !accepted) {
+    LOG(INFO) << "Multiplex: failed to open virtual socket for service_id="
+              << service_id;
+    if (is_outgoing_ && virtual_socket_infos_.empty() &&
+        pending_requests_.empty()) {
+      close_when_drained_ = true;
+      cond_.Notify();
+    }
+    return nullptr;
+  }
+  LOG(INFO) << "Multiplex: opened virtual socket for service_id="
+            << service_id;
+  return virtual_sockets_[salted_service_id_hash];
+}
+
+bool MultiplexSocket::IsEnabled() const {
+  MutexLock lock(&mutex_);
+  return !closed_;
+}
+
+int MultiplexSocket::GetVirtualSocketCount() const {
+  MutexLock lock(&mutex_);
+  return virtual_socket_infos_.size();
+}
+
+void MultiplexSocket::Shutdown() {
+  MutexLock lock(&mutex_);
+  CloseLocked();
+}
+
+void MultiplexSocket::RunReadLoop() {
+  InputStream& input_stream = physical_socket_->GetInputStream();
+  const std::int32_t max_frame_length =
+      FeatureFlags::GetInstance().GetFlags().connection_max_frame_length;
+  while (true) {
+    ExceptionOr<std::int32_t> frame_length =
+        Base64Utils::ReadInt(&input_stream);
+    if (!frame_length.ok() || frame_length.result() < 0 ||
+        frame_length.result() > max_frame_length) {
+      break;
+    }
+    ExceptionOr<ByteArray> bytes =
+        input_stream.ReadExactly(frame_length.result());
+    if (!bytes.ok()) {
+      break;
+    }
+    ExceptionOr<MultiplexFrame> frame = FromBytes(bytes.result());
+    if (!frame.ok()) {
+      LOG(WARNING) << "Multiplex: dropping invalid frame.";
+      continue;
+    }
+    switch (frame.result().frame_type()) {
+      case MultiplexFrame::CONTROL_FRAME:
+        HandleControlFrame(frame.result());
+        break;
+      case MultiplexFrame::DATA_FRAME:
+        HandleData(frame.result().header().salted_service_id_hash(),
+                   frame.result().data_frame().data());
+        break;
+      default:
+        LOG(WARNING) << "Multiplex: dropping frame of unknown type "
+                     << frame.result().frame_type();
+        break;
+    }
+  }
+  LOG(INFO) << "Multiplex: stopped reading from the physical socket.";
+  MutexLock lock(&mutex_);
+  CloseLocked();
+}
+
+void MultiplexSocket::RunWriteLoop() {
+  OutputStream& output_stream = physical_socket_->GetOutputStream();
+  while (true) {
+    std::string frame;
+    {
+      MutexLock lock(&mutex_);
+      while (!closed_ && control_frames_.empty() && writer_turns_.empty() &&
+             !close_when_drained_) {
+        cond_.Wait();
+      }
+      if (closed_) {
+        return;
+      }
+      if (!control_frames_.empty()) {
+        frame = std::move(control_frames_.front());
+        control_frames_.pop_front();
+      } else if (!writer_turns_.empty()) {
+        std::string salted_service_id_hash = std::move(writer_turns_.front());
+        writer_turns_.pop_front();
+        std::deque<std::string>& frames = data_frames_[salted_service_id_hash];
+        frame = std::move(frames.front());
+        frames.pop_front();
+        if (frames.empty()) {
+          data_frames_.erase(salted_service_id_hash);
+        } else {
+          writer_turns_.push_back(std::move(salted_service_id_hash));
+        }
+        // Makes room for a blocked QueueDataFrame().
+        cond_.Notify();
+      } else {
+        LOG(INFO) << "Multiplex: all virtual sockets are closed; closing the "
+                     "physical socket.";
+        CloseLocked();
+        return;
+      }
+    }
+    if (!Base64Utils::WriteInt(&output_stream, frame.size()).Ok() ||
+        !output_stream.Write(frame).Ok() || !output_stream.Flush().Ok()) {
+      LOG(WARNING) << "Multiplex: failed to write to the physical socket.";
+      MutexLock lock(&mutex_);
+      CloseLocked();
+      return;
+    }
+  }
+}
+
+void MultiplexSocket::HandleControlFrame(const MultiplexFrame& frame) {
+  const std::string& salted_service_id_hash =
+      frame.header().salted_service_id_hash();
+  const MultiplexControlFrame& control_frame = frame.control_frame();
+  switch (control_frame.control_frame_type()) {
+    case MultiplexControlFrame::CONNECTION_REQUEST:
+      HandleConnectionRequest(salted_service_id_hash,
+                              frame.header().service_id_hash_salt());
+      break;
+    case MultiplexControlFrame::CONNECTION_RESPONSE:
+      HandleConnectionResponse(
+          salted_service_id_hash,
+          control_frame.connection_response_frame().connection_response_code());
+      break;
+    case MultiplexControlFrame::DISCONNECTION:
+      HandleDisconnection(salted_service_id_hash);
+      break;
+    case MultiplexControlFrame::WINDOW_UPDATE:
+      HandleWindowUpdate(
+          salted_service_id_hash,
+          control_frame.window_update_frame().window_increment());
+      break;
+    default:
+      LOG(WARNING) << "Multiplex: dropping control frame of unknown type "
+                   << control_frame.control_frame_type();
+      break;
+  }
+}
+
+void MultiplexSocket::HandleConnectionRequest(
+    const std::string& salted_service_id_hash, const std::string& salt) {
+  std::string service_id =
+      resolver_ ? resolver_(salted_service_id_hash, salt) : "";
+  std::shared_ptr<MediumSocket> virtual_socket;
+  {
+    MutexLock lock(&mutex_);
+    if (closed_) {
+      return;
+    }
+    if (!service_id.empty() &&
+        !virtual_sockets_.contains(salted_service_id_hash)) {
+      virtual_socket = CreateVirtualSocketLocked(salted_service_id_hash);
+    }
+    QueueControlFrameLocked(ForConnectionResponse(
+        salted_service_id_hash, virtual_socket != nullptr
+                                    ? ConnectionResponseFrame::CONNECTION_ACCEPTED
+                                    : ConnectionResponseFrame::NOT_LISTENING));
+  }
+  if (virtual_socket == nullptr) {
+    LOG(INFO) << "Multiplex: rejected virtual socket request; not listening.";
+    return;
+  }
+  LOG(INFO) << "Multiplex: accepted virtual socket for service_id="
+            << service_id;
+  incoming_socket_callback_(service_id, std::move(virtual_socket));
+}
+
+void MultiplexSocket::HandleConnectionResponse(
+    const std::string& salted_service_id_hash,
+    ConnectionResponseFrame::ConnectionResponseCode response_code) {
+  MutexLock lock(&mutex_);
+  auto it = pending_requests_.find(salted_service_id_hash);
+  if (it == pending_requests_.end()) {
+    // The request timed out. Close the virtual socket the remote device opened
+    // for it.
+    if (response_code == ConnectionResponseFrame::CONNECTION_ACCEPTED &&
+        !closed_) {
+      QueueControlFrameLocked(ForDisconnection(salted_service_id_hash));
+    }
+    return;
+  }
+  it->second.responded = true;
+  it->second.accepted =
+      response_code == ConnectionResponseFrame::CONNECTION_ACCEPTED &&
+      CreateVirtualSocketLocked(salted_service_id_hash) != nullptr;
+  cond_.Notify();
+}
+
+void MultiplexSocket::HandleDisconnection(
+    const std::string& salted_service_id_hash) {
+  MutexLock lock(&mutex_);
+  auto it = virtual_sockets_.find(salted_service_id_hash);
+  if (it == virtual_sockets_.end()) {
+    return;
+  }
+  LOG(INFO) << "Multiplex: remote device closed a virtual socket.";
+  VirtualSocketInfo& info = virtual_socket_infos_[salted_service_id_hash];
+  info.closed = true;
+  cond_.Notify();
+  // The input stream is closed behind the data still to be fed to it.
+  std::shared_ptr<MediumSocket> virtual_socket = it->second;
+  if (info.incoming == nullptr) {
+    virtual_socket->GetInputStream().Close();
+    return;
+  }
+  info.incoming->executor.Execute(
+      "multiplex-deliver", [virtual_socket = std::move(virtual_socket)]() {
+        virtual_socket->GetInputStream().Close();
+      });
+}
+
+void MultiplexSocket::HandleWindowUpdate(
+    const std::string& salted_service_id_hash, int window_increment) {
+  if (window_increment <= 0) {
+    LOG(WARNING) << "Multiplex: dropping invalid window update of "
+                 << window_increment << " bytes.";
+    return;
+  }
+  MutexLock lock(&mutex_);
+  auto info = virtual_socket_infos_.find(salted_service_id_hash);
+  if (info == virtual_socket_infos_.end()) {
+    return;
+  }
+  info->second.send_window += window_increment;
+  // Wakes up a QueueDataFrame() waiting for window.
+  cond_.Notify();
+}
+
+void MultiplexSocket::HandleData(const std::string& salted_service_id_hash,
+                                 const std::string& data) {
+  MutexLock lock(&mutex_);
+  auto it = virtual_sockets_.find(salted_service_id_hash);
+  if (it == virtual_sockets_.end() ||
+      virtual_socket_infos_[salted_service_id_hash].closed) {
+    VLOG(1) << "Multiplex: dropping data for a closed virtual socket.";
+    return;
+  }
+  std::shared_ptr<MediumSocket> virtual_socket = it->second;
+  IncomingDelivery* incoming =
+      virtual_socket_infos_[salted_service_id_hash].incoming.get();
+  if (incoming->pending_bytes + incoming->unannounced_bytes +
+          static_cast<std::int64_t>(data.size()) >
+      kWindowSize) {
+    // The remote device sent more than its window. Waiting for room would
+    // stall every other virtual socket, so close this one alone.
+    LOG(WARNING) << "Multiplex: closing a virtual socket whose remote device "
+                    "exceeded its window; "
+                 << incoming->pending_bytes << " bytes are pending.";
+    CloseVirtualOutputStreamLocked(salted_service_id_hash);
+    virtual_socket->GetInputStream().Close();
+    return;
+  }
+  incoming->pending_bytes += data.size();
+  incoming->executor.Execute(
+      "multiplex-deliver",
+      [this, incoming, salted_service_id_hash,
+       virtual_socket = std::move(virtual_socket),
+       bytes = ByteArray(data)]() mutable {
+        std::int64_t size = bytes.size();
+        // Blocks while the input stream of the virtual socket is full.
+        virtual_socket->FeedIncomingData(std::move(bytes));
+        OnIncomingDataFed(salted_service_id_hash, incoming, size);
+      });
+}
+
+void MultiplexSocket::OnIncomingDataFed(
+    const std::string& salted_service_id_hash, IncomingDelivery* incoming,
+    std::int64_t size) {
+  MutexLock lock(&mutex_);
+  incoming->pending_bytes -= size;
+  incoming->unannounced_bytes += size;
+  if (incoming->unannounced_bytes < kWindowUpdateThreshold || closed_) {
+    return;
+  }
+  auto info = virtual_socket_infos_.find(salted_service_id_hash);
+  if (info == virtual_socket_infos_.end() || info->second.closed) {
+    return;
+  }
+  QueueControlFrameLocked(
+      ForWindowUpdate(salted_service_id_hash, incoming->unannounced_bytes));
+  incoming->unannounced_bytes = 0;
+}
+
+std::shared_ptr<MediumSocket> MultiplexSocket::CreateVirtualSocketLocked(
+    const std::string& salted_service_id_hash) {
+  auto output_stream =
+      std::make_unique<VirtualOutputStream>(this, salted_service_id_hash);
+  MediumSocket* virtual_socket = physical_socket_->CreateVirtualSocket(
+      salted_service_id_hash, output_stream.get(),
+      physical_socket_->GetMedium(), &virtual_sockets_);
+  if (virtual_socket == nullptr || virtual_socket == physical_socket_.get()) {
+    LOG(WARNING) << "Multiplex: the physical socket doesn't support virtual "
+                    "sockets.";
+    return nullptr;
+  }
+  virtual_socket->AddOnSocketClosedListener(
+      std::make_unique<absl::AnyInvocable<void()>>(
+          [this, salted_service_id_hash]() {
+            OnVirtualSocketClosed(salted_service_id_hash);
+          }));
+  VirtualSocketInfo& info = virtual_socket_infos_[salted_service_id_hash];
+  info.output_stream = std::move(output_stream);
+  info.incoming = std::make_unique<IncomingDelivery>();
+  return virtual_sockets_[salted_service_id_hash];
+}
+
+Exception MultiplexSocket::QueueDataFrame(
+    const std::string& salted_service_id_hash, std::string frame,
+    std::int64_t data_size) {
+  const size_t capacity = FeatureFlags::GetInstance()
+                           .GetFlags()
+                           .multiplex_socket_middle_priority_queue_capacity;
+  MutexLock lock(&mutex_);
+  while (true) {
+    auto info = virtual_socket_infos_.find(salted_service_id_hash);
+    if (closed_ || info == virtual_socket_infos_.end() || info->second.closed) {
+      return {Exception::kIo};
+    }
+    auto frames = data_frames_.find(salted_service_id_hash);
+    if ((frames == data_frames_.end() || frames->second.size() < capacity) &&
+        info->second.send_window >= data_size) {
+      info->second.send_window -= data_size;
+      break;
+    }
+    cond_.Wait();
+  }
+  std::deque<std::string>& frames = data_frames_[salted_service_id_hash];
+  if (frames.empty()) {
+    writer_turns_.push_back(salted_service_id_hash);
+  }
+  frames.push_back(std::move(frame));
+  cond_.Notify();
+  return {Exception::kSuccess};
+}
+
+void MultiplexSocket::QueueControlFrameLocked(std::string frame) {
+  control_frames_.push_back(std::move(frame));
+  cond_.Notify();
+}
+
+void MultiplexSocket::CloseVirtualOutputStream(
+    const std::string& salted_service_id_hash) {
+  MutexLock lock(&mutex_);
+  CloseVirtualOutputStreamLocked(salted_service_id_hash);
+}
+
+void MultiplexSocket::CloseVirtualOutputStreamLocked(
+    const std::string& salted_service_id_hash) {
+  auto info = virtual_socket_infos_.find(salted_service_id_hash);
+  if (info == virtual_socket_infos_.end() || info->second.closed) {
+    return;
+  }
+  info->second.closed = true;
+  cond_.Notify();
+  if (closed_) {
+    return;
+  }
+  std::deque<std::string>& frames = data_frames_[salted_service_id_hash];
+  if (frames.empty()) {
+    writer_turns_.push_back(salted_service_id_hash);
+  }
+  frames.push_back(ForDisconnection(salted_service_id_hash));
+}
+
+void MultiplexSocket::OnVirtualSocketClosed(
+    const std::string& salted_service_id_hash) {
+  CloseVirtualOutputStream(salted_service_id_hash);
+  std::unique_ptr<IncomingDelivery> incoming;
+  {
+    MutexLock lock(&mutex_);
+    virtual_sockets_.erase(salted_service_id_hash);
+    auto info = virtual_socket_infos_.find(salted_service_id_hash);
+    if (info != virtual_socket_infos_.end()) {
+      incoming = std::move(info->second.incoming);
+      virtual_socket_infos_.erase(info);
+    }
+    if (is_outgoing_ && virtual_socket_infos_.empty() &&
+        pending_requests_.empty()) {
+      close_when_drained_ = true;
+      cond_.Notify();
+    }
+  }
+  // Destroyed without the lock, since its pending deliveries take it. They
+  // don't block, as the input stream of the virtual socket is closed.
+  incoming.reset();
+}
+
+void MultiplexSocket::CloseLocked() {
+  if (closed_) {
+    return;
+  }
+  closed_ = true;
+  for (auto& [salted_service_id_hash, virtual_socket] : virtual_sockets_) {
+    virtual_socket->GetInputStream().Close();
+  }
+  for (auto& [salted_service_id_hash, info] : virtual_socket_infos_) {
+    info.closed = true;
+  }
+  control_frames_.clear();
+  data_frames_.clear();
+  writer_turns_.clear();
+  cond_.Notify();
+  physical_socket_->Close();
+}
+
+Exception MultiplexSocket::VirtualOutputStream::Write(absl::string_view data) {
+  // Copied, since the virtual socket may be closed from another thread while
+  // this write waits for room in the queue.
+  MultiplexSocket* multiplex_socket = multiplex_socket_;
+  std::string salted_service_id_hash = salted_service_id_hash_;
+  for (size_t offset = 0; offset < data.size(); offset += kMaxDataFrameSize) {
+    absl::string_view frame_data = data.substr(offset, kMaxDataFrameSize);
+    Exception exception = multiplex_socket->QueueDataFrame(
+        salted_service_id_hash, ForData(salted_service_id_hash, frame_data),
+        frame_data.size());
+    if (!exception.Ok()) {
+      return exception;
+    }
+  }
+  return {Exception::kSuccess};
+}
+
+Exception MultiplexSocket::VirtualOutputStream::Close() {
+  multiplex_socket_->CloseVirtualOutputStream(salted_service_id_hash_);
+  return {Exception::kSuccess};
+}
+
+}  // namespace multiplex
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,265 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_MEDIUMS_MULTIPLEX_MULTIPLEX_SOCKET_H_
+#define CORE_INTERNAL_MEDIUMS_MULTIPLEX_MULTIPLEX_SOCKET_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/strings/string_view.h"
+#include "connections/implementation/mediums/multiplex/multiplex_frames.h"
+#include "internal/platform/condition_variable.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/output_stream.h"
+#include "internal/platform/single_thread_executor.h"
+#include "internal/platform/socket.h"
+
+namespace nearby {
+namespace connections {
+namespace multiplex {
+
+// Carries several virtual sockets over one physical socket, so that a second
+// connection to an already connected device does not need a new physical
+// connection.
+//
+// Every frame on the physical socket is a MultiplexFrame, preceded by its
+// length as a 4-byte big-endian integer. Frames name their virtual socket by
+// its salted service id hash.
+//
+// Outgoing frames are queued per virtual socket, and a single writer thread
+// takes one frame from each virtual socket in turn, so that a large transfer
+// on one virtual socket does not hold back the others. A write blocks once
+// its virtual socket has `multiplex_socket_middle_priority_queue_capacity`
+// frames queued, without affecting the other virtual sockets.
+//
+// Each direction of a virtual socket has its own flow control window of
+// `kWindowSize` bytes. Data frames use up the window of their sender, and the
+// receiver sends a WINDOW_UPDATE frame once its virtual socket has consumed a
+// part of the data. A write blocks while its virtual socket has no window
+// left, so a virtual socket that is read slowly throttles its own writer
+// without affecting the others. Devices only advertise the multiplex TXT
+// record if they speak this protocol, so the window needs no negotiation.
+//
+// Incoming data is handed to each virtual socket by a thread of its own, so
+// the read loop never waits for a virtual socket that is read slowly. A remote
+// device that sends more than the window allows is misbehaving, and the
+// virtual socket is closed instead of buffering without bounds.
+//
+// Only WifiLan links are multiplexed so far. Bluetooth links are not, even
+// with `kEnableMultiplexBluetooth` set.
+//
+// The MultiplexSocket must outlive its virtual sockets: they have to be
+// closed before it is destroyed.
+class MultiplexSocket {
+ public:
+  // Returns the service id that `salted_service_id_hash` was generated from
+  // with `salt`, or an empty string if incoming connections are not accepted
+  // for it.
+  using ServiceIdResolver = absl::AnyInvocable<std::string(
+      absl::string_view salted_service_id_hash, absl::string_view salt)>;
+
+  // Called from the read loop with every virtual socket opened by the remote
+  // device.
+  using IncomingSocketCallback = absl::AnyInvocable<void(
+      const std::string& service_id,
+      std::shared_ptr<MediumSocket> virtual_socket)>;
+
+  // Largest amount of data carried by one data frame. Larger writes are split,
+  // so that virtual sockets take turns at this granularity.
+  static constexpr int kMaxDataFrameSize = 32 * 1024;
+
+  // Initial flow control window of each direction of a virtual socket. Must
+  // match the window in WindowUpdateFrame.
+  static constexpr std::int64_t kWindowSize = 4 * 1024 * 1024;
+
+  // Incoming data consumed before a WINDOW_UPDATE frame is sent for it.
+  static constexpr std::int64_t kWindowUpdateThreshold = kWindowSize / 4;
+
+  // Multiplexes a physical socket that this device connected. The physical
+  // socket is closed once its last virtual socket is closed.
+  static std::unique_ptr<MultiplexSocket> CreateOutgoing(
+      std::unique_ptr<MediumSocket> physical_socket);
+
+  // Multiplexes a physical socket that the remote device connected, and
+  // accepts virtual sockets for the service ids known to `resolver`.
+  static std::unique_ptr<MultiplexSocket> CreateIncoming(
+      std::unique_ptr<MediumSocket> physical_socket,
+      ServiceIdResolver resolver, IncomingSocketCallback callback);
+
+  MultiplexSocket(const MultiplexSocket&) = delete;
+  MultiplexSocket& operator=(const MultiplexSocket&) = delete;
+  ~MultiplexSocket();
+
+  // Opens a virtual socket to `service_id` on the remote device. Blocks until
+  // the remote device accepts or rejects it, or for at most
+  // `multiplex_socket_connection_response_timeout_millis`. Returns nullptr on
+  // failure.
+  std::shared_ptr<MediumSocket> EstablishVirtualSocket(
+      const std::string& service_id) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns false once the physical socket is closed.
+  bool IsEnabled() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the number of virtual sockets that are not closed locally yet.
+  int GetVirtualSocketCount() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Closes the physical socket. All virtual sockets stop reading and writing.
+  void Shutdown() ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  // The output stream of a virtual socket. Wraps writes in data frames.
+  class VirtualOutputStream : public OutputStream {
+   public:
+    VirtualOutputStream(MultiplexSocket* multiplex_socket,
+                        std::string salted_service_id_hash)
+        : multiplex_socket_(multiplex_socket),
+          salted_service_id_hash_(std::move(salted_service_id_hash)) {}
+
+    Exception Write(absl::string_view data) override;
+    Exception Flush() override { return {Exception::kSuccess}; }
+    Exception Close() override;
+
+   private:
+    MultiplexSocket* multiplex_socket_;
+    std::string salted_service_id_hash_;
+  };
+
+  // Feeds incoming data to the input stream of a virtual socket.
+  struct IncomingDelivery {
+    // Bytes received and not fed yet. Guarded by `mutex_`.
+    std::int64_t pending_bytes = 0;
+    // Bytes fed and not announced in a WINDOW_UPDATE frame yet. Guarded by
+    // `mutex_`.
+    std::int64_t unannounced_bytes = 0;
+    SingleThreadExecutor executor;
+  };
+
+  struct VirtualSocketInfo {
+    std::unique_ptr<VirtualOutputStream> output_stream;
+    std::unique_ptr<IncomingDelivery> incoming;
+    // Bytes this device may still send before the remote device announces
+    // more.
+    std::int64_t send_window = kWindowSize;
+    // Set once this device or the remote device closed the virtual socket.
+    // No more data frames are sent after that.
+    bool closed = false;
+  };
+
+  struct PendingRequest {
+    bool responded = false;
+    bool accepted = false;
+  };
+
+  MultiplexSocket(std::unique_ptr<MediumSocket> physical_socket,
+                  bool is_outgoing, ServiceIdResolver resolver,
+                  IncomingSocketCallback callback);
+
+  void Start();
+  void RunReadLoop();
+  void RunWriteLoop();
+  void HandleControlFrame(const MultiplexFrame& frame)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  void HandleConnectionRequest(const std::string& salted_service_id_hash,
+                               const std::string& salt)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  void HandleConnectionResponse(
+      const std::string& salted_service_id_hash,
+      ConnectionResponseFrame::ConnectionResponseCode response_code)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  void HandleDisconnection(const std::string& salted_service_id_hash)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  void HandleWindowUpdate(const std::string& salted_service_id_hash,
+                          int window_increment) ABSL_LOCKS_EXCLUDED(mutex_);
+  void HandleData(const std::string& salted_service_id_hash,
+                  const std::string& data) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Creates the virtual socket for `salted_service_id_hash`. Returns nullptr
+  // if the physical socket does not support virtual sockets.
+  std::shared_ptr<MediumSocket> CreateVirtualSocketLocked(
+      const std::string& salted_service_id_hash)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Queues `frame`, which carries `data_size` bytes of data, behind the frames
+  // already queued for the virtual socket. Blocks while the queue is full or
+  // the window of the virtual socket is too small.
+  Exception QueueDataFrame(const std::string& salted_service_id_hash,
+                           std::string frame, std::int64_t data_size)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  // Records that `size` bytes were fed to the virtual socket, and announces
+  // them to the remote device once enough have been.
+  void OnIncomingDataFed(const std::string& salted_service_id_hash,
+                         IncomingDelivery* incoming, std::int64_t size)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  // Queues a control frame. Control frames are sent before data frames.
+  void QueueControlFrameLocked(std::string frame)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Sends the DISCONNECTION frame for a virtual socket that this device
+  // closed, behind any data still queued for it.
+  void CloseVirtualOutputStream(const std::string& salted_service_id_hash)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  void CloseVirtualOutputStreamLocked(const std::string& salted_service_id_hash)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void OnVirtualSocketClosed(const std::string& salted_service_id_hash)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Closes the physical socket and the input streams of all virtual sockets.
+  void CloseLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const bool is_outgoing_;
+  ServiceIdResolver resolver_;
+  IncomingSocketCallback incoming_socket_callback_;
+
+  mutable Mutex mutex_;
+  // Notified whenever the state guarded by `mutex_` changes.
+  ConditionVariable cond_{&mutex_};
+  std::unique_ptr<MediumSocket> physical_socket_;
+  bool closed_ ABSL_GUARDED_BY(mutex_) = false;
+  // Set on an outgoing link once its last virtual socket is closed. The
+  // physical socket is closed when the queued frames are written.
+  bool close_when_drained_ ABSL_GUARDED_BY(mutex_) = false;
+
+  // Virtual sockets by salted service id hash. `virtual_sockets_` is filled
+  // in by MediumSocket::CreateVirtualSocket().
+  absl::flat_hash_map<std::string, std::shared_ptr<MediumSocket>>
+      virtual_sockets_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, VirtualSocketInfo> virtual_socket_infos_
+      ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, PendingRequest> pending_requests_
+      ABSL_GUARDED_BY(mutex_);
+
+  // Frames waiting for the writer. `data_frames_` only has entries for
+  // virtual sockets with queued frames, in the order they are served.
+  std::deque<std::string> control_frames_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, std::deque<std::string>> data_frames_
+      ABSL_GUARDED_BY(mutex_);
+  std::deque<std::string> writer_turns_ ABSL_GUARDED_BY(mutex_);
+
+  SingleThreadExecutor reader_;
+  SingleThreadExecutor writer_;
+};
+
+}  // namespace multiplex
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_MEDIUMS_MULTIPLEX_MULTIPLEX_SOCKET_H_
@@ -0,0 +1,355 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/mediums/multiplex/multiplex_socket.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "connections/implementation/mediums/multiplex/multiplex_frames.h"
+#include "internal/flags/nearby_flags.h"
+#include "internal/platform/base64_utils.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/implementation/wifi_lan.h"
+#include "internal/platform/input_stream.h"
+#include "internal/platform/output_stream.h"
+#include "internal/platform/pipe.h"
+#include "internal/platform/single_thread_executor.h"
+#include "internal/platform/socket.h"
+#include "internal/platform/wifi_lan.h"
+
+namespace nearby {
+namespace connections {
+namespace multiplex {
+namespace {
+
+constexpr absl::string_view kServiceId = "service";
+constexpr absl::string_view kOtherServiceId = "other-service";
+constexpr absl::Duration kWaitDuration = absl::Seconds(5);
+
+// One end of an in-memory WifiLan connection.
+class PipeWifiLanSocket : public api::WifiLanSocket {
+ public:
+  PipeWifiLanSocket(std::unique_ptr<InputStream> input_stream,
+                    std::unique_ptr<OutputStream> output_stream)
+      : input_stream_(std::move(input_stream)),
+        output_stream_(std::move(output_stream)) {}
+
+  InputStream& GetInputStream() override { return *input_stream_; }
+  OutputStream& GetOutputStream() override { return *output_stream_; }
+  Exception Close() override {
+    input_stream_->Close();
+    output_stream_->Close();
+    return {Exception::kSuccess};
+  }
+
+ private:
+  std::unique_ptr<InputStream> input_stream_;
+  std::unique_ptr<OutputStream> output_stream_;
+};
+
+class MultiplexSocketTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    NearbyFlags::GetInstance().OverrideBoolFlagValue(
+        config_package_nearby::nearby_connections_feature::
+            kEnableMultiplexWifiLan,
+        true);
+    auto [outgoing_input, incoming_output] = CreatePipe();
+    auto [incoming_input, outgoing_output] = CreatePipe();
+    outgoing_ = MultiplexSocket::CreateOutgoing(
+        std::make_unique<WifiLanSocket>(std::make_unique<PipeWifiLanSocket>(
+            std::move(outgoing_input), std::move(outgoing_output))));
+    incoming_ = MultiplexSocket::CreateIncoming(
+        std::make_unique<WifiLanSocket>(std::make_unique<PipeWifiLanSocket>(
+            std::move(incoming_input), std::move(incoming_output))),
+        [](absl::string_view salted_service_id_hash, absl::string_view salt) {
+          if (salted_service_id_hash ==
+              GenerateSaltedServiceIdHash(kServiceId, salt)) {
+            return std::string(kServiceId);
+          }
+          return std::string();
+        },
+        [this](const std::string& service_id,
+               std::shared_ptr<MediumSocket> virtual_socket) {
+          absl::MutexLock lock(&mutex_);
+          EXPECT_EQ(service_id, kServiceId);
+          incoming_virtual_sockets_.push_back(std::move(virtual_socket));
+        });
+  }
+
+  void TearDown() override {
+    outgoing_.reset();
+    incoming_.reset();
+    NearbyFlags::GetInstance().ResetOverridedValues();
+  }
+
+  std::shared_ptr<MediumSocket> GetIncomingVirtualSocket(int index) {
+    absl::MutexLock lock(&mutex_);
+    auto has_socket = [this, index]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+      return incoming_virtual_sockets_.size() > index;
+    };
+    if (!mutex_.AwaitWithTimeout(absl::Condition(&has_socket),
+                                 kWaitDuration)) {
+      return nullptr;
+    }
+    return incoming_virtual_sockets_[index];
+  }
+
+  static std::string Read(MediumSocket& socket, int size) {
+    ExceptionOr<ByteArray> bytes = socket.GetInputStream().ReadExactly(size);
+    return bytes.ok() ? std::string(bytes.result()) : "";
+  }
+
+  std::unique_ptr<MultiplexSocket> outgoing_;
+  std::unique_ptr<MultiplexSocket> incoming_;
+  absl::Mutex mutex_;
+  std::vector<std::shared_ptr<MediumSocket>> incoming_virtual_sockets_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+TEST_F(MultiplexSocketTest, EstablishesVirtualSocket) {
+  std::shared_ptr<MediumSocket> outgoing_socket =
+      outgoing_->EstablishVirtualSocket(std::string(kServiceId));
+  ASSERT_NE(outgoing_socket, nullptr);
+  EXPECT_TRUE(outgoing_socket->IsVirtualSocket());
+  std::shared_ptr<MediumSocket> incoming_socket = GetIncomingVirtualSocket(0);
+  ASSERT_NE(incoming_socket, nullptr);
+
+  EXPECT_TRUE(outgoing_socket->GetOutputStream().Write("hello").Ok());
+  EXPECT_EQ(Read(*incoming_socket, 5), "hello");
+  EXPECT_TRUE(incoming_socket->GetOutputStream().Write("world").Ok());
+  EXPECT_EQ(Read(*outgoing_socket, 5), "world");
+
+  outgoing_socket->Close();
+  incoming_socket->Close();
+}
+
+TEST_F(MultiplexSocketTest, RejectsServiceThatIsNotListening) {
+  std::shared_ptr<MediumSocket> outgoing_socket =
+      outgoing_->EstablishVirtualSocket(std::string(kServiceId));
+  ASSERT_NE(outgoing_socket, nullptr);
+
+  EXPECT_EQ(outgoing_->EstablishVirtualSocket(std::string(kOtherServiceId)),
+            nullptr);
+  EXPECT_TRUE(outgoing_->IsEnabled());
+  EXPECT_EQ(outgoing_->GetVirtualSocketCount(), 1);
+  outgoing_socket->Close();
+  GetIncomingVirtualSocket(0)->Close();
+}
+
+TEST_F(MultiplexSocketTest, VirtualSocketsShareThePhysicalSocket) {
+  std::shared_ptr<MediumSocket> first =
+      outgoing_->EstablishVirtualSocket(std::string(kServiceId));
+  std::shared_ptr<MediumSocket> second =
+      outgoing_->EstablishVirtualSocket(std::string(kServiceId));
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  std::shared_ptr<MediumSocket> incoming_first = GetIncomingVirtualSocket(0);
+  std::shared_ptr<MediumSocket> incoming_second = GetIncomingVirtualSocket(1);
+  ASSERT_NE(incoming_first, nullptr);
+  ASSERT_NE(incoming_second, nullptr);
+  EXPECT_EQ(outgoing_->GetVirtualSocketCount(), 2);
+
+  // A write larger than a data frame is split, and arrives in one piece.
+  std::string large(3 * MultiplexSocket::kMaxDataFrameSize + 7, 'a');
+  EXPECT_TRUE(first->GetOutputStream().Write(large).Ok());
+  EXPECT_TRUE(second->GetOutputStream().Write("second").Ok());
+
+  EXPECT_EQ(Read(*incoming_second, 6), "second");
+  EXPECT_EQ(Read(*incoming_first, large.size()), large);
+
+  first->Close();
+  second->Close();
+  incoming_first->Close();
+  incoming_second->Close();
+}
+
+TEST_F(MultiplexSocketTest, VirtualSocketReadSlowlyThrottlesOnlyItsWriter) {
+  std::shared_ptr<MediumSocket> slow =
+      outgoing_->EstablishVirtualSocket(std::string(kServiceId));
+  std::shared_ptr<MediumSocket> other =
+      outgoing_->EstablishVirtualSocket(std::string(kServiceId));
+  ASSERT_NE(slow, nullptr);
+  ASSERT_NE(other, nullptr);
+  std::shared_ptr<MediumSocket> incoming_slow = GetIncomingVirtualSocket(0);
+  std::shared_ptr<MediumSocket> incoming_other = GetIncomingVirtualSocket(1);
+  ASSERT_NE(incoming_slow, nullptr);
+  ASSERT_NE(incoming_other, nullptr);
+
+  // Nobody reads `incoming_slow` yet, so the write waits for window once it
+  // has used up its own, instead of failing or stalling the physical socket.
+  std::string data(2 * MultiplexSocket::kWindowSize, 'a');
+  Exception write_result = {Exception::kFailed};
+  absl::Notification write_done;
+  SingleThreadExecutor writer;
+  writer.Execute([&]() {
+    write_result = slow->GetOutputStream().Write(data);
+    write_done.Notify();
+  });
+  EXPECT_FALSE(write_done.WaitForNotificationWithTimeout(absl::Seconds(1)));
+
+  EXPECT_TRUE(other->GetOutputStream().Write("other").Ok());
+  EXPECT_EQ(Read(*incoming_other, 5), "other");
+  EXPECT_TRUE(incoming_other->GetOutputStream().Write("back").Ok());
+  EXPECT_EQ(Read(*other, 4), "back");
+
+  // Reading makes room for the rest of the write.
+  EXPECT_EQ(Read(*incoming_slow, data.size()), data);
+  EXPECT_TRUE(write_done.WaitForNotificationWithTimeout(kWaitDuration));
+  EXPECT_TRUE(write_result.Ok());
+
+  slow->Close();
+  other->Close();
+  incoming_slow->Close();
+  incoming_other->Close();
+}
+
+TEST(MultiplexSocketWindowTest, ClosesVirtualSocketThatExceedsItsWindow) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableMultiplexWifiLan,
+      true);
+  auto [remote_input, incoming_output] = CreatePipe();
+  auto [incoming_input, remote_output] = CreatePipe();
+  absl::Notification accepted;
+  std::shared_ptr<MediumSocket> incoming_socket;
+  std::unique_ptr<MultiplexSocket> incoming = MultiplexSocket::CreateIncoming(
+      std::make_unique<WifiLanSocket>(std::make_unique<PipeWifiLanSocket>(
+          std::move(incoming_input), std::move(incoming_output))),
+      [](absl::string_view salted_service_id_hash, absl::string_view salt) {
+        return std::string(kServiceId);
+      },
+      [&](const std::string& service_id,
+          std::shared_ptr<MediumSocket> virtual_socket) {
+        incoming_socket = std::move(virtual_socket);
+        accepted.Notify();
+      });
+  auto write_frame = [&remote_output](const std::string& frame) {
+    EXPECT_TRUE(Base64Utils::WriteInt(remote_output.get(), frame.size()).Ok());
+    EXPECT_TRUE(remote_output->Write(frame).Ok());
+  };
+  std::string salted_service_id_hash =
+      GenerateSaltedServiceIdHash(kServiceId, "salt");
+  write_frame(ForConnectionRequest(salted_service_id_hash, "salt"));
+  ASSERT_TRUE(accepted.WaitForNotificationWithTimeout(kWaitDuration));
+
+  // Nobody reads `incoming_socket`, and the remote device ignores its window.
+  std::string data(MultiplexSocket::kMaxDataFrameSize, 'a');
+  for (std::int64_t sent = 0; sent <= MultiplexSocket::kWindowSize;
+       sent += data.size()) {
+    write_frame(ForData(salted_service_id_hash, data));
+  }
+
+  // The remote device is told that the virtual socket is closed.
+  bool disconnected = false;
+  while (!disconnected) {
+    ExceptionOr<std::int32_t> frame_length =
+        Base64Utils::ReadInt(remote_input.get());
+    ASSERT_TRUE(frame_length.ok());
+    ExceptionOr<ByteArray> bytes =
+        remote_input->ReadExactly(frame_length.result());
+    ASSERT_TRUE(bytes.ok());
+    ExceptionOr<MultiplexFrame> frame = FromBytes(bytes.result());
+    ASSERT_TRUE(frame.ok());
+    disconnected = frame.result().control_frame().control_frame_type() ==
+                   MultiplexControlFrame::DISCONNECTION;
+  }
+
+  // The virtual socket ends after the data that fit in the window.
+  std::int64_t read_size = 0;
+  while (true) {
+    ExceptionOr<ByteArray> bytes = incoming_socket->GetInputStream().Read(
+        MultiplexSocket::kMaxDataFrameSize);
+    if (!bytes.ok()) {
+      break;
+    }
+    read_size += bytes.result().size();
+  }
+  EXPECT_LE(read_size, MultiplexSocket::kWindowSize);
+  EXPECT_TRUE(incoming->IsEnabled());
+
+  incoming_socket->Close();
+  incoming.reset();
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST_F(MultiplexSocketTest, ClosingVirtualSocketClosesRemoteInput) {
+  std::shared_ptr<MediumSocket> outgoing_socket =
+      outgoing_->EstablishVirtualSocket(std::string(kServiceId));
+  ASSERT_NE(outgoing_socket, nullptr);
+  std::shared_ptr<MediumSocket> incoming_socket = GetIncomingVirtualSocket(0);
+  ASSERT_NE(incoming_socket, nullptr);
+
+  EXPECT_TRUE(outgoing_socket->GetOutputStream().Write("bye").Ok());
+  outgoing_socket->Close();
+
+  // Data written before Close() is delivered before the disconnection.
+  EXPECT_EQ(Read(*incoming_socket, 3), "bye");
+  EXPECT_FALSE(incoming_socket->GetInputStream().Read(1).ok());
+  EXPECT_EQ(outgoing_->GetVirtualSocketCount(), 0);
+  incoming_socket->Close();
+}
+
+TEST_F(MultiplexSocketTest, ClosesOutgoingLinkAfterLastVirtualSocket) {
+  std::shared_ptr<MediumSocket> outgoing_socket =
+      outgoing_->EstablishVirtualSocket(std::string(kServiceId));
+  ASSERT_NE(outgoing_socket, nullptr);
+  ASSERT_NE(GetIncomingVirtualSocket(0), nullptr);
+
+  outgoing_socket->Close();
+
+  absl::Time deadline = absl::Now() + kWaitDuration;
+  while ((outgoing_->IsEnabled() || incoming_->IsEnabled()) &&
+         absl::Now() < deadline) {
+    absl::SleepFor(absl::Milliseconds(10));
+  }
+  EXPECT_FALSE(outgoing_->IsEnabled());
+  EXPECT_FALSE(incoming_->IsEnabled());
+  GetIncomingVirtualSocket(0)->Close();
+}
+
+TEST_F(MultiplexSocketTest, ShutdownClosesVirtualSockets) {
+  std::shared_ptr<MediumSocket> outgoing_socket =
+      outgoing_->EstablishVirtualSocket(std::string(kServiceId));
+  ASSERT_NE(outgoing_socket, nullptr);
+  std::shared_ptr<MediumSocket> incoming_socket = GetIncomingVirtualSocket(0);
+  ASSERT_NE(incoming_socket, nullptr);
+
+  outgoing_->Shutdown();
+
+  EXPECT_FALSE(outgoing_socket->GetInputStream().Read(1).ok());
+  EXPECT_FALSE(outgoing_socket->GetOutputStream().Write("late").Ok());
+  EXPECT_FALSE(incoming_socket->GetInputStream().Read(1).ok());
+  EXPECT_EQ(outgoing_->EstablishVirtualSocket(std::string(kServiceId)),
+            nullptr);
+  outgoing_socket->Close();
+  incoming_socket->Close();
+}
+
+}  // namespace
+}  // namespace multiplex
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,103 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/mediums/service_id_identity.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/base/no_destructor.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "connections/implementation/mediums/advertisements/dct_advertisement.h"
+#include "connections/implementation/mediums/ble/bloom_filter.h"
+#include "connections/implementation/mediums/utils.h"
+#include "internal/encoding/codec.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/mutex_lock.h"
+#include "internal/platform/nsd_service_info.h"
+
+namespace nearby {
+namespace connections {
+
+namespace {
+
+constexpr size_t kSha256Length = 32;
+
+struct Cache {
+  Mutex mutex;
+  absl::flat_hash_map<std::string, std::unique_ptr<ServiceIdIdentity>>
+      identities ABSL_GUARDED_BY(mutex);
+};
+
+Cache& GetCache() {
+  static absl::NoDestructor<Cache> cache;
+  return *cache;
+}
+
+}  // namespace
+
+const ServiceIdIdentity& ServiceIdIdentity::Get(absl::string_view service_id) {
+  Cache& cache = GetCache();
+  {
+    MutexLock lock(&cache.mutex);
+    auto it = cache.identities.find(service_id);
+    if (it != cache.identities.end()) {
+      return *it->second;
+    }
+  }
+  // Hash outside of the lock; if another thread gets there first, its
+  // identity wins and ours is dropped.
+  std::unique_ptr<ServiceIdIdentity> identity(
+      new ServiceIdIdentity(std::string(service_id)));
+  MutexLock lock(&cache.mutex);
+  auto [it, inserted] =
+      cache.identities.try_emplace(service_id, std::move(identity));
+  return *it->second;
+}
+
+ServiceIdIdentity::ServiceIdIdentity(const std::string& service_id)
+    : sha256_(Utils::Sha256Hash(service_id, kSha256Length)),
+      dct_service_id_hash_(
+          advertisements::ble::DctAdvertisement::ComputeServiceIdHash(
+              service_id)),
+      bloom_filter_hashes_(mediums::BloomFilter::GetHashes(service_id)) {
+  nsd_service_type_ = absl::StrFormat(
+      NsdServiceInfo::kNsdTypeFormat,
+      encoding::HexEncode(absl::string_view(sha256_).substr(
+          0, NsdServiceInfo::kTypeFromServiceIdHashLength)));
+  // Bytes are sign-extended before shifting, as the ports that peers already
+  // listen on were picked that way.
+  port_hash_ = sha256_[0] << 24 | sha256_[1] << 16 | sha256_[2] << 8 |
+               sha256_[3];
+}
+
+ByteArray ServiceIdIdentity::GetHash(size_t length) const {
+  return ByteArray(sha256_.data(), std::min(length, sha256_.size()));
+}
+
+int ServiceIdIdentity::GetPort(
+    std::pair<std::int32_t, std::int32_t> port_range) const {
+  return port_range.first +
+         (port_hash_ % (port_range.second - port_range.first));
+}
+
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,76 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_MEDIUMS_SERVICE_ID_IDENTITY_H_
+#define CORE_INTERNAL_MEDIUMS_SERVICE_ID_IDENTITY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "connections/implementation/mediums/ble/bloom_filter.h"
+#include "internal/platform/byte_array.h"
+
+namespace nearby {
+namespace connections {
+
+// The identifiers every medium derives from a service id: the SHA-256 prefixes
+// put in advertisements, the mDNS service type and port, the DCT service id
+// hash and the bloom filter hashes. Each is computed once per service id and
+// kept for the life of the process, since advertising and scanning otherwise
+// recompute them for every packet. Apps use a handful of fixed service ids, so
+// the cache stays small.
+class ServiceIdIdentity {
+ public:
+  // Returns the identity of `service_id`. Thread-safe; the reference stays
+  // valid until the process exits.
+  static const ServiceIdIdentity& Get(absl::string_view service_id);
+
+  ServiceIdIdentity(const ServiceIdIdentity&) = delete;
+  ServiceIdIdentity& operator=(const ServiceIdIdentity&) = delete;
+
+  // The first `length` bytes of the SHA-256 hash of the service id, same as
+  // Utils::Sha256Hash(service_id, length). `length` is at most 32.
+  ByteArray GetHash(size_t length) const;
+
+  // The mDNS service type, e.g. "_0A1B2C3D4E5F._tcp.".
+  const std::string& GetNsdServiceType() const { return nsd_service_type_; }
+
+  // A port in [port_range.first, port_range.second) picked by the hash.
+  int GetPort(std::pair<std::int32_t, std::int32_t> port_range) const;
+
+  const std::string& GetDctServiceIdHash() const {
+    return dct_service_id_hash_;
+  }
+
+  const mediums::BloomFilter::Hashes& GetBloomFilterHashes() const {
+    return bloom_filter_hashes_;
+  }
+
+ private:
+  explicit ServiceIdIdentity(const std::string& service_id);
+
+  std::string sha256_;
+  std::string nsd_service_type_;
+  std::uint32_t port_hash_;
+  std::string dct_service_id_hash_;
+  mediums::BloomFilter::Hashes bloom_filter_hashes_;
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_MEDIUMS_SERVICE_ID_IDENTITY_H_
@@ -0,0 +1,92 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/mediums/service_id_identity.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "connections/implementation/mediums/advertisements/dct_advertisement.h"
+#include "connections/implementation/mediums/ble/bloom_filter.h"
+#include "connections/implementation/mediums/utils.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/nsd_service_info.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+constexpr char kServiceId[] = "com.google.location.nearby.apps.test";
+
+TEST(ServiceIdIdentityTest, ReturnsSameIdentityForServiceId) {
+  const ServiceIdIdentity& identity = ServiceIdIdentity::Get(kServiceId);
+
+  EXPECT_EQ(&ServiceIdIdentity::Get(std::string(kServiceId)), &identity);
+  EXPECT_NE(&ServiceIdIdentity::Get("other"), &identity);
+}
+
+TEST(ServiceIdIdentityTest, HashMatchesSha256Prefix) {
+  const ServiceIdIdentity& identity = ServiceIdIdentity::Get(kServiceId);
+
+  for (size_t length : {2, 3, 4, 6, 32}) {
+    EXPECT_EQ(identity.GetHash(length), Utils::Sha256Hash(kServiceId, length));
+  }
+}
+
+TEST(ServiceIdIdentityTest, NsdServiceTypeMatchesHashedFormat) {
+  std::string hex;
+  for (char byte : std::string(Utils::Sha256Hash(
+           kServiceId, NsdServiceInfo::kTypeFromServiceIdHashLength))) {
+    absl::StrAppend(&hex, absl::StrFormat("%02X", byte));
+  }
+
+  EXPECT_EQ(ServiceIdIdentity::Get(kServiceId).GetNsdServiceType(),
+            absl::StrFormat(NsdServiceInfo::kNsdTypeFormat, hex));
+}
+
+TEST(ServiceIdIdentityTest, PortMatchesHashedPort) {
+  // SHA-256 of "a" starts with 0xCA, so the port relies on sign extension.
+  for (const std::string service_id : {"a", "b", "c", "d", kServiceId}) {
+    const std::string hash = std::string(Utils::Sha256Hash(service_id, 4));
+    std::uint32_t value =
+        hash[0] << 24 | hash[1] << 16 | hash[2] << 8 | hash[3];
+
+    EXPECT_EQ(ServiceIdIdentity::Get(service_id).GetPort({10000, 60000}),
+              10000 + value % 50000);
+  }
+}
+
+TEST(ServiceIdIdentityTest, DctHashAndBloomFilterHashesMatch) {
+  const ServiceIdIdentity& identity = ServiceIdIdentity::Get(kServiceId);
+
+  EXPECT_EQ(identity.GetDctServiceIdHash(),
+            advertisements::ble::DctAdvertisement::ComputeServiceIdHash(
+                kServiceId));
+  EXPECT_EQ(identity.GetBloomFilterHashes(),
+            mediums::BloomFilter::GetHashes(kServiceId));
+
+  mediums::BloomFilter bloom_filter(
+      std::make_unique<mediums::BitSetImpl<10>>());
+  bloom_filter.Add(identity.GetBloomFilterHashes());
+  EXPECT_TRUE(bloom_filter.PossiblyContains(kServiceId));
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
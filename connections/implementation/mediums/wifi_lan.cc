@@ -14,20 +14,26 @@
 
 #include "connections/implementation/mediums/wifi_lan.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
-#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
 #include "connections/implementation/bwu_handler.h"
-#include "connections/implementation/mediums/utils.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "connections/implementation/mediums/multiplex/multiplex_frames.h"
+#include "connections/implementation/mediums/multiplex/multiplex_socket.h"
+#include "connections/implementation/mediums/service_id_identity.h"
 #include "connections/implementation/mediums/wifi_lan_bwu_handler.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/cancellation_flag.h"
 #include "internal/platform/exception.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/expected.h"
 #include "internal/platform/implementation/upgrade_address_info.h"
 #include "internal/platform/logging.h"
@@ -41,6 +47,22 @@ namespace connections {
 
 namespace {
 using location::nearby::proto::connections::OperationResultCode;
+using multiplex::MultiplexSocket;
+
+// TXT record with the port of the multiplex server socket.
+constexpr char kMultiplexPortTxtRecordKey[] = "mp";
+
+bool IsMultiplexEnabled() {
+  return NearbyFlags::GetInstance().GetBoolFlag(
+      config_package_nearby::nearby_connections_feature::
+          kEnableMultiplexWifiLan);
+}
+
+// Virtual sockets created on a WifiLanSocket are WifiLanSockets. Copies share
+// their streams and close listeners.
+WifiLanSocket ToWifiLanSocket(const std::shared_ptr<MediumSocket>& socket) {
+  return *static_cast<WifiLanSocket*>(socket.get());
+}
 }  // namespace
 
 WifiLan::~WifiLan() {
@@ -54,6 +76,12 @@ WifiLan::~WifiLan() {
   while (!advertising_info_.nsd_service_infos.empty()) {
     StopAdvertising(advertising_info_.nsd_service_infos.begin()->first);
   }
+  {
+    MutexLock lock(&mutex_);
+    StopAcceptingMultiplexConnectionsLocked();
+    outgoing_multiplex_sockets_.clear();
+    incoming_multiplex_sockets_.clear();
+  }
   // All the AcceptLoopRunnable objects in here should already have gotten an
   // opportunity to shut themselves down cleanly in the calls to
   // StopAcceptingConnections() above.
@@ -111,6 +139,11 @@ ErrorOr<bool> WifiLan::StartAdvertising(const std::string& service_id,
     port = port_result.value();
   }
   nsd_service_info.SetPort(port);
+  if (multiplex_server_socket_.IsValid()) {
+    nsd_service_info.SetTxtRecord(
+        kMultiplexPortTxtRecordKey,
+        absl::StrCat(multiplex_server_socket_.GetPort()));
+  }
   if (!medium_.StartAdvertising(nsd_service_info)) {
     LOG(INFO) << "Failed to turn on WifiLan advertising with nsd_service_info="
               << &nsd_service_info
@@ -249,11 +282,18 @@ ErrorOr<int> WifiLan::StartAcceptingConnectionsLocked(
           .first->second;
 
   port = owned_server_socket.GetPort();
+  auto shared_callback =
+      std::make_shared<AcceptedConnectionCallback>(std::move(callback));
+  {
+    MutexLock lock(&accepted_connection_callbacks_mutex_);
+    accepted_connection_callbacks_[service_id] = shared_callback;
+  }
+  StartAcceptingMultiplexConnectionsLocked();
   // Start the accept loop on a dedicated thread - this stays alive and
   // listening for new incoming connections until StopAcceptingConnections() is
   // invoked.
   accept_loops_runner_.Execute(
-      "wifi-lan-accept", [callback = std::move(callback),
+      "wifi-lan-accept", [callback = std::move(shared_callback),
                           server_socket = std::move(owned_server_socket),
                           service_id]() mutable {
         while (true) {
@@ -264,9 +304,9 @@ ErrorOr<int> WifiLan::StartAcceptingConnectionsLocked(
           }
           LOG(INFO) << "Accepted connection for " << service_id;
           bool callback_called = false;
-          if (callback && !callback_called) {
+          if (*callback && !callback_called) {
             LOG(INFO) << "Call back triggered for physical socket.";
-            callback(service_id, std::move(client_socket));
+            (*callback)(service_id, std::move(client_socket));
           }
         }
       });
@@ -332,6 +372,13 @@ bool WifiLan::StopAcceptingConnectionsLocked(const std::string& service_id) {
   // That may take some time to complete, but there's no particular reason to
   // wait around for it.
   auto item = server_sockets_.extract(it);
+  {
+    MutexLock lock(&accepted_connection_callbacks_mutex_);
+    accepted_connection_callbacks_.erase(item.key());
+  }
+  if (server_sockets_.empty()) {
+    StopAcceptingMultiplexConnectionsLocked();
+  }
   // ### Note: service_id should no longer be used after this as it was passed
   // as a reference to the key in the server_sockets_ map.  It is still
   // available as item.key().
@@ -389,27 +436,42 @@ ErrorOr<WifiLanSocket> WifiLan::Connect(const std::string& service_id,
                       CLIENT_CANCELLATION_CANCEL_LAN_OUTGOING_CONNECTION)};
   }
 
+  const std::string ip_address = service_info.GetIPAddress();
   ExceptionOr<WifiLanSocket> virtual_socket =
-      ConnectWithMultiplexSocketLocked(service_id, service_info.GetIPAddress());
+      ConnectWithMultiplexSocketLocked(service_id, ip_address);
   if (virtual_socket.ok()) {
     return virtual_socket.result();
   }
 
+  // Only the first connection to a device opens its multiplex server socket;
+  // later ones are virtual sockets on it.
+  int multiplex_port = GetRemoteMultiplexPort(service_info);
+  if (multiplex_port > 0 && !ip_address.empty() &&
+      !outgoing_multiplex_sockets_.contains(ip_address)) {
+    NsdServiceInfo multiplex_service_info = service_info;
+    multiplex_service_info.SetPort(multiplex_port);
+    WifiLanSocket physical_socket =
+        medium_.ConnectToService(multiplex_service_info, cancellation_flag);
+    if (physical_socket.IsValid()) {
+      virtual_socket = CreateOutgoingMultiplexSocketLocked(
+          physical_socket, service_id, ip_address);
+      if (virtual_socket.ok()) {
+        LOG(INFO) << "Successfully connected via Multiplex WifiLan [service_id="
+                  << service_id << "]";
+        return virtual_socket.result();
+      }
+    }
+    LOG(INFO) << "Failed to connect to the WifiLan multiplex server socket "
+                 "[service_id="
+              << service_id << "]; falling back to a physical socket.";
+  }
+
   socket = medium_.ConnectToService(service_info, cancellation_flag);
   if (!socket.IsValid()) {
     LOG(INFO) << "Failed to Connect via WifiLan [service_id=" << service_id
               << "]";
     return {Error(
         OperationResultCode::CONNECTIVITY_LAN_CLIENT_SOCKET_CREATION_FAILURE)};
-  } else {
-    ExceptionOr<WifiLanSocket> virtual_socket =
-        CreateOutgoingMultiplexSocketLocked(socket, service_id,
-                                            service_info.GetIPAddress());
-    if (virtual_socket.ok()) {
-      LOG(INFO) << "Successfully connected via Multiplex WifiLan [service_id="
-                << service_id << "]";
-      return virtual_socket.result();
-    }
   }
 
   LOG(INFO) << "Successfully connected via WifiLan [service_id=" << service_id
@@ -455,17 +517,6 @@ ErrorOr<WifiLanSocket> WifiLan::Connect(const std::string& service_id,
               << "], [" << service_address << "]";
     return {Error(
         OperationResultCode::CONNECTIVITY_LAN_CLIENT_SOCKET_CREATION_FAILURE)};
-  } else {
-    ExceptionOr<WifiLanSocket> virtual_socket =
-        CreateOutgoingMultiplexSocketLocked(
-            socket, service_id,
-            std::string(service_address.address.begin(),
-                        service_address.address.end()));
-    if (virtual_socket.ok()) {
-      LOG(INFO) << "Successfully connected via Multiplex WifiLan [service_id="
-                << service_id << "]";
-      return virtual_socket.result();
-    }
   }
 
   LOG(INFO) << "Successfully connected via WifiLan [service_id=" << service_id
@@ -475,13 +526,141 @@ ErrorOr<WifiLanSocket> WifiLan::Connect(const std::string& service_id,
 
 ExceptionOr<WifiLanSocket> WifiLan::ConnectWithMultiplexSocketLocked(
     const std::string& service_id, const std::string& ip_address) {
-  return ExceptionOr<WifiLanSocket>(Exception::kFailed);
+  RemoveClosedMultiplexSocketsLocked();
+  const auto& it = outgoing_multiplex_sockets_.find(ip_address);
+  if (it == outgoing_multiplex_sockets_.end() || !it->second->IsEnabled()) {
+    return ExceptionOr<WifiLanSocket>(Exception::kFailed);
+  }
+  std::shared_ptr<MediumSocket> virtual_socket =
+      it->second->EstablishVirtualSocket(service_id);
+  if (virtual_socket == nullptr) {
+    LOG(INFO) << "Failed to open a WifiLan virtual socket [service_id="
+              << service_id << "]";
+    return ExceptionOr<WifiLanSocket>(Exception::kFailed);
+  }
+  LOG(INFO) << "Reused the WifiLan multiplex socket [service_id=" << service_id
+            << "]";
+  return ExceptionOr<WifiLanSocket>(ToWifiLanSocket(virtual_socket));
 }
 
 ExceptionOr<WifiLanSocket> WifiLan::CreateOutgoingMultiplexSocketLocked(
     WifiLanSocket& socket, const std::string& service_id,
     const std::string& ip_address) {
-  return ExceptionOr<WifiLanSocket>(Exception::kFailed);
+  std::unique_ptr<MultiplexSocket> multiplex_socket =
+      MultiplexSocket::CreateOutgoing(std::make_unique<WifiLanSocket>(socket));
+  std::shared_ptr<MediumSocket> virtual_socket =
+      multiplex_socket->EstablishVirtualSocket(service_id);
+  if (virtual_socket == nullptr) {
+    return ExceptionOr<WifiLanSocket>(Exception::kFailed);
+  }
+  outgoing_multiplex_sockets_[ip_address] = std::move(multiplex_socket);
+  return ExceptionOr<WifiLanSocket>(ToWifiLanSocket(virtual_socket));
+}
+
+int WifiLan::GetRemoteMultiplexPort(const NsdServiceInfo& service_info) const {
+  if (!IsMultiplexEnabled()) {
+    return 0;
+  }
+  int port = 0;
+  if (!absl::SimpleAtoi(service_info.GetTxtRecord(kMultiplexPortTxtRecordKey),
+                        &port) ||
+      port <= 0 || port > 65535) {
+    return 0;
+  }
+  return port;
+}
+
+void WifiLan::StartAcceptingMultiplexConnectionsLocked() {
+  if (!IsMultiplexEnabled() || multiplex_server_socket_.IsValid()) {
+    return;
+  }
+  multiplex_server_socket_ = medium_.ListenForService(/*port=*/0);
+  if (!multiplex_server_socket_.IsValid()) {
+    LOG(INFO) << "Failed to start the WifiLan multiplex server socket.";
+    return;
+  }
+  accept_loops_runner_.Execute(
+      "wifi-lan-multiplex-accept",
+      [this, server_socket = multiplex_server_socket_]() mutable {
+        while (true) {
+          WifiLanSocket physical_socket = server_socket.Accept();
+          if (!physical_socket.IsValid()) {
+            server_socket.Close();
+            break;
+          }
+          OnMultiplexConnectionAccepted(std::move(physical_socket));
+        }
+      });
+}
+
+void WifiLan::StopAcceptingMultiplexConnectionsLocked() {
+  if (!multiplex_server_socket_.IsValid()) {
+    return;
+  }
+  multiplex_server_socket_.Close();
+  multiplex_server_socket_ = WifiLanServerSocket();
+}
+
+void WifiLan::OnMultiplexConnectionAccepted(WifiLanSocket socket) {
+  LOG(INFO) << "Accepted WifiLan multiplex connection.";
+  std::unique_ptr<MultiplexSocket> multiplex_socket =
+      MultiplexSocket::CreateIncoming(
+          std::make_unique<WifiLanSocket>(std::move(socket)),
+          [this](absl::string_view salted_service_id_hash,
+                 absl::string_view salt) {
+            return ResolveMultiplexServiceId(salted_service_id_hash, salt);
+          },
+          [this](const std::string& service_id,
+                 std::shared_ptr<MediumSocket> virtual_socket) {
+            OnIncomingVirtualSocket(service_id, std::move(virtual_socket));
+          });
+  MutexLock lock(&mutex_);
+  RemoveClosedMultiplexSocketsLocked();
+  incoming_multiplex_sockets_.push_back(std::move(multiplex_socket));
+}
+
+std::string WifiLan::ResolveMultiplexServiceId(
+    absl::string_view salted_service_id_hash, absl::string_view salt) {
+  MutexLock lock(&accepted_connection_callbacks_mutex_);
+  for (const auto& [service_id, callback] : accepted_connection_callbacks_) {
+    if (multiplex::GenerateSaltedServiceIdHash(service_id, salt) ==
+        salted_service_id_hash) {
+      return service_id;
+    }
+  }
+  return "";
+}
+
+void WifiLan::OnIncomingVirtualSocket(
+    const std::string& service_id,
+    std::shared_ptr<MediumSocket> virtual_socket) {
+  std::shared_ptr<AcceptedConnectionCallback> callback;
+  {
+    MutexLock lock(&accepted_connection_callbacks_mutex_);
+    const auto& it = accepted_connection_callbacks_.find(service_id);
+    if (it != accepted_connection_callbacks_.end()) {
+      callback = it->second;
+    }
+  }
+  if (callback == nullptr || !*callback) {
+    virtual_socket->Close();
+    return;
+  }
+  LOG(INFO) << "Accepted virtual socket for " << service_id;
+  (*callback)(service_id, ToWifiLanSocket(virtual_socket));
+}
+
+void WifiLan::RemoveClosedMultiplexSocketsLocked() {
+  auto is_closed = [](const std::unique_ptr<MultiplexSocket>& socket) {
+    return !socket->IsEnabled() && socket->GetVirtualSocketCount() == 0;
+  };
+  absl::erase_if(outgoing_multiplex_sockets_, [&](const auto& item) {
+    return is_closed(item.second);
+  });
+  incoming_multiplex_sockets_.erase(
+      std::remove_if(incoming_multiplex_sockets_.begin(),
+                     incoming_multiplex_sockets_.end(), is_closed),
+      incoming_multiplex_sockets_.end());
 }
 
 api::UpgradeAddressInfo WifiLan::GetUpgradeAddressCandidates(
@@ -495,29 +674,12 @@ api::UpgradeAddressInfo WifiLan::GetUpgradeAddressCandidates(
 }
 
 std::string WifiLan::GenerateServiceType(const std::string& service_id) {
-  std::string service_id_hash_string;
-
-  const ByteArray service_id_hash = Utils::Sha256Hash(
-      service_id, NsdServiceInfo::kTypeFromServiceIdHashLength);
-  for (auto byte : std::string(service_id_hash)) {
-    absl::StrAppend(&service_id_hash_string, absl::StrFormat("%02X", byte));
-  }
-
-  return absl::StrFormat(NsdServiceInfo::kNsdTypeFormat,
-                         service_id_hash_string);
+  return ServiceIdIdentity::Get(service_id).GetNsdServiceType();
 }
 
 int WifiLan::GeneratePort(const std::string& service_id,
                           std::pair<std::int32_t, std::int32_t> port_range) {
-  const std::string service_id_hash =
-      std::string(Utils::Sha256Hash(service_id, 4));
-
-  std::uint32_t uint_of_service_id_hash =
-      service_id_hash[0] << 24 | service_id_hash[1] << 16 |
-      service_id_hash[2] << 8 | service_id_hash[3];
-
-  return port_range.first +
-         (uint_of_service_id_hash % (port_range.second - port_range.first));
+  return ServiceIdIdentity::Get(service_id).GetPort(port_range);
 }
 
 std::unique_ptr<BwuHandler> WifiLan::CreateBwuHandler(
@@ -19,12 +19,14 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/functional/any_invocable.h"
 #include "connections/implementation/bwu_handler.h"
+#include "connections/implementation/mediums/multiplex/multiplex_socket.h"
 #include "internal/platform/cancellation_flag.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/expected.h"
@@ -158,7 +160,8 @@ class WifiLan {
     absl::flat_hash_set<std::string> service_ids;
   };
 
-  static constexpr int kMaxConcurrentAcceptLoops = 5;
+  // One accept loop per service id, and one for the multiplex server socket.
+  static constexpr int kMaxConcurrentAcceptLoops = 6;
 
   // Establishes connection to WifiLan service by ip address through
   // MultiplexSocket.
@@ -172,6 +175,35 @@ class WifiLan {
       WifiLanSocket& socket, const std::string& service_id,
       const std::string& ip_address) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Returns the port of the remote multiplex server socket, or 0 if
+  // `service_info` doesn't advertise one or multiplexing is disabled.
+  int GetRemoteMultiplexPort(const NsdServiceInfo& service_info) const;
+
+  // Starts the multiplex server socket if multiplexing is enabled and it is
+  // not running yet.
+  void StartAcceptingMultiplexConnectionsLocked()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void StopAcceptingMultiplexConnectionsLocked()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Takes over a physical socket accepted by the multiplex server socket.
+  void OnMultiplexConnectionAccepted(WifiLanSocket socket)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the service id accepting connections that matches a virtual
+  // socket request, or an empty string.
+  std::string ResolveMultiplexServiceId(
+      absl::string_view salted_service_id_hash, absl::string_view salt)
+      ABSL_LOCKS_EXCLUDED(accepted_connection_callbacks_mutex_);
+  void OnIncomingVirtualSocket(const std::string& service_id,
+                               std::shared_ptr<MediumSocket> virtual_socket)
+      ABSL_LOCKS_EXCLUDED(accepted_connection_callbacks_mutex_);
+
+  // Drops multiplex sockets whose physical socket and virtual sockets are all
+  // closed.
+  void RemoveClosedMultiplexSocketsLocked()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   // Same as IsAvailable(), but must be called with mutex_ held.
   bool IsAvailableLocked() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
@@ -219,6 +251,26 @@ class WifiLan {
   absl::flat_hash_map<std::string, WifiLanServerSocket> server_sockets_
       ABSL_GUARDED_BY(mutex_);
 
+  // The callbacks passed to StartAcceptingConnections(), by service id. They
+  // are also used for virtual sockets, from the read loops of multiplex
+  // sockets, which must not wait for `mutex_` while Connect() holds it.
+  Mutex accepted_connection_callbacks_mutex_;
+  absl::flat_hash_map<std::string, std::shared_ptr<AcceptedConnectionCallback>>
+      accepted_connection_callbacks_
+          ABSL_GUARDED_BY(accepted_connection_callbacks_mutex_);
+
+  // Listens for physical sockets that carry virtual sockets, for all service
+  // ids. Its port is advertised in a TXT record, so that devices without
+  // multiplexing never connect to it.
+  WifiLanServerSocket multiplex_server_socket_ ABSL_GUARDED_BY(mutex_);
+  // Multiplex sockets this device connected, by remote ip address.
+  absl::flat_hash_map<std::string,
+                      std::unique_ptr<multiplex::MultiplexSocket>>
+      outgoing_multiplex_sockets_ ABSL_GUARDED_BY(mutex_);
+  // Multiplex sockets accepted by `multiplex_server_socket_`.
+  std::vector<std::unique_ptr<multiplex::MultiplexSocket>>
+      incoming_multiplex_sockets_ ABSL_GUARDED_BY(mutex_);
+
   std::string last_mdns_service_name_ ABSL_GUARDED_BY(mutex_);
   int last_server_port_ ABSL_GUARDED_BY(mutex_) = 0;
 };
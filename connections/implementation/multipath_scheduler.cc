@@ -0,0 +1,174 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/multipath_scheduler.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "connections/implementation/endpoint_channel.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/mutex_lock.h"
+
+namespace nearby::connections {
+
+EndpointChannel* MultipathScheduler::PickPath(
+    const std::string& endpoint_id,
+    const std::vector<std::shared_ptr<EndpointChannel>>& paths) {
+  if (paths.empty()) return nullptr;
+  if (paths.size() == 1) return paths[0].get();
+
+  std::vector<std::int64_t> weights;
+  weights.reserve(paths.size());
+  std::int64_t measured_sum = 0;
+  int num_measured = 0;
+  for (const auto& path : paths) {
+    auto weight =
+        static_cast<std::int64_t>(path->GetThroughputBytesPerSecond());
+    weights.push_back(weight);
+    if (weight > 0) {
+      measured_sum += weight;
+      ++num_measured;
+    }
+  }
+  std::int64_t default_weight =
+      num_measured > 0 ? std::max<std::int64_t>(measured_sum / num_measured, 1)
+                       : 1;
+  for (auto& weight : weights) {
+    if (weight <= 0) weight = default_weight;
+  }
+
+  MutexLock lock(&mutex_);
+  PathStates& states = endpoints_[endpoint_id];
+  // Drop the state of paths that are gone, unless RemovePath() still has to
+  // hand their retained frames over.
+  absl::erase_if(states, [&paths](const auto& entry) {
+    return entry.second.retained_frames.empty() &&
+           std::none_of(paths.begin(), paths.end(), [&entry](const auto& path) {
+             return path.get() == entry.first;
+           });
+  });
+
+  for (const auto& path : paths) states.try_emplace(path.get());
+
+  // References into `states` are stable from here on; no more insertions.
+  std::int64_t total_weight = 0;
+  size_t picked = 0;
+  PathState* picked_state = nullptr;
+  for (size_t i = 0; i < paths.size(); ++i) {
+    PathState& state = states.find(paths[i].get())->second;
+    // A full additional path sits out until the remote device catches up.
+    if (i != 0 && state.retained_bytes >= kMaxRetainedBytesPerPath) continue;
+    state.current_weight += weights[i];
+    total_weight += weights[i];
+    if (picked_state == nullptr ||
+        state.current_weight > picked_state->current_weight) {
+      picked = i;
+      picked_state = &state;
+    }
+  }
+  picked_state->current_weight -= total_weight;
+  return paths[picked].get();
+}
+
+Exception MultipathScheduler::WriteToPath(
+    const std::string& endpoint_id, EndpointChannel* path,
+    const std::string& frame, absl::AnyInvocable<void()> on_written) {
+  std::shared_ptr<Mutex> write_mutex;
+  {
+    MutexLock lock(&mutex_);
+    PathState* state = FindPathLocked(endpoint_id, path);
+    if (state == nullptr) return {Exception::kIo};
+    write_mutex = state->write_mutex;
+  }
+
+  MutexLock write_lock(write_mutex.get());
+  {
+    MutexLock lock(&mutex_);
+    PathState* state = FindPathLocked(endpoint_id, path);
+    if (state == nullptr) return {Exception::kIo};
+    state->retained_frames.push_back(frame);
+    state->retained_bytes += frame.size();
+    ++state->written_frames;
+  }
+  Exception exception = path->WriteAndNotify(frame, std::move(on_written));
+  if (!exception.Ok()) {
+    // No frame was written after this one, so it is still the newest one,
+    // unless RemovePath() took it already.
+    MutexLock lock(&mutex_);
+    PathState* state = FindPathLocked(endpoint_id, path);
+    if (state != nullptr && !state->retained_frames.empty()) {
+      state->retained_bytes -= state->retained_frames.back().size();
+      state->retained_frames.pop_back();
+      --state->written_frames;
+    }
+  }
+  return exception;
+}
+
+void MultipathScheduler::OnPathAck(const std::string& endpoint_id,
+                                   const EndpointChannel* path,
+                                   std::int64_t received_data_frames) {
+  MutexLock lock(&mutex_);
+  PathState* state = FindPathLocked(endpoint_id, path);
+  if (state == nullptr) return;
+  std::int64_t acked_frames =
+      state->written_frames - state->retained_frames.size();
+  while (acked_frames < received_data_frames &&
+         !state->retained_frames.empty()) {
+    state->retained_bytes -= state->retained_frames.front().size();
+    state->retained_frames.pop_front();
+    ++acked_frames;
+  }
+}
+
+std::vector<std::string> MultipathScheduler::RemovePath(
+    const std::string& endpoint_id, const EndpointChannel* path) {
+  MutexLock lock(&mutex_);
+  auto endpoint_it = endpoints_.find(endpoint_id);
+  if (endpoint_it == endpoints_.end()) return {};
+  auto path_it = endpoint_it->second.find(path);
+  if (path_it == endpoint_it->second.end()) return {};
+
+  std::vector<std::string> frames(
+      std::make_move_iterator(path_it->second.retained_frames.begin()),
+      std::make_move_iterator(path_it->second.retained_frames.end()));
+  endpoint_it->second.erase(path_it);
+  return frames;
+}
+
+void MultipathScheduler::ForgetEndpoint(const std::string& endpoint_id) {
+  MutexLock lock(&mutex_);
+  endpoints_.erase(endpoint_id);
+}
+
+MultipathScheduler::PathState* MultipathScheduler::FindPathLocked(
+    const std::string& endpoint_id, const EndpointChannel* path) {
+  auto endpoint_it = endpoints_.find(endpoint_id);
+  if (endpoint_it == endpoints_.end()) return nullptr;
+  auto path_it = endpoint_it->second.find(path);
+  if (path_it == endpoint_it->second.end()) return nullptr;
+  return &path_it->second;
+}
+
+}  // namespace nearby::connections
@@ -0,0 +1,118 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_MULTIPATH_SCHEDULER_H_
+#define CORE_INTERNAL_MULTIPATH_SCHEDULER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "connections/implementation/endpoint_channel.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/mutex.h"
+
+namespace nearby::connections {
+
+// Decides which channel ("path") of an endpoint carries the next payload chunk
+// when the endpoint has several (see kEnableMultipathTransfer).
+//
+// Paths are picked by smooth weighted round-robin, weighted by the measured
+// write throughput of each channel, so that every path carries a share of the
+// chunks proportional to its bandwidth. Unmeasured paths are weighted like the
+// average measured path.
+//
+// Chunks written to additional paths are retained until the remote device
+// acknowledges them with a PATH_ACK frame, so that they can be sent again over
+// the primary path if their path fails first. The remote device drops the
+// duplicates. A path with `kMaxRetainedBytesPerPath` unacknowledged bytes is
+// not picked until acknowledgements come in; nothing is dropped unacknowledged.
+//
+// The scheduler is thread-safe.
+class MultipathScheduler {
+ public:
+  // Unacknowledged bytes past which an additional path gets no more chunks.
+  static constexpr size_t kMaxRetainedBytesPerPath = 4 * 1024 * 1024;
+
+  // The device reading an additional path acknowledges the DATA frames it read
+  // once this many frames, or bytes, came in since its last acknowledgement.
+  // The byte threshold is well below `kMaxRetainedBytesPerPath`, so that a
+  // full path is always acknowledged.
+  static constexpr int kPathAckIntervalFrames = 8;
+  static constexpr size_t kPathAckIntervalBytes = kMaxRetainedBytesPerPath / 4;
+
+  // Returns the path in `paths` that should carry the next chunk. `paths[0]`
+  // is the primary path of the endpoint.
+  EndpointChannel* PickPath(
+      const std::string& endpoint_id,
+      const std::vector<std::shared_ptr<EndpointChannel>>& paths)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Writes `frame`, a serialized payload chunk, to the additional path `path`,
+  // and retains it until the remote device acknowledges it. Frames are retained
+  // in the order they are written to the path, which is the order they are
+  // acknowledged in. If the write fails, or `path` was removed, `frame` is not
+  // retained and has to be sent over another path. `on_written` is passed on
+  // to EndpointChannel::WriteAndNotify().
+  Exception WriteToPath(const std::string& endpoint_id, EndpointChannel* path,
+                        const std::string& frame,
+                        absl::AnyInvocable<void()> on_written = nullptr)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Releases the frames retained for `path`, once the remote device has read
+  // `received_data_frames` of the frames written to it.
+  void OnPathAck(const std::string& endpoint_id, const EndpointChannel* path,
+                 std::int64_t received_data_frames)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Forgets `path` and returns the frames retained for it, oldest first.
+  std::vector<std::string> RemovePath(const std::string& endpoint_id,
+                                      const EndpointChannel* path)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Forgets all paths of `endpoint_id`.
+  void ForgetEndpoint(const std::string& endpoint_id)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  struct PathState {
+    std::int64_t current_weight = 0;
+    std::deque<std::string> retained_frames;
+    size_t retained_bytes = 0;
+    // Frames written to the path, acknowledged or not.
+    std::int64_t written_frames = 0;
+    // Held while a frame is retained and written, so that frames are retained
+    // in the order they are written.
+    std::shared_ptr<Mutex> write_mutex = std::make_shared<Mutex>();
+  };
+  using PathStates = absl::flat_hash_map<const EndpointChannel*, PathState>;
+
+  PathState* FindPathLocked(const std::string& endpoint_id,
+                            const EndpointChannel* path)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  Mutex mutex_;
+  absl::flat_hash_map<std::string, PathStates> endpoints_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace nearby::connections
+
+#endif  // CORE_INTERNAL_MULTIPATH_SCHEDULER_H_
@@ -0,0 +1,184 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/multipath_scheduler.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "connections/implementation/endpoint_channel.h"
+#include "connections/implementation/fake_endpoint_channel.h"
+#include "internal/platform/exception.h"
+#include "proto/connections_enums.pb.h"
+
+namespace nearby::connections {
+namespace {
+
+using ::location::nearby::proto::connections::Medium;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+constexpr char kEndpointId[] = "ABCD";
+constexpr char kServiceId[] = "service";
+
+class MeasuredEndpointChannel : public FakeEndpointChannel {
+ public:
+  MeasuredEndpointChannel(Medium medium, double throughput_bytes_per_second)
+      : FakeEndpointChannel(medium, kServiceId),
+        throughput_bytes_per_second_(throughput_bytes_per_second) {}
+
+  double GetThroughputBytesPerSecond() const override {
+    return throughput_bytes_per_second_;
+  }
+
+ private:
+  const double throughput_bytes_per_second_;
+};
+
+absl::flat_hash_map<EndpointChannel*, int> CountPicks(
+    MultipathScheduler& scheduler,
+    const std::vector<std::shared_ptr<EndpointChannel>>& paths, int picks) {
+  absl::flat_hash_map<EndpointChannel*, int> counts;
+  for (int i = 0; i < picks; ++i) {
+    ++counts[scheduler.PickPath(kEndpointId, paths)];
+  }
+  return counts;
+}
+
+TEST(MultipathSchedulerTest, SinglePathIsAlwaysPicked) {
+  MultipathScheduler scheduler;
+  std::vector<std::shared_ptr<EndpointChannel>> paths = {
+      std::make_shared<MeasuredEndpointChannel>(Medium::WIFI_LAN, 0)};
+
+  EXPECT_EQ(scheduler.PickPath(kEndpointId, paths), paths[0].get());
+  EXPECT_THAT(scheduler.RemovePath(kEndpointId, paths[0].get()), IsEmpty());
+}
+
+TEST(MultipathSchedulerTest, SplitsEvenlyWithoutMeasurements) {
+  MultipathScheduler scheduler;
+  std::vector<std::shared_ptr<EndpointChannel>> paths = {
+      std::make_shared<MeasuredEndpointChannel>(Medium::WIFI_LAN, 0),
+      std::make_shared<MeasuredEndpointChannel>(Medium::BLUETOOTH, 0)};
+
+  auto counts = CountPicks(scheduler, paths, 10);
+
+  EXPECT_EQ(counts[paths[0].get()], 5);
+  EXPECT_EQ(counts[paths[1].get()], 5);
+}
+
+TEST(MultipathSchedulerTest, SplitsProportionallyToThroughput) {
+  MultipathScheduler scheduler;
+  std::vector<std::shared_ptr<EndpointChannel>> paths = {
+      std::make_shared<MeasuredEndpointChannel>(Medium::WIFI_LAN, 3000),
+      std::make_shared<MeasuredEndpointChannel>(Medium::BLUETOOTH, 1000)};
+
+  auto counts = CountPicks(scheduler, paths, 40);
+
+  EXPECT_EQ(counts[paths[0].get()], 30);
+  EXPECT_EQ(counts[paths[1].get()], 10);
+}
+
+TEST(MultipathSchedulerTest, UnmeasuredPathGetsAverageWeight) {
+  MultipathScheduler scheduler;
+  std::vector<std::shared_ptr<EndpointChannel>> paths = {
+      std::make_shared<MeasuredEndpointChannel>(Medium::WIFI_LAN, 2000),
+      std::make_shared<MeasuredEndpointChannel>(Medium::WIFI_DIRECT, 0)};
+
+  auto counts = CountPicks(scheduler, paths, 10);
+
+  EXPECT_EQ(counts[paths[0].get()], 5);
+  EXPECT_EQ(counts[paths[1].get()], 5);
+}
+
+TEST(MultipathSchedulerTest, RetainsFramesUntilAcknowledged) {
+  MultipathScheduler scheduler;
+  std::vector<std::shared_ptr<EndpointChannel>> paths = {
+      std::make_shared<MeasuredEndpointChannel>(Medium::WIFI_LAN, 0),
+      std::make_shared<MeasuredEndpointChannel>(Medium::BLUETOOTH, 0)};
+  scheduler.PickPath(kEndpointId, paths);
+
+  for (const char* frame : {"a", "b", "c", "d"}) {
+    ASSERT_TRUE(
+        scheduler.WriteToPath(kEndpointId, paths[1].get(), frame).Ok());
+  }
+  scheduler.OnPathAck(kEndpointId, paths[1].get(), 2);
+  // Acknowledgements are cumulative; a stale one releases nothing.
+  scheduler.OnPathAck(kEndpointId, paths[1].get(), 1);
+
+  EXPECT_THAT(scheduler.RemovePath(kEndpointId, paths[0].get()), IsEmpty());
+  EXPECT_THAT(scheduler.RemovePath(kEndpointId, paths[1].get()),
+              ElementsAre("c", "d"));
+  // Removing forgets the retained frames.
+  EXPECT_THAT(scheduler.RemovePath(kEndpointId, paths[1].get()), IsEmpty());
+}
+
+TEST(MultipathSchedulerTest, FailedWriteIsNotRetained) {
+  MultipathScheduler scheduler;
+  auto failing = std::make_shared<MeasuredEndpointChannel>(Medium::BLUETOOTH, 0);
+  std::vector<std::shared_ptr<EndpointChannel>> paths = {
+      std::make_shared<MeasuredEndpointChannel>(Medium::WIFI_LAN, 0), failing};
+  scheduler.PickPath(kEndpointId, paths);
+
+  ASSERT_TRUE(scheduler.WriteToPath(kEndpointId, failing.get(), "a").Ok());
+  failing->set_write_output(Exception{Exception::kIo});
+  EXPECT_FALSE(scheduler.WriteToPath(kEndpointId, failing.get(), "b").Ok());
+
+  EXPECT_THAT(scheduler.RemovePath(kEndpointId, failing.get()),
+              ElementsAre("a"));
+  // The path is gone, so nothing can be written to it any more.
+  EXPECT_FALSE(scheduler.WriteToPath(kEndpointId, failing.get(), "c").Ok());
+}
+
+TEST(MultipathSchedulerTest, FullPathIsNotPickedUntilAcknowledged) {
+  MultipathScheduler scheduler;
+  std::vector<std::shared_ptr<EndpointChannel>> paths = {
+      std::make_shared<MeasuredEndpointChannel>(Medium::WIFI_LAN, 1),
+      std::make_shared<MeasuredEndpointChannel>(Medium::BLUETOOTH, 1000000)};
+  std::string frame(MultipathScheduler::kMaxRetainedBytesPerPath / 4, 'x');
+
+  for (int i = 0; i < 4; ++i) {
+    EndpointChannel* path = scheduler.PickPath(kEndpointId, paths);
+    ASSERT_EQ(path, paths[1].get());
+    ASSERT_TRUE(scheduler.WriteToPath(kEndpointId, path, frame).Ok());
+  }
+  // The fast path is full, so the primary path gets the next chunks.
+  EXPECT_EQ(scheduler.PickPath(kEndpointId, paths), paths[0].get());
+  EXPECT_EQ(scheduler.PickPath(kEndpointId, paths), paths[0].get());
+
+  scheduler.OnPathAck(kEndpointId, paths[1].get(), 1);
+
+  EXPECT_EQ(scheduler.PickPath(kEndpointId, paths), paths[1].get());
+  // Nothing unacknowledged was dropped.
+  EXPECT_EQ(scheduler.RemovePath(kEndpointId, paths[1].get()).size(), 3);
+}
+
+TEST(MultipathSchedulerTest, ForgetEndpointDropsRetainedFrames) {
+  MultipathScheduler scheduler;
+  std::vector<std::shared_ptr<EndpointChannel>> paths = {
+      std::make_shared<MeasuredEndpointChannel>(Medium::WIFI_LAN, 1),
+      std::make_shared<MeasuredEndpointChannel>(Medium::BLUETOOTH, 1000)};
+  scheduler.PickPath(kEndpointId, paths);
+  ASSERT_TRUE(scheduler.WriteToPath(kEndpointId, paths[1].get(), "frame").Ok());
+
+  scheduler.ForgetEndpoint(kEndpointId);
+
+  EXPECT_THAT(scheduler.RemovePath(kEndpointId, paths[1].get()), IsEmpty());
+}
+
+}  // namespace
+}  // namespace nearby::connections
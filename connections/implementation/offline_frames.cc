@@ -14,7 +14,9 @@
 
 #include "connections/implementation/offline_frames.h"
 
+#include <cstddef>
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -27,6 +29,10 @@
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
 #include "connections/medium_selector.h"
 #include "connections/status.h"
+#include "google/protobuf/arena.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/message_lite.h"
+#include "google/protobuf/wire_format_lite.h"
 #include "internal/flags/nearby_flags.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/logging.h"
@@ -38,6 +44,7 @@ namespace {
 
 using ExceptionOrOfflineFrame =
     ExceptionOr<::location::nearby::connections::OfflineFrame>;
+using ::google::protobuf::internal::WireFormatLite;
 using ::location::nearby::connections::BandwidthUpgradeNegotiationFrame;
 using ::location::nearby::connections::ConnectionRequestFrame;
 using ::location::nearby::connections::ConnectionResponseFrame;
@@ -49,6 +56,97 @@ using ::location::nearby::connections::OsInfo;
 using ::location::nearby::connections::PayloadTransferFrame;
 using ::location::nearby::connections::V1Frame;
 
+// A length-delimited field within a serialized message.
+struct FieldSpan {
+  // Offsets of the field's tag, and of the first byte after the field.
+  size_t begin = 0;
+  size_t end = 0;
+  // The field's contents.
+  absl::string_view value;
+};
+
+// Finds length-delimited field `field_number` in the serialized message
+// `message`. Fails if the field is missing or occurs more than once, as
+// repeated occurrences would have to be merged.
+bool FindSingleLengthDelimitedField(absl::string_view message,
+                                    int field_number, FieldSpan& span) {
+  google::protobuf::io::CodedInputStream input(
+      reinterpret_cast<const uint8_t*>(message.data()),
+      static_cast<int>(message.size()));
+  bool found = false;
+  while (true) {
+    size_t tag_offset = input.CurrentPosition();
+    uint32_t tag = input.ReadTag();
+    if (tag == 0) return found && input.ConsumedEntireMessage();
+    if (WireFormatLite::GetTagFieldNumber(tag) != field_number) {
+      if (!WireFormatLite::SkipField(&input, tag)) return false;
+      continue;
+    }
+    uint32_t length;
+    if (found ||
+        WireFormatLite::GetTagWireType(tag) !=
+            WireFormatLite::WIRETYPE_LENGTH_DELIMITED ||
+        !input.ReadVarint32(&length)) {
+      return false;
+    }
+    size_t value_offset = input.CurrentPosition();
+    if (!input.Skip(length)) return false;
+    span.begin = tag_offset;
+    span.end = input.CurrentPosition();
+    span.value = message.substr(value_offset, length);
+    found = true;
+  }
+}
+
+// Parses `message` into `proto`, leaving out the field at `span`. Since the
+// encoding of a message is the concatenation of its fields, this equals
+// parsing the whole message and clearing the field afterwards.
+bool ParseWithoutField(absl::string_view message, const FieldSpan& span,
+                       google::protobuf::MessageLite& proto) {
+  return proto.ParseFromString(message.substr(0, span.begin)) &&
+         proto.MergeFromString(message.substr(span.end));
+}
+
+// Parses a PAYLOAD_TRANSFER DATA frame into `frame` without copying the chunk
+// body, which is returned in `body` instead. Fails for any other frame, and
+// for DATA frames encoded in a way the walk below does not handle; these are
+// left for the regular parser.
+bool ParseDataFrameWithoutBody(absl::string_view bytes, OfflineFrame& frame,
+                               absl::string_view& body) {
+  FieldSpan v1;
+  FieldSpan payload_transfer;
+  FieldSpan payload_chunk;
+  FieldSpan chunk_body;
+  if (!FindSingleLengthDelimitedField(bytes, OfflineFrame::kV1FieldNumber,
+                                      v1) ||
+      !FindSingleLengthDelimitedField(
+          v1.value, V1Frame::kPayloadTransferFieldNumber, payload_transfer) ||
+      !FindSingleLengthDelimitedField(
+          payload_transfer.value,
+          PayloadTransferFrame::kPayloadChunkFieldNumber, payload_chunk) ||
+      !FindSingleLengthDelimitedField(
+          payload_chunk.value,
+          PayloadTransferFrame::PayloadChunk::kBodyFieldNumber, chunk_body)) {
+    return false;
+  }
+  if (!ParseWithoutField(bytes, v1, frame)) return false;
+  V1Frame& v1_frame = *frame.mutable_v1();
+  if (!ParseWithoutField(v1.value, payload_transfer, v1_frame)) return false;
+  PayloadTransferFrame& transfer_frame = *v1_frame.mutable_payload_transfer();
+  if (!ParseWithoutField(payload_transfer.value, payload_chunk,
+                         transfer_frame) ||
+      transfer_frame.packet_type() != PayloadTransferFrame::DATA) {
+    return false;
+  }
+  PayloadTransferFrame::PayloadChunk& chunk =
+      *transfer_frame.mutable_payload_chunk();
+  if (!ParseWithoutField(payload_chunk.value, chunk_body, chunk)) return false;
+  // Keeps the frame valid: a DATA chunk must have a body.
+  chunk.set_body("");
+  body = chunk_body.value;
+  return true;
+}
+
 }  // namespace
 
 ExceptionOrOfflineFrame FromBytes(absl::string_view bytes) {
@@ -65,6 +163,23 @@ ExceptionOrOfflineFrame FromBytes(absl::string_view bytes) {
   }
 }
 
+ExceptionOr<ArenaOfflineFrame> FromBytes(absl::string_view bytes,
+                                         google::protobuf::Arena* arena) {
+  ArenaOfflineFrame result;
+  result.frame = google::protobuf::Arena::Create<OfflineFrame>(arena);
+  absl::string_view body;
+  if (ParseDataFrameWithoutBody(bytes, *result.frame, body)) {
+    result.data_body = body;
+  } else if (!result.frame->ParseFromString(bytes)) {
+    return ExceptionOr<ArenaOfflineFrame>(Exception::kInvalidProtocolBuffer);
+  }
+  Exception validation_exception = EnsureValidOfflineFrame(*result.frame);
+  if (validation_exception.Raised()) {
+    return ExceptionOr<ArenaOfflineFrame>(validation_exception);
+  }
+  return ExceptionOr<ArenaOfflineFrame>(result);
+}
+
 V1Frame::FrameType GetFrameType(const OfflineFrame& frame) {
   if ((frame.version() == OfflineFrame::V1) && frame.has_v1()) {
     return frame.v1().type();
@@ -201,6 +316,13 @@ std::string ForConnectionResponse(std::int32_t status, const OsInfo& os_info) {
       NearbyFlags::GetInstance().GetInt64Flag(
           config_package_nearby::nearby_connections_feature::
               kSafeToDisconnectVersion));
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnablePayloadCompression)) {
+    sub_frame->add_supported_payload_compressions(
+        PayloadTransferFrame::PayloadHeader::DEFLATE);
+  }
+  sub_frame->set_supports_multi_chunk_bytes(true);
 
   return frame.SerializeAsString();
 }
@@ -459,6 +581,21 @@ std::string ForBwuSafeToClose() {
   return frame.SerializeAsString();
 }
 
+std::string ForBwuSafeToClose(bool supports_multipath) {
+  OfflineFrame frame;
+
+  frame.set_version(OfflineFrame::V1);
+  auto* v1_frame = frame.mutable_v1();
+  v1_frame->set_type(V1Frame::BANDWIDTH_UPGRADE_NEGOTIATION);
+  auto* sub_frame = v1_frame->mutable_bandwidth_upgrade_negotiation();
+  sub_frame->set_event_type(
+      BandwidthUpgradeNegotiationFrame::SAFE_TO_CLOSE_PRIOR_CHANNEL);
+  sub_frame->mutable_safe_to_close_prior_channel()->set_supports_multipath(
+      supports_multipath);
+
+  return frame.SerializeAsString();
+}
+
 std::string ForBwuIntroduction(const std::string& endpoint_id,
                              bool supports_disabling_encryption) {
   OfflineFrame frame;
@@ -551,6 +688,17 @@ std::string ForKeepAlive(bool ack, uint32_t seq_num) {
   return frame.SerializeAsString();
 }
 
+std::string ForPathAck(std::int64_t received_data_frames) {
+  OfflineFrame frame;
+
+  frame.set_version(OfflineFrame::V1);
+  auto* v1_frame = frame.mutable_v1();
+  v1_frame->set_type(V1Frame::PATH_ACK);
+  v1_frame->mutable_path_ack()->set_received_data_frames(received_data_frames);
+
+  return frame.SerializeAsString();
+}
+
 std::string ForDisconnection(bool request_safe_to_disconnect,
                            bool ack_safe_to_disconnect) {
   OfflineFrame frame;
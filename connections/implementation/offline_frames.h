@@ -16,6 +16,7 @@
 #define CORE_INTERNAL_OFFLINE_FRAMES_H_
 
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -23,6 +24,7 @@
 #include "connections/connection_options.h"
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
 #include "connections/medium_selector.h"
+#include "google/protobuf/arena.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/mac_address.h"
 #include "internal/platform/service_address.h"
@@ -45,6 +47,23 @@ using WifiDirectAuthType =
 ExceptionOr<location::nearby::connections::OfflineFrame> FromBytes(
     absl::string_view offline_frame_bytes);
 
+// An incoming message parsed by FromBytes(bytes, arena).
+struct ArenaOfflineFrame {
+  // Allocated on, and owned by, the arena.
+  location::nearby::connections::OfflineFrame* frame = nullptr;
+  // Set for PAYLOAD_TRANSFER DATA frames only: the chunk body, as a view into
+  // the parsed bytes. The body is not copied into `frame`, whose chunk body is
+  // left empty.
+  std::optional<absl::string_view> data_body;
+};
+
+// Parses incoming message like FromBytes() above, but allocates the frame on
+// `arena` so that a reader can reuse the memory for the next frame.
+// The result is valid until `arena` is reset, and `data_body` as long as
+// `offline_frame_bytes` is.
+ExceptionOr<ArenaOfflineFrame> FromBytes(absl::string_view offline_frame_bytes,
+                                         google::protobuf::Arena* arena);
+
 // Returns FrameType of a parsed message, or
 // V1Frame::UNKNOWN_FRAME_TYPE, if frame contents is not recognized.
 location::nearby::connections::V1Frame::FrameType GetFrameType(
@@ -111,9 +130,11 @@ std::string ForBwuPathRequest(
     const location::nearby::connections::MediumRole& medium_role);
 std::string ForBwuLastWrite();
 std::string ForBwuSafeToClose();
+std::string ForBwuSafeToClose(bool supports_multipath);
 
 std::string ForKeepAlive();
 std::string ForKeepAlive(bool ack, uint32_t seq_num);
+std::string ForPathAck(std::int64_t received_data_frames);
 std::string ForDisconnection(bool request_safe_to_disconnect,
                            bool ack_safe_to_disconnect);
 UpgradePathInfo::Medium MediumToUpgradePathInfoMedium(Medium medium);
@@ -0,0 +1,138 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures parser::FromBytes() on the receive path, with and without an arena,
+// for the frame types seen most often during a transfer. Reports heap
+// allocations and nanoseconds per parsed frame:
+//
+//   bazel run -c opt //connections/implementation:offline_frames_benchmark
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "connections/implementation/offline_frames.h"
+#include "connections/implementation/proto/offline_wire_formats.pb.h"
+#include "google/protobuf/arena.h"
+#include "internal/platform/mac_address.h"
+
+namespace {
+
+std::atomic<std::int64_t> g_allocations{0};
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace nearby::connections::parser {
+namespace {
+
+using ::location::nearby::connections::PayloadTransferFrame;
+
+constexpr int kIterations = 100000;
+// A typical chunk size on Wi-Fi mediums.
+constexpr std::size_t kDataChunkSize = 64 * 1024;
+// Initial arena block; a DATA frame without its body fits easily.
+constexpr std::size_t kArenaBlockSize = 4 * 1024;
+
+struct Result {
+  double allocations_per_frame;
+  double ns_per_frame;
+};
+
+template <typename Parse>
+Result Measure(Parse parse) {
+  // Warm up, so that lazily initialized state is not counted.
+  parse();
+  std::int64_t allocations = g_allocations.load();
+  absl::Time start = absl::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    if (!parse()) {
+      std::fprintf(stderr, "Failed to parse frame.\n");
+      std::exit(1);
+    }
+  }
+  absl::Duration elapsed = absl::Now() - start;
+  return {
+      .allocations_per_frame =
+          static_cast<double>(g_allocations.load() - allocations) / kIterations,
+      .ns_per_frame = absl::ToDoubleNanoseconds(elapsed) / kIterations,
+  };
+}
+
+void Run(const char* name, const std::string& bytes) {
+  Result heap = Measure([&bytes]() { return FromBytes(bytes).ok(); });
+
+  std::vector<char> initial_block(kArenaBlockSize);
+  google::protobuf::ArenaOptions options;
+  options.initial_block = initial_block.data();
+  options.initial_block_size = initial_block.size();
+  google::protobuf::Arena arena(options);
+  Result on_arena = Measure([&bytes, &arena]() {
+    bool ok = FromBytes(bytes, &arena).ok();
+    arena.Reset();
+    return ok;
+  });
+
+  std::printf("%-12s %8zu %12.2f %10.1f %12.2f %10.1f\n", name, bytes.size(),
+              heap.allocations_per_frame, heap.ns_per_frame,
+              on_arena.allocations_per_frame, on_arena.ns_per_frame);
+}
+
+void RunAll() {
+  PayloadTransferFrame::PayloadHeader header;
+  header.set_id(1234567890);
+  header.set_type(PayloadTransferFrame::PayloadHeader::FILE);
+  header.set_total_size(100 * kDataChunkSize);
+  header.set_file_name("benchmark.bin");
+  PayloadTransferFrame::PayloadChunk chunk;
+  chunk.set_flags(0);
+  chunk.set_offset(10 * kDataChunkSize);
+  chunk.set_body(std::string(kDataChunkSize, 'x'));
+  PayloadTransferFrame::ControlMessage control;
+  control.set_event(PayloadTransferFrame::ControlMessage::PAYLOAD_CANCELED);
+  control.set_offset(10 * kDataChunkSize);
+
+  std::printf("%-12s %8s %12s %10s %12s %10s\n", "frame", "bytes",
+              "heap allocs", "heap ns", "arena allocs", "arena ns");
+  Run("DATA", ForDataPayloadTransfer(header, chunk));
+  Run("CONTROL", ForControlPayloadTransfer(header, control));
+  Run("KEEP_ALIVE", ForKeepAlive(/*ack=*/true, /*seq_num=*/42));
+  MacAddress mac_address;
+  MacAddress::FromString("AA:BB:CC:DD:EE:FF", mac_address);
+  Run("BWU", ForBwuBluetoothPathAvailable("service", mac_address));
+}
+
+}  // namespace
+}  // namespace nearby::connections::parser
+
+int main() {
+  nearby::connections::parser::RunAll();
+  return 0;
+}
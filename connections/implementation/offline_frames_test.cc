@@ -27,8 +27,10 @@
 #include "connections/connection_options.h"
 #include "connections/implementation/flags/nearby_connections_feature_flags.h"
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
+#include "google/protobuf/arena.h"
 #include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
 #include "internal/platform/mac_address.h"
 #include "internal/platform/service_address.h"
 
@@ -98,6 +100,96 @@ TEST(OfflineFramesTest, CanParseMessageFromBytes) {
       std::vector(kMediums.begin(), kMediums.end()));
 }
 
+TEST(OfflineFramesTest, ArenaFromBytesPassesDataBodyAsView) {
+  PayloadTransferFrame::PayloadHeader header;
+  PayloadTransferFrame::PayloadChunk chunk;
+  header.set_id(12345);
+  header.set_type(PayloadTransferFrame::PayloadHeader::FILE);
+  header.set_total_size(1024);
+  chunk.set_body("payload data");
+  chunk.set_offset(150);
+  chunk.set_flags(0);
+  std::string bytes = ForDataPayloadTransfer(header, chunk);
+
+  constexpr absl::string_view kExpected =
+      R"pb(
+    version: V1
+    v1: <
+      type: PAYLOAD_TRANSFER
+      payload_transfer: <
+        packet_type: DATA,
+        payload_header: < type: FILE id: 12345 total_size: 1024 >
+        payload_chunk: < flags: 0 offset: 150 body: "" >
+      >
+    >)pb";
+  google::protobuf::Arena arena;
+  auto response = FromBytes(bytes, &arena);
+  ASSERT_TRUE(response.ok());
+  EXPECT_THAT(*response.result().frame, EqualsProto(kExpected));
+  ASSERT_TRUE(response.result().data_body.has_value());
+  absl::string_view body = *response.result().data_body;
+  EXPECT_EQ(body, "payload data");
+  // The body was not copied.
+  EXPECT_GE(body.data(), bytes.data());
+  EXPECT_LE(body.data() + body.size(), bytes.data() + bytes.size());
+}
+
+TEST(OfflineFramesTest, ArenaFromBytesParsesOtherFramesFully) {
+  PayloadTransferFrame::PayloadHeader header;
+  PayloadTransferFrame::ControlMessage control;
+  header.set_id(12345);
+  header.set_type(PayloadTransferFrame::PayloadHeader::BYTES);
+  header.set_total_size(1024);
+  control.set_event(PayloadTransferFrame::ControlMessage::PAYLOAD_CANCELED);
+  control.set_offset(150);
+  google::protobuf::Arena arena;
+
+  for (const std::string& bytes :
+       {ForControlPayloadTransfer(header, control), ForKeepAlive(),
+        ForBwuLastWrite()}) {
+    auto expected = FromBytes(bytes);
+    ASSERT_TRUE(expected.ok());
+    auto response = FromBytes(bytes, &arena);
+    ASSERT_TRUE(response.ok());
+    EXPECT_THAT(*response.result().frame, EqualsProto(expected.result()));
+    EXPECT_FALSE(response.result().data_body.has_value());
+  }
+}
+
+TEST(OfflineFramesTest, ArenaFromBytesMergesRepeatedDataFields) {
+  PayloadTransferFrame::PayloadHeader header;
+  PayloadTransferFrame::PayloadChunk chunk;
+  header.set_id(12345);
+  header.set_type(PayloadTransferFrame::PayloadHeader::FILE);
+  header.set_total_size(1024);
+  chunk.set_body("first");
+  chunk.set_offset(0);
+  chunk.set_flags(0);
+  PayloadTransferFrame::PayloadChunk second_chunk;
+  second_chunk.set_body("second");
+  // Concatenated messages are merged; the fast path must not pick the first
+  // body.
+  std::string bytes = ForDataPayloadTransfer(header, chunk) +
+                      ForDataPayloadTransfer(header, second_chunk);
+  google::protobuf::Arena arena;
+
+  auto response = FromBytes(bytes, &arena);
+  ASSERT_TRUE(response.ok());
+  auto expected = FromBytes(bytes);
+  ASSERT_TRUE(expected.ok());
+  EXPECT_THAT(*response.result().frame, EqualsProto(expected.result()));
+  EXPECT_EQ(response.result().frame->v1().payload_transfer().payload_chunk()
+                .body(),
+            "second");
+}
+
+TEST(OfflineFramesTest, ArenaFromBytesRejectsMalformedFrames) {
+  google::protobuf::Arena arena;
+
+  auto response = FromBytes("\x12\xff\x01garbage", &arena);
+  EXPECT_EQ(response.exception(), Exception::kInvalidProtocolBuffer);
+}
+
 TEST(OfflineFramesTest, CanGenerateLegacyConnectionRequest) {
   constexpr absl::string_view kExpected =
       R"pb(
@@ -352,6 +444,7 @@ TEST(OfflineFramesTest, CanGenerateConnectionResponse) {
         os_info { type: LINUX }
         multiplex_socket_bitmask: 0
         safe_to_disconnect_version: 5
+        supports_multi_chunk_bytes: true
       >
     >)pb";
 
@@ -668,6 +761,23 @@ TEST(OfflineFramesTest, CanGenerateBwuSafeToClose) {
   EXPECT_THAT(message, EqualsProto(kExpected));
 }
 
+TEST(OfflineFramesTest, CanGenerateBwuSafeToCloseWithMultipath) {
+  constexpr absl::string_view kExpected =
+      R"pb(
+    version: V1
+    v1: <
+      type: BANDWIDTH_UPGRADE_NEGOTIATION
+      bandwidth_upgrade_negotiation: <
+        event_type: SAFE_TO_CLOSE_PRIOR_CHANNEL
+        safe_to_close_prior_channel: < supports_multipath: true >
+      >
+    >)pb";
+  auto response = FromBytes(ForBwuSafeToClose(/*supports_multipath=*/true));
+  ASSERT_TRUE(response.ok());
+  OfflineFrame message = response.result();
+  EXPECT_THAT(message, EqualsProto(kExpected));
+}
+
 TEST(OfflineFramesTest, CanGenerateBwuIntroduction) {
   constexpr absl::string_view kExpected =
       R"pb(
@@ -703,6 +813,20 @@ TEST(OfflineFramesTest, CanGenerateKeepAlive) {
   EXPECT_THAT(message, EqualsProto(kExpected));
 }
 
+TEST(OfflineFramesTest, CanGeneratePathAck) {
+  constexpr absl::string_view kExpected =
+      R"pb(
+    version: V1
+    v1: <
+      type: PATH_ACK
+      path_ack: < received_data_frames: 42 >
+    >)pb";
+  auto response = FromBytes(ForPathAck(42));
+  ASSERT_TRUE(response.ok());
+  OfflineFrame message = response.result();
+  EXPECT_THAT(message, EqualsProto(kExpected));
+}
+
 TEST(OfflineFramesTest, CanGenerateDisconnection) {
   constexpr absl::string_view kExpected =
       R"pb(
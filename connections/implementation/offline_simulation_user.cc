@@ -69,6 +69,16 @@ void OfflineSimulationUser::OnEndpointDisconnect(
   if (disconnect_latch_) disconnect_latch_->CountDown();
 }
 
+void OfflineSimulationUser::OnBandwidthChanged(const std::string& endpoint_id,
+                                               Medium medium) {
+  Medium previous = medium_.exchange(medium);
+  // The first report only tells the medium the connection was established on.
+  if (previous != Medium::UNKNOWN_MEDIUM && previous != medium &&
+      upgrade_latch_) {
+    upgrade_latch_->CountDown();
+  }
+}
+
 void OfflineSimulationUser::OnEndpointFound(const std::string& endpoint_id,
                                             const ByteArray& endpoint_info,
                                             const std::string& service_id) {
@@ -131,6 +141,8 @@ Status OfflineSimulationUser::StartAdvertising(const std::string& service_id,
           absl::bind_front(&OfflineSimulationUser::OnConnectionRejected, this),
       .disconnected_cb =
           absl::bind_front(&OfflineSimulationUser::OnEndpointDisconnect, this),
+      .bandwidth_changed_cb =
+          absl::bind_front(&OfflineSimulationUser::OnBandwidthChanged, this),
   };
   return ctrl_.StartAdvertising(&client_, service_id_, advertising_options_,
                                 {
@@ -188,6 +200,8 @@ Status OfflineSimulationUser::RequestConnection(CountDownLatch* latch) {
           absl::bind_front(&OfflineSimulationUser::OnConnectionRejected, this),
       .disconnected_cb =
           absl::bind_front(&OfflineSimulationUser::OnEndpointDisconnect, this),
+      .bandwidth_changed_cb =
+          absl::bind_front(&OfflineSimulationUser::OnBandwidthChanged, this),
   };
   client_.AddCancellationFlag(discovered_.endpoint_id);
   return ctrl_.RequestConnection(&client_, discovered_.endpoint_id,
@@ -211,6 +225,8 @@ Status OfflineSimulationUser::RequestConnectionV3(
           absl::bind_front(&OfflineSimulationUser::OnConnectionRejected, this),
       .disconnected_cb =
           absl::bind_front(&OfflineSimulationUser::OnEndpointDisconnect, this),
+      .bandwidth_changed_cb =
+          absl::bind_front(&OfflineSimulationUser::OnBandwidthChanged, this),
   };
   client_.AddCancellationFlag(remote_device.GetEndpointId());
   return ctrl_.RequestConnectionV3(
@@ -15,6 +15,7 @@
 #ifndef CORE_INTERNAL_OFFLINE_SIMULATION_USER_H_
 #define CORE_INTERNAL_OFFLINE_SIMULATION_USER_H_
 
+#include <atomic>
 #include <string>
 #include <utility>
 #include <vector>
@@ -66,7 +67,8 @@ class OfflineSimulationUser {
 
   explicit OfflineSimulationUser(
       absl::string_view device_name,
-      BooleanMediumSelector allowed = BooleanMediumSelector())
+      BooleanMediumSelector allowed = BooleanMediumSelector(),
+      const BwuManager::Config& bwu_config = BwuManager::Config())
       : info_{ByteArray{std::string(device_name)}},
         advertising_options_{
             {
@@ -86,7 +88,7 @@ class OfflineSimulationUser {
             Strategy::kP2pCluster,
             allowed,
         }},
-        ctrl_(BwuManager::Config()) {}
+        ctrl_(bwu_config) {}
   virtual ~OfflineSimulationUser() = default;
 
   // Calls PcpManager::StartAdvertising().
@@ -152,6 +154,14 @@ class OfflineSimulationUser {
 
   void ExpectPayload(CountDownLatch& latch) { payload_latch_ = &latch; }
   void ExpectDisconnect(CountDownLatch& latch) { disconnect_latch_ = &latch; }
+  // latch.CountDown() will be called whenever the connection moves to another
+  // medium after it has been established.
+  void ExpectBandwidthUpgrade(CountDownLatch& latch) {
+    upgrade_latch_ = &latch;
+  }
+
+  // Returns the medium last reported by the bandwidth_changed_cb callback.
+  Medium GetMedium() const { return medium_; }
 
   const DiscoveredInfo& GetDiscovered() const { return discovered_; }
   ByteArray GetInfo() const { return info_; }
@@ -220,6 +230,7 @@ class OfflineSimulationUser {
   void OnConnectionAccepted(const std::string& endpoint_id);
   void OnConnectionRejected(const std::string& endpoint_id, Status status);
   void OnEndpointDisconnect(const std::string& endpoint_id);
+  void OnBandwidthChanged(const std::string& endpoint_id, Medium medium);
 
   // DiscoveryListener callbacks
   void OnEndpointFound(const std::string& endpoint_id,
@@ -250,6 +261,8 @@ class OfflineSimulationUser {
   CountDownLatch* lost_latch_ = nullptr;
   CountDownLatch* payload_latch_ = nullptr;
   CountDownLatch* disconnect_latch_ = nullptr;
+  CountDownLatch* upgrade_latch_ = nullptr;
+  std::atomic<Medium> medium_ = Medium::UNKNOWN_MEDIUM;
   Future<bool>* future_ = nullptr;
   absl::AnyInvocable<bool(const PayloadProgressInfo&)> predicate_;
   ClientProxy client_;
@@ -50,7 +50,7 @@
 #include "connections/implementation/mediums/bluetooth_classic.h"
 #include "connections/implementation/mediums/bluetooth_endpoint_channel.h"
 #include "connections/implementation/mediums/mediums.h"
-#include "connections/implementation/mediums/utils.h"
+#include "connections/implementation/mediums/service_id_identity.h"
 #include "connections/implementation/mediums/wifi_lan_endpoint_channel.h"
 #include "connections/implementation/pcp.h"
 #include "connections/implementation/pcp_handler.h"
@@ -94,11 +94,6 @@ using ::nearby::analytics::OperationResultWithMedium;
 
 }  // namespace
 
-ByteArray P2pClusterPcpHandler::GenerateHash(const std::string& source,
-                                             size_t size) {
-  return Utils::Sha256Hash(source, size);
-}
-
 bool P2pClusterPcpHandler::ShouldAdvertiseBluetoothMacOverBle(
     PowerLevel power_level) {
   return power_level == PowerLevel::kHighPower;
@@ -208,8 +203,8 @@ BasePcpHandler::StartOperationResult P2pClusterPcpHandler::StartAdvertisingImpl(
   }
 
   if (advertising_options.allowed.bluetooth) {
-    const ByteArray bluetooth_hash =
-        GenerateHash(service_id, BluetoothDeviceName::kServiceIdHashLength);
+    const ByteArray bluetooth_hash = ServiceIdIdentity::Get(service_id).GetHash(
+        BluetoothDeviceName::kServiceIdHashLength);
     ErrorOr<Medium> bluetooth_result = StartBluetoothAdvertising(
         client, service_id, bluetooth_hash, local_endpoint_id,
         local_endpoint_info, web_rtc_state);
@@ -344,7 +339,8 @@ bool P2pClusterPcpHandler::IsRecognizedBluetoothEndpoint(
   }
 
   ByteArray expected_service_id_hash =
-      GenerateHash(service_id, BluetoothDeviceName::kServiceIdHashLength);
+      ServiceIdIdentity::Get(service_id).GetHash(
+          BluetoothDeviceName::kServiceIdHashLength);
 
   if (name.GetServiceIdHash() != expected_service_id_hash) {
     LOG(INFO) << name_string
@@ -551,8 +547,9 @@ bool P2pClusterPcpHandler::IsRecognizedBleEndpoint(
   // Check ServiceId for normal advertisement.
   // ServiceIdHash is empty for fast advertisement.
   if (!advertisement.IsFastAdvertisement()) {
-    ByteArray expected_service_id_hash = GenerateHash(
-        std::string(service_id), BleAdvertisement::kServiceIdHashLength);
+    ByteArray expected_service_id_hash =
+        ServiceIdIdentity::Get(service_id).GetHash(
+            BleAdvertisement::kServiceIdHashLength);
 
     if (advertisement.GetServiceIdHash() != expected_service_id_hash) {
       LOG(INFO)
@@ -925,7 +922,8 @@ bool P2pClusterPcpHandler::IsRecognizedWifiServiceEndpoint(
   }
 
   ByteArray expected_service_id_hash =
-      GenerateHash(service_id, WifiLanServiceInfo::kServiceIdHashLength);
+      ServiceIdIdentity::Get(service_id).GetHash(
+          WifiLanServiceInfo::kServiceIdHashLength);
 
   if (wifi_lan_service_info.GetServiceIdHash() != expected_service_id_hash) {
     LOG(INFO)
@@ -1530,8 +1528,9 @@ P2pClusterPcpHandler::UpdateAdvertisingOptionsImpl(
               client, BLUETOOTH, update_index,
               OperationResultCode::DETAIL_SUCCESS));
     } else {
-      const ByteArray bluetooth_hash = GenerateHash(
-          std::string(service_id), BluetoothDeviceName::kServiceIdHashLength);
+      const ByteArray bluetooth_hash =
+          ServiceIdIdentity::Get(service_id).GetHash(
+              BluetoothDeviceName::kServiceIdHashLength);
       ErrorOr<Medium> bluetooth_result = StartBluetoothAdvertising(
           client, std::string(service_id), bluetooth_hash,
           std::string(local_endpoint_id),
@@ -2207,7 +2206,8 @@ ErrorOr<Medium> P2pClusterPcpHandler::StartBleAdvertising(
                          local_endpoint_info, /*uwb_address=*/ByteArray{}));
   } else {
     const ByteArray service_id_hash =
-        GenerateHash(service_id, BleAdvertisement::kServiceIdHashLength);
+        ServiceIdIdentity::Get(service_id).GetHash(
+            BleAdvertisement::kServiceIdHashLength);
     MacAddress bluetooth_mac_address;
     if (bluetooth_medium_.IsAvailable() &&
         ShouldAdvertiseBluetoothMacOverBle(power_level))
@@ -2511,8 +2511,8 @@ ErrorOr<Medium> P2pClusterPcpHandler::StartAwdlAdvertising(
   }
 
   // Generate a WifiLanServiceInfo with which to become AWDL discoverable.
-  const ByteArray service_id_hash =
-      GenerateHash(service_id, WifiLanServiceInfo::kServiceIdHashLength);
+  const ByteArray service_id_hash = ServiceIdIdentity::Get(service_id).GetHash(
+      WifiLanServiceInfo::kServiceIdHashLength);
   WifiLanServiceInfo service_info{kWifiLanServiceInfoVersion,
                                   GetPcp(),
                                   local_endpoint_id,
@@ -2572,8 +2572,8 @@ ErrorOr<Medium> P2pClusterPcpHandler::StartWifiLanAdvertising(
             << service_id << ": start";
   // Generate a WifiLanServiceInfo with which to become WifiLan discoverable.
   // TODO(b/169550050): Implement UWBAddress.
-  const ByteArray service_id_hash =
-      GenerateHash(service_id, WifiLanServiceInfo::kServiceIdHashLength);
+  const ByteArray service_id_hash = ServiceIdIdentity::Get(service_id).GetHash(
+      WifiLanServiceInfo::kServiceIdHashLength);
   WifiLanServiceInfo service_info{kWifiLanServiceInfoVersion,
                                   GetPcp(),
                                   local_endpoint_id,
@@ -2770,7 +2770,8 @@ Status P2pClusterPcpHandler::InjectBluetoothEndpoint(
       injected_bluetooth_device_store_.CreateInjectedBluetoothDevice(
           metadata.remote_bluetooth_mac_address, metadata.endpoint_id,
           metadata.endpoint_info,
-          GenerateHash(service_id, BluetoothDeviceName::kServiceIdHashLength),
+          ServiceIdIdentity::Get(service_id).GetHash(
+              BluetoothDeviceName::kServiceIdHashLength),
           GetPcp());
 
   if (!remote_bluetooth_device.IsValid()) {
@@ -173,7 +173,6 @@ class P2pClusterPcpHandler : public BasePcpHandler {
   static constexpr WifiLanServiceInfo::Version kWifiLanServiceInfoVersion =
       WifiLanServiceInfo::Version::kV1;
 
-  static ByteArray GenerateHash(const std::string& source, size_t size);
   static bool ShouldAdvertiseBluetoothMacOverBle(PowerLevel power_level);
   static bool ShouldAcceptBluetoothConnections(
       const AdvertisingOptions& advertising_options);
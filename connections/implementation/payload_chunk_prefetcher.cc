@@ -0,0 +1,67 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/payload_chunk_prefetcher.h"
+
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+#include "absl/functional/any_invocable.h"
+#include "connections/implementation/internal_payload.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/logging.h"
+
+namespace nearby::connections {
+
+PayloadChunkPrefetcher::PayloadChunkPrefetcher(
+    InternalPayload* payload, size_t depth,
+    absl::AnyInvocable<int()> chunk_size_provider)
+    : payload_(payload),
+      chunk_size_provider_(std::move(chunk_size_provider)),
+      chunks_(depth) {}
+
+PayloadChunkPrefetcher::~PayloadChunkPrefetcher() { Stop(); }
+
+ByteArray PayloadChunkPrefetcher::NextChunk() {
+  if (!started_) {
+    started_ = true;
+    executor_.Execute("prefetch-payload", [this]() { ReadLoop(); });
+  }
+  std::optional<ByteArray> chunk = chunks_.Take();
+  return chunk.has_value() ? std::move(*chunk) : ByteArray();
+}
+
+void PayloadChunkPrefetcher::Stop() {
+  chunks_.Close();
+  executor_.Shutdown();
+}
+
+void PayloadChunkPrefetcher::ReadLoop() {
+  while (!chunks_.IsClosed()) {
+    int chunk_size = chunk_size_provider_();
+    if (chunk_size <= 0) {
+      VLOG(1) << "PayloadChunkPrefetcher: no chunk size for payload_id="
+              << payload_->GetId() << ", stopping.";
+      break;
+    }
+    ByteArray chunk = payload_->DetachNextChunk(chunk_size);
+    bool end_of_payload = chunk.Empty();
+    if (!chunks_.Put(std::move(chunk)) || end_of_payload) break;
+  }
+  // Wakes up the sender if it is waiting for a chunk that will never come.
+  chunks_.Close();
+}
+
+}  // namespace nearby::connections
@@ -0,0 +1,67 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_PAYLOAD_CHUNK_PREFETCHER_H_
+#define CORE_INTERNAL_PAYLOAD_CHUNK_PREFETCHER_H_
+
+#include <cstddef>
+
+#include "absl/functional/any_invocable.h"
+#include "connections/implementation/internal_payload.h"
+#include "internal/platform/bounded_blocking_queue.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/single_thread_executor.h"
+
+namespace nearby::connections {
+
+// Reads the chunks of an outgoing payload ahead of the sender on a dedicated
+// thread, so that reading from disk overlaps with framing, encryption and
+// writing the previous chunks.
+//
+// At most `depth` chunks are buffered. Reading starts on the first call to
+// NextChunk(), which lets the sender skip to a resume offset first.
+class PayloadChunkPrefetcher {
+ public:
+  // `chunk_size_provider` is called on the prefetch thread before each read;
+  // returning a non-positive size ends the payload early.
+  PayloadChunkPrefetcher(InternalPayload* payload, size_t depth,
+                         absl::AnyInvocable<int()> chunk_size_provider);
+  ~PayloadChunkPrefetcher();
+
+  PayloadChunkPrefetcher(const PayloadChunkPrefetcher&) = delete;
+  PayloadChunkPrefetcher& operator=(const PayloadChunkPrefetcher&) = delete;
+
+  // Blocks until the next chunk has been read. Returns an empty chunk at the
+  // end of the payload, on a read error, or after Stop().
+  ByteArray NextChunk();
+
+  // Stops reading ahead and waits for the prefetch thread to exit. A read
+  // blocked on a stream payload only returns once the payload is closed, so
+  // callers that abort a stream transfer must close the payload first.
+  void Stop();
+
+ private:
+  void ReadLoop();
+
+  InternalPayload* const payload_;
+  absl::AnyInvocable<int()> chunk_size_provider_;
+  BoundedBlockingQueue<ByteArray> chunks_;
+  // Only touched by the sender thread.
+  bool started_ = false;
+  SingleThreadExecutor executor_;
+};
+
+}  // namespace nearby::connections
+
+#endif  // CORE_INTERNAL_PAYLOAD_CHUNK_PREFETCHER_H_
@@ -0,0 +1,131 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/payload_chunk_prefetcher.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "connections/implementation/internal_payload.h"
+#include "connections/implementation/proto/offline_wire_formats.pb.h"
+#include "connections/payload.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+
+namespace nearby::connections {
+namespace {
+
+using ::location::nearby::connections::PayloadTransferFrame;
+
+// Produces `num_chunks` chunks; chunk `i` is filled with 'a' + i.
+class FakeInternalPayload : public InternalPayload {
+ public:
+  explicit FakeInternalPayload(int num_chunks)
+      : InternalPayload(Payload(ByteArray())), num_chunks_(num_chunks) {}
+
+  PayloadTransferFrame::PayloadHeader::PayloadType GetType() const override {
+    return PayloadTransferFrame::PayloadHeader::BYTES;
+  }
+  std::int64_t GetTotalSize() const override { return kIndeterminateSize; }
+  ByteArray DetachNextChunk(int chunk_size) override {
+    int index = reads_++;
+    if (index >= num_chunks_) return {};
+    return ByteArray(std::string(chunk_size, 'a' + index % 26));
+  }
+  Exception AttachNextChunk(absl::string_view chunk) override {
+    return {Exception::kIo};
+  }
+  ExceptionOr<size_t> SkipToOffset(size_t offset) override {
+    return {Exception::kIo};
+  }
+
+  int reads() const { return reads_; }
+
+ private:
+  const int num_chunks_;
+  std::atomic_int reads_ = 0;
+};
+
+TEST(PayloadChunkPrefetcherTest, ReturnsChunksInOrder) {
+  FakeInternalPayload payload(3);
+  PayloadChunkPrefetcher prefetcher(&payload, /*depth=*/2, []() { return 4; });
+
+  EXPECT_EQ(prefetcher.NextChunk(), ByteArray("aaaa"));
+  EXPECT_EQ(prefetcher.NextChunk(), ByteArray("bbbb"));
+  EXPECT_EQ(prefetcher.NextChunk(), ByteArray("cccc"));
+  EXPECT_TRUE(prefetcher.NextChunk().Empty());
+  // Reading past the end keeps returning empty chunks.
+  EXPECT_TRUE(prefetcher.NextChunk().Empty());
+}
+
+TEST(PayloadChunkPrefetcherTest, UsesChunkSizeFromProvider) {
+  FakeInternalPayload payload(2);
+  int chunk_size = 1;
+  PayloadChunkPrefetcher prefetcher(&payload, /*depth=*/1,
+                                    [&chunk_size]() { return chunk_size++; });
+
+  EXPECT_EQ(prefetcher.NextChunk().size(), 1);
+  EXPECT_EQ(prefetcher.NextChunk().size(), 2);
+}
+
+TEST(PayloadChunkPrefetcherTest, DoesNotReadBeforeFirstChunkIsRequested) {
+  FakeInternalPayload payload(10);
+  PayloadChunkPrefetcher prefetcher(&payload, /*depth=*/4, []() { return 4; });
+
+  absl::SleepFor(absl::Milliseconds(50));
+
+  EXPECT_EQ(payload.reads(), 0);
+}
+
+TEST(PayloadChunkPrefetcherTest, ReadsAheadAtMostDepthChunks) {
+  constexpr size_t kDepth = 3;
+  FakeInternalPayload payload(100);
+  PayloadChunkPrefetcher prefetcher(&payload, kDepth, []() { return 4; });
+
+  EXPECT_FALSE(prefetcher.NextChunk().Empty());
+  absl::SleepFor(absl::Milliseconds(100));
+
+  // One chunk handed out, `kDepth` queued and one blocked waiting for space.
+  EXPECT_GT(payload.reads(), 1);
+  EXPECT_LE(payload.reads(), kDepth + 2);
+}
+
+TEST(PayloadChunkPrefetcherTest, NonPositiveChunkSizeEndsPayload) {
+  FakeInternalPayload payload(10);
+  PayloadChunkPrefetcher prefetcher(&payload, /*depth=*/2, []() { return 0; });
+
+  EXPECT_TRUE(prefetcher.NextChunk().Empty());
+  EXPECT_EQ(payload.reads(), 0);
+}
+
+TEST(PayloadChunkPrefetcherTest, StopEndsPayload) {
+  FakeInternalPayload payload(100);
+  PayloadChunkPrefetcher prefetcher(&payload, /*depth=*/2, []() { return 4; });
+  EXPECT_FALSE(prefetcher.NextChunk().Empty());
+
+  prefetcher.Stop();
+
+  int reads = payload.reads();
+  absl::SleepFor(absl::Milliseconds(50));
+  EXPECT_EQ(payload.reads(), reads);
+}
+
+}  // namespace
+}  // namespace nearby::connections
@@ -0,0 +1,141 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/payload_chunk_reassembler.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "connections/implementation/proto/offline_wire_formats.pb.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/logging.h"
+#include "internal/platform/mutex_lock.h"
+
+namespace nearby::connections {
+
+namespace {
+
+bool IsLastChunk(const PayloadChunkReassembler::PayloadTransferFrame& frame) {
+  return (frame.payload_chunk().flags() &
+          PayloadChunkReassembler::PayloadTransferFrame::PayloadChunk::
+              LAST_CHUNK) != 0;
+}
+
+bool IsCompressed(const PayloadChunkReassembler::PayloadTransferFrame& frame) {
+  return frame.payload_header().compression() ==
+         PayloadChunkReassembler::PayloadTransferFrame::PayloadHeader::DEFLATE;
+}
+
+}  // namespace
+
+std::int64_t PayloadChunkReassembler::GetPosition(
+    const PayloadTransferFrame& frame) {
+  return IsCompressed(frame) ? frame.payload_chunk().index()
+                             : frame.payload_chunk().offset();
+}
+
+std::int64_t PayloadChunkReassembler::GetNextPosition(
+    const PayloadTransferFrame& frame, size_t body_size) {
+  return GetPosition(frame) + (IsCompressed(frame) ? 1 : body_size);
+}
+
+ExceptionOr<std::vector<PayloadChunkReassembler::PayloadTransferFrame>>
+PayloadChunkReassembler::Add(const std::string& endpoint_id,
+                             PayloadTransferFrame frame,
+                             std::optional<std::int64_t> next_position) {
+  Key key{endpoint_id, frame.payload_header().id()};
+  std::int64_t position = GetPosition(frame);
+  std::vector<PayloadTransferFrame> ready;
+  using Result = ExceptionOr<std::vector<PayloadTransferFrame>>;
+
+  MutexLock lock(&mutex_);
+  PayloadState& state = payloads_[key];
+  if (state.next_position < 0) {
+    if (next_position.has_value()) {
+      state.next_position = *next_position;
+    } else if (frame.payload_chunk().index() == 0) {
+      state.next_position = position;
+    }
+  }
+
+  if (state.next_position >= 0 && position < state.next_position) {
+    VLOG(1) << "Dropping duplicate chunk at offset "
+            << frame.payload_chunk().offset() << " of payload " << key.second
+            << " from " << endpoint_id;
+    return Result(std::move(ready));
+  }
+
+  if (state.next_position < 0 || position > state.next_position) {
+    size_t body_size = frame.payload_chunk().body().size();
+    if (state.held_back_bytes + body_size > kMaxHeldBackBytesPerPayload) {
+      LOG(WARNING) << "Too many out-of-order chunks of payload " << key.second
+                   << " from " << endpoint_id << ", giving up.";
+      payloads_.erase(key);
+      return Result(Exception::kIo);
+    }
+    if (state.held_back.try_emplace(position, std::move(frame)).second) {
+      state.held_back_bytes += body_size;
+    }
+    return Result(std::move(ready));
+  }
+
+  // `frame` is the next expected chunk.
+  bool is_last_chunk = IsLastChunk(frame);
+  state.next_position =
+      GetNextPosition(frame, frame.payload_chunk().body().size());
+  ready.push_back(std::move(frame));
+  while (!is_last_chunk && !state.held_back.empty()) {
+    auto it = state.held_back.begin();
+    if (it->first > state.next_position) break;
+    state.held_back_bytes -= it->second.payload_chunk().body().size();
+    if (it->first == state.next_position) {
+      is_last_chunk = IsLastChunk(it->second);
+      state.next_position = GetNextPosition(
+          it->second, it->second.payload_chunk().body().size());
+      ready.push_back(std::move(it->second));
+    }
+    state.held_back.erase(it);
+  }
+  if (is_last_chunk) payloads_.erase(key);
+  return Result(std::move(ready));
+}
+
+void PayloadChunkReassembler::Forget(const std::string& endpoint_id,
+                                     std::int64_t payload_id) {
+  MutexLock lock(&mutex_);
+  payloads_.erase(Key{endpoint_id, payload_id});
+}
+
+bool PayloadChunkReassembler::HasPayloads(const std::string& endpoint_id) {
+  MutexLock lock(&mutex_);
+  return std::any_of(payloads_.begin(), payloads_.end(),
+                     [&endpoint_id](const auto& entry) {
+                       return entry.first.first == endpoint_id;
+                     });
+}
+
+void PayloadChunkReassembler::ForgetEndpoint(const std::string& endpoint_id) {
+  MutexLock lock(&mutex_);
+  absl::erase_if(payloads_, [&endpoint_id](const auto& entry) {
+    return entry.first.first == endpoint_id;
+  });
+}
+
+}  // namespace nearby::connections
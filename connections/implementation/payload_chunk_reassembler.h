@@ -0,0 +1,105 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_PAYLOAD_CHUNK_REASSEMBLER_H_
+#define CORE_INTERNAL_PAYLOAD_CHUNK_REASSEMBLER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "connections/implementation/proto/offline_wire_formats.pb.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/mutex.h"
+
+namespace nearby::connections {
+
+// Puts incoming payload chunks back in offset order when an endpoint sends
+// them over several channels at once (see kEnableMultipathTransfer).
+//
+// Chunks that arrive ahead of the next expected offset are held back until the
+// gap is filled; chunks at offsets that were already passed on are dropped,
+// since a sender resends chunks of a failed path over another one. The bodies
+// of a compressed payload are shorter than the offsets between its chunks, so
+// those chunks are ordered by their index instead.
+//
+// The reassembler is thread-safe.
+class PayloadChunkReassembler {
+ public:
+  using PayloadTransferFrame =
+      ::location::nearby::connections::PayloadTransferFrame;
+
+  // Upper bound for the body bytes held back per payload.
+  static constexpr size_t kMaxHeldBackBytesPerPayload = 32 * 1024 * 1024;
+
+  // Returns where the chunk of `frame` goes in its payload: its offset, or its
+  // index if the payload is compressed.
+  static std::int64_t GetPosition(const PayloadTransferFrame& frame);
+
+  // Returns where the chunk after the one of `frame` goes, given the size of
+  // its (possibly compressed) body.
+  static std::int64_t GetNextPosition(const PayloadTransferFrame& frame,
+                                      size_t body_size);
+
+  // Takes a DATA frame received from `endpoint_id` and returns the frames that
+  // are ready to be processed, in offset order. That is `frame` itself if it
+  // is the next expected chunk, followed by any held-back chunks it unblocks.
+  //
+  // A payload starts at its first chunk, the one with index 0, which is not
+  // necessarily at offset 0 (e.g. a payload sent from an offset). If chunks of
+  // the payload were processed without the reassembler, `next_position` is
+  // the position of the next one. Until the start is known, chunks are held
+  // back.
+  //
+  // Returns Exception::kIo, and forgets the payload, if more than
+  // kMaxHeldBackBytesPerPayload would be held back.
+  ExceptionOr<std::vector<PayloadTransferFrame>> Add(
+      const std::string& endpoint_id, PayloadTransferFrame frame,
+      std::optional<std::int64_t> next_position = std::nullopt)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // True if chunks of a payload from `endpoint_id` are being reassembled.
+  bool HasPayloads(const std::string& endpoint_id) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Forgets a payload, e.g. because it was canceled or failed.
+  void Forget(const std::string& endpoint_id, std::int64_t payload_id)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Forgets all payloads of `endpoint_id`.
+  void ForgetEndpoint(const std::string& endpoint_id)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  struct PayloadState {
+    // The offset, or index for a compressed payload, of the next chunk to
+    // pass on. -1 until the start of the payload is known.
+    std::int64_t next_position = -1;
+    std::map<std::int64_t, PayloadTransferFrame> held_back;
+    size_t held_back_bytes = 0;
+  };
+  using Key = std::pair<std::string, std::int64_t>;
+
+  Mutex mutex_;
+  absl::flat_hash_map<Key, PayloadState> payloads_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace nearby::connections
+
+#endif  // CORE_INTERNAL_PAYLOAD_CHUNK_REASSEMBLER_H_
@@ -0,0 +1,213 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/payload_chunk_reassembler.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "connections/implementation/proto/offline_wire_formats.pb.h"
+#include "internal/platform/exception.h"
+
+namespace nearby::connections {
+namespace {
+
+using ::location::nearby::connections::PayloadTransferFrame;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+constexpr char kEndpointId[] = "ABCD";
+constexpr std::int64_t kPayloadId = 42;
+
+// Only the chunk at offset 0 is given index 0, i.e. is the first one sent.
+PayloadTransferFrame CreateChunk(std::int64_t offset, const std::string& body,
+                                 bool last_chunk = false) {
+  PayloadTransferFrame frame;
+  frame.set_packet_type(PayloadTransferFrame::DATA);
+  frame.mutable_payload_header()->set_id(kPayloadId);
+  frame.mutable_payload_header()->set_type(
+      PayloadTransferFrame::PayloadHeader::BYTES);
+  frame.mutable_payload_chunk()->set_offset(offset);
+  frame.mutable_payload_chunk()->set_index(offset == 0 ? 0 : 1);
+  frame.mutable_payload_chunk()->set_body(body);
+  if (last_chunk) {
+    frame.mutable_payload_chunk()->set_flags(
+        PayloadTransferFrame::PayloadChunk::LAST_CHUNK);
+  }
+  return frame;
+}
+
+// Returns the offsets of the frames that became ready.
+std::vector<std::int64_t> AddChunk(PayloadChunkReassembler& reassembler,
+                                   PayloadTransferFrame frame,
+                                   std::optional<std::int64_t> next_position =
+                                       std::nullopt) {
+  ExceptionOr<std::vector<PayloadTransferFrame>> ready =
+      reassembler.Add(kEndpointId, std::move(frame), next_position);
+  EXPECT_TRUE(ready.ok());
+  std::vector<std::int64_t> offsets;
+  if (!ready.ok()) return offsets;
+  for (const auto& ready_frame : ready.result()) {
+    offsets.push_back(ready_frame.payload_chunk().offset());
+  }
+  return offsets;
+}
+
+TEST(PayloadChunkReassemblerTest, PassesInOrderChunksThrough) {
+  PayloadChunkReassembler reassembler;
+
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(0, "abc")), ElementsAre(0));
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(3, "def")), ElementsAre(3));
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(6, "", true)),
+              ElementsAre(6));
+}
+
+TEST(PayloadChunkReassemblerTest, HoldsBackChunksUntilGapIsFilled) {
+  PayloadChunkReassembler reassembler;
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(0, "abc")), ElementsAre(0));
+
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(6, "ghi")), IsEmpty());
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(9, "", true)), IsEmpty());
+
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(3, "def")),
+              ElementsAre(3, 6, 9));
+}
+
+TEST(PayloadChunkReassemblerTest, WaitsForFirstChunkOfUnknownPayload) {
+  PayloadChunkReassembler reassembler;
+
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(3, "def")), IsEmpty());
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(0, "abc")), ElementsAre(0, 3));
+}
+
+TEST(PayloadChunkReassemblerTest, StartsPayloadAtFirstChunkSent) {
+  PayloadChunkReassembler reassembler;
+  PayloadTransferFrame first_chunk = CreateChunk(100, "abc");
+  first_chunk.mutable_payload_chunk()->set_index(0);
+
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(103, "def")), IsEmpty());
+  EXPECT_THAT(AddChunk(reassembler, first_chunk), ElementsAre(100, 103));
+}
+
+TEST(PayloadChunkReassemblerTest, ContinuesPayloadStartedElsewhere) {
+  PayloadChunkReassembler reassembler;
+
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(103, "def"),
+                       /*next_position=*/100),
+              IsEmpty());
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(100, "abc")),
+              ElementsAre(100, 103));
+}
+
+TEST(PayloadChunkReassemblerTest, DropsDuplicates) {
+  PayloadChunkReassembler reassembler;
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(0, "abc")), ElementsAre(0));
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(6, "ghi")), IsEmpty());
+
+  // Resent after a path failed.
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(0, "abc")), IsEmpty());
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(6, "ghi")), IsEmpty());
+
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(3, "def")),
+              ElementsAre(3, 6));
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(3, "def")), IsEmpty());
+}
+
+TEST(PayloadChunkReassemblerTest, OrdersCompressedChunksByIndex) {
+  PayloadChunkReassembler reassembler;
+  // Offsets count uncompressed bytes, so they are ahead of the bodies.
+  auto create_compressed_chunk = [](std::int64_t offset, int index,
+                                    const std::string& body,
+                                    bool last_chunk = false) {
+    PayloadTransferFrame frame = CreateChunk(offset, body, last_chunk);
+    frame.mutable_payload_header()->set_compression(
+        PayloadTransferFrame::PayloadHeader::DEFLATE);
+    frame.mutable_payload_chunk()->set_index(index);
+    return frame;
+  };
+
+  EXPECT_THAT(AddChunk(reassembler, create_compressed_chunk(0, 0, "ab")),
+              ElementsAre(0));
+  EXPECT_THAT(AddChunk(reassembler, create_compressed_chunk(200, 2, "cd")),
+              IsEmpty());
+  EXPECT_THAT(AddChunk(reassembler, create_compressed_chunk(300, 3, "", true)),
+              IsEmpty());
+  EXPECT_THAT(AddChunk(reassembler, create_compressed_chunk(100, 1, "ef")),
+              ElementsAre(100, 200, 300));
+}
+
+TEST(PayloadChunkReassemblerTest, ForgetsPayloadAfterLastChunk) {
+  PayloadChunkReassembler reassembler;
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(0, "abc", true)),
+              ElementsAre(0));
+
+  // A new payload with the same id starts over.
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(3, "def")), IsEmpty());
+}
+
+TEST(PayloadChunkReassemblerTest, ForgetDropsHeldBackChunks) {
+  PayloadChunkReassembler reassembler;
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(0, "abc")), ElementsAre(0));
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(6, "ghi")), IsEmpty());
+
+  reassembler.Forget(kEndpointId, kPayloadId);
+
+  EXPECT_THAT(
+      AddChunk(reassembler, CreateChunk(3, "def"), /*next_position=*/3),
+      ElementsAre(3));
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(9, "jkl")), IsEmpty());
+}
+
+TEST(PayloadChunkReassemblerTest, ForgetEndpointDropsAllPayloads) {
+  PayloadChunkReassembler reassembler;
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(0, "abc")), ElementsAre(0));
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(6, "ghi")), IsEmpty());
+
+  reassembler.ForgetEndpoint(kEndpointId);
+
+  EXPECT_FALSE(reassembler.HasPayloads(kEndpointId));
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(3, "def")), IsEmpty());
+}
+
+TEST(PayloadChunkReassemblerTest, HasPayloadsUntilLastChunk) {
+  PayloadChunkReassembler reassembler;
+  EXPECT_FALSE(reassembler.HasPayloads(kEndpointId));
+
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(0, "abc")), ElementsAre(0));
+  EXPECT_TRUE(reassembler.HasPayloads(kEndpointId));
+
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(3, "", true)), ElementsAre(3));
+  EXPECT_FALSE(reassembler.HasPayloads(kEndpointId));
+}
+
+TEST(PayloadChunkReassemblerTest, FailsWhenHoldingBackTooMuch) {
+  PayloadChunkReassembler reassembler;
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(0, "abc")), ElementsAre(0));
+  std::string body(PayloadChunkReassembler::kMaxHeldBackBytesPerPayload / 2,
+                   'x');
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(100, body)), IsEmpty());
+  EXPECT_THAT(AddChunk(reassembler, CreateChunk(100 + body.size(), body)),
+              IsEmpty());
+
+  EXPECT_FALSE(reassembler
+                   .Add(kEndpointId, CreateChunk(100 + 2 * body.size(), "x"))
+                   .ok());
+}
+
+}  // namespace
+}  // namespace nearby::connections
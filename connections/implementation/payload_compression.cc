@@ -0,0 +1,163 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/payload_compression.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/logging.h"
+#include <zlib.h>
+
+namespace nearby::connections {
+namespace {
+
+// Only the start of the first chunk is sampled, to keep the check cheap.
+constexpr std::size_t kEntropySampleSize = 4096;
+// Samples smaller than this say too little about the rest of the payload.
+constexpr std::size_t kMinEntropySampleSize = 256;
+constexpr double kMaxCompressibleBitsPerByte = 7.0;
+
+// Raw DEFLATE with a 32KB window. The compressor uses about 256KB and the
+// decompressor about 40KB per payload.
+constexpr int kWindowBits = -15;
+constexpr int kMemLevel = 8;
+// Low bandwidth links are slow enough that a fast level costs more in bytes
+// sent than it saves in CPU.
+constexpr int kCompressionLevel = 6;
+
+constexpr std::size_t kDecompressBlockSize = 64 * 1024;
+
+}  // namespace
+
+bool IsLikelyCompressible(absl::string_view sample) {
+  sample = sample.substr(0, kEntropySampleSize);
+  if (sample.size() < kMinEntropySampleSize) {
+    return false;
+  }
+  std::array<int, 256> counts = {};
+  for (unsigned char c : sample) {
+    ++counts[c];
+  }
+  double bits_per_byte = 0;
+  for (int count : counts) {
+    if (count == 0) continue;
+    double p = static_cast<double>(count) / sample.size();
+    bits_per_byte -= p * std::log2(p);
+  }
+  return bits_per_byte < kMaxCompressibleBitsPerByte;
+}
+
+PayloadCompressor::PayloadCompressor() {
+  initialized_ = deflateInit2(&stream_, kCompressionLevel, Z_DEFLATED,
+                              kWindowBits, kMemLevel,
+                              Z_DEFAULT_STRATEGY) == Z_OK;
+  if (!initialized_) {
+    LOG(ERROR) << "Failed to initialize payload compression.";
+  }
+}
+
+PayloadCompressor::~PayloadCompressor() {
+  if (initialized_) deflateEnd(&stream_);
+}
+
+ExceptionOr<ByteArray> PayloadCompressor::Compress(absl::string_view chunk) {
+  if (!initialized_) {
+    return ExceptionOr<ByteArray>(Exception::kFailed);
+  }
+  // deflateBound() doesn't count the sync flush marker.
+  std::string output(deflateBound(&stream_, chunk.size()) + 16, 0);
+  stream_.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(chunk.data()));
+  stream_.avail_in = chunk.size();
+  std::size_t output_size = 0;
+  do {
+    if (output_size == output.size()) {
+      output.resize(output.size() * 2);
+    }
+    stream_.next_out = reinterpret_cast<Bytef*>(output.data() + output_size);
+    stream_.avail_out = output.size() - output_size;
+    int result = deflate(&stream_, Z_SYNC_FLUSH);
+    if (result != Z_OK && result != Z_BUF_ERROR) {
+      LOG(ERROR) << "Failed to compress payload chunk: " << result;
+      return ExceptionOr<ByteArray>(Exception::kFailed);
+    }
+    output_size = output.size() - stream_.avail_out;
+  } while (stream_.avail_out == 0);
+  output.resize(output_size);
+  input_size_ += chunk.size();
+  output_size_ += output_size;
+  return ExceptionOr<ByteArray>(ByteArray(std::move(output)));
+}
+
+PayloadDecompressor::PayloadDecompressor() {
+  initialized_ = inflateInit2(&stream_, kWindowBits) == Z_OK;
+  if (!initialized_) {
+    LOG(ERROR) << "Failed to initialize payload decompression.";
+  }
+}
+
+PayloadDecompressor::~PayloadDecompressor() {
+  if (initialized_) inflateEnd(&stream_);
+}
+
+ExceptionOr<ByteArray> PayloadDecompressor::Decompress(
+    absl::string_view chunk, std::int64_t max_size) {
+  if (!initialized_) {
+    return ExceptionOr<ByteArray>(Exception::kFailed);
+  }
+  std::string output;
+  stream_.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(chunk.data()));
+  stream_.avail_in = chunk.size();
+  do {
+    std::size_t output_size = output.size();
+    if (static_cast<std::int64_t>(output_size) >= max_size &&
+        stream_.avail_in > 0) {
+      LOG(WARNING) << "Payload chunk decompresses to more than " << max_size
+                   << " bytes.";
+      return ExceptionOr<ByteArray>(Exception::kFailed);
+    }
+    std::size_t block_size = std::min<std::int64_t>(
+        kDecompressBlockSize, std::max<std::int64_t>(max_size - output_size, 1));
+    output.resize(output_size + block_size);
+    stream_.next_out = reinterpret_cast<Bytef*>(output.data() + output_size);
+    stream_.avail_out = block_size;
+    int result = inflate(&stream_, Z_SYNC_FLUSH);
+    output.resize(output.size() - stream_.avail_out);
+    if (result == Z_BUF_ERROR && stream_.avail_in == 0) {
+      break;
+    }
+    if (result != Z_OK) {
+      LOG(WARNING) << "Failed to decompress payload chunk: " << result;
+      return ExceptionOr<ByteArray>(Exception::kFailed);
+    }
+  } while (stream_.avail_in > 0 || stream_.avail_out == 0);
+  if (static_cast<std::int64_t>(output.size()) > max_size) {
+    LOG(WARNING) << "Payload chunk decompresses to more than " << max_size
+                 << " bytes.";
+    return ExceptionOr<ByteArray>(Exception::kFailed);
+  }
+  return ExceptionOr<ByteArray>(ByteArray(std::move(output)));
+}
+
+}  // namespace nearby::connections
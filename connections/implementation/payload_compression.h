@@ -0,0 +1,80 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_PAYLOAD_COMPRESSION_H_
+#define CORE_INTERNAL_PAYLOAD_COMPRESSION_H_
+
+#include <cstdint>
+
+#include "absl/strings/string_view.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+#include <zlib.h>
+
+namespace nearby::connections {
+
+// Returns true if the first bytes of `sample` have low enough entropy for
+// DEFLATE to shrink them noticeably. Already compressed data (images, video,
+// archives) is close to 8 bits per byte and is not worth the CPU.
+bool IsLikelyCompressible(absl::string_view sample);
+
+// Compresses the chunks of one outgoing payload as a single raw DEFLATE
+// stream. Each chunk is flushed to a byte boundary, so that the receiver can
+// decompress it as soon as it arrives, while later chunks still benefit from
+// the history of the earlier ones.
+class PayloadCompressor {
+ public:
+  PayloadCompressor();
+  ~PayloadCompressor();
+
+  PayloadCompressor(const PayloadCompressor&) = delete;
+  PayloadCompressor& operator=(const PayloadCompressor&) = delete;
+
+  ExceptionOr<ByteArray> Compress(absl::string_view chunk);
+
+  // Total bytes passed to and returned by Compress().
+  std::int64_t GetInputSize() const { return input_size_; }
+  std::int64_t GetOutputSize() const { return output_size_; }
+
+ private:
+  z_stream stream_ = {};
+  bool initialized_ = false;
+  std::int64_t input_size_ = 0;
+  std::int64_t output_size_ = 0;
+};
+
+// Decompresses the chunks of one incoming payload sent by a
+// PayloadCompressor, in order.
+class PayloadDecompressor {
+ public:
+  PayloadDecompressor();
+  ~PayloadDecompressor();
+
+  PayloadDecompressor(const PayloadDecompressor&) = delete;
+  PayloadDecompressor& operator=(const PayloadDecompressor&) = delete;
+
+  // Fails if `chunk` is corrupt or decompresses to more than `max_size`
+  // bytes, so that a small chunk can't make the receiver allocate without
+  // bound.
+  ExceptionOr<ByteArray> Decompress(absl::string_view chunk,
+                                    std::int64_t max_size);
+
+ private:
+  z_stream stream_ = {};
+  bool initialized_ = false;
+};
+
+}  // namespace nearby::connections
+
+#endif  // CORE_INTERNAL_PAYLOAD_COMPRESSION_H_
@@ -0,0 +1,87 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/payload_compression.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+
+namespace nearby::connections {
+namespace {
+
+std::string RandomBytes(int size) {
+  std::mt19937 generator(42);
+  std::string bytes(size, 0);
+  for (char& c : bytes) {
+    c = static_cast<char>(generator());
+  }
+  return bytes;
+}
+
+std::string Text(int size) {
+  std::string text;
+  while (text.size() < size) {
+    text += "Payload bytes go on the wire exactly as read. ";
+  }
+  text.resize(size);
+  return text;
+}
+
+TEST(PayloadCompressionTest, DetectsCompressibleData) {
+  EXPECT_TRUE(IsLikelyCompressible(Text(4096)));
+  EXPECT_FALSE(IsLikelyCompressible(RandomBytes(4096)));
+  // Too small to tell.
+  EXPECT_FALSE(IsLikelyCompressible(Text(100)));
+}
+
+TEST(PayloadCompressionTest, RoundTripsChunksInOrder) {
+  PayloadCompressor compressor;
+  PayloadDecompressor decompressor;
+  std::string chunks[] = {Text(10000), RandomBytes(5000), Text(70000), "x"};
+
+  for (const std::string& chunk : chunks) {
+    ExceptionOr<ByteArray> compressed = compressor.Compress(chunk);
+    ASSERT_TRUE(compressed.ok());
+    ExceptionOr<ByteArray> decompressed = decompressor.Decompress(
+        std::string(compressed.result()), chunk.size());
+    ASSERT_TRUE(decompressed.ok());
+    EXPECT_EQ(std::string(decompressed.result()), chunk);
+  }
+  EXPECT_EQ(compressor.GetInputSize(), 85001);
+  EXPECT_LT(compressor.GetOutputSize(), compressor.GetInputSize() / 2);
+}
+
+TEST(PayloadCompressionTest, DecompressFailsAboveMaxSize) {
+  PayloadCompressor compressor;
+  PayloadDecompressor decompressor;
+  ExceptionOr<ByteArray> compressed = compressor.Compress(Text(100000));
+  ASSERT_TRUE(compressed.ok());
+
+  EXPECT_FALSE(
+      decompressor.Decompress(std::string(compressed.result()), 99999).ok());
+}
+
+TEST(PayloadCompressionTest, DecompressFailsOnCorruptChunk) {
+  PayloadDecompressor decompressor;
+
+  EXPECT_FALSE(decompressor.Decompress(RandomBytes(1000), 100000).ok());
+}
+
+}  // namespace
+}  // namespace nearby::connections
@@ -19,6 +19,7 @@
 #include <cstdint>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -26,8 +27,10 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/any_invocable.h"
 #include "absl/functional/bind_front.h"
+#include "absl/hash/hash.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "connections/implementation/analytics/analytics_recorder.h"
 #include "connections/implementation/client_proxy.h"
@@ -36,6 +39,8 @@
 #include "connections/implementation/flags/nearby_connections_feature_flags.h"
 #include "connections/implementation/internal_payload.h"
 #include "connections/implementation/internal_payload_factory.h"
+#include "connections/implementation/payload_chunk_prefetcher.h"
+#include "connections/implementation/payload_compression.h"
 #include "connections/listeners.h"
 #include "connections/medium_selector.h"
 #include "connections/payload.h"
@@ -49,6 +54,7 @@
 #include "internal/platform/feature_flags.h"
 #include "internal/platform/implementation/system_clock.h"
 #include "internal/platform/logging.h"
+#include "internal/platform/metrics_registry.h"
 #include "internal/platform/mutex_lock.h"
 #include "internal/platform/single_thread_executor.h"
 
@@ -64,6 +70,9 @@ using ::location::nearby::proto::connections::PayloadStatus;
 using ::nearby::analytics::AnalyticsRecorder;
 
 constexpr absl::Duration kMinTransferUpdateInterval = absl::Milliseconds(50);
+// Bounds what a compressed chunk may expand to, whatever size the sender
+// announced for the payload. Senders never send chunks this large.
+constexpr std::int64_t kMaxDecompressedChunkSize = 8 * 1024 * 1024;
 
 std::string EndpointIdsToString(const std::vector<std::string>& endpoint_ids) {
   return absl::StrCat(endpoint_ids.size(), ":",
@@ -111,10 +120,29 @@ PayloadProgressInfo::Status PayloadStatusToTransferUpdateStatus(
 
 }  // namespace
 
+void PayloadManager::WrittenChunks::Add(const std::string& endpoint_id,
+                                        const Chunk& chunk) {
+  MutexLock lock(&mutex_);
+  auto it = newest_.find(endpoint_id);
+  if (it != newest_.end() && it->second.chunk.offset >= chunk.offset) return;
+  newest_[endpoint_id] = Newest{.chunk = chunk};
+}
+
+std::optional<PayloadManager::WrittenChunks::Chunk>
+PayloadManager::WrittenChunks::TakeUnreported(const std::string& endpoint_id) {
+  MutexLock lock(&mutex_);
+  auto it = newest_.find(endpoint_id);
+  if (it == newest_.end() || it->second.reported) return std::nullopt;
+  it->second.reported = true;
+  return it->second.chunk;
+}
+
 int PayloadManager::SendPayloadLoop(
     ClientProxy* client, PendingPayload& pending_payload,
     PayloadTransferFrame::PayloadHeader& payload_header,
-    int64_t next_chunk_offset, size_t resume_offset, int index) {
+    int64_t next_chunk_offset, size_t resume_offset, int index,
+    PayloadChunkPrefetcher* prefetcher, PayloadCompressor* compressor,
+    const std::shared_ptr<WrittenChunks>& written_chunks) {
   auto [available_endpoint_ids, unavailable_endpoints] =
       GetAvailableAndUnavailableEndpoints(pending_payload);
 
@@ -177,9 +205,14 @@ int PayloadManager::SendPayloadLoop(
 
   // This will block if there is no data to transfer.
   // It will resume when new data arrives, or if Close() is called.
-  int chunk_size = GetOptimalChunkSize(available_endpoint_ids);
-  ByteArray next_chunk =
-      pending_payload.GetInternalPayload()->DetachNextChunk(chunk_size);
+  ByteArray next_chunk;
+  if (prefetcher != nullptr) {
+    next_chunk = prefetcher->NextChunk();
+  } else {
+    int chunk_size = GetOptimalChunkSize(available_endpoint_ids);
+    next_chunk =
+        pending_payload.GetInternalPayload()->DetachNextChunk(chunk_size);
+  }
   if (shutdown_.Get()) return -1;
   // Save chunk size. We'll need it after we move next_chunk.
   size_t next_chunk_size = next_chunk.size();
@@ -200,11 +233,52 @@ int PayloadManager::SendPayloadLoop(
   // used to decide if the received chunk is the initial payload chunk.
   // In other cases, the offset should only be used in both side logs when error
   // happened.
+  static MetricsCounter& chunks_sent =
+      MetricsRegistry::GetInstance().GetCounter("payload.chunks_sent");
+  static MetricsCounter& bytes_sent =
+      MetricsRegistry::GetInstance().GetCounter("payload.bytes_sent");
+  static MetricsHistogram& chunk_send_us =
+      MetricsRegistry::GetInstance().GetHistogram("payload.chunk_send_us");
+  if (index == 0 && compressor != nullptr &&
+      IsLikelyCompressible(next_chunk.AsStringView())) {
+    payload_header.set_compression(PayloadTransferFrame::PayloadHeader::DEFLATE);
+  }
+  if (payload_header.compression() ==
+          PayloadTransferFrame::PayloadHeader::DEFLATE &&
+      next_chunk_size > 0) {
+    ExceptionOr<ByteArray> compressed_chunk =
+        compressor->Compress(next_chunk.AsStringView());
+    if (!compressed_chunk.ok()) {
+      HandleFinishedOutgoingPayload(
+          client, available_endpoint_ids, payload_header, next_chunk_offset,
+          OperationResultCode::DETAIL_UNKNOWN, PayloadStatus::LOCAL_ERROR);
+      return -1;
+    }
+    next_chunk = std::move(compressed_chunk.result());
+  }
   PayloadTransferFrame::PayloadChunk payload_chunk(CreatePayloadChunk(
       next_chunk_offset - resume_offset, std::move(next_chunk), index));
+  bool is_last_chunk = IsLastChunk(payload_chunk);
+  // The last chunk is written by the time SendPayloadChunk() returns.
+  EndpointManager::ChunkWrittenCallback on_chunk_written;
+  if (!is_last_chunk) {
+    WrittenChunks::Chunk chunk = {
+        .flags = payload_chunk.flags(),
+        .offset = payload_chunk.offset(),
+        .body_size = static_cast<int64_t>(next_chunk_size)};
+    on_chunk_written = [written_chunks, chunk](const std::string& endpoint_id) {
+      written_chunks->Add(endpoint_id, chunk);
+    };
+  }
+  absl::Time send_start_time = SystemClock::ElapsedRealtime();
   const std::vector<std::string>& failed_endpoint_ids =
       endpoint_manager_->SendPayloadChunk(payload_header, payload_chunk,
-                                          available_endpoint_ids);
+                                          available_endpoint_ids,
+                                          std::move(on_chunk_written));
+  chunk_send_us.RecordDuration(SystemClock::ElapsedRealtime() -
+                               send_start_time);
+  chunks_sent.Increment();
+  bytes_sent.Increment(next_chunk_size);
   // Check whether at least one endpoint failed.
   if (!failed_endpoint_ids.empty()) {
     VLOG(1) << "Payload xfer: endpoints failed: payload_id="
@@ -215,7 +289,6 @@ int PayloadManager::SendPayloadLoop(
             OperationResultCode::CONNECTIVITY_GENERIC_WRITING_CHANNEL_IO_ERROR,
             PayloadStatus::ENDPOINT_IO_ERROR);
   }
-  bool is_last_chunk = IsLastChunk(payload_chunk);
   // Check whether at least one endpoint succeeded -- if they all failed,
   // we'll just go right back to the top of the loop and break out when
   // availableEndpointIds is re-synced and found to be empty at that point.
@@ -233,9 +306,17 @@ int PayloadManager::SendPayloadLoop(
           }
         }
 
-        HandleSuccessfulOutgoingChunk(
-            client, endpoint_id, payload_header, payload_chunk.flags(),
-            payload_chunk.offset(), payload_chunk.body().size());
+        if (is_last_chunk) {
+          HandleSuccessfulOutgoingChunk(client, endpoint_id, payload_header,
+                                        payload_chunk.flags(),
+                                        payload_chunk.offset(),
+                                        next_chunk_size);
+        } else if (std::optional<WrittenChunks::Chunk> written =
+                       written_chunks->TakeUnreported(endpoint_id)) {
+          HandleSuccessfulOutgoingChunk(client, endpoint_id, payload_header,
+                                        written->flags, written->offset,
+                                        written->body_size);
+        }
       }
     }
 
@@ -285,9 +366,18 @@ std::string PayloadManager::ToString(EndpointInfo::Status status) {
 
 // Creates and starts tracking a PendingPayload for this Payload.
 Payload::Id PayloadManager::CreateOutgoingPayload(
-    Payload payload, const std::vector<std::string>& endpoint_ids) {
+    ClientProxy* client, Payload payload,
+    const std::vector<std::string>& endpoint_ids) {
+  // A receiver that doesn't know about chunked BYTES payloads would hand its
+  // client the first chunk only.
+  bool send_bytes_in_chunks =
+      !endpoint_ids.empty() &&
+      std::all_of(endpoint_ids.begin(), endpoint_ids.end(),
+                  [client](const std::string& endpoint_id) {
+                    return client->IsMultiChunkBytesEnabled(endpoint_id);
+                  });
   ErrorOr<std::unique_ptr<InternalPayload>> result =
-      CreateOutgoingInternalPayload(std::move(payload));
+      CreateOutgoingInternalPayload(std::move(payload), send_bytes_in_chunks);
   if (result.has_error()) {
     LOG(ERROR) << "Failed to create outgoing internal payload: "
                << result.error().operation_result_code().value();
@@ -429,7 +519,7 @@ void PayloadManager::SendPayload(ClientProxy* client,
           : 0;
 
   Payload::Id payload_id =
-      CreateOutgoingPayload(std::move(payload), endpoint_ids);
+      CreateOutgoingPayload(client, std::move(payload), endpoint_ids);
   executor->Execute("send-payload", [this, client, endpoint_ids, payload_id,
                                      payload_type, resume_offset,
                                      payload_total_size]() {
@@ -457,13 +547,41 @@ void PayloadManager::SendPayload(ClientProxy* client,
     PayloadTransferFrame::PayloadHeader payload_header{
         CreatePayloadHeader(*internal_payload, resume_offset)};
 
+    // A resumed payload continues a stream the receiver already started, so
+    // it's always sent as it is.
+    std::unique_ptr<PayloadCompressor> compressor;
+    if (resume_offset == 0 && ShouldCompressPayload(client, endpoint_ids)) {
+      compressor = std::make_unique<PayloadCompressor>();
+    }
+
+    // Reads chunks ahead on another thread so that disk reads overlap with
+    // encrypting and writing the previous chunks.
+    std::unique_ptr<PayloadChunkPrefetcher> prefetcher;
+    if (NearbyFlags::GetInstance().GetBoolFlag(
+            config_package_nearby::nearby_connections_feature::
+                kEnablePipelinedPayloadSend)) {
+      prefetcher = std::make_unique<PayloadChunkPrefetcher>(
+          internal_payload,
+          NearbyFlags::GetInstance().GetInt64Flag(
+              config_package_nearby::nearby_connections_feature::
+                  kPayloadSendPipelineDepth),
+          [this, payload = &*pending_payload]() {
+            return GetOptimalChunkSize(
+                GetAvailableAndUnavailableEndpoints(*payload).first);
+          });
+    }
+
+    auto written_chunks = std::make_shared<WrittenChunks>();
+
     bool should_continue = true;
     int64_t next_chunk_offset = 0;
     int index = 0;
 
     while (should_continue && !shutdown_.Get()) {
-      int bytes_sent = SendPayloadLoop(client, *pending_payload, payload_header,
-                                       next_chunk_offset, resume_offset, index);
+      int bytes_sent =
+          SendPayloadLoop(client, *pending_payload, payload_header,
+                          next_chunk_offset, resume_offset, index,
+                          prefetcher.get(), compressor.get(), written_chunks);
       should_continue = (bytes_sent >= 0);
       if (should_continue) {
         if (next_chunk_offset == 0 && resume_offset > 0) {
@@ -474,6 +592,35 @@ void PayloadManager::SendPayload(ClientProxy* client,
       index++;
     }
 
+    if (prefetcher != nullptr) {
+      // A stream read blocks until more data arrives; close the payload (as
+      // DestroyPendingPayload() would) so the prefetch thread can exit.
+      if (payload_type == PayloadType::kStream) internal_payload->Close();
+      prefetcher->Stop();
+    }
+
+    if (payload_header.compression() ==
+            PayloadTransferFrame::PayloadHeader::DEFLATE &&
+        compressor->GetInputSize() > 0) {
+      static MetricsCounter& compressed_payloads =
+          MetricsRegistry::GetInstance().GetCounter(
+              "payload.compressed_payloads");
+      static MetricsCounter& compression_saved_bytes =
+          MetricsRegistry::GetInstance().GetCounter(
+              "payload.compression_saved_bytes");
+      static MetricsHistogram& compression_ratio_percent =
+          MetricsRegistry::GetInstance().GetHistogram(
+              "payload.compression_ratio_percent");
+      compressed_payloads.Increment();
+      compression_saved_bytes.Increment(compressor->GetInputSize() -
+                                        compressor->GetOutputSize());
+      compression_ratio_percent.Record(compressor->GetOutputSize() * 100 /
+                                       compressor->GetInputSize());
+      VLOG(1) << "PayloadManager compressed payload_id=" << payload_id
+              << " from " << compressor->GetInputSize() << " to "
+              << compressor->GetOutputSize() << " bytes.";
+    }
+
     RunOnStatusUpdateThread("destroy-payload",
                             [this, payload_id]()
                                 RUN_ON_PAYLOAD_STATUS_UPDATE_THREAD() {
@@ -544,7 +691,13 @@ void PayloadManager::OnIncomingFrame(OfflineFrame& offline_frame,
       ProcessControlPacket(to_client, from_endpoint_id, frame);
       break;
     case PayloadTransferFrame::DATA:
-      ProcessDataPacket(to_client, from_endpoint_id, frame, current_medium);
+      if (is_multipath_enabled_ && NeedsReassembly(from_endpoint_id, frame)) {
+        ProcessMultipathDataPacket(to_client, from_endpoint_id, frame,
+                                   current_medium);
+      } else {
+        ProcessDataPacket(to_client, from_endpoint_id, frame,
+                          frame.payload_chunk().body(), current_medium);
+      }
       break;
     case PayloadTransferFrame::PAYLOAD_ACK:
       VLOG(1) << "[safe-to-disconnect][PAYLOAD_RECEIVED_ACK] sender "
@@ -559,6 +712,28 @@ void PayloadManager::OnIncomingFrame(OfflineFrame& offline_frame,
   }
 }
 
+// @EndpointManagerDataPool
+void PayloadManager::OnIncomingDataFrame(OfflineFrame& offline_frame,
+                                         absl::string_view body,
+                                         const std::string& from_endpoint_id,
+                                         ClientProxy* to_client,
+                                         Medium current_medium) {
+  PayloadTransferFrame& frame =
+      *offline_frame.mutable_v1()->mutable_payload_transfer();
+  // BYTES payloads sent in one chunk are created from its body, and chunks
+  // held back for reordering must own their body; those need the copy.
+  bool is_single_chunk_bytes = frame.payload_header().type() ==
+                                   PayloadTransferFrame::PayloadHeader::BYTES &&
+                               !frame.payload_header().is_multi_chunk();
+  if (is_multipath_enabled_ || is_single_chunk_bytes ||
+      !to_client->IsConnectedToEndpoint(from_endpoint_id)) {
+    EndpointManager::FrameProcessor::OnIncomingDataFrame(
+        offline_frame, body, from_endpoint_id, to_client, current_medium);
+    return;
+  }
+  ProcessDataPacket(to_client, from_endpoint_id, frame, body, current_medium);
+}
+
 void PayloadManager::OnEndpointDisconnect(ClientProxy* client,
                                           const std::string& service_id,
                                           const std::string& endpoint_id,
@@ -568,6 +743,7 @@ void PayloadManager::OnEndpointDisconnect(ClientProxy* client,
     barrier.CountDown();
     return;
   }
+  if (is_multipath_enabled_) chunk_reassembler_.ForgetEndpoint(endpoint_id);
   RunOnStatusUpdateThread(
       "payload-manager-on-disconnect",
       [this, client, endpoint_id, barrier,
@@ -681,12 +857,44 @@ SingleThreadExecutor* PayloadManager::GetOutgoingPayloadExecutor(
   }
 }
 
+bool PayloadManager::ShouldCompressPayload(
+    ClientProxy* client, const std::vector<std::string>& endpoint_ids) {
+  if (endpoint_ids.empty()) {
+    return false;
+  }
+  double max_throughput = NearbyFlags::GetInstance().GetInt64Flag(
+      config_package_nearby::nearby_connections_feature::
+          kPayloadCompressionMaxThroughputBytesPerSecond);
+  for (const auto& endpoint_id : endpoint_ids) {
+    if (!client->IsPayloadCompressionEnabled(endpoint_id)) {
+      return false;
+    }
+    double throughput =
+        endpoint_manager_->GetThroughputBytesPerSecond(endpoint_id);
+    if (throughput > 0) {
+      if (throughput > max_throughput) {
+        return false;
+      }
+      continue;
+    }
+    switch (client->GetConnectedMedium(endpoint_id)) {
+      case Medium::BLE:
+      case Medium::BLE_L2CAP:
+      case Medium::BLUETOOTH:
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
 int PayloadManager::GetOptimalChunkSize(
     const std::vector<std::string>& endpoint_ids) {
   int minChunkSize = std::numeric_limits<int>::max();
   for (const auto& endpoint_id : endpoint_ids) {
-    minChunkSize = std::min(
-        minChunkSize, endpoint_manager_->GetMaxTransmitPacketSize(endpoint_id));
+    minChunkSize =
+        std::min(minChunkSize, endpoint_manager_->GetChunkSize(endpoint_id));
   }
   return minChunkSize;
 }
@@ -705,6 +913,12 @@ PayloadTransferFrame::PayloadHeader PayloadManager::CreatePayloadHeader(
     payload_header.set_parent_folder(internal_payload.GetParentFolder());
     payload_header.set_last_modified_timestamp_millis(
         absl::ToUnixMillis(internal_payload.GetLastModifiedTime()));
+    if (offset > 0) {
+      payload_header.set_resume_offset(offset);
+    }
+  }
+  if (internal_payload.IsMultiChunkBytes()) {
+    payload_header.set_is_multi_chunk(true);
   }
   payload_header.set_total_size(payload_size ==
                                         InternalPayload::kIndeterminateSize
@@ -736,7 +950,8 @@ PayloadManager::CreateIncomingPayload(const PayloadTransferFrame& frame,
                                       const std::string& save_path) {
   ErrorOr<std::unique_ptr<InternalPayload>> result =
       CreateIncomingInternalPayload(
-          frame, save_path.empty() ? custom_save_path_ : save_path);
+          frame, endpoint_id,
+          save_path.empty() ? custom_save_path_ : save_path);
   if (result.has_error()) {
     return {result.error()};
   }
@@ -1030,6 +1245,9 @@ void PayloadManager::HandleFinishedIncomingPayload(
     const PayloadTransferFrame::PayloadHeader& payload_header,
     int64_t offset_bytes, PayloadStatus status,
     OperationResultCode operation_result_code) {
+  if (is_multipath_enabled_) {
+    chunk_reassembler_.Forget(endpoint_id, payload_header.id());
+  }
   SendClientCallbacksForFinishedIncomingPayload(client, endpoint_id,
                                                 payload_header, offset_bytes,
                                                 status, operation_result_code);
@@ -1229,7 +1447,8 @@ void PayloadManager::HandleSuccessfulIncomingChunk(
 // @EndpointManagerDataPool
 void PayloadManager::ProcessDataPacket(
     ClientProxy* to_client, const std::string& from_endpoint_id,
-    PayloadTransferFrame& payload_transfer_frame, Medium medium) {
+    PayloadTransferFrame& payload_transfer_frame,
+    absl::string_view payload_chunk_body, Medium medium) {
   PayloadTransferFrame::PayloadHeader& payload_header =
       *payload_transfer_frame.mutable_payload_header();
   PayloadTransferFrame::PayloadChunk& payload_chunk =
@@ -1248,6 +1467,9 @@ void PayloadManager::ProcessDataPacket(
     return;
   }
   Payload::Id payload_id = payload_header.id();
+  // Taken before the body of a single-chunk BYTES payload is decompressed.
+  int64_t next_chunk_position = PayloadChunkReassembler::GetNextPosition(
+      payload_transfer_frame, payload_chunk_body.size());
   PendingPayloadHandle pending_payload;
   if (payload_chunk.offset() == 0) {
     RunOnStatusUpdateThread(
@@ -1261,6 +1483,42 @@ void PayloadManager::ProcessDataPacket(
               payload_header.total_size());
         });
 
+    // A BYTES payload sent in one chunk is created from the body of that
+    // chunk, so it is decompressed here rather than when it is attached.
+    if (payload_header.compression() ==
+            PayloadTransferFrame::PayloadHeader::DEFLATE &&
+        payload_header.type() == PayloadTransferFrame::PayloadHeader::BYTES &&
+        !payload_header.is_multi_chunk() && !payload_chunk_body.empty()) {
+      // The announced size is checked first, since it bounds the output.
+      ExceptionOr<ByteArray> decompressed =
+          payload_header.total_size() < 0 ||
+                  payload_header.total_size() > kMaxIncomingBytesPayloadSize
+              ? ExceptionOr<ByteArray>(Exception::kFailed)
+              : PayloadDecompressor().Decompress(payload_chunk_body,
+                                                 payload_header.total_size());
+      if (!decompressed.ok()) {
+        LOG(ERROR) << "ProcessDataPacket: [data: decompression error] "
+                      "endpoint_id="
+                   << from_endpoint_id << "; payload_id=" << payload_id;
+        RunOnStatusUpdateThread(
+            "process-data-packet",
+            [to_client, from_endpoint_id, payload_header]()
+                RUN_ON_PAYLOAD_STATUS_UPDATE_THREAD() {
+                  to_client->GetAnalyticsRecorder().OnIncomingPayloadDone(
+                      from_endpoint_id, payload_header.id(),
+                      PayloadStatus::LOCAL_ERROR,
+                      OperationResultCode::DETAIL_UNKNOWN);
+                });
+        SendControlMessage({from_endpoint_id}, payload_header,
+                           payload_chunk.offset(),
+                           PayloadTransferFrame::ControlMessage::PAYLOAD_ERROR);
+        return;
+      }
+      payload_chunk.set_body(std::string(std::move(decompressed.result())));
+      payload_chunk_body = payload_chunk.body();
+      payload_header.clear_compression();
+    }
+
     ErrorOr<PendingPayloadHandle> result =
         CreateIncomingPayload(payload_transfer_frame, from_endpoint_id,
                               to_client->GetSavePath(from_endpoint_id));
@@ -1290,20 +1548,14 @@ void PayloadManager::ProcessDataPacket(
     } else {
       pending_payload = std::move(result.value());
     }
+    if (payload_header.compression() ==
+        PayloadTransferFrame::PayloadHeader::DEFLATE) {
+      pending_payload->SetDecompressor(std::make_unique<PayloadDecompressor>());
+    }
     // Also, let the client know of this new incoming payload.
-    RunOnStatusUpdateThread(
-        "process-data-packet",
-        [to_client, from_endpoint_id,
-         pending_payload = GetPayload(payload_id)]()
-            RUN_ON_PAYLOAD_STATUS_UPDATE_THREAD() {
-              if (!pending_payload) return;
-              VLOG(1) << "PayloadManager received new payload_id="
-                      << pending_payload->GetInternalPayload()->GetId()
-                      << " from endpoint_id=" << from_endpoint_id;
-              to_client->OnPayload(
-                  from_endpoint_id,
-                  pending_payload->GetInternalPayload()->ReleasePayload());
-            });
+    if (!pending_payload->GetInternalPayload()->IsMultiChunkBytes()) {
+      ReleaseIncomingPayload(to_client, from_endpoint_id, payload_id);
+    }
   } else {
     pending_payload = GetPayload(payload_header.id());
   }
@@ -1333,11 +1585,39 @@ void PayloadManager::ProcessDataPacket(
   pending_payload->SetOffsetForEndpoint(from_endpoint_id,
                                         payload_chunk.offset());
 
+  ByteArray decompressed_body;
+  if (payload_header.compression() ==
+          PayloadTransferFrame::PayloadHeader::DEFLATE &&
+      !payload_chunk_body.empty()) {
+    PayloadDecompressor* decompressor = pending_payload->GetDecompressor();
+    // A chunk never holds more than the rest of the payload.
+    int64_t max_size =
+        payload_header.total_size() == InternalPayload::kIndeterminateSize
+            ? kMaxDecompressedChunkSize
+            : std::min(kMaxDecompressedChunkSize,
+                       payload_header.total_size() - payload_chunk.offset());
+    ExceptionOr<ByteArray> decompressed =
+        decompressor == nullptr
+            ? ExceptionOr<ByteArray>(Exception::kFailed)
+            : decompressor->Decompress(payload_chunk_body, max_size);
+    if (!decompressed.ok()) {
+      LOG(ERROR) << "ProcessDataPacket: [data: decompression error] endpoint_id="
+                 << from_endpoint_id
+                 << "; payload_id=" << pending_payload->GetId();
+      HandleFinishedIncomingPayload(
+          to_client, from_endpoint_id, payload_header, payload_chunk.offset(),
+          PayloadStatus::LOCAL_ERROR, OperationResultCode::DETAIL_UNKNOWN);
+      return;
+    }
+    decompressed_body = std::move(decompressed.result());
+    payload_chunk_body = decompressed_body.AsStringView();
+  }
+
   // Save size of packet before we move it.
-  int64_t payload_body_size = payload_chunk.body().size();
+  int64_t payload_body_size = payload_chunk_body.size();
 
   if (pending_payload->GetInternalPayload()
-          ->AttachNextChunk(payload_chunk.body())
+          ->AttachNextChunk(payload_chunk_body)
           .Raised()) {
     LOG(ERROR) << "ProcessDataPacket: [data: error] endpoint_id="
                << from_endpoint_id
@@ -1347,8 +1627,13 @@ void PayloadManager::ProcessDataPacket(
         PayloadStatus::LOCAL_ERROR, OperationResultCode::IO_FILE_WRITING_ERROR);
     return;
   }
+  pending_payload->SetNextChunkPosition(next_chunk_position);
   bool is_last_chunk = (payload_chunk.flags() &
                         PayloadTransferFrame::PayloadChunk::LAST_CHUNK) != 0;
+  if (is_last_chunk &&
+      pending_payload->GetInternalPayload()->IsMultiChunkBytes()) {
+    ReleaseIncomingPayload(to_client, from_endpoint_id, payload_id);
+  }
   SendPayloadReceivedAck(to_client, *pending_payload, from_endpoint_id,
                          is_last_chunk);
 
@@ -1357,6 +1642,70 @@ void PayloadManager::ProcessDataPacket(
                                 payload_body_size);
 }
 
+void PayloadManager::ReleaseIncomingPayload(ClientProxy* to_client,
+                                            const std::string& from_endpoint_id,
+                                            Payload::Id payload_id) {
+  RunOnStatusUpdateThread(
+      "process-data-packet",
+      [to_client, from_endpoint_id, pending_payload = GetPayload(payload_id)]()
+          RUN_ON_PAYLOAD_STATUS_UPDATE_THREAD() {
+            if (!pending_payload) return;
+            VLOG(1) << "PayloadManager received new payload_id="
+                    << pending_payload->GetInternalPayload()->GetId()
+                    << " from endpoint_id=" << from_endpoint_id;
+            to_client->OnPayload(
+                from_endpoint_id,
+                pending_payload->GetInternalPayload()->ReleasePayload());
+          });
+}
+
+// @EndpointManagerDataPool
+bool PayloadManager::NeedsReassembly(
+    const std::string& from_endpoint_id,
+    const PayloadTransferFrame& payload_transfer_frame) {
+  if (endpoint_manager_->HasPathsForEndpoint(from_endpoint_id) ||
+      chunk_reassembler_.HasPayloads(from_endpoint_id)) {
+    return true;
+  }
+  PendingPayloadHandle pending_payload =
+      GetPayload(payload_transfer_frame.payload_header().id());
+  if (!pending_payload) {
+    return payload_transfer_frame.payload_chunk().index() != 0;
+  }
+  return PayloadChunkReassembler::GetPosition(payload_transfer_frame) !=
+         pending_payload->GetNextChunkPosition();
+}
+
+// @EndpointManagerDataPool
+void PayloadManager::ProcessMultipathDataPacket(
+    ClientProxy* to_client, const std::string& from_endpoint_id,
+    PayloadTransferFrame& payload_transfer_frame, Medium medium) {
+  PayloadTransferFrame::PayloadHeader payload_header =
+      payload_transfer_frame.payload_header();
+  int64_t offset = payload_transfer_frame.payload_chunk().offset();
+  // A payload whose earlier chunks were processed directly continues where
+  // they left off.
+  std::optional<int64_t> next_position;
+  if (PendingPayloadHandle pending_payload = GetPayload(payload_header.id())) {
+    next_position = pending_payload->GetNextChunkPosition();
+  }
+  ExceptionOr<std::vector<PayloadTransferFrame>> ready_frames =
+      chunk_reassembler_.Add(from_endpoint_id,
+                             std::move(payload_transfer_frame), next_position);
+  if (!ready_frames.ok()) {
+    LOG(ERROR) << "ProcessMultipathDataPacket: [reorder: error] endpoint_id="
+               << from_endpoint_id << "; payload_id=" << payload_header.id();
+    HandleFinishedIncomingPayload(
+        to_client, from_endpoint_id, payload_header, offset,
+        PayloadStatus::LOCAL_ERROR, OperationResultCode::DETAIL_UNKNOWN);
+    return;
+  }
+  for (PayloadTransferFrame& frame : ready_frames.result()) {
+    ProcessDataPacket(to_client, from_endpoint_id, frame,
+                      frame.payload_chunk().body(), medium);
+  }
+}
+
 // @EndpointManagerDataPool
 void PayloadManager::ProcessControlPacket(
     ClientProxy* to_client, const std::string& from_endpoint_id,
@@ -1648,49 +1997,56 @@ void PayloadManager::RunOnStatusUpdateThread(
 
 /////////////////////////////// PendingPayloads ////////////////////////////////
 
+PayloadManager::PendingPayloads::Shard&
+PayloadManager::PendingPayloads::GetShard(Payload::Id payload_id) const {
+  return shards_[absl::Hash<Payload::Id>()(payload_id) % kShardCount];
+}
+
 void PayloadManager::PendingPayloads::StartTrackingPayload(
     Payload::Id payload_id, std::unique_ptr<PendingPayload> pending_payload) {
-  MutexLock lock(&mutex_);
+  Shard& shard = GetShard(payload_id);
+  MutexLock lock(&shard.mutex);
 
   // If the |payload_id| is being re-used, always prefer the newer payload.
-  Remove(pending_payloads_.find(payload_id));
+  Remove(shard, shard.pending_payloads.find(payload_id));
   VLOG(1) << "StartTrackingPayload: " << pending_payload->ToString();
   pending_payload->IncRefCount();
-  pending_payloads_[payload_id] = std::move(pending_payload);
+  shard.pending_payloads[payload_id] = std::move(pending_payload);
 }
 
 void PayloadManager::PendingPayloads::StopTrackingPayload(
     Payload::Id payload_id) {
-  MutexLock lock(&mutex_);
+  Shard& shard = GetShard(payload_id);
+  MutexLock lock(&shard.mutex);
   VLOG(1) << "StopTrackingPayload " << payload_id;
-  Remove(pending_payloads_.find(payload_id));
+  Remove(shard, shard.pending_payloads.find(payload_id));
 }
 
-void PayloadManager::PendingPayloads::Remove(
-    absl::flat_hash_map<Payload::Id, std::unique_ptr<PendingPayload>>::iterator
-        it) {
-  if (it != pending_payloads_.end()) {
+void PayloadManager::PendingPayloads::Remove(Shard& shard,
+                                             PayloadMap::iterator it) {
+  if (it != shard.pending_payloads.end()) {
     int refcount = it->second->DecRefCount();
     if (refcount == 0) {
       // Nobody is using the payload, we can remove it.
       VLOG(1) << "Erase payload " << it->second->ToString();
-      pending_payloads_.erase(it);
+      shard.pending_payloads.erase(it);
     } else {
       // Someone is still using the payload. Move it to the garbage bin. The
       // payload will be removed when they release it.
       VLOG(1) << "Bin payload " << it->second->ToString();
-      payload_garbage_bin_.push_back(
-          std::move(pending_payloads_.extract(it).mapped()));
+      shard.payload_garbage_bin.push_back(
+          std::move(shard.pending_payloads.extract(it).mapped()));
     }
   }
 }
 
 PayloadManager::PendingPayloadHandle
 PayloadManager::PendingPayloads::GetPayload(Payload::Id payload_id) const {
-  MutexLock lock(&mutex_);
+  Shard& shard = GetShard(payload_id);
+  MutexLock lock(&shard.mutex);
 
-  auto item = pending_payloads_.find(payload_id);
-  if (item == pending_payloads_.end()) {
+  auto item = shard.pending_payloads.find(payload_id);
+  if (item == shard.pending_payloads.end()) {
     return PendingPayloadHandle();
   }
   PendingPayload* payload = item->second.get();
@@ -1701,40 +2057,44 @@ PayloadManager::PendingPayloads::GetPayload(Payload::Id payload_id) const {
 }
 
 void PayloadManager::PendingPayloads::StopTrackingAllPayloads() {
-  MutexLock lock(&mutex_);
-
-  for (auto it = pending_payloads_.begin(); it != pending_payloads_.end();) {
-    Remove(it++);
+  for (Shard& shard : shards_) {
+    MutexLock lock(&shard.mutex);
+    for (auto it = shard.pending_payloads.begin();
+         it != shard.pending_payloads.end();) {
+      Remove(shard, it++);
+    }
   }
 }
 
 void PayloadManager::PendingPayloads::ForEachPayload(
     absl::AnyInvocable<void(PendingPayload*)> callback) {
-  MutexLock lock(&mutex_);
-
-  for (const auto& item : pending_payloads_) {
-    callback(item.second.get());
+  for (Shard& shard : shards_) {
+    MutexLock lock(&shard.mutex);
+    for (const auto& item : shard.pending_payloads) {
+      callback(item.second.get());
+    }
   }
 }
 
 void PayloadManager::PendingPayloads::Release(PendingPayload* payload) {
   // Called when `PendingPayloadHandle` is destroyed.
-  MutexLock lock(&mutex_);
+  Shard& shard = GetShard(payload->GetId());
+  MutexLock lock(&shard.mutex);
   VLOG(1) << __func__ << " " << payload->ToString();
-  auto it = pending_payloads_.find(payload->GetId());
-  if (it != pending_payloads_.end() && it->second.get() == payload) {
+  auto it = shard.pending_payloads.find(payload->GetId());
+  if (it != shard.pending_payloads.end() && it->second.get() == payload) {
     // The payload is still tracked.
     payload->DecRefCount();
     return;
   }
-  auto bin_it =
-      std::find_if(payload_garbage_bin_.begin(), payload_garbage_bin_.end(),
-                   [payload](auto& item) { return item.get() == payload; });
-  if (bin_it != payload_garbage_bin_.end()) {
+  auto bin_it = std::find_if(
+      shard.payload_garbage_bin.begin(), shard.payload_garbage_bin.end(),
+      [payload](auto& item) { return item.get() == payload; });
+  if (bin_it != shard.payload_garbage_bin.end()) {
     int refcount = payload->DecRefCount();
     if (refcount == 0) {
       // The payload is not tracked and it was the last reference.
-      payload_garbage_bin_.erase(bin_it);
+      shard.payload_garbage_bin.erase(bin_it);
     }
   }
 }
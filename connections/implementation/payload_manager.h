@@ -15,9 +15,11 @@
 #ifndef CORE_INTERNAL_PAYLOAD_MANAGER_H_
 #define CORE_INTERNAL_PAYLOAD_MANAGER_H_
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -25,14 +27,20 @@
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/any_invocable.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "connections/implementation/client_proxy.h"
 #include "connections/implementation/endpoint_manager.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
 #include "connections/implementation/internal_payload.h"
+#include "connections/implementation/payload_chunk_prefetcher.h"
+#include "connections/implementation/payload_chunk_reassembler.h"
+#include "connections/implementation/payload_compression.h"
 #include "connections/listeners.h"
 #include "connections/payload.h"
 #include "connections/payload_type.h"
 #include "connections/status.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/atomic_boolean.h"
 #include "internal/platform/atomic_reference.h"
 #include "internal/platform/byte_array.h"
@@ -67,6 +75,20 @@ class PayloadManager : public EndpointManager::FrameProcessor {
       const std::string& from_endpoint_id, ClientProxy* to_client,
       location::nearby::proto::connections::Medium current_medium) override;
 
+  // Frames of different endpoints may be processed at the same time if
+  // kEnableConcurrentFrameProcessing is on.
+  bool AllowsConcurrentDispatch() const override {
+    return is_concurrent_frame_processing_enabled_;
+  }
+
+  // @EndpointManagerReaderThread
+  // Attaches `body` to the payload without copying it into the frame first.
+  void OnIncomingDataFrame(
+      location::nearby::connections::OfflineFrame& offline_frame,
+      absl::string_view body, const std::string& from_endpoint_id,
+      ClientProxy* to_client,
+      location::nearby::proto::connections::Medium current_medium) override;
+
   // @EndpointManagerThread
   void OnEndpointDisconnect(
       ClientProxy* client, const std::string& service_id,
@@ -158,6 +180,21 @@ class PayloadManager : public EndpointManager::FrameProcessor {
     void SetOffsetForEndpoint(const std::string& endpoint_id, int64_t offset)
         ABSL_LOCKS_EXCLUDED(mutex_);
 
+    // The decompressor of an incoming payload sent compressed, or null. Only
+    // used by the thread that attaches its chunks.
+    PayloadDecompressor* GetDecompressor() { return decompressor_.get(); }
+    void SetDecompressor(std::unique_ptr<PayloadDecompressor> decompressor) {
+      decompressor_ = std::move(decompressor);
+    }
+
+    // Where the next chunk of an incoming payload goes; see
+    // PayloadChunkReassembler::GetPosition(). Only used by the thread that
+    // attaches its chunks.
+    int64_t GetNextChunkPosition() const { return next_chunk_position_; }
+    void SetNextChunkPosition(int64_t position) {
+      next_chunk_position_ = position;
+    }
+
     // Closes internal_payload_.
     // Close is called when a pending peyload does not have associated
     // endpoints.
@@ -176,6 +213,8 @@ class PayloadManager : public EndpointManager::FrameProcessor {
     AtomicBoolean is_locally_canceled_{false};
     AtomicBoolean is_closed_;
     const std::unique_ptr<InternalPayload> internal_payload_;
+    std::unique_ptr<PayloadDecompressor> decompressor_;
+    int64_t next_chunk_position_ = 0;
     absl::AnyInvocable<void(PendingPayload*) &&> destroy_callback_;
     absl::flat_hash_map<std::string, EndpointInfo> endpoints_
         ABSL_GUARDED_BY(mutex_);
@@ -220,38 +259,45 @@ class PayloadManager : public EndpointManager::FrameProcessor {
   };
 
   // Tracks and manages PendingPayload objects in a synchronized manner.
+  // Payloads are spread over shards by id, each with a lock of its own, so
+  // that readers of different endpoints processing frames at the same time
+  // (see kEnableConcurrentFrameProcessing) rarely wait for each other.
   class PendingPayloads {
    public:
     PendingPayloads() = default;
     ~PendingPayloads() = default;
 
     void StartTrackingPayload(Payload::Id payload_id,
-                              std::unique_ptr<PendingPayload> pending_payload)
-        ABSL_LOCKS_EXCLUDED(mutex_);
-    void StopTrackingPayload(Payload::Id payload_id)
-        ABSL_LOCKS_EXCLUDED(mutex_);
-    void StopTrackingAllPayloads() ABSL_LOCKS_EXCLUDED(mutex_);
-    PendingPayloadHandle GetPayload(Payload::Id payload_id) const
-        ABSL_LOCKS_EXCLUDED(mutex_);
+                              std::unique_ptr<PendingPayload> pending_payload);
+    void StopTrackingPayload(Payload::Id payload_id);
+    void StopTrackingAllPayloads();
+    PendingPayloadHandle GetPayload(Payload::Id payload_id) const;
     // Calls `callback` for each tracked payload. The callback must not call
     // other `PendingPayloads` methods.
-    void ForEachPayload(absl::AnyInvocable<void(PendingPayload*)> callback)
-        ABSL_LOCKS_EXCLUDED(mutex_);
+    void ForEachPayload(absl::AnyInvocable<void(PendingPayload*)> callback);
 
    private:
-    void Release(PendingPayload* payload) ABSL_LOCKS_EXCLUDED(mutex_);
-    void Remove(absl::flat_hash_map<
-                Payload::Id, std::unique_ptr<PendingPayload>>::iterator it)
-        ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
-    mutable Mutex mutex_;
-    absl::flat_hash_map<Payload::Id, std::unique_ptr<PendingPayload>>
-        pending_payloads_ ABSL_GUARDED_BY(mutex_);
-    // When we stop tracking a payload but someone is still holding a handle to
-    // the payload, we can't delete it just yet. Instead, we move it to the
-    // garbage bin. When the `PendingPayloadHandle` is released, the payload
-    // will be removed from the bin.
-    std::vector<std::unique_ptr<PendingPayload>> payload_garbage_bin_
-        ABSL_GUARDED_BY(mutex_);
+    static constexpr int kShardCount = 16;
+
+    using PayloadMap =
+        absl::flat_hash_map<Payload::Id, std::unique_ptr<PendingPayload>>;
+    struct Shard {
+      mutable Mutex mutex;
+      PayloadMap pending_payloads ABSL_GUARDED_BY(mutex);
+      // When we stop tracking a payload but someone is still holding a handle
+      // to the payload, we can't delete it just yet. Instead, we move it to
+      // the garbage bin. When the `PendingPayloadHandle` is released, the
+      // payload will be removed from the bin.
+      std::vector<std::unique_ptr<PendingPayload>> payload_garbage_bin
+          ABSL_GUARDED_BY(mutex);
+    };
+
+    Shard& GetShard(Payload::Id payload_id) const;
+    void Release(PendingPayload* payload);
+    static void Remove(Shard& shard, PayloadMap::iterator it)
+        ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mutex);
+
+    mutable std::array<Shard, kShardCount> shards_;
   };
 
   using Endpoints = std::vector<const EndpointInfo*>;
@@ -263,13 +309,59 @@ class PayloadManager : public EndpointManager::FrameProcessor {
   static std::pair<std::vector<std::string>, Endpoints>
   GetAvailableAndUnavailableEndpoints(const PendingPayload& pending_payload);
 
+  // The newest chunk of an outgoing payload that each endpoint's channel has
+  // written. Channels may write a chunk after SendPayloadChunk() returns (see
+  // kEnablePipelinedPayloadSend), so progress is only reported up to it.
+  // Updated from the channels' writer threads, which may still be writing
+  // once the payload is done, hence shared.
+  class WrittenChunks {
+   public:
+    struct Chunk {
+      int32_t flags;
+      int64_t offset;
+      int64_t body_size;
+    };
+
+    // Records that `chunk` has been written to `endpoint_id`. Chunks may be
+    // written out of order over several paths; older ones are ignored.
+    void Add(const std::string& endpoint_id, const Chunk& chunk)
+        ABSL_LOCKS_EXCLUDED(mutex_);
+
+    // Returns the newest written chunk, unless it was returned already.
+    std::optional<Chunk> TakeUnreported(const std::string& endpoint_id)
+        ABSL_LOCKS_EXCLUDED(mutex_);
+
+   private:
+    struct Newest {
+      Chunk chunk;
+      bool reported = false;
+    };
+
+    Mutex mutex_;
+    absl::flat_hash_map<std::string, Newest> newest_ ABSL_GUARDED_BY(mutex_);
+  };
+
   // Returns the number of bytes sent.  0 bytes sent indicates end of payload.
   // Returns -1 on error.
+  // `prefetcher`, if not null, supplies the chunks instead of reading them
+  // from the payload on this thread.
+  // `compressor`, if not null, compresses the chunks if the first one looks
+  // compressible, in which case `payload_header` is marked as compressed.
+  // `written_chunks` tracks which chunks have been written, for reporting
+  // progress.
   int SendPayloadLoop(
       ClientProxy* client, PendingPayload& pending_payload,
       location::nearby::connections::PayloadTransferFrame::PayloadHeader&
           payload_header,
-      int64_t next_chunk_offset, size_t resume_offset, int index);
+      int64_t next_chunk_offset, size_t resume_offset, int index,
+      PayloadChunkPrefetcher* prefetcher, PayloadCompressor* compressor,
+      const std::shared_ptr<WrittenChunks>& written_chunks);
+
+  // Returns true if a payload sent to `endpoint_ids` is worth compressing:
+  // all of them can decompress it and are on low bandwidth connections.
+  bool ShouldCompressPayload(ClientProxy* client,
+                             const std::vector<std::string>& endpoint_ids);
+
   void SendClientCallbacksForFinishedIncomingPayloadRunnable(
       ClientProxy* client, const std::string& endpoint_id,
       const location::nearby::connections::PayloadTransferFrame::PayloadHeader&
@@ -311,8 +403,8 @@ class PayloadManager : public EndpointManager::FrameProcessor {
       ABSL_LOCKS_EXCLUDED(mutex_);
 
   Payload::Id CreateOutgoingPayload(
-      Payload payload, const std::vector<std::string>& endpoint_ids)
-      ABSL_LOCKS_EXCLUDED(mutex_);
+      ClientProxy* client, Payload payload,
+      const std::vector<std::string>& endpoint_ids) ABSL_LOCKS_EXCLUDED(mutex_);
 
   void SendClientCallbacksForFinishedOutgoingPayload(
       ClientProxy* client,
@@ -389,11 +481,33 @@ class PayloadManager : public EndpointManager::FrameProcessor {
       int32_t payload_chunk_flags, int64_t payload_chunk_offset,
       int64_t payload_chunk_body_size);
 
+  // `payload_chunk_body` is the body of the frame's chunk, which may have been
+  // left out of the frame itself (see OnIncomingDataFrame()).
   void ProcessDataPacket(ClientProxy* to_client,
                          const std::string& from_endpoint_id,
                          location::nearby::connections::PayloadTransferFrame&
                              payload_transfer_frame,
+                         absl::string_view payload_chunk_body,
                          location::nearby::proto::connections::Medium medium);
+  // Hands the incoming payload to the client, on the status update thread.
+  void ReleaseIncomingPayload(ClientProxy* to_client,
+                              const std::string& from_endpoint_id,
+                              Payload::Id payload_id);
+  // True if a DATA frame must go through ProcessMultipathDataPacket(): the
+  // endpoint has several paths, chunks of it are being reassembled, or the
+  // chunk is not the next one expected (e.g. it was written to a path this
+  // device has not added yet).
+  bool NeedsReassembly(
+      const std::string& from_endpoint_id,
+      const location::nearby::connections::PayloadTransferFrame&
+          payload_transfer_frame);
+  // Puts DATA frames that arrive over several paths back in order before
+  // handing them to ProcessDataPacket().
+  void ProcessMultipathDataPacket(
+      ClientProxy* to_client, const std::string& from_endpoint_id,
+      location::nearby::connections::PayloadTransferFrame&
+          payload_transfer_frame,
+      location::nearby::proto::connections::Medium medium);
   void ProcessControlPacket(ClientProxy* to_client,
                             const std::string& from_endpoint_id,
                             location::nearby::connections::PayloadTransferFrame&
@@ -448,6 +562,16 @@ class PayloadManager : public EndpointManager::FrameProcessor {
   PendingPayloads pending_payloads_;
   EndpointManager* endpoint_manager_;
 
+  // Only used if kEnableMultipathTransfer is enabled.
+  PayloadChunkReassembler chunk_reassembler_;
+  const bool is_multipath_enabled_ = NearbyFlags::GetInstance().GetBoolFlag(
+      config_package_nearby::nearby_connections_feature::
+          kEnableMultipathTransfer);
+  const bool is_concurrent_frame_processing_enabled_ =
+      NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableConcurrentFrameProcessing);
+
   // When callback processing cannot keep the speed of callback update, the
   // callback thread will be lag to the real transfer. In order to keep sync
   // between callback and sending/receiving threads, we will skip
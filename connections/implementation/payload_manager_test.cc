@@ -15,18 +15,23 @@
 #include "connections/implementation/payload_manager.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <string>
 #include <utility>
 
 #include "gtest/gtest.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "connections/implementation/internal_payload_factory.h"
 #include "connections/implementation/offline_frames.h"
+#include "connections/implementation/payload_compression.h"
 #include "connections/implementation/simulation_user.h"
 #include "connections/listeners.h"
 #include "connections/medium_selector.h"
 #include "connections/payload.h"
 #include "connections/status.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/count_down_latch.h"
 #include "internal/platform/exception.h"
@@ -118,6 +123,16 @@ class PayloadSimulationUser : public SimulationUser {
                         Medium::WIFI_HOTSPOT);
   }
 
+  // Processes a DATA frame as if `discovered_` sent it.
+  void ReceiveFrame(const PayloadTransferFrame::PayloadHeader& header,
+                    const PayloadTransferFrame::PayloadChunk& chunk) {
+    OfflineFrame offline_frame;
+    offline_frame.ParseFromString(
+        parser::ForDataPayloadTransfer(header, chunk));
+    pm_.OnIncomingFrame(offline_frame, discovered_.endpoint_id, &client_,
+                        Medium::BLUETOOTH);
+  }
+
   Status CancelPayload() {
     if (sender_payload_id_) {
       return pm_.CancelPayload(&client_, sender_payload_id_);
@@ -406,6 +421,184 @@ TEST_P(PayloadManagerTest, SendPayloadWithSkip_StreamPayload) {
   env_.Stop();
 }
 
+TEST_P(PayloadManagerTest, SendPayloadWithSkip_MultipathEnabled) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableMultipathTransfer,
+      true);
+  constexpr size_t kOffset = 3;
+  env_.Start();
+  PayloadSimulationUser user_a(kDeviceA, GetParam());
+  PayloadSimulationUser user_b(kDeviceB, GetParam());
+  ASSERT_TRUE(SetupConnection(user_a, user_b));
+  auto [input, tx] = CreatePipe();
+  user_a.ExpectPayload(payload_latch_);
+  tx->Write(kMessage);
+
+  Payload payload(std::move(input));
+  payload.SetOffset(kOffset);
+  user_b.SendPayload(std::move(payload));
+  ASSERT_TRUE(payload_latch_.Await(kDefaultTimeout).result());
+  ASSERT_NE(user_a.GetPayload().AsStream(), nullptr);
+  InputStream& rx = *user_a.GetPayload().AsStream();
+
+  EXPECT_TRUE(user_a.WaitForProgress(
+      [](const PayloadProgressInfo& info) {
+        return info.bytes_transferred >= kMessage.size() - kOffset;
+      },
+      kProgressTimeout));
+  EXPECT_EQ(rx.Read(kChunkSize).result(), ByteArray("sage"));
+
+  tx->Write(kMessage);
+  EXPECT_TRUE(user_a.WaitForProgress(
+      [](const PayloadProgressInfo& info) {
+        return info.bytes_transferred >= 2 * kMessage.size() - kOffset;
+      },
+      kProgressTimeout));
+  EXPECT_EQ(rx.Read(kChunkSize).result().AsStringView(), kMessage);
+
+  rx.Close();
+  tx->Close();
+  user_a.Stop();
+  user_b.Stop();
+  env_.Stop();
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+PayloadTransferFrame::PayloadChunk CreateCompressedChunk(
+    PayloadCompressor& compressor, int64_t offset, int index,
+    absl::string_view body, bool last_chunk = false) {
+  PayloadTransferFrame::PayloadChunk chunk;
+  chunk.set_offset(offset);
+  chunk.set_index(index);
+  if (!body.empty()) {
+    chunk.set_body(std::string(compressor.Compress(body).result()));
+  }
+  if (last_chunk) {
+    chunk.set_flags(PayloadTransferFrame::PayloadChunk::LAST_CHUNK);
+  }
+  return chunk;
+}
+
+TEST_P(PayloadManagerTest, CanReceiveCompressedBytePayload) {
+  env_.Start();
+  PayloadSimulationUser user_a(kDeviceA, GetParam());
+  PayloadSimulationUser user_b(kDeviceB, GetParam());
+  ASSERT_TRUE(SetupConnection(user_a, user_b));
+  std::string message(10 * 1024, 'a');
+  PayloadTransferFrame::PayloadHeader header;
+  header.set_id(1234);
+  header.set_type(PayloadTransferFrame::PayloadHeader::BYTES);
+  header.set_total_size(message.size());
+  header.set_compression(PayloadTransferFrame::PayloadHeader::DEFLATE);
+  PayloadCompressor compressor;
+
+  user_a.ExpectPayload(payload_latch_);
+  user_a.ReceiveFrame(header, CreateCompressedChunk(compressor, 0, 0, message));
+  user_a.ReceiveFrame(header, CreateCompressedChunk(compressor, message.size(),
+                                                    1, "", true));
+  ASSERT_TRUE(payload_latch_.Await(kDefaultTimeout).result());
+  EXPECT_EQ(user_a.GetPayload().AsBytes(), ByteArray(message));
+
+  user_a.Stop();
+  user_b.Stop();
+  env_.Stop();
+}
+
+TEST_P(PayloadManagerTest, RejectsCompressedChunkThatExpandsTooMuch) {
+  env_.Start();
+  PayloadSimulationUser user_a(kDeviceA, GetParam());
+  PayloadSimulationUser user_b(kDeviceB, GetParam());
+  ASSERT_TRUE(SetupConnection(user_a, user_b));
+  // A few kilobytes that inflate to more than any chunk a sender would send,
+  // within the size the sender claims for the payload.
+  std::string bomb(9 * 1024 * 1024, '\0');
+  PayloadTransferFrame::PayloadHeader header;
+  header.set_id(1234);
+  header.set_type(PayloadTransferFrame::PayloadHeader::STREAM);
+  header.set_total_size(64 * 1024 * 1024);
+  header.set_compression(PayloadTransferFrame::PayloadHeader::DEFLATE);
+  PayloadCompressor compressor;
+
+  user_a.ExpectPayload(payload_latch_);
+  user_a.ReceiveFrame(header, CreateCompressedChunk(compressor, 0, 0, bomb));
+  ASSERT_TRUE(payload_latch_.Await(kDefaultTimeout).result());
+  EXPECT_TRUE(user_a.WaitForProgress(
+      [](const PayloadProgressInfo& info) {
+        return info.status == PayloadProgressInfo::Status::kFailure;
+      },
+      kProgressTimeout));
+
+  user_a.Stop();
+  user_b.Stop();
+  env_.Stop();
+}
+
+TEST_P(PayloadManagerTest, RejectsCompressedBytePayloadAboveSizeLimit) {
+  env_.Start();
+  PayloadSimulationUser user_a(kDeviceA, GetParam());
+  PayloadSimulationUser user_b(kDeviceB, GetParam());
+  ASSERT_TRUE(SetupConnection(user_a, user_b));
+  PayloadTransferFrame::PayloadHeader header;
+  header.set_id(1234);
+  header.set_type(PayloadTransferFrame::PayloadHeader::BYTES);
+  header.set_total_size(kMaxIncomingBytesPayloadSize + 1);
+  header.set_compression(PayloadTransferFrame::PayloadHeader::DEFLATE);
+  PayloadCompressor compressor;
+
+  user_a.ExpectPayload(payload_latch_);
+  user_a.ReceiveFrame(header,
+                      CreateCompressedChunk(compressor, 0, 0, kMessage, true));
+  EXPECT_FALSE(payload_latch_.Await(absl::Milliseconds(100)).result());
+
+  user_a.Stop();
+  user_b.Stop();
+  env_.Stop();
+}
+
+TEST_P(PayloadManagerTest, CanReceiveCompressedChunksOutOfOrder) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableMultipathTransfer,
+      true);
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnablePayloadCompression,
+      true);
+  env_.Start();
+  PayloadSimulationUser user_a(kDeviceA, GetParam());
+  PayloadSimulationUser user_b(kDeviceB, GetParam());
+  ASSERT_TRUE(SetupConnection(user_a, user_b));
+  std::string part1(10 * 1024, 'a');
+  std::string part2(10 * 1024, 'b');
+  PayloadTransferFrame::PayloadHeader header;
+  header.set_id(1234);
+  header.set_type(PayloadTransferFrame::PayloadHeader::BYTES);
+  header.set_total_size(part1.size() + part2.size());
+  header.set_is_multi_chunk(true);
+  header.set_compression(PayloadTransferFrame::PayloadHeader::DEFLATE);
+  PayloadCompressor compressor;
+  PayloadTransferFrame::PayloadChunk chunk1 =
+      CreateCompressedChunk(compressor, 0, 0, part1);
+  PayloadTransferFrame::PayloadChunk chunk2 =
+      CreateCompressedChunk(compressor, part1.size(), 1, part2);
+  PayloadTransferFrame::PayloadChunk last_chunk = CreateCompressedChunk(
+      compressor, header.total_size(), 2, "", true);
+
+  // As if the chunks were striped over two paths.
+  user_a.ExpectPayload(payload_latch_);
+  user_a.ReceiveFrame(header, chunk2);
+  user_a.ReceiveFrame(header, last_chunk);
+  user_a.ReceiveFrame(header, chunk1);
+  ASSERT_TRUE(payload_latch_.Await(kDefaultTimeout).result());
+  EXPECT_EQ(user_a.GetPayload().AsBytes(), ByteArray(part1 + part2));
+
+  user_a.Stop();
+  user_b.Stop();
+  env_.Stop();
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
 TEST_P(PayloadManagerTest, OfflineFrame_BeforeConnected_ShouldDrop) {
   env_.Start();
   PayloadSimulationUser user(kDeviceB, GetParam());
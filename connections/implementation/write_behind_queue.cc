@@ -0,0 +1,135 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/write_behind_queue.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/strings/string_view.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/mutex_lock.h"
+
+namespace nearby::connections {
+
+WriteBehindQueue::WriteBehindQueue(
+    std::int64_t max_queued_bytes, std::size_t max_batch_bytes,
+    absl::AnyInvocable<Exception(absl::string_view data)> write)
+    : max_queued_bytes_(max_queued_bytes),
+      max_batch_bytes_(max_batch_bytes),
+      write_(std::move(write)) {}
+
+WriteBehindQueue::~WriteBehindQueue() {
+  Flush();
+  writer_.Shutdown();
+}
+
+Exception WriteBehindQueue::Write(absl::string_view chunk) {
+  MutexLock lock(&mutex_);
+  while (queued_bytes_ >= max_queued_bytes_ && exception_.Ok()) {
+    cond_.Wait();
+  }
+  if (!exception_.Ok()) {
+    return exception_;
+  }
+  chunks_.emplace_back(chunk);
+  queued_bytes_ += chunk.size();
+  if (!writing_) {
+    writing_ = true;
+    writer_.Execute([this]() { RunWriteLoop(); });
+  }
+  return {Exception::kSuccess};
+}
+
+Exception WriteBehindQueue::Flush() {
+  MutexLock lock(&mutex_);
+  while (writing_) {
+    cond_.Wait();
+  }
+  return exception_;
+}
+
+void WriteBehindQueue::Close(absl::AnyInvocable<void()> on_closed) {
+  {
+    MutexLock lock(&mutex_);
+    if (exception_.Ok()) {
+      exception_ = {Exception::kIo};
+    }
+    DropChunks();
+    cond_.Notify();
+    if (writing_) {
+      // Closed twice while writing; the first `on_closed` is still pending.
+      if (on_closed_ == nullptr) {
+        on_closed_ = std::move(on_closed);
+      }
+      return;
+    }
+  }
+  on_closed();
+}
+
+void WriteBehindQueue::RunWriteLoop() {
+  std::string batch;
+  while (true) {
+    absl::AnyInvocable<void()> on_closed;
+    {
+      MutexLock lock(&mutex_);
+      queued_bytes_ -= batch.size();
+      batch.clear();
+      if (!exception_.Ok()) {
+        DropChunks();
+      }
+      cond_.Notify();
+      if (chunks_.empty()) {
+        if (on_closed_ == nullptr) {
+          writing_ = false;
+          return;
+        }
+        // Still `writing_`, so that the destructor waits for it.
+        on_closed = std::move(on_closed_);
+        on_closed_ = nullptr;
+      } else {
+        batch = std::move(chunks_.front());
+        chunks_.pop_front();
+        while (!chunks_.empty() &&
+               batch.size() + chunks_.front().size() <= max_batch_bytes_) {
+          batch.append(chunks_.front());
+          chunks_.pop_front();
+        }
+      }
+    }
+
+    if (on_closed != nullptr) {
+      on_closed();
+      continue;
+    }
+    Exception exception = write_(batch);
+    if (!exception.Ok()) {
+      MutexLock lock(&mutex_);
+      exception_ = exception;
+    }
+  }
+}
+
+void WriteBehindQueue::DropChunks() {
+  for (const std::string& chunk : chunks_) {
+    queued_bytes_ -= chunk.size();
+  }
+  chunks_.clear();
+}
+
+}  // namespace nearby::connections
@@ -0,0 +1,90 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_WRITE_BEHIND_QUEUE_H_
+#define CORE_INTERNAL_WRITE_BEHIND_QUEUE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/strings/string_view.h"
+#include "internal/platform/condition_variable.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/single_thread_executor.h"
+
+namespace nearby::connections {
+
+// Writes the chunks of an incoming file on a worker thread, so that the thread
+// reading them from the endpoint doesn't wait for the disk.
+//
+// Chunks that queue up while a write is in progress are joined and handed to
+// `write` at once, up to `max_batch_bytes`, so a slow disk gets fewer, larger
+// writes. Write() only blocks the caller while `max_queued_bytes` are queued or
+// being written.
+class WriteBehindQueue {
+ public:
+  // `write` is called on the worker thread, with the chunks in the order they
+  // were queued. Once it fails, the rest of the queue is dropped.
+  WriteBehindQueue(std::int64_t max_queued_bytes, std::size_t max_batch_bytes,
+                   absl::AnyInvocable<Exception(absl::string_view data)> write);
+  // Waits for the queued chunks to be written.
+  ~WriteBehindQueue();
+
+  WriteBehindQueue(const WriteBehindQueue&) = delete;
+  WriteBehindQueue& operator=(const WriteBehindQueue&) = delete;
+
+  // Queues `chunk`. Returns the exception of a failed earlier write, if any.
+  Exception Write(absl::string_view chunk) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Blocks until the queued chunks are written. Returns the exception of the
+  // first failed write, if any.
+  Exception Flush() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Drops the chunks that are not written yet, and fails Write() from now on,
+  // including calls blocked waiting for room. Doesn't wait for the disk:
+  // `on_closed` is called once no write is in progress, on the calling thread
+  // if the worker is idle and on the worker thread otherwise.
+  void Close(absl::AnyInvocable<void()> on_closed) ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  void RunWriteLoop() ABSL_LOCKS_EXCLUDED(mutex_);
+  void DropChunks() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const std::int64_t max_queued_bytes_;
+  const std::size_t max_batch_bytes_;
+  // Only called on `writer_`.
+  absl::AnyInvocable<Exception(absl::string_view data)> write_;
+
+  Mutex mutex_;
+  // Notified when room is made, a write fails, or the worker goes idle.
+  ConditionVariable cond_{&mutex_};
+  std::deque<std::string> chunks_ ABSL_GUARDED_BY(mutex_);
+  // Includes the batch being written.
+  std::int64_t queued_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool writing_ ABSL_GUARDED_BY(mutex_) = false;
+  Exception exception_ ABSL_GUARDED_BY(mutex_) = {Exception::kSuccess};
+  // Set by Close() while a write is in progress.
+  absl::AnyInvocable<void()> on_closed_ ABSL_GUARDED_BY(mutex_);
+
+  SingleThreadExecutor writer_;
+};
+
+}  // namespace nearby::connections
+
+#endif  // CORE_INTERNAL_WRITE_BEHIND_QUEUE_H_
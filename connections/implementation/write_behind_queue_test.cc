@@ -0,0 +1,213 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/write_behind_queue.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/single_thread_executor.h"
+
+namespace nearby::connections {
+namespace {
+
+// Records the writes, and holds them while `blocked` is set.
+class FakeDisk {
+ public:
+  Exception Write(absl::string_view data) {
+    absl::MutexLock lock(&mutex_);
+    auto unblocked = [this]() ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+      return !blocked_;
+    };
+    mutex_.Await(absl::Condition(&unblocked));
+    writes_.emplace_back(data);
+    return exception_;
+  }
+
+  void SetBlocked(bool blocked) {
+    absl::MutexLock lock(&mutex_);
+    blocked_ = blocked;
+  }
+
+  void SetException(Exception exception) {
+    absl::MutexLock lock(&mutex_);
+    exception_ = exception;
+  }
+
+  std::vector<std::string> GetWrites() {
+    absl::MutexLock lock(&mutex_);
+    return writes_;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  bool blocked_ ABSL_GUARDED_BY(mutex_) = false;
+  Exception exception_ ABSL_GUARDED_BY(mutex_) = {Exception::kSuccess};
+  std::vector<std::string> writes_ ABSL_GUARDED_BY(mutex_);
+};
+
+TEST(WriteBehindQueueTest, WritesChunksInOrder) {
+  FakeDisk disk;
+  WriteBehindQueue queue(/*max_queued_bytes=*/100, /*max_batch_bytes=*/10,
+                         [&](absl::string_view data) {
+                           return disk.Write(data);
+                         });
+  std::string expected;
+
+  for (char c = 'a'; c <= 'z'; ++c) {
+    std::string chunk(c % 4 + 1, c);
+    EXPECT_TRUE(queue.Write(chunk).Ok());
+    expected += chunk;
+  }
+  EXPECT_TRUE(queue.Flush().Ok());
+
+  std::string written;
+  for (const std::string& data : disk.GetWrites()) {
+    EXPECT_LE(data.size(), 10);
+    written += data;
+  }
+  EXPECT_EQ(written, expected);
+}
+
+TEST(WriteBehindQueueTest, JoinsChunksQueuedDuringWrite) {
+  FakeDisk disk;
+  WriteBehindQueue queue(/*max_queued_bytes=*/100, /*max_batch_bytes=*/6,
+                         [&](absl::string_view data) {
+                           return disk.Write(data);
+                         });
+
+  disk.SetBlocked(true);
+  EXPECT_TRUE(queue.Write("ab").Ok());
+  EXPECT_TRUE(queue.Write("cd").Ok());
+  EXPECT_TRUE(queue.Write("ef").Ok());
+  EXPECT_TRUE(queue.Write("gh").Ok());
+  EXPECT_TRUE(queue.Write("ij").Ok());
+  disk.SetBlocked(false);
+  EXPECT_TRUE(queue.Flush().Ok());
+
+  // The first chunk may be taken before the others are queued.
+  std::vector<std::string> writes = disk.GetWrites();
+  EXPECT_LE(writes.size(), 3);
+  std::string written;
+  for (const std::string& data : writes) {
+    written += data;
+  }
+  EXPECT_EQ(written, "abcdefghij");
+}
+
+TEST(WriteBehindQueueTest, WriteBlocksWhenQueueIsFull) {
+  FakeDisk disk;
+  WriteBehindQueue queue(/*max_queued_bytes=*/4, /*max_batch_bytes=*/4,
+                         [&](absl::string_view data) {
+                           return disk.Write(data);
+                         });
+  absl::Mutex mutex;
+  bool written = false;
+
+  disk.SetBlocked(true);
+  EXPECT_TRUE(queue.Write("abcd").Ok());
+  SingleThreadExecutor reader;
+  reader.Execute([&]() {
+    EXPECT_TRUE(queue.Write("efgh").Ok());
+    absl::MutexLock lock(&mutex);
+    written = true;
+  });
+  absl::SleepFor(absl::Milliseconds(100));
+  {
+    absl::MutexLock lock(&mutex);
+    EXPECT_FALSE(written);
+  }
+  disk.SetBlocked(false);
+  reader.Shutdown();
+
+  EXPECT_TRUE(written);
+  EXPECT_TRUE(queue.Flush().Ok());
+  EXPECT_EQ(disk.GetWrites(), (std::vector<std::string>{"abcd", "efgh"}));
+}
+
+TEST(WriteBehindQueueTest, ReturnsFailedWrite) {
+  FakeDisk disk;
+  WriteBehindQueue queue(/*max_queued_bytes=*/100, /*max_batch_bytes=*/100,
+                         [&](absl::string_view data) {
+                           return disk.Write(data);
+                         });
+
+  disk.SetException({Exception::kIo});
+  EXPECT_TRUE(queue.Write("abcd").Ok());
+  EXPECT_EQ(queue.Flush(), Exception{Exception::kIo});
+  EXPECT_EQ(queue.Write("efgh"), Exception{Exception::kIo});
+  EXPECT_EQ(disk.GetWrites(), std::vector<std::string>{"abcd"});
+}
+
+TEST(WriteBehindQueueTest, CloseFailsBlockedWrite) {
+  FakeDisk disk;
+  WriteBehindQueue queue(/*max_queued_bytes=*/4, /*max_batch_bytes=*/4,
+                         [&](absl::string_view data) {
+                           return disk.Write(data);
+                         });
+  absl::Mutex mutex;
+  bool closed = false;
+
+  disk.SetBlocked(true);
+  EXPECT_TRUE(queue.Write("abcd").Ok());
+  SingleThreadExecutor reader;
+  reader.Execute([&]() {
+    EXPECT_EQ(queue.Write("efgh"), Exception{Exception::kIo});
+  });
+  absl::SleepFor(absl::Milliseconds(100));
+  queue.Close([&]() {
+    absl::MutexLock lock(&mutex);
+    closed = true;
+  });
+  // The blocked write returns while "abcd" is still being written.
+  reader.Shutdown();
+  {
+    absl::MutexLock lock(&mutex);
+    EXPECT_FALSE(closed);
+  }
+  disk.SetBlocked(false);
+
+  EXPECT_EQ(queue.Flush(), Exception{Exception::kIo});
+  {
+    absl::MutexLock lock(&mutex);
+    EXPECT_TRUE(closed);
+  }
+  EXPECT_EQ(disk.GetWrites(), std::vector<std::string>{"abcd"});
+}
+
+TEST(WriteBehindQueueTest, CloseWhenIdleCallsBackAtOnce) {
+  FakeDisk disk;
+  WriteBehindQueue queue(/*max_queued_bytes=*/100, /*max_batch_bytes=*/100,
+                         [&](absl::string_view data) {
+                           return disk.Write(data);
+                         });
+  bool closed = false;
+
+  EXPECT_TRUE(queue.Write("abcd").Ok());
+  EXPECT_TRUE(queue.Flush().Ok());
+  queue.Close([&]() { closed = true; });
+
+  EXPECT_TRUE(closed);
+  EXPECT_EQ(queue.Write("efgh"), Exception{Exception::kIo});
+  EXPECT_EQ(disk.GetWrites(), std::vector<std::string>{"abcd"});
+}
+
+}  // namespace
+}  // namespace nearby::connections
@@ -0,0 +1,508 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/encoding/codec.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace nearby {
+namespace encoding {
+namespace {
+
+constexpr uint8_t kInvalid = 0xff;
+
+constexpr char kBase64Chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+// The two chars of each 12-bit value, so that the scalar encoder needs two
+// lookups per three bytes.
+constexpr std::array<char, 8192> MakeBase64PairTable() {
+  std::array<char, 8192> table{};
+  for (int i = 0; i < 4096; ++i) {
+    table[2 * i] = kBase64Chars[i >> 6];
+    table[2 * i + 1] = kBase64Chars[i & 0x3f];
+  }
+  return table;
+}
+
+constexpr std::array<char, 8192> kBase64PairTable = MakeBase64PairTable();
+
+constexpr std::array<uint8_t, 256> MakeBase64DecodeTable() {
+  std::array<uint8_t, 256> table{};
+  for (auto& value : table) value = kInvalid;
+  for (int i = 0; i < 64; ++i) {
+    table[static_cast<uint8_t>(kBase64Chars[i])] = i;
+  }
+  return table;
+}
+
+constexpr std::array<uint8_t, 256> kBase64DecodeTable = MakeBase64DecodeTable();
+
+// The value of a char at one position of a four char group, already shifted
+// into place. Invalid chars set the top byte, so that a group is checked with
+// a single test.
+constexpr std::array<uint32_t, 256> MakeBase64GroupTable(int shift) {
+  std::array<uint32_t, 256> table{};
+  for (int c = 0; c < 256; ++c) {
+    table[c] = kBase64DecodeTable[c] == kInvalid
+                   ? 0xff000000
+                   : static_cast<uint32_t>(kBase64DecodeTable[c]) << shift;
+  }
+  return table;
+}
+
+constexpr std::array<uint32_t, 256> kBase64GroupTables[] = {
+    MakeBase64GroupTable(18), MakeBase64GroupTable(12),
+    MakeBase64GroupTable(6), MakeBase64GroupTable(0)};
+
+constexpr char kHexChars[] = "0123456789ABCDEF";
+
+constexpr std::array<char, 512> MakeHexTable() {
+  std::array<char, 512> table{};
+  for (int i = 0; i < 256; ++i) {
+    table[2 * i] = kHexChars[i >> 4];
+    table[2 * i + 1] = kHexChars[i & 0xf];
+  }
+  return table;
+}
+
+constexpr std::array<char, 512> kHexTable = MakeHexTable();
+
+constexpr int kBase85CharsNumber = 85;
+constexpr uint8_t kBase85Zero = 'z';
+constexpr unsigned char kBase85EncodeChars[] = {
+    '!', '"', '#', '$', '%', '&', '\'', '(', ')', '*', '+', ',', '-', '.', '/',
+    '0', '1', '2', '3', '4', '5', '6',  '7', '8', '9', ':', ';', '<', '=', '>',
+    '?', '@', 'A', 'B', 'C', 'D', 'E',  'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M',
+    'N', 'O', 'P', 'Q', 'R', 'S', 'T',  'U', 'V', 'W', 'X', 'Y', 'Z', '[', '\\',
+    ']', '^', '_', '`', 'a', 'b', 'c',  'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k',
+    'l', 'm', 'n', 'o', 'p', 'q', 'r',  's', 't', 'u'};
+
+constexpr uint8_t kBase85LastEncodeChar =
+    kBase85EncodeChars[kBase85CharsNumber - 1];
+
+constexpr uint8_t kBase85DecodeCharsCount[] = {0, 0, 1, 2, 3};
+
+constexpr std::array<uint8_t, 256> MakeBase85DecodeTable() {
+  std::array<uint8_t, 256> table{};
+  for (auto& value : table) value = kInvalid;
+  for (int i = 0; i < kBase85CharsNumber; ++i) {
+    table[kBase85EncodeChars[i]] = i;
+  }
+  return table;
+}
+
+constexpr std::array<uint8_t, 256> kBase85DecodeChars = MakeBase85DecodeTable();
+
+// The chars skipped by absl::WebSafeBase64Unescape().
+bool IsBase64Whitespace(uint8_t c) {
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+#if defined(__SSSE3__)
+// Maps 16 sextets to their chars (Wojciech Muła's pshufb lookup).
+__m128i Base64SextetsToChars(__m128i sextets) {
+  // Reduces each sextet to the index of its range: 13 for 'A'-'Z', 0 for
+  // 'a'-'z', 1 to 10 for '0'-'9', 11 for '-' and 12 for '_'.
+  __m128i ranges = _mm_subs_epu8(sextets, _mm_set1_epi8(51));
+  __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), sextets);
+  ranges = _mm_or_si128(ranges, _mm_and_si128(upper, _mm_set1_epi8(13)));
+  const __m128i offsets = _mm_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '-' - 62, '_' - 63, 'A', 0, 0);
+  return _mm_add_epi8(_mm_shuffle_epi8(offsets, ranges), sextets);
+}
+#endif
+
+#if defined(__SSE2__)
+__m128i NibblesToHex(__m128i nibbles) {
+  __m128i letters =
+      _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)),
+                    _mm_set1_epi8('A' - '0' - 10));
+  return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letters);
+}
+#endif
+
+}  // namespace
+
+size_t WebSafeBase64Encode(absl::string_view input, absl::Span<char> output) {
+  const size_t size = input.size();
+  if (output.size() < WebSafeBase64EncodedSize(size)) {
+    return 0;
+  }
+  const uint8_t* in = reinterpret_cast<const uint8_t*>(input.data());
+  char* out = output.data();
+  size_t i = 0;
+  size_t o = 0;
+#if defined(__SSSE3__)
+  // Loads 16 bytes and encodes the first 12 of them.
+  const __m128i shuffle =
+      _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+  for (; size - i >= 16; i += 12, o += 16) {
+    __m128i bytes = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), shuffle);
+    // Moves the four sextets of each three bytes into their own byte.
+    __m128i high = _mm_mulhi_epu16(
+        _mm_and_si128(bytes, _mm_set1_epi32(0x0fc0fc00)),
+        _mm_set1_epi32(0x04000040));
+    __m128i low =
+        _mm_mullo_epi16(_mm_and_si128(bytes, _mm_set1_epi32(0x003f03f0)),
+                        _mm_set1_epi32(0x01000010));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o),
+                     Base64SextetsToChars(_mm_or_si128(high, low)));
+  }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+  const uint8x16x4_t table =
+      vld1q_u8_x4(reinterpret_cast<const uint8_t*>(kBase64Chars));
+  const uint8x16_t mask = vdupq_n_u8(0x3f);
+  for (; size - i >= 48; i += 48, o += 64) {
+    uint8x16x3_t bytes = vld3q_u8(in + i);
+    uint8x16x4_t chars;
+    chars.val[0] = vqtbl4q_u8(table, vshrq_n_u8(bytes.val[0], 2));
+    chars.val[1] = vqtbl4q_u8(
+        table, vandq_u8(vorrq_u8(vshlq_n_u8(bytes.val[0], 4),
+                                 vshrq_n_u8(bytes.val[1], 4)),
+                        mask));
+    chars.val[2] = vqtbl4q_u8(
+        table, vandq_u8(vorrq_u8(vshlq_n_u8(bytes.val[1], 2),
+                                 vshrq_n_u8(bytes.val[2], 6)),
+                        mask));
+    chars.val[3] = vqtbl4q_u8(table, vandq_u8(bytes.val[2], mask));
+    vst4q_u8(reinterpret_cast<uint8_t*>(out + o), chars);
+  }
+#endif
+  for (; size - i >= 3; i += 3, o += 4) {
+    uint32_t value = in[i] << 16 | in[i + 1] << 8 | in[i + 2];
+    std::memcpy(out + o, &kBase64PairTable[2 * (value >> 12)], 2);
+    std::memcpy(out + o + 2, &kBase64PairTable[2 * (value & 0xfff)], 2);
+  }
+  if (size - i == 1) {
+    out[o++] = kBase64Chars[in[i] >> 2];
+    out[o++] = kBase64Chars[(in[i] & 0x3) << 4];
+  } else if (size - i == 2) {
+    uint32_t value = in[i] << 8 | in[i + 1];
+    out[o++] = kBase64Chars[value >> 10];
+    out[o++] = kBase64Chars[(value >> 4) & 0x3f];
+    out[o++] = kBase64Chars[(value & 0xf) << 2];
+  }
+  return o;
+}
+
+std::string WebSafeBase64Encode(absl::string_view input) {
+  std::string result(WebSafeBase64EncodedSize(input.size()), '\0');
+  WebSafeBase64Encode(input, absl::MakeSpan(result));
+  return result;
+}
+
+std::optional<size_t> WebSafeBase64Decode(absl::string_view input,
+                                          absl::Span<char> output) {
+  const size_t size = input.size();
+  if (output.size() < WebSafeBase64DecodedMaxSize(size)) {
+    return std::nullopt;
+  }
+  const uint8_t* in = reinterpret_cast<const uint8_t*>(input.data());
+  uint8_t* out = reinterpret_cast<uint8_t*>(output.data());
+  size_t i = 0;
+  size_t o = 0;
+  // The fast paths stop at the first group that holds anything other than
+  // Base64 chars, such as padding or whitespace, and leave the rest to the
+  // char by char loop below.
+#if defined(__aarch64__) && defined(__ARM_NEON)
+  const uint8x16x4_t low_table = vld1q_u8_x4(kBase64DecodeTable.data());
+  const uint8x16x4_t high_table = vld1q_u8_x4(kBase64DecodeTable.data() + 64);
+  for (; size - i >= 64; i += 64, o += 48) {
+    uint8x16x4_t chars = vld4q_u8(in + i);
+    uint8x16x4_t sextets;
+    uint8x16_t invalid = vdupq_n_u8(0);
+    for (int k = 0; k < 4; ++k) {
+      // Chars from 128 up are not covered by the two lookups.
+      sextets.val[k] = vqtbx4q_u8(vqtbl4q_u8(low_table, chars.val[k]),
+                                  high_table,
+                                  vsubq_u8(chars.val[k], vdupq_n_u8(64)));
+      invalid = vorrq_u8(invalid, vorrq_u8(sextets.val[k], chars.val[k]));
+    }
+    if (vmaxvq_u8(invalid) & 0x80) {
+      break;
+    }
+    uint8x16x3_t bytes;
+    bytes.val[0] = vorrq_u8(vshlq_n_u8(sextets.val[0], 2),
+                            vshrq_n_u8(sextets.val[1], 4));
+    bytes.val[1] = vorrq_u8(vshlq_n_u8(sextets.val[1], 4),
+                            vshrq_n_u8(sextets.val[2], 2));
+    bytes.val[2] = vorrq_u8(vshlq_n_u8(sextets.val[2], 6), sextets.val[3]);
+    vst3q_u8(out + o, bytes);
+  }
+#endif
+  for (; size - i >= 4; i += 4, o += 3) {
+    uint32_t value = kBase64GroupTables[0][in[i]] |
+                     kBase64GroupTables[1][in[i + 1]] |
+                     kBase64GroupTables[2][in[i + 2]] |
+                     kBase64GroupTables[3][in[i + 3]];
+    if (value & 0xff000000) {
+      break;
+    }
+    out[o] = value >> 16;
+    out[o + 1] = value >> 8;
+    out[o + 2] = value;
+  }
+
+  uint32_t value = 0;
+  int group_size = 0;
+  for (; i < size && in[i] != '='; ++i) {
+    if (IsBase64Whitespace(in[i])) continue;
+    uint8_t sextet = kBase64DecodeTable[in[i]];
+    if (sextet == kInvalid) {
+      return std::nullopt;
+    }
+    value = value << 6 | sextet;
+    if (++group_size == 4) {
+      out[o++] = value >> 16;
+      out[o++] = value >> 8;
+      out[o++] = value;
+      value = 0;
+      group_size = 0;
+    }
+  }
+  if (i < size) {
+    // Padding, if present, must complete the last group.
+    int padding = 0;
+    for (; i < size; ++i) {
+      if (in[i] == '=') {
+        ++padding;
+      } else if (!IsBase64Whitespace(in[i])) {
+        return std::nullopt;
+      }
+    }
+    if (group_size < 2 || group_size + padding != 4) {
+      return std::nullopt;
+    }
+  }
+  switch (group_size) {
+    case 0:
+      break;
+    case 2:
+      out[o++] = value >> 4;
+      break;
+    case 3:
+      out[o++] = value >> 10;
+      out[o++] = value >> 2;
+      break;
+    default:
+      return std::nullopt;
+  }
+  return o;
+}
+
+size_t HexEncode(absl::string_view input, absl::Span<char> output) {
+  const size_t size = input.size();
+  if (output.size() < HexEncodedSize(size)) {
+    return 0;
+  }
+  const uint8_t* in = reinterpret_cast<const uint8_t*>(input.data());
+  char* out = output.data();
+  size_t i = 0;
+#if defined(__SSE2__)
+  const __m128i mask = _mm_set1_epi8(0x0f);
+  for (; size - i >= 16; i += 16) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    __m128i high = NibblesToHex(_mm_and_si128(_mm_srli_epi16(bytes, 4), mask));
+    __m128i low = NibblesToHex(_mm_and_si128(bytes, mask));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i),
+                     _mm_unpacklo_epi8(high, low));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i + 16),
+                     _mm_unpackhi_epi8(high, low));
+  }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+  const uint8x16_t table = vld1q_u8(reinterpret_cast<const uint8_t*>(kHexChars));
+  for (; size - i >= 16; i += 16) {
+    uint8x16_t bytes = vld1q_u8(in + i);
+    uint8x16x2_t chars;
+    chars.val[0] = vqtbl1q_u8(table, vshrq_n_u8(bytes, 4));
+    chars.val[1] = vqtbl1q_u8(table, vandq_u8(bytes, vdupq_n_u8(0x0f)));
+    vst2q_u8(reinterpret_cast<uint8_t*>(out + 2 * i), chars);
+  }
+#endif
+  for (; i < size; ++i) {
+    std::memcpy(out + 2 * i, &kHexTable[2 * in[i]], 2);
+  }
+  return HexEncodedSize(size);
+}
+
+std::string HexEncode(absl::string_view input) {
+  std::string result(HexEncodedSize(input.size()), '\0');
+  HexEncode(input, absl::MakeSpan(result));
+  return result;
+}
+
+size_t Base85Encode(absl::string_view input, bool padding,
+                    absl::Span<char> output) {
+  size_t result_size = Base85EncodedMaxSize(input.size(), padding);
+  if (output.size() < result_size) {
+    return 0;
+  }
+  char* result_buffer = output.data();
+  char* result_buffer_end = output.data() + result_size;
+
+  size_t bytes = input.size();
+  const unsigned char* data =
+      reinterpret_cast<const unsigned char*>(input.data());
+  while (bytes) {
+    int count;
+    uint32_t value = 0;
+    for (count = 24; count >= 0; count -= 8) {
+      uint32_t ch = *data++;
+      value |= ch << count;
+      if (--bytes == 0) break;
+    }
+
+    if (value == 0) {
+      // special case, use 'z' to encode it
+      result_buffer[0] = kBase85Zero;
+      ++result_buffer;
+      if (count < 0 || padding) {
+        result_buffer_end -= 4;
+      } else {
+        count = (24 - count) >> 3;
+        result_buffer_end -= (((count % 4) * 5 + 3) >> 2) - 1;
+      }
+      continue;
+    }
+
+    int changed_count = 0;
+    for (count = 4; count >= 0; count--) {
+      int val = value % 85;
+      value /= 85;
+      if (result_buffer + count < result_buffer_end) {
+        result_buffer[count] = kBase85EncodeChars[val];
+        ++changed_count;
+      }
+    }
+
+    result_buffer += changed_count;
+  }
+
+  return result_buffer - output.data();
+}
+
+std::optional<size_t> Base85DecodedSize(absl::string_view input) {
+  size_t length = 0;
+  size_t pos = 0;
+  for (; pos < input.size();) {
+    if (input[pos] == kBase85Zero) {
+      // special zero case
+      length += 4;
+      ++pos;
+      continue;
+    }
+    if (pos + 5 > input.size()) {
+      size_t remain = input.size() - pos;
+      if (remain == 1) {
+        return std::nullopt;
+      }
+      length += kBase85DecodeCharsCount[remain];
+      break;
+    }
+    pos += 5;
+    length += 4;
+  }
+  return length;
+}
+
+std::optional<size_t> Base85Decode(absl::string_view input,
+                                   absl::Span<char> output) {
+  std::optional<size_t> decoded_size = Base85DecodedSize(input);
+  if (!decoded_size.has_value() || output.size() < *decoded_size) {
+    return std::nullopt;
+  }
+  size_t length = *decoded_size;
+
+  const char* input_buffer = input.data();
+  const char* input_buffer_end = input_buffer + input.size();
+  char* result_buffer = output.data();
+  char* result_buffer_end = result_buffer + length;
+
+  while (length) {
+    int count = 4;
+    int decoded_char;
+    uint8_t input_char;
+    uint32_t value = 0;
+    bool skip_the_group = false;
+    do {
+      if (input_buffer < input_buffer_end) {
+        input_char = *input_buffer++;
+        // handle special case 'z'
+        if (count == 4 && input_char == kBase85Zero) {
+          for (int i = 0; i < count; ++i) {
+            *result_buffer++ = 0x00;
+          }
+          length -= 4;
+          skip_the_group = true;
+          break;
+        }
+
+        decoded_char = kBase85DecodeChars[input_char];
+        if (decoded_char == kInvalid) return std::nullopt;
+      } else {
+        decoded_char = kBase85LastEncodeChar;
+      }
+      value = value * 85 + decoded_char;
+    } while (--count);
+    if (skip_the_group) {
+      continue;
+    }
+    if (input_buffer < input_buffer_end) {
+      input_char = *input_buffer++;
+      decoded_char = kBase85DecodeChars[input_char];
+      if (decoded_char == kInvalid) return std::nullopt;
+    } else {
+      decoded_char = kBase85LastEncodeChar;
+    }
+    /* Detect overflow. */
+    if (0xffffffff / 85 < value || 0xffffffff - decoded_char < (value *= 85))
+      return std::nullopt;
+    value += decoded_char;
+
+    count = (length < 4) ? length : 4;
+    length -= count;
+    do {
+      value = (value << 8) | (value >> 24);
+      if (result_buffer < result_buffer_end) {
+        *result_buffer++ = value;
+      }
+    } while (--count);
+  }
+
+  return *decoded_size;
+}
+
+}  // namespace encoding
+}  // namespace nearby
@@ -0,0 +1,89 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_NEARBY_INTERNAL_ENCODING_CODEC_H_
+#define THIRD_PARTY_NEARBY_INTERNAL_ENCODING_CODEC_H_
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+
+namespace nearby {
+namespace encoding {
+
+// Text encodings of binary data that write into caller-provided buffers and
+// never allocate. Where the target has SSE2/SSSE3 (x86) or NEON (AArch64),
+// Base64 and hex process 16 to 64 bytes per step; elsewhere they fall back to
+// table-driven scalar loops producing the same output.
+
+// Web-safe Base64 ('-' and '_' instead of '+' and '/') without padding, the
+// same as absl::WebSafeBase64Escape().
+constexpr size_t WebSafeBase64EncodedSize(size_t size) {
+  return size / 3 * 4 + (size % 3 == 0 ? 0 : size % 3 + 1);
+}
+
+// Writes the encoding of `input` to the start of `output`. Returns the number
+// of chars written, or 0 if `output` is smaller than
+// WebSafeBase64EncodedSize(input.size()).
+size_t WebSafeBase64Encode(absl::string_view input, absl::Span<char> output);
+std::string WebSafeBase64Encode(absl::string_view input);
+
+// An upper bound of the decoded size of `size` chars. Exact for input without
+// padding or whitespace.
+constexpr size_t WebSafeBase64DecodedMaxSize(size_t size) {
+  return size / 4 * 3 + (size % 4 <= 1 ? 0 : size % 4 - 1);
+}
+
+// Decodes `input` to the start of `output`. Accepts the same input as
+// absl::WebSafeBase64Unescape(): padding is optional and whitespace is
+// skipped. Returns the number of bytes written, or nullopt if `input` is not
+// valid or `output` is smaller than WebSafeBase64DecodedMaxSize(input.size()).
+std::optional<size_t> WebSafeBase64Decode(absl::string_view input,
+                                          absl::Span<char> output);
+
+// Uppercase hex, two chars per byte.
+constexpr size_t HexEncodedSize(size_t size) { return size * 2; }
+
+// Returns the number of chars written, or 0 if `output` is smaller than
+// HexEncodedSize(input.size()).
+size_t HexEncode(absl::string_view input, absl::Span<char> output);
+std::string HexEncode(absl::string_view input);
+
+// Base85 as in internal/encoding/base85.h. A group of four zero bytes is
+// written as 'z', so the encoding may be shorter than this.
+constexpr size_t Base85EncodedMaxSize(size_t size, bool padding) {
+  return padding ? 5 * (size / 4) + (size % 4 != 0 ? 5 : 0)
+                 : 5 * (size / 4) + ((size % 4) * 5 + 3) / 4;
+}
+
+// Returns the number of chars written, or 0 if `output` is smaller than
+// Base85EncodedMaxSize(input.size(), padding).
+size_t Base85Encode(absl::string_view input, bool padding,
+                    absl::Span<char> output);
+
+// Returns the decoded size of `input`, or nullopt if its length is not valid.
+std::optional<size_t> Base85DecodedSize(absl::string_view input);
+
+// Returns the number of bytes written, or nullopt if `input` is not valid or
+// `output` is smaller than Base85DecodedSize(input).
+std::optional<size_t> Base85Decode(absl::string_view input,
+                                   absl::Span<char> output);
+
+}  // namespace encoding
+}  // namespace nearby
+
+#endif  // THIRD_PARTY_NEARBY_INTERNAL_ENCODING_CODEC_H_
@@ -0,0 +1,154 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the codecs against the implementations they replace: absl for
+// Base64, the ostringstream loop nearby::utils::HexEncode() used to run, and
+// the string API of base85.h. Reports heap allocations and nanoseconds per
+// call:
+//
+//   bazel run -c opt //internal/encoding:codec_benchmark
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <ios>
+#include <new>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "absl/strings/escaping.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "internal/encoding/base85.h"
+#include "internal/encoding/codec.h"
+
+namespace {
+
+std::atomic<std::int64_t> g_allocations{0};
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace nearby::encoding {
+namespace {
+
+constexpr int kIterations = 200000;
+// Endpoint info, a WifiLanServiceInfo TXT record and a file digest sized
+// inputs.
+constexpr std::size_t kSizes[] = {17, 131, 4096};
+
+// Keeps the compiler from dropping the measured calls.
+std::atomic<std::size_t> g_sink{0};
+
+struct Result {
+  double allocations_per_call;
+  double ns_per_call;
+};
+
+template <typename Call>
+Result Measure(Call call) {
+  // Warm up, so that lazily initialized state is not counted.
+  g_sink += call();
+  std::int64_t allocations = g_allocations.load();
+  absl::Time start = absl::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    g_sink += call();
+  }
+  absl::Duration elapsed = absl::Now() - start;
+  return {
+      .allocations_per_call =
+          static_cast<double>(g_allocations.load() - allocations) / kIterations,
+      .ns_per_call = absl::ToDoubleNanoseconds(elapsed) / kIterations,
+  };
+}
+
+template <typename Before, typename After>
+void Run(const char* name, std::size_t size, Before before, After after) {
+  Result old_result = Measure(before);
+  Result new_result = Measure(after);
+  std::printf("%-16s %6zu %12.2f %10.1f %12.2f %10.1f\n", name, size,
+              old_result.allocations_per_call, old_result.ns_per_call,
+              new_result.allocations_per_call, new_result.ns_per_call);
+}
+
+std::string StreamHexEncode(const std::string& data) {
+  std::ostringstream stream;
+  stream << std::hex << std::setfill('0') << std::uppercase;
+  for (unsigned char val : data) {
+    stream << std::setw(2) << static_cast<int>(val);
+  }
+  return stream.str();
+}
+
+void RunAll() {
+  std::printf("%-16s %6s %12s %10s %12s %10s\n", "codec", "bytes",
+              "old allocs", "old ns", "new allocs", "new ns");
+  for (std::size_t size : kSizes) {
+    std::string data(size, '\0');
+    for (std::size_t i = 0; i < size; ++i) {
+      data[i] = static_cast<char>(i * 131 + 7);
+    }
+    std::vector<char> buffer(Base85EncodedMaxSize(size, /*padding=*/true) +
+                             HexEncodedSize(size));
+    absl::Span<char> output = absl::MakeSpan(buffer);
+    std::string base64 = absl::WebSafeBase64Escape(data);
+    std::string base85 = Base85Encode(data);
+
+    Run(
+        "base64 encode", size,
+        [&]() { return absl::WebSafeBase64Escape(data).size(); },
+        [&]() { return WebSafeBase64Encode(data, output); });
+    Run(
+        "base64 decode", size,
+        [&]() {
+          std::string decoded;
+          absl::WebSafeBase64Unescape(base64, &decoded);
+          return decoded.size();
+        },
+        [&]() { return WebSafeBase64Decode(base64, output).value_or(0); });
+    Run(
+        "hex encode", size, [&]() { return StreamHexEncode(data).size(); },
+        [&]() { return HexEncode(data, output); });
+    Run(
+        "base85 encode", size, [&]() { return Base85Encode(data).size(); },
+        [&]() { return Base85Encode(data, /*padding=*/false, output); });
+    Run(
+        "base85 decode", size,
+        [&]() { return Base85Decode(base85).value_or("").size(); },
+        [&]() { return Base85Decode(base85, output).value_or(0); });
+  }
+}
+
+}  // namespace
+}  // namespace nearby::encoding
+
+int main() {
+  nearby::encoding::RunAll();
+  return 0;
+}
@@ -0,0 +1,137 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/encoding/codec.h"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "absl/random/random.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/escaping.h"
+#include "absl/types/span.h"
+
+namespace nearby {
+namespace encoding {
+namespace {
+
+std::string RandomBytes(absl::BitGen& bitgen, size_t size) {
+  std::string bytes;
+  for (size_t i = 0; i < size; ++i) {
+    bytes.push_back(absl::Uniform(bitgen, 0, 256));
+  }
+  return bytes;
+}
+
+// Decodes with WebSafeBase64Decode() and checks that absl agrees.
+std::optional<std::string> DecodeBase64(const std::string& input) {
+  std::string output(WebSafeBase64DecodedMaxSize(input.size()), '\0');
+  std::optional<size_t> size =
+      WebSafeBase64Decode(input, absl::MakeSpan(output));
+  std::string expected;
+  bool expected_ok = absl::WebSafeBase64Unescape(input, &expected);
+  EXPECT_EQ(size.has_value(), expected_ok) << input;
+  if (!size.has_value()) {
+    return std::nullopt;
+  }
+  output.resize(*size);
+  EXPECT_EQ(output, expected) << input;
+  return output;
+}
+
+TEST(CodecTest, Base64MatchesAbsl) {
+  absl::BitGen bitgen;
+  // Covers the tails after each of the vectorized block sizes.
+  for (size_t size = 0; size < 200; ++size) {
+    std::string data = RandomBytes(bitgen, size);
+    std::string encoded = WebSafeBase64Encode(data);
+    EXPECT_EQ(encoded, absl::WebSafeBase64Escape(data));
+    EXPECT_EQ(encoded.size(), WebSafeBase64EncodedSize(size));
+    EXPECT_EQ(DecodeBase64(encoded), data);
+  }
+}
+
+TEST(CodecTest, Base64DecodesPaddingAndWhitespace) {
+  EXPECT_EQ(DecodeBase64("QUJDRA=="), "ABCD");
+  EXPECT_EQ(DecodeBase64("QUJDRA"), "ABCD");
+  EXPECT_EQ(DecodeBase64("QUJD RA"), "ABCD");
+  EXPECT_EQ(DecodeBase64("QUJD\n"), "ABC");
+  EXPECT_EQ(DecodeBase64("QUE="), "AA");
+  EXPECT_EQ(DecodeBase64(""), "");
+}
+
+TEST(CodecTest, Base64RejectsInvalidInput) {
+  EXPECT_FALSE(DecodeBase64("QUJDRA=").has_value());
+  EXPECT_FALSE(DecodeBase64("QUJDRA===").has_value());
+  EXPECT_FALSE(DecodeBase64("QUJDRA==QUJD").has_value());
+  EXPECT_FALSE(DecodeBase64("QUJDR").has_value());
+  EXPECT_FALSE(DecodeBase64("QQ=").has_value());
+  EXPECT_FALSE(DecodeBase64("+/+/").has_value());
+}
+
+TEST(CodecTest, Base64RejectsInvalidCharAnywhere) {
+  absl::BitGen bitgen;
+  std::string encoded = WebSafeBase64Encode(RandomBytes(bitgen, 150));
+  for (char invalid : {'+', '/', '\x80', '\xff', '\0'}) {
+    for (size_t i = 0; i < encoded.size(); ++i) {
+      std::string corrupted = encoded;
+      corrupted[i] = invalid;
+      EXPECT_FALSE(DecodeBase64(corrupted).has_value()) << i;
+    }
+  }
+}
+
+TEST(CodecTest, Base64FailsOnSmallOutput) {
+  char output[3];
+
+  EXPECT_EQ(WebSafeBase64Encode("ABC", absl::MakeSpan(output)), 0);
+  EXPECT_FALSE(
+      WebSafeBase64Decode("QUJDRA", absl::MakeSpan(output)).has_value());
+}
+
+TEST(CodecTest, HexMatchesAbsl) {
+  absl::BitGen bitgen;
+  for (size_t size = 0; size < 100; ++size) {
+    std::string data = RandomBytes(bitgen, size);
+    EXPECT_EQ(HexEncode(data),
+              absl::AsciiStrToUpper(absl::BytesToHexString(data)));
+  }
+}
+
+TEST(CodecTest, HexFailsOnSmallOutput) {
+  char output[3];
+
+  EXPECT_EQ(HexEncode("AB", absl::MakeSpan(output)), 0);
+}
+
+TEST(CodecTest, Base85EncodesAndDecodesIntoSpans) {
+  char encoded[Base85EncodedMaxSize(11, /*padding=*/false)];
+  size_t encoded_size =
+      Base85Encode("hello,world", /*padding=*/false, absl::MakeSpan(encoded));
+  ASSERT_EQ(encoded_size, 14);
+  EXPECT_EQ(std::string(encoded, encoded_size), "BOu!rD_-*NEbo7");
+
+  char decoded[11];
+  EXPECT_EQ(Base85DecodedSize("BOu!rD_-*NEbo7"), 11);
+  EXPECT_EQ(Base85Decode("BOu!rD_-*NEbo7", absl::MakeSpan(decoded)), 11);
+  EXPECT_EQ(std::string(decoded, 11), "hello,world");
+  EXPECT_FALSE(
+      Base85Decode("BOu!rD_-*NEbo7", absl::MakeSpan(decoded, 10)).has_value());
+}
+
+}  // namespace
+}  // namespace encoding
+}  // namespace nearby
@@ -14,12 +14,15 @@
 
 #include "internal/platform/base64_utils.h"
 
+#include <cstddef>
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <utility>
 
-#include "absl/strings/escaping.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "internal/encoding/codec.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/input_stream.h"
@@ -28,16 +31,20 @@
 namespace nearby {
 
 std::string Base64Utils::Encode(const ByteArray& bytes) {
-  return absl::WebSafeBase64Escape(bytes.AsStringView());
+  return encoding::WebSafeBase64Encode(bytes.AsStringView());
 }
 
 ByteArray Base64Utils::Decode(absl::string_view base64_string) {
-  std::string decoded_string;
-  if (!absl::WebSafeBase64Unescape(base64_string, &decoded_string)) {
+  std::string decoded_string(
+      encoding::WebSafeBase64DecodedMaxSize(base64_string.size()), '\0');
+  std::optional<size_t> decoded_size = encoding::WebSafeBase64Decode(
+      base64_string, absl::MakeSpan(decoded_string));
+  if (!decoded_size.has_value()) {
     return ByteArray();
   }
 
-  return ByteArray(decoded_string.data(), decoded_string.size());
+  decoded_string.resize(*decoded_size);
+  return ByteArray(std::move(decoded_string));
 }
 
 std::int32_t Base64Utils::BytesToInt(const ByteArray& bytes) {
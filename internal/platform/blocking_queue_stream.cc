@@ -16,8 +16,11 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <optional>
 #include <utility>
 
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/feature_flags.h"
@@ -26,6 +29,13 @@
 namespace nearby {
 
 BlockingQueueStream::BlockingQueueStream() {
+  is_multiplex_enabled_ =
+      NearbyFlags::GetInstance().GetBoolFlag(
+          connections::config_package_nearby::nearby_connections_feature::
+              kEnableMultiplexBluetooth) ||
+      NearbyFlags::GetInstance().GetBoolFlag(
+          connections::config_package_nearby::nearby_connections_feature::
+              kEnableMultiplexWifiLan);
   LOG(INFO) << "Create a BlockingQueueStream with size "
             << FeatureFlags::GetInstance()
                    .GetFlags()
@@ -38,12 +48,20 @@ ExceptionOr<ByteArray> BlockingQueueStream::Read(std::int64_t size) {
     return ExceptionOr<ByteArray>(Exception::kExecution);
   }
 
-  if (is_closed_) {
-    LOG(INFO) << "Failed to read BlockingQueueStream because it was closed.";
-    return ExceptionOr<ByteArray>(Exception::kIo);
+  ByteArray bytes;
+  if (!queue_head_.Empty()) {
+    bytes = queue_head_;
+  } else if (is_closed_) {
+    // Bytes written before Close() can still be read.
+    std::optional<ByteArray> queued_bytes = blocking_queue_.TryTake();
+    if (!queued_bytes.has_value()) {
+      LOG(INFO) << "Failed to read BlockingQueueStream because it was closed.";
+      return ExceptionOr<ByteArray>(Exception::kIo);
+    }
+    bytes = *std::move(queued_bytes);
+  } else {
+    bytes = blocking_queue_.Take();
   }
-
-  ByteArray bytes = queue_head_.Empty() ? blocking_queue_.Take() : queue_head_;
   if (bytes == queue_end_) {
     LOG(INFO) << "BlockingQueueStream is Interrupted.";
     return ExceptionOr<ByteArray>(Exception::kIo);
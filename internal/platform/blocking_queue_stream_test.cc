@@ -41,5 +41,25 @@ TEST(BlockingQueueStreamTest, MultiplexDisabled) {
   stream.Close();
 }
 
+TEST(BlockingQueueStreamTest, MultiplexEnabled) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      connections::config_package_nearby::nearby_connections_feature::
+          kEnableMultiplexWifiLan,
+      true);
+  BlockingQueueStream stream;
+  stream.Write(ByteArray("test1test2test3"));
+
+  ExceptionOr<ByteArray> result = stream.Read(5);
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(result.result(), ByteArray("test1"));
+  result = stream.Read(100);
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(result.result(), ByteArray("test2test3"));
+
+  stream.Close();
+  EXPECT_EQ(stream.Read(5), ExceptionOr<ByteArray>(Exception::kIo));
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
 }  // namespace
 }  // namespace nearby
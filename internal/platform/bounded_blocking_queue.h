@@ -0,0 +1,126 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PLATFORM_PUBLIC_BOUNDED_BLOCKING_QUEUE_H_
+#define PLATFORM_PUBLIC_BOUNDED_BLOCKING_QUEUE_H_
+
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "internal/platform/condition_variable.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/mutex_lock.h"
+
+namespace nearby {
+
+// A move-only, closeable, bounded FIFO used to connect pipeline stages running
+// on different threads.
+//
+// Put() blocks while the queue is full, Take() blocks while it is empty.
+// Close() wakes up every waiter: afterwards Put() fails and Take() drains the
+// remaining elements before returning std::nullopt.
+template <typename T>
+class BoundedBlockingQueue {
+ public:
+  explicit BoundedBlockingQueue(size_t capacity)
+      : capacity_(capacity == 0 ? 1 : capacity) {}
+  BoundedBlockingQueue(const BoundedBlockingQueue&) = delete;
+  BoundedBlockingQueue& operator=(const BoundedBlockingQueue&) = delete;
+
+  // Returns false if the queue was closed before `value` could be queued.
+  bool Put(T value) ABSL_LOCKS_EXCLUDED(mutex_) {
+    MutexLock lock(&mutex_);
+    while (!closed_ && queue_.size() >= capacity_) {
+      cond_.Wait();
+    }
+    if (closed_) return false;
+    queue_.push_back(std::move(value));
+    cond_.Notify();
+    return true;
+  }
+
+  // Queues `value` without waiting. Returns false if the queue is full or
+  // closed.
+  bool TryPut(T value) ABSL_LOCKS_EXCLUDED(mutex_) {
+    MutexLock lock(&mutex_);
+    if (closed_ || queue_.size() >= capacity_) return false;
+    queue_.push_back(std::move(value));
+    cond_.Notify();
+    return true;
+  }
+
+  // Returns std::nullopt once the queue is closed and drained.
+  std::optional<T> Take() ABSL_LOCKS_EXCLUDED(mutex_) {
+    MutexLock lock(&mutex_);
+    while (!closed_ && queue_.empty()) {
+      cond_.Wait();
+    }
+    return PopLocked();
+  }
+
+  // Returns std::nullopt if the queue is empty.
+  std::optional<T> TryTake() ABSL_LOCKS_EXCLUDED(mutex_) {
+    MutexLock lock(&mutex_);
+    return PopLocked();
+  }
+
+  // Blocks until every queued element has been taken, or the queue is closed.
+  void WaitUntilEmpty() ABSL_LOCKS_EXCLUDED(mutex_) {
+    MutexLock lock(&mutex_);
+    while (!closed_ && !queue_.empty()) {
+      cond_.Wait();
+    }
+  }
+
+  void Close() ABSL_LOCKS_EXCLUDED(mutex_) {
+    MutexLock lock(&mutex_);
+    closed_ = true;
+    cond_.Notify();
+  }
+
+  bool IsClosed() const ABSL_LOCKS_EXCLUDED(mutex_) {
+    MutexLock lock(&mutex_);
+    return closed_;
+  }
+
+  size_t Size() const ABSL_LOCKS_EXCLUDED(mutex_) {
+    MutexLock lock(&mutex_);
+    return queue_.size();
+  }
+
+  size_t Capacity() const { return capacity_; }
+
+ private:
+  std::optional<T> PopLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    if (queue_.empty()) return std::nullopt;
+    std::optional<T> front(std::move(queue_.front()));
+    queue_.pop_front();
+    // Wakes up both blocked producers and WaitUntilEmpty() callers.
+    cond_.Notify();
+    return front;
+  }
+
+  const size_t capacity_;
+  mutable Mutex mutex_;
+  ConditionVariable cond_{&mutex_};
+  std::deque<T> queue_ ABSL_GUARDED_BY(mutex_);
+  bool closed_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+}  // namespace nearby
+
+#endif  // PLATFORM_PUBLIC_BOUNDED_BLOCKING_QUEUE_H_
@@ -0,0 +1,123 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/bounded_blocking_queue.h"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+
+#include "gtest/gtest.h"
+#include "internal/platform/count_down_latch.h"
+#include "internal/platform/single_thread_executor.h"
+
+namespace nearby {
+namespace {
+
+TEST(BoundedBlockingQueue, PutTakeKeepsOrder) {
+  BoundedBlockingQueue<int> queue(4);
+
+  EXPECT_TRUE(queue.Put(1));
+  EXPECT_TRUE(queue.Put(2));
+  EXPECT_TRUE(queue.Put(3));
+
+  EXPECT_EQ(queue.Size(), 3);
+  EXPECT_EQ(queue.Take(), 1);
+  EXPECT_EQ(queue.Take(), 2);
+  EXPECT_EQ(queue.Take(), 3);
+  EXPECT_EQ(queue.TryTake(), std::nullopt);
+}
+
+TEST(BoundedBlockingQueue, SupportsMoveOnlyTypes) {
+  BoundedBlockingQueue<std::unique_ptr<int>> queue(1);
+
+  EXPECT_TRUE(queue.Put(std::make_unique<int>(42)));
+  std::optional<std::unique_ptr<int>> value = queue.Take();
+
+  ASSERT_TRUE(value.has_value());
+  EXPECT_EQ(**value, 42);
+}
+
+TEST(BoundedBlockingQueue, TryPutFailsWhenFull) {
+  BoundedBlockingQueue<int> queue(1);
+
+  EXPECT_TRUE(queue.TryPut(1));
+  EXPECT_FALSE(queue.TryPut(2));
+}
+
+TEST(BoundedBlockingQueue, PutBlocksUntilSpaceIsAvailable) {
+  BoundedBlockingQueue<int> queue(1);
+  SingleThreadExecutor executor;
+  CountDownLatch put_done(1);
+  std::atomic_bool second_put_finished = false;
+  ASSERT_TRUE(queue.Put(1));
+
+  executor.Execute([&]() {
+    queue.Put(2);
+    second_put_finished = true;
+    put_done.CountDown();
+  });
+
+  EXPECT_FALSE(put_done.Await(absl::Milliseconds(100)).result());
+  EXPECT_FALSE(second_put_finished);
+  EXPECT_EQ(queue.Take(), 1);
+  EXPECT_TRUE(put_done.Await(absl::Seconds(1)).result());
+  EXPECT_EQ(queue.Take(), 2);
+}
+
+TEST(BoundedBlockingQueue, CloseUnblocksTakeAndDrainsRemaining) {
+  BoundedBlockingQueue<int> queue(2);
+  SingleThreadExecutor executor;
+  CountDownLatch take_done(1);
+  std::optional<int> taken = 0;
+
+  executor.Execute([&]() {
+    taken = queue.Take();
+    take_done.CountDown();
+  });
+  queue.Close();
+
+  EXPECT_TRUE(take_done.Await(absl::Seconds(1)).result());
+  EXPECT_EQ(taken, std::nullopt);
+  EXPECT_FALSE(queue.Put(1));
+  EXPECT_TRUE(queue.IsClosed());
+}
+
+TEST(BoundedBlockingQueue, TakeAfterCloseReturnsQueuedElements) {
+  BoundedBlockingQueue<int> queue(2);
+  queue.Put(7);
+
+  queue.Close();
+
+  EXPECT_EQ(queue.Take(), 7);
+  EXPECT_EQ(queue.Take(), std::nullopt);
+}
+
+TEST(BoundedBlockingQueue, WaitUntilEmptyReturnsAfterDrain) {
+  BoundedBlockingQueue<int> queue(2);
+  SingleThreadExecutor executor;
+  queue.Put(1);
+  queue.Put(2);
+
+  executor.Execute([&]() {
+    queue.Take();
+    queue.Take();
+  });
+  queue.WaitUntilEmpty();
+
+  EXPECT_EQ(queue.Size(), 0);
+}
+
+}  // namespace
+}  // namespace nearby
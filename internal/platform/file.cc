@@ -77,8 +77,15 @@ Exception OutputFile::Write(absl::string_view data) {
   return impl_->Write(data);
 }
 
+Exception OutputFile::Preallocate(std::int64_t size) {
+  return impl_->Preallocate(size);
+}
+
+Exception OutputFile::Sync() { return impl_->Sync(); }
+
 // Disallows further writes to the file and frees system resources,
 // associated with it.
+
 Exception OutputFile::Close() { return impl_->Close(); }
 
 // Returns a handle to the underlying  output stream.
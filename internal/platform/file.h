@@ -89,6 +89,14 @@ class OutputFile final {
   // Returns Exception::kIo on error, Exception::kSuccess otherwise.
   Exception Write(absl::string_view data);
 
+  // Reserves room for a file of `size` bytes. Returns Exception::kIo on error,
+  // Exception::kSuccess otherwise.
+  Exception Preallocate(std::int64_t size);
+
+  // Writes the bytes written so far through to the storage device. Returns
+  // Exception::kIo on error, Exception::kSuccess otherwise.
+  Exception Sync();
+
   // Disallows further writes to the file and frees system resources,
   // associated with it.
   Exception Close();
@@ -32,6 +32,7 @@
 #include "internal/platform/implementation/g3/socket_base.h"
 #include "internal/platform/implementation/psk_info.h"
 #include "internal/platform/input_stream.h"
+#include "internal/platform/medium_environment.h"
 #include "internal/platform/nsd_service_info.h"
 #include "internal/platform/output_stream.h"
 
@@ -42,6 +43,8 @@ class AwdlMedium;
 
 class AwdlSocket : public api::AwdlSocket, public SocketBase {
  public:
+  AwdlSocket() : SocketBase(SimulatedMedium::kAwdl) {}
+
   // Returns the InputStream of this connected AwdlSocket.
   InputStream& GetInputStream() override {
     return SocketBase::GetInputStream();
@@ -40,6 +40,7 @@
 #include "internal/platform/implementation/g3/bluetooth_adapter.h"
 #include "internal/platform/implementation/g3/socket_base.h"
 #include "internal/platform/input_stream.h"
+#include "internal/platform/medium_environment.h"
 #include "internal/platform/output_stream.h"
 #include "internal/platform/uuid.h"
 
@@ -48,7 +49,8 @@ namespace g3 {
 
 class BleSocket : public api::ble::BleSocket, public SocketBase {
  public:
-  explicit BleSocket(BluetoothAdapter* adapter) : adapter_(adapter) {}
+  explicit BleSocket(BluetoothAdapter* adapter)
+      : SocketBase(SimulatedMedium::kBle), adapter_(adapter) {}
 
   // Returns the InputStream of this connected BleSocket.
   InputStream& GetInputStream() override {
@@ -28,6 +28,7 @@
 #include "internal/platform/implementation/g3/socket_base.h"
 #include "internal/platform/input_stream.h"
 #include "internal/platform/mac_address.h"
+#include "internal/platform/medium_environment.h"
 #include "internal/platform/output_stream.h"
 
 namespace nearby {
@@ -36,8 +37,9 @@ namespace g3 {
 // https://developer.android.com/reference/android/bluetooth/BluetoothSocket.html.
 class BluetoothSocket : public api::BluetoothSocket, public SocketBase {
  public:
-  BluetoothSocket() = default;
-  explicit BluetoothSocket(BluetoothAdapter* adapter) : adapter_(adapter) {}
+  BluetoothSocket() : SocketBase(SimulatedMedium::kBluetoothClassic) {}
+  explicit BluetoothSocket(BluetoothAdapter* adapter)
+      : SocketBase(SimulatedMedium::kBluetoothClassic), adapter_(adapter) {}
 
   // Returns the InputStream of this connected BluetoothSocket.
   InputStream& GetInputStream() override {
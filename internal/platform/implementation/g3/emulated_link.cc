@@ -0,0 +1,283 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/implementation/g3/emulated_link.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/function_ref.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/input_stream.h"
+#include "internal/platform/medium_environment.h"
+#include "internal/platform/output_stream.h"
+
+namespace nearby {
+namespace g3 {
+namespace {
+
+// State shared by both ends of an emulated link.
+class EmulatedLink {
+ public:
+  // Creates a link and, when the simulated clock is in use, subscribes it to
+  // clock updates.
+  static std::shared_ptr<EmulatedLink> Create(const LinkModel& model);
+
+  explicit EmulatedLink(const LinkModel& model)
+      : model_(model),
+        use_simulated_clock_(MediumEnvironment::Instance()
+                                 .GetEnvironmentConfig()
+                                 .use_simulated_clock),
+        clock_observer_name_(absl::StrFormat("emulated_link_%p", this)),
+        random_(model.random_seed) {}
+  ~EmulatedLink() {
+    if (use_simulated_clock_) {
+      MediumEnvironment::Instance().RemoveSimulatedClockObserver(
+          clock_observer_name_);
+    }
+  }
+
+  ExceptionOr<ByteArray> Read(std::int64_t size) ABSL_LOCKS_EXCLUDED(mutex_);
+  Exception Write(absl::string_view data) ABSL_LOCKS_EXCLUDED(mutex_);
+  void CloseInput() ABSL_LOCKS_EXCLUDED(mutex_);
+  void CloseOutput() ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  struct Packet {
+    ByteArray data;
+    absl::Time deliver_at;
+  };
+
+  // Blocks until `deadline` has passed. Returns false if `interrupted` becomes
+  // true first.
+  bool WaitUntil(absl::Time deadline, absl::FunctionRef<bool()> interrupted)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  absl::Duration GetTransmissionTime(std::int64_t size) const;
+  absl::Duration GetJitter() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void OnClockAdvanced() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  const LinkModel model_;
+  const bool use_simulated_clock_;
+  const std::string clock_observer_name_;
+
+  absl::Mutex mutex_;
+  absl::CondVar cond_;
+  // Packets in flight, ordered by delivery time.
+  std::deque<Packet> packets_ ABSL_GUARDED_BY(mutex_);
+  std::mt19937 random_ ABSL_GUARDED_BY(mutex_);
+  // When the last packet written has been sent completely.
+  absl::Time link_free_at_ ABSL_GUARDED_BY(mutex_) = absl::InfinitePast();
+  absl::Time last_deliver_at_ ABSL_GUARDED_BY(mutex_) = absl::InfinitePast();
+  std::int64_t bytes_sent_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool stalled_ ABSL_GUARDED_BY(mutex_) = false;
+  bool broken_ ABSL_GUARDED_BY(mutex_) = false;
+  bool input_closed_ ABSL_GUARDED_BY(mutex_) = false;
+  bool output_closed_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+std::shared_ptr<EmulatedLink> EmulatedLink::Create(const LinkModel& model) {
+  auto link = std::make_shared<EmulatedLink>(model);
+  if (link->use_simulated_clock_) {
+    MediumEnvironment::Instance().AddSimulatedClockObserver(
+        link->clock_observer_name_,
+        [weak_link = std::weak_ptr<EmulatedLink>(link)]() {
+          if (std::shared_ptr<EmulatedLink> link = weak_link.lock()) {
+            link->OnClockAdvanced();
+          }
+        });
+  }
+  return link;
+}
+
+ExceptionOr<ByteArray> EmulatedLink::Read(std::int64_t size) {
+  absl::MutexLock lock(mutex_);
+  auto interrupted = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return broken_ || input_closed_;
+  };
+  while (true) {
+    if (broken_) return ExceptionOr<ByteArray>(Exception::kIo);
+    // As with CreatePipe(), the end of the stream is signalled with an empty
+    // chunk.
+    if (input_closed_) return ExceptionOr<ByteArray>(ByteArray());
+    if (!packets_.empty()) {
+      if (WaitUntil(packets_.front().deliver_at, interrupted)) break;
+      continue;
+    }
+    if (output_closed_) return ExceptionOr<ByteArray>(ByteArray());
+    cond_.Wait(&mutex_);
+  }
+
+  Packet& packet = packets_.front();
+  if (static_cast<std::int64_t>(packet.data.size()) <= size) {
+    ByteArray data = std::move(packet.data);
+    packets_.pop_front();
+    return ExceptionOr<ByteArray>(std::move(data));
+  }
+  // Leave the rest of the packet for the next read.
+  ByteArray data(packet.data.data(), size);
+  packet.data =
+      ByteArray(packet.data.data() + size, packet.data.size() - size);
+  return ExceptionOr<ByteArray>(std::move(data));
+}
+
+Exception EmulatedLink::Write(absl::string_view data) {
+  absl::MutexLock lock(mutex_);
+  auto interrupted = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return broken_ || input_closed_ || output_closed_;
+  };
+  while (!data.empty()) {
+    if (interrupted()) return {Exception::kIo};
+    std::int64_t packet_size = static_cast<std::int64_t>(data.size());
+    if (model_.mtu_bytes > 0) {
+      packet_size = std::min(packet_size, model_.mtu_bytes);
+    }
+    if (model_.disconnect_after_bytes > 0 &&
+        bytes_sent_ + packet_size > model_.disconnect_after_bytes) {
+      broken_ = true;
+      packets_.clear();
+      cond_.SignalAll();
+      return {Exception::kIo};
+    }
+
+    absl::Time send_at =
+        std::max(MediumEnvironment::Instance().Now(), link_free_at_);
+    if (model_.stall_after_bytes > 0 && !stalled_ &&
+        bytes_sent_ >= model_.stall_after_bytes) {
+      stalled_ = true;
+      send_at += model_.stall_duration;
+    }
+    link_free_at_ = send_at + GetTransmissionTime(packet_size);
+    // Jitter only ever delays a packet behind the ones sent before it.
+    last_deliver_at_ = std::max(last_deliver_at_,
+                                link_free_at_ + model_.latency + GetJitter());
+    packets_.push_back(
+        {.data = ByteArray(data.data(), packet_size),
+         .deliver_at = last_deliver_at_});
+    bytes_sent_ += packet_size;
+    data.remove_prefix(packet_size);
+    cond_.SignalAll();
+
+    // The link has no send buffer: the writer waits until the packet is out.
+    if (!WaitUntil(link_free_at_, interrupted)) return {Exception::kIo};
+  }
+  return {Exception::kSuccess};
+}
+
+void EmulatedLink::CloseInput() {
+  absl::MutexLock lock(mutex_);
+  input_closed_ = true;
+  packets_.clear();
+  cond_.SignalAll();
+}
+
+void EmulatedLink::CloseOutput() {
+  absl::MutexLock lock(mutex_);
+  // Packets in flight are still delivered.
+  output_closed_ = true;
+  cond_.SignalAll();
+}
+
+bool EmulatedLink::WaitUntil(absl::Time deadline,
+                             absl::FunctionRef<bool()> interrupted) {
+  while (!interrupted()) {
+    absl::Time now = MediumEnvironment::Instance().Now();
+    if (now >= deadline) return true;
+    if (use_simulated_clock_) {
+      // Woken up by OnClockAdvanced().
+      cond_.Wait(&mutex_);
+    } else {
+      cond_.WaitWithTimeout(&mutex_, deadline - now);
+    }
+  }
+  return false;
+}
+
+absl::Duration EmulatedLink::GetTransmissionTime(std::int64_t size) const {
+  if (model_.bandwidth_bytes_per_second <= 0) return absl::ZeroDuration();
+  return absl::Seconds(static_cast<double>(size) /
+                       model_.bandwidth_bytes_per_second);
+}
+
+absl::Duration EmulatedLink::GetJitter() {
+  if (model_.jitter <= absl::ZeroDuration()) return absl::ZeroDuration();
+  std::uniform_int_distribution<std::int64_t> distribution(
+      0, absl::ToInt64Nanoseconds(model_.jitter) - 1);
+  return absl::Nanoseconds(distribution(random_));
+}
+
+void EmulatedLink::OnClockAdvanced() {
+  absl::MutexLock lock(mutex_);
+  cond_.SignalAll();
+}
+
+class EmulatedLinkInputStream : public InputStream {
+ public:
+  explicit EmulatedLinkInputStream(std::shared_ptr<EmulatedLink> link)
+      : link_(std::move(link)) {}
+  ~EmulatedLinkInputStream() override { link_->CloseInput(); }
+
+  ExceptionOr<ByteArray> Read(std::int64_t size) override {
+    return link_->Read(size);
+  }
+  Exception Close() override {
+    link_->CloseInput();
+    return {Exception::kSuccess};
+  }
+
+ private:
+  std::shared_ptr<EmulatedLink> link_;
+};
+
+class EmulatedLinkOutputStream : public OutputStream {
+ public:
+  explicit EmulatedLinkOutputStream(std::shared_ptr<EmulatedLink> link)
+      : link_(std::move(link)) {}
+  ~EmulatedLinkOutputStream() override { link_->CloseOutput(); }
+
+  Exception Write(absl::string_view data) override {
+    return link_->Write(data);
+  }
+  Exception Flush() override { return {Exception::kSuccess}; }
+  Exception Close() override {
+    link_->CloseOutput();
+    return {Exception::kSuccess};
+  }
+
+ private:
+  std::shared_ptr<EmulatedLink> link_;
+};
+
+}  // namespace
+
+std::pair<std::unique_ptr<InputStream>, std::unique_ptr<OutputStream>>
+CreateEmulatedLinkPipe(const LinkModel& model) {
+  std::shared_ptr<EmulatedLink> link = EmulatedLink::Create(model);
+  return std::make_pair(std::make_unique<EmulatedLinkInputStream>(link),
+                        std::make_unique<EmulatedLinkOutputStream>(link));
+}
+
+}  // namespace g3
+}  // namespace nearby
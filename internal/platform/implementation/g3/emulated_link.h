@@ -0,0 +1,40 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_NEARBY_INTERNAL_PLATFORM_IMPLEMENTATION_G3_EMULATED_LINK_H_
+#define THIRD_PARTY_NEARBY_INTERNAL_PLATFORM_IMPLEMENTATION_G3_EMULATED_LINK_H_
+
+#include <memory>
+#include <utility>
+
+#include "internal/platform/input_stream.h"
+#include "internal/platform/medium_environment.h"
+#include "internal/platform/output_stream.h"
+
+namespace nearby {
+namespace g3 {
+
+// Creates a pipe that behaves like the link described by `model`: written data
+// is cut into packets, the writer is held back by the bandwidth, and every
+// packet becomes readable after the latency and jitter have passed.
+// Time is taken from MediumEnvironment, so the simulated clock is honored.
+//
+// Like CreatePipe(), the pipe stays valid as long as either stream exists.
+std::pair<std::unique_ptr<InputStream>, std::unique_ptr<OutputStream>>
+CreateEmulatedLinkPipe(const LinkModel& model);
+
+}  // namespace g3
+}  // namespace nearby
+
+#endif  // THIRD_PARTY_NEARBY_INTERNAL_PLATFORM_IMPLEMENTATION_G3_EMULATED_LINK_H_
@@ -0,0 +1,154 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/implementation/g3/emulated_link.h"
+
+#include <cstdint>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/implementation/g3/wifi_lan.h"
+#include "internal/platform/input_stream.h"
+#include "internal/platform/medium_environment.h"
+#include "internal/platform/output_stream.h"
+#include "thread/fiber/fiber.h"
+
+namespace nearby {
+namespace g3 {
+namespace {
+
+constexpr absl::Duration kTimeout = absl::Seconds(5);
+
+std::string ReadString(InputStream& input, std::int64_t size) {
+  ExceptionOr<ByteArray> read = input.Read(size);
+  EXPECT_TRUE(read.ok());
+  return read.ok() ? read.result().string_data() : "";
+}
+
+TEST(EmulatedLinkTest, SplitsWritesIntoPackets) {
+  MediumEnvironment::Instance().Start();
+  auto [input, output] = CreateEmulatedLinkPipe({.mtu_bytes = 4});
+
+  ASSERT_TRUE(output->Write("abcdefghij").Ok());
+
+  EXPECT_EQ(ReadString(*input, 100), "abcd");
+  EXPECT_EQ(ReadString(*input, 2), "ef");
+  EXPECT_EQ(ReadString(*input, 100), "gh");
+  EXPECT_EQ(ReadString(*input, 100), "ij");
+  MediumEnvironment::Instance().Stop();
+}
+
+TEST(EmulatedLinkTest, DeliversAfterLatencyOnSimulatedClock) {
+  MediumEnvironment::Instance().Start({.use_simulated_clock = true});
+  auto [input, output] =
+      CreateEmulatedLinkPipe({.latency = absl::Milliseconds(100)});
+  ASSERT_TRUE(output->Write("abc").Ok());
+
+  InputStream* input_stream = input.get();
+  std::string read;
+  absl::Notification read_done;
+  thread::Fiber reader([&]() {
+    read = ReadString(*input_stream, 100);
+    read_done.Notify();
+  });
+  MediumEnvironment::Instance().FastForward(absl::Milliseconds(99));
+  EXPECT_FALSE(
+      read_done.WaitForNotificationWithTimeout(absl::Milliseconds(50)));
+  MediumEnvironment::Instance().FastForward(absl::Milliseconds(1));
+  EXPECT_TRUE(read_done.WaitForNotificationWithTimeout(kTimeout));
+  reader.Join();
+
+  EXPECT_EQ(read, "abc");
+  MediumEnvironment::Instance().Stop();
+}
+
+TEST(EmulatedLinkTest, HoldsWriterBackByBandwidth) {
+  MediumEnvironment::Instance().Start();
+  auto [input, output] =
+      CreateEmulatedLinkPipe({.bandwidth_bytes_per_second = 100'000});
+
+  absl::Time start = absl::Now();
+  ASSERT_TRUE(output->Write(std::string(10'000, 'x')).Ok());
+
+  EXPECT_GE(absl::Now() - start, absl::Milliseconds(100));
+  EXPECT_EQ(ReadString(*input, 20'000).size(), 10'000);
+  MediumEnvironment::Instance().Stop();
+}
+
+TEST(EmulatedLinkTest, StallsAfterConfiguredBytes) {
+  MediumEnvironment::Instance().Start();
+  auto [input, output] = CreateEmulatedLinkPipe(
+      {.stall_after_bytes = 3, .stall_duration = absl::Milliseconds(100)});
+  ASSERT_TRUE(output->Write("abc").Ok());
+
+  absl::Time start = absl::Now();
+  ASSERT_TRUE(output->Write("def").Ok());
+
+  EXPECT_GE(absl::Now() - start, absl::Milliseconds(100));
+  EXPECT_EQ(ReadString(*input, 100), "abc");
+  EXPECT_EQ(ReadString(*input, 100), "def");
+  MediumEnvironment::Instance().Stop();
+}
+
+TEST(EmulatedLinkTest, DisconnectsAfterConfiguredBytes) {
+  MediumEnvironment::Instance().Start();
+  auto [input, output] = CreateEmulatedLinkPipe({.disconnect_after_bytes = 5});
+  ASSERT_TRUE(output->Write("abc").Ok());
+
+  EXPECT_TRUE(output->Write("def").Raised(Exception::kIo));
+
+  EXPECT_FALSE(input->Read(100).ok());
+  EXPECT_TRUE(output->Write("g").Raised(Exception::kIo));
+  MediumEnvironment::Instance().Stop();
+}
+
+TEST(EmulatedLinkTest, EndsStreamAfterDeliveringPacketsInFlight) {
+  MediumEnvironment::Instance().Start();
+  auto [input, output] =
+      CreateEmulatedLinkPipe({.latency = absl::Milliseconds(10)});
+  ASSERT_TRUE(output->Write("abc").Ok());
+  output->Close();
+
+  EXPECT_EQ(ReadString(*input, 100), "abc");
+  EXPECT_EQ(ReadString(*input, 100), "");
+  MediumEnvironment::Instance().Stop();
+}
+
+TEST(EmulatedLinkTest, SocketsUseLinkModelOfTheirMedium) {
+  EnvironmentConfig config;
+  config.link_models[SimulatedMedium::kWifiLan] = {.mtu_bytes = 2};
+  MediumEnvironment::Instance().Start(config);
+  WifiLanSocket socket_a;
+  WifiLanSocket socket_b;
+  socket_a.Connect(socket_b);
+  socket_b.Connect(socket_a);
+
+  ASSERT_TRUE(socket_a.GetOutputStream().Write("abcd").Ok());
+  ASSERT_TRUE(socket_b.GetOutputStream().Write("efgh").Ok());
+
+  EXPECT_EQ(ReadString(socket_b.GetInputStream(), 100), "ab");
+  EXPECT_EQ(ReadString(socket_a.GetInputStream(), 100), "ef");
+  socket_a.Close();
+  socket_b.Close();
+  MediumEnvironment::Instance().Stop();
+}
+
+}  // namespace
+}  // namespace g3
+}  // namespace nearby
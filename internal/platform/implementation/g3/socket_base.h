@@ -18,6 +18,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <tuple>
 #include <utility>
 
@@ -25,7 +26,9 @@
 #include "absl/synchronization/mutex.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/exception.h"
+#include "internal/platform/implementation/g3/emulated_link.h"
 #include "internal/platform/input_stream.h"
+#include "internal/platform/medium_environment.h"
 #include "internal/platform/output_stream.h"
 #include "internal/platform/pipe.h"
 
@@ -35,7 +38,15 @@ namespace g3 {
 // Common base for BT, BLE and Wifi socket implementations.
 class SocketBase {
  public:
-  SocketBase() { std::tie(input_for_remote_, output_) = CreatePipe(); }
+  // Data written to a socket of `medium` travels over the link model that
+  // MediumEnvironment has for it, or over a plain pipe if there is none.
+  explicit SocketBase(SimulatedMedium medium) {
+    std::optional<LinkModel> link_model =
+        MediumEnvironment::Instance().GetLinkModel(medium);
+    std::tie(input_for_remote_, output_) =
+        link_model.has_value() ? CreateEmulatedLinkPipe(*link_model)
+                               : CreatePipe();
+  }
   virtual ~SocketBase() {
     absl::MutexLock lock(mutex_);
     DoClose();
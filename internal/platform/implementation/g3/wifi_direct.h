@@ -33,6 +33,7 @@
 #include "internal/platform/implementation/g3/socket_base.h"
 #include "internal/platform/implementation/wifi_direct.h"
 #include "internal/platform/input_stream.h"
+#include "internal/platform/medium_environment.h"
 #include "internal/platform/output_stream.h"
 #include "internal/platform/wifi_credential.h"
 
@@ -43,6 +44,8 @@ class WifiDirectMedium;
 
 class WifiDirectSocket : public api::WifiDirectSocket, public SocketBase {
  public:
+  WifiDirectSocket() : SocketBase(SimulatedMedium::kWifiDirect) {}
+
   // Returns the InputStream of the WifiDirectSocket.
   // On error, returned stream will report Exception::kIo on any operation.
   //
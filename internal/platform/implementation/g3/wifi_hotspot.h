@@ -25,6 +25,7 @@
 #include "internal/platform/implementation/g3/socket_base.h"
 #include "internal/platform/implementation/wifi_hotspot.h"
 #include "internal/platform/input_stream.h"
+#include "internal/platform/medium_environment.h"
 #include "internal/platform/output_stream.h"
 #include "internal/platform/wifi_credential.h"
 
@@ -35,6 +36,8 @@ class WifiHotspotMedium;
 
 class WifiHotspotSocket : public api::WifiHotspotSocket, public SocketBase {
  public:
+  WifiHotspotSocket() : SocketBase(SimulatedMedium::kWifiHotspot) {}
+
   // Returns the InputStream of the WifiHotspotSocket.
   // On error, returned stream will report Exception::kIo on any operation.
   //
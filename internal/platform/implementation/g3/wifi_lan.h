@@ -38,6 +38,8 @@ class WifiLanMedium;
 
 class WifiLanSocket : public api::WifiLanSocket, public SocketBase {
  public:
+  WifiLanSocket() : SocketBase(SimulatedMedium::kWifiLan) {}
+
   // Returns the InputStream of this connected WifiLanSocket.
   InputStream& GetInputStream() override {
     return SocketBase::GetInputStream();
@@ -12,21 +12,50 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <sdbus-c++/IObject.h>
 #include <sdbus-c++/ProxyInterfaces.h>
 
 #include "absl/strings/string_view.h"
 #include "internal/platform/bluetooth_utils.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/implementation/ble.h"
 #include "internal/platform/implementation/linux/bluetooth_classic_device.h"
 #include "internal/platform/implementation/linux/bluez.h"
 #include "internal/platform/implementation/linux/bluez_device.h"
 #include "internal/platform/implementation/linux/dbus.h"
+#include "internal/platform/implementation/linux/utils.h"
 #include "internal/platform/logging.h"
 
 namespace nearby {
 namespace linux {
+static constexpr const char *kDevicePropServiceData = "ServiceData";
+
+std::shared_ptr<const api::ble::BleAdvertisementData>
+ServiceDataToAdvertisementData(
+    const std::map<std::string, sdbus::Variant> &service_data) {
+  auto adv_data = std::make_shared<api::ble::BleAdvertisementData>();
+  adv_data->service_data.reserve(service_data.size());
+  for (const auto &[uuid_str, data] : service_data) {
+    auto uuid = UuidFromString(uuid_str);
+    if (!uuid.has_value()) {
+      LOG(ERROR) << __func__ << ": Could not parse UUID string " << uuid_str
+                 << " in ServiceData";
+      continue;
+    }
+    const std::vector<uint8_t> &bytes = data.get<std::vector<uint8_t>>();
+    adv_data->service_data.emplace(
+        *uuid, ByteArray(reinterpret_cast<const char *>(bytes.data()),
+                         bytes.size()));
+  }
+  return adv_data;
+}
+
 BluetoothDevice::BluetoothDevice(std::shared_ptr<bluez::Device> device)
     : lost_(false), device_(device) {
   LOG(INFO) << "Created BluetoothDevice for: " << device -> Address();
@@ -87,6 +116,40 @@ MacAddress BluetoothDevice::GetMacAddress() const {
   }
 }
 
+std::shared_ptr<const api::ble::BleAdvertisementData>
+BluetoothDevice::GetAdvertisementData() {
+  {
+    absl::ReaderMutexLock l(&properties_mutex_);
+    if (service_data_cached_) return last_known_advertisement_data_;
+  }
+  // No PropertiesChanged signal carried ServiceData yet, so read it once.
+  std::optional<std::map<std::string, sdbus::Variant>> service_data =
+      ServiceData();
+  if (!service_data.has_value()) return nullptr;
+  UpdateServiceData(*service_data);
+  absl::ReaderMutexLock l(&properties_mutex_);
+  return last_known_advertisement_data_;
+}
+
+void BluetoothDevice::UpdateAddress(absl::string_view address) {
+  absl::MutexLock l(&properties_mutex_);
+  MacAddress::FromString(address, last_known_address_);
+}
+
+void BluetoothDevice::UpdateServiceData(
+    const std::map<std::string, sdbus::Variant> &service_data) {
+  auto adv_data = ServiceDataToAdvertisementData(service_data);
+  absl::MutexLock l(&properties_mutex_);
+  last_known_advertisement_data_ = std::move(adv_data);
+  service_data_cached_ = true;
+}
+
+void BluetoothDevice::InvalidateServiceData() {
+  absl::MutexLock l(&properties_mutex_);
+  last_known_advertisement_data_ = nullptr;
+  service_data_cached_ = false;
+}
+
 std::string BluetoothDevice::GetAddressType() const {
   auto device = device_;
   if (device == nullptr) return "public";
@@ -174,10 +237,14 @@ void MonitoredBluetoothDevice::onPropertiesChanged(
       LOG(INFO) << __func__ << ": " << getProxy().getObjectPath()
                            << ": Notifying observers about address change";
       std::string address = it->second.get<std::string>();
+      UpdateAddress(address);
       for (const auto &observer : observers_.GetObservers()) {
         observer->DeviceAddressChanged(*this, address);
       }
 
+    } else if (it->first == kDevicePropServiceData) {
+      UpdateServiceData(
+          it->second.get<std::map<std::string, sdbus::Variant>>());
     } else if (it->first == bluez::DEVICE_PROP_PAIRED) {
       LOG(INFO) << __func__ << ": " << getProxy().getObjectPath()
                            << "Notifying observers about paired status change.";
@@ -199,6 +266,10 @@ void MonitoredBluetoothDevice::onPropertiesChanged(
         callback->device_name_changed_cb(*this);
     }
   }
+
+  for (const auto &property : invalidatedProperties) {
+    if (property == kDevicePropServiceData) InvalidateServiceData();
+  }
 }
 
 }  // namespace linux
@@ -16,8 +16,10 @@
 #define PLATFORM_IMPL_LINUX_BLUETOOTH_CLASSIC_DEVICE_H_
 
 #include <atomic>
+#include <map>
 #include <memory>
 #include <optional>
+#include <string>
 
 #include <sdbus-c++/Error.h>
 #include <sdbus-c++/IConnection.h>
@@ -37,7 +39,17 @@
 #include "internal/platform/implementation/linux/generated/dbus/bluez/device_client.h"
 
 namespace nearby {
+namespace api::ble {
+struct BleAdvertisementData;
+}  // namespace api::ble
+
 namespace linux {
+// Converts the ServiceData property of a BlueZ device into advertisement data.
+// Entries whose key is not a valid UUID are skipped.
+std::shared_ptr<const api::ble::BleAdvertisementData>
+ServiceDataToAdvertisementData(
+    const std::map<std::string, sdbus::Variant> &service_data);
+
 // https://developer.android.com/reference/android/bluetooth/BluetoothDevice.html.
 
 class BluetoothDevice : public api::BluetoothDevice {
@@ -57,7 +69,16 @@ class BluetoothDevice : public api::BluetoothDevice {
   std::optional<int16_t> GetRssi() const;
   std::optional<int16_t> GetTxPower() const;
 
-  MacAddress GetAddress() const { return last_known_address_; }
+  MacAddress GetAddress() const {
+    absl::ReaderMutexLock l(&properties_mutex_);
+    return last_known_address_;
+  }
+
+  // Returns the advertisement data of the last ServiceData seen for this
+  // device, or nullptr if it has none. Only the first call reads the property
+  // over D-Bus; later changes arrive through UpdateServiceData().
+  std::shared_ptr<const api::ble::BleAdvertisementData> GetAdvertisementData()
+      ABSL_LOCKS_EXCLUDED(properties_mutex_);
 
   std::optional<std::map<std::string, sdbus::Variant>> ServiceData() {
     auto device = device_;
@@ -121,6 +142,15 @@ class BluetoothDevice : public api::BluetoothDevice {
   bool Lost() const { return lost_; }
   sdbus::ObjectPath GetObjectPath() {return device_->getProxy().getObjectPath();}
 
+ protected:
+  // Update the cached properties from a PropertiesChanged signal.
+  void UpdateAddress(absl::string_view address)
+      ABSL_LOCKS_EXCLUDED(properties_mutex_);
+  void UpdateServiceData(
+      const std::map<std::string, sdbus::Variant> &service_data)
+      ABSL_LOCKS_EXCLUDED(properties_mutex_);
+  void InvalidateServiceData() ABSL_LOCKS_EXCLUDED(properties_mutex_);
+
  private:
   UniqueId unique_id_;
   std::atomic_bool lost_;
@@ -128,6 +158,9 @@ class BluetoothDevice : public api::BluetoothDevice {
   mutable absl::Mutex properties_mutex_;
   mutable std::string last_known_name_ ABSL_GUARDED_BY(properties_mutex_);
   mutable MacAddress last_known_address_ ABSL_GUARDED_BY(properties_mutex_);
+  bool service_data_cached_ ABSL_GUARDED_BY(properties_mutex_) = false;
+  std::shared_ptr<const api::ble::BleAdvertisementData>
+      last_known_advertisement_data_ ABSL_GUARDED_BY(properties_mutex_);
 
   std::shared_ptr<bluez::Device> device_;
 };
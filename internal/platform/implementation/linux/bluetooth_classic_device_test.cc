@@ -0,0 +1,77 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/implementation/linux/bluetooth_classic_device.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sdbus-c++/Types.h>
+
+#include "gtest/gtest.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/implementation/ble.h"
+#include "internal/platform/implementation/linux/utils.h"
+#include "internal/platform/mac_address.h"
+
+namespace nearby {
+namespace linux {
+namespace {
+
+constexpr char kServiceUuid[] = "0000fef3-0000-1000-8000-00805f9b34fb";
+
+TEST(BluetoothClassicDeviceTest, ServiceDataToAdvertisementData) {
+  std::map<std::string, sdbus::Variant> service_data = {
+      {kServiceUuid, sdbus::Variant(std::vector<uint8_t>{1, 2, 3})},
+      {"not-a-uuid", sdbus::Variant(std::vector<uint8_t>{4})}};
+
+  auto adv_data = ServiceDataToAdvertisementData(service_data);
+
+  ASSERT_NE(adv_data, nullptr);
+  ASSERT_EQ(adv_data->service_data.size(), 1);
+  EXPECT_EQ(adv_data->service_data.at(*UuidFromString(kServiceUuid)),
+            ByteArray(std::string("\x01\x02\x03")));
+}
+
+TEST(BluetoothClassicDeviceTest, ServiceDataFeed) {
+  // A second worth of ServiceData changes from a busy environment, at 1k
+  // PropertiesChanged signals per second.
+  for (int i = 0; i < 1000; ++i) {
+    std::vector<uint8_t> bytes(24, static_cast<uint8_t>(i));
+    std::map<std::string, sdbus::Variant> service_data = {
+        {kServiceUuid, sdbus::Variant(bytes)}};
+
+    auto adv_data = ServiceDataToAdvertisementData(service_data);
+
+    ASSERT_NE(adv_data, nullptr);
+    ASSERT_EQ(adv_data->service_data.size(), 1);
+    EXPECT_EQ(adv_data->service_data.at(*UuidFromString(kServiceUuid)),
+              ByteArray(std::string(bytes.begin(), bytes.end())));
+  }
+}
+
+TEST(BluetoothClassicDeviceTest, PeripheralIdIsMacAddress) {
+  // Peripheral ids were derived by stripping the colons from the MAC and
+  // parsing it as hex.
+  MacAddress address;
+  ASSERT_TRUE(MacAddress::FromString("A4:C1:38:0B:5E:F2", address));
+  EXPECT_EQ(address.address(), 0xA4C1380B5EF2ULL);
+}
+
+}  // namespace
+}  // namespace linux
+}  // namespace nearby
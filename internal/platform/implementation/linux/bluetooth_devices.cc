@@ -13,7 +13,6 @@
 // limitations under the License.
 
 #include <algorithm>
-#include <chrono>
 #include <functional>
 #include <optional>
 #include <string>
@@ -33,7 +32,6 @@
 
 namespace nearby {
 namespace linux {
-static constexpr std::chrono::minutes kLostPeripheralsCleanupMinFreq(5);
 absl::Mutex g_shared_devices_lock;
 absl::flat_hash_map<std::string, std::weak_ptr<SharedBluetoothDevices>>
     g_shared_devices ABSL_GUARDED_BY(g_shared_devices_lock);
@@ -115,13 +113,7 @@ void BluetoothDevices::mark_peripheral_lost(
 }
 
 void BluetoothDevices::cleanup_lost_peripherals() {
-  auto now = std::chrono::steady_clock::now();
   absl::MutexLock lock(&devices_by_path_lock_);
-  if ((now - last_cleanup_) < kLostPeripheralsCleanupMinFreq) {
-    return;
-  }
-  last_cleanup_ = now;
-
   for (auto it = devices_by_path_.begin(), end = devices_by_path_.end();
        it != end;) {
     auto copy = it++;
@@ -15,7 +15,6 @@
 #ifndef PLATFORM_IMPL_LINUX_BLUETOOTH_DEVICES_H_
 #define PLATFORM_IMPL_LINUX_BLUETOOTH_DEVICES_H_
 
-#include <chrono>
 #include <memory>
 #include <string>
 
@@ -60,6 +59,8 @@ class BluetoothDevices final {
       ABSL_LOCKS_EXCLUDED(devices_by_path_lock_);
   void mark_peripheral_lost(const sdbus::ObjectPath &)
       ABSL_LOCKS_EXCLUDED(devices_by_path_lock_);
+  // Removes the peripherals marked lost. Called periodically by the
+  // advertisement monitors.
   void cleanup_lost_peripherals() ABSL_LOCKS_EXCLUDED(devices_by_path_lock_);
 
     // DEBUG
@@ -80,8 +81,6 @@ class BluetoothDevices final {
   absl::Mutex devices_by_path_lock_;
   absl::flat_hash_map<std::string, std::shared_ptr<MonitoredBluetoothDevice>>
       devices_by_path_ ABSL_GUARDED_BY(devices_by_path_lock_);
-  std::chrono::time_point<std::chrono::steady_clock> last_cleanup_
-      ABSL_GUARDED_BY(devices_by_path_lock_);
 };
 
 struct SharedBluetoothDevices {
@@ -1,15 +1,17 @@
 #include "internal/platform/implementation/linux/bluez_advertisement_monitor.h"
 
-#include <regex>
+#include <chrono>
+#include <memory>
 
-#include "internal/platform/byte_array.h"
 #include "internal/platform/implementation/ble.h"
 #include "internal/platform/implementation/linux/dbus.h"
-#include "internal/platform/implementation/linux/utils.h"
 #include "internal/platform/uuid.h"
 namespace nearby {
 namespace linux {
 namespace bluez {
+static constexpr std::chrono::milliseconds kLostPeripheralsCleanupInterval =
+    std::chrono::minutes(5);
+
 AdvertisementMonitor::AdvertisementMonitor(
     sdbus::IConnection &system_bus, Uuid service_uuid,
     api::ble::TxPowerLevel tx_power_level, absl::string_view type,
@@ -37,32 +39,24 @@ AdvertisementMonitor::AdvertisementMonitor(
       service_uuid_(service_uuid),
       tx_power_level_(tx_power_level) {
   registerAdaptor();
+  // Lost peripherals are swept here rather than on every DeviceFound(), which
+  // would lock the device map for each advertisement.
+  cleanup_timer_.Create(kLostPeripheralsCleanupInterval.count(),
+                        kLostPeripheralsCleanupInterval.count(),
+                        [devices = devices_]() {
+                          devices->cleanup_lost_peripherals();
+                        });
 }
 
 void AdvertisementMonitor::DeviceFound(const sdbus::ObjectPath &device) {
-  devices_->cleanup_lost_peripherals();
   auto peripheral = devices_->add_new_device(device);
-  auto service_data = peripheral->ServiceData();
-  if (!service_data.has_value()) return;
-
-  struct api::ble::BleAdvertisementData adv_data;
-  for (const auto &[uuid_str, data] : *service_data) {
-    auto uuid = UuidFromString(uuid_str);
-    if (!uuid.has_value()) {
-      LOG(ERROR)
-          << __func__
-          << ": Could not parse UUID string in ServiceData for peripheral "
-          << peripheral->getProxy().getObjectPath();
-      continue;
-    }
+  // Both the address and the service data are cached from PropertiesChanged
+  // signals, so this does not wait on D-Bus once the device is known.
+  auto adv_data = peripheral->GetAdvertisementData();
+  if (adv_data == nullptr) return;
 
-    std::vector<uint8_t> bytes = data.get<std::vector<uint8_t>>();
-    adv_data.service_data.emplace(*uuid,
-                                  std::string(bytes.begin(), bytes.end()));
-  }
-  auto id = std::stoull(std::regex_replace(peripheral->GetMacAddress().ToString(),
-      std::regex("[:\\-]"), ""), nullptr, 16);
-  scan_callback_.advertisement_found_cb(id, adv_data);
+  scan_callback_.advertisement_found_cb(peripheral->GetAddress().address(),
+                                        *adv_data);
 }
 
 void AdvertisementMonitor::DeviceLost(const sdbus::ObjectPath &device) {
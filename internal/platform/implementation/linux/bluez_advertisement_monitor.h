@@ -23,6 +23,7 @@
 #include "internal/platform/implementation/linux/bluetooth_devices.h"
 #include "internal/platform/implementation/linux/bluez.h"
 #include "internal/platform/implementation/linux/generated/dbus/bluez/advertisement_monitor_server.h"
+#include "internal/platform/implementation/linux/timer.h"
 #include "internal/platform/uuid.h"
 
 namespace nearby {
@@ -47,7 +48,10 @@ class AdvertisementMonitor final
                        absl::string_view type,
                        std::shared_ptr<BluetoothDevices> devices,
                        api::ble::BleMedium::ScanningCallback scan_callback);
-  ~AdvertisementMonitor() { unregisterAdaptor(); }
+  ~AdvertisementMonitor() {
+    cleanup_timer_.Stop();
+    unregisterAdaptor();
+  }
 
  private:
   // Methods
@@ -90,6 +94,8 @@ class AdvertisementMonitor final
   std::string type_;
   Uuid service_uuid_;
   api::ble::TxPowerLevel tx_power_level_;
+  // Periodically drops the peripherals marked lost by DeviceLost().
+  Timer cleanup_timer_;
 };
 }  // namespace bluez
 }  // namespace linux
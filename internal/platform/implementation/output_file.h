@@ -15,6 +15,8 @@
 #ifndef PLATFORM_API_OUTPUT_FILE_H_
 #define PLATFORM_API_OUTPUT_FILE_H_
 
+#include <cstdint>
+
 #include "absl/time/time.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/output_stream.h"
@@ -27,6 +29,16 @@ class OutputFile : public OutputStream {
  public:
   ~OutputFile() override = default;
   virtual void SetLastModifiedTime(absl::Time last_modified_time) = 0;
+  // Reserves room for a file of `size` bytes before it is written, so that it
+  // doesn't grow piece by piece. The file only keeps the bytes written to it
+  // when it is closed. Platforms that can't preallocate ignore it.
+  virtual Exception Preallocate(std::int64_t size) {
+    return {Exception::kSuccess};
+  }
+  // Makes sure the bytes written so far are on the storage device, not just
+  // handed to the OS, so that they survive a crash. Platforms that can't sync
+  // ignore it.
+  virtual Exception Sync() { return {Exception::kSuccess}; }
   // File flush is a no-op.
   Exception Flush() override { return {Exception::kSuccess}; }
 };
@@ -14,10 +14,16 @@
 
 #include "internal/platform/implementation/shared/file.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT
 #include <ios>
 #include <memory>
 #include <string>
+#include <system_error>  // NOLINT
 
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
@@ -81,10 +87,51 @@ ExceptionOr<ByteArray> IOFile::Read(std::int64_t size) {
 Exception IOFile::Close() {
   if (file_.is_open()) {
     file_.close();
+    if (preallocated_size_ > written_size_) {
+      std::error_code error_code;
+      std::filesystem::resize_file(path_, written_size_, error_code);
+    }
+    preallocated_size_ = 0;
   }
   return {Exception::kSuccess};
 }
 
+Exception IOFile::Preallocate(std::int64_t size) {
+  if (!file_.is_open() || !file_.good()) {
+    return {Exception::kIo};
+  }
+  if (size <= written_size_ || size <= preallocated_size_) {
+    return {Exception::kSuccess};
+  }
+  file_.flush();
+  std::error_code error_code;
+  std::filesystem::resize_file(path_, size, error_code);
+  if (error_code) {
+    return {Exception::kIo};
+  }
+  preallocated_size_ = size;
+  return {Exception::kSuccess};
+}
+
+Exception IOFile::Sync() {
+  if (!file_.is_open()) {
+    return {Exception::kIo};
+  }
+  file_.flush();
+  if (!file_.good()) {
+    return {Exception::kIo};
+  }
+  // std::fstream has no descriptor to sync; syncing another one of the same
+  // file writes its data through all the same.
+  int fd = ::open(path_.c_str(), O_WRONLY);
+  if (fd < 0) {
+    return {Exception::kIo};
+  }
+  int result = ::fsync(fd);
+  ::close(fd);
+  return {result == 0 ? Exception::kSuccess : Exception::kIo};
+}
+
 Exception IOFile::Write(absl::string_view data) {
   if (!file_.is_open()) {
     return {Exception::kIo};
@@ -96,7 +143,11 @@ Exception IOFile::Write(absl::string_view data) {
 
   file_.write(data.data(), data.size());
   file_.flush();
-  return {file_.good() ? Exception::kSuccess : Exception::kIo};
+  if (!file_.good()) {
+    return {Exception::kIo};
+  }
+  written_size_ += data.size();
+  return {Exception::kSuccess};
 }
 
 absl::Time IOFile::GetLastModifiedTime() const {
@@ -44,6 +44,8 @@ class IOFile final : public api::InputFile, public api::OutputFile {
   Exception Close() override;
 
   Exception Write(absl::string_view data) override;
+  Exception Preallocate(std::int64_t size) override;
+  Exception Sync() override;
 
   absl::Time GetLastModifiedTime() const override;
   void SetLastModifiedTime(absl::Time last_modified_time) override;
@@ -56,6 +58,10 @@ class IOFile final : public api::InputFile, public api::OutputFile {
   const std::string path_;
   std::fstream file_;
   std::int64_t total_size_ = 0;
+  // Bytes written, and the size reserved by Preallocate(). The file is cut
+  // back to the bytes written when it is closed.
+  std::int64_t written_size_ = 0;
+  std::int64_t preallocated_size_ = 0;
 };
 
 }  // namespace shared
@@ -141,5 +141,33 @@ TEST_F(FileTest, IOFile_CloseOutput) {
   EXPECT_EQ(io_file->Write(bytes), Exception{Exception::kIo});
 }
 
+TEST_F(FileTest, IOFile_PreallocateKeepsWrittenBytesOnClose) {
+  auto io_file = shared::IOFile::CreateOutputFile(path_);
+  EXPECT_EQ(io_file->Preallocate(100), Exception{Exception::kSuccess});
+  EXPECT_EQ(io_file->Write("abc"), Exception{Exception::kSuccess});
+  io_file->Close();
+
+  auto io_file_input = shared::IOFile::CreateInputFile(path_);
+  EXPECT_EQ(io_file_input->GetTotalSize(), 3);
+  AssertEquals(io_file_input->Read(kMaxSize), "abc");
+}
+
+TEST_F(FileTest, IOFile_Sync) {
+  auto io_file = shared::IOFile::CreateOutputFile(path_);
+  EXPECT_EQ(io_file->Write("abc"), Exception{Exception::kSuccess});
+  EXPECT_EQ(io_file->Sync(), Exception{Exception::kSuccess});
+  io_file->Close();
+  EXPECT_EQ(io_file->Sync(), Exception{Exception::kIo});
+
+  auto io_file_input = shared::IOFile::CreateInputFile(path_);
+  AssertEquals(io_file_input->Read(kMaxSize), "abc");
+}
+
+TEST_F(FileTest, IOFile_PreallocateClosedFile) {
+  auto io_file = shared::IOFile::CreateOutputFile(path_);
+  io_file->Close();
+  EXPECT_EQ(io_file->Preallocate(100), Exception{Exception::kIo});
+}
+
 }  // namespace shared
 }  // namespace nearby
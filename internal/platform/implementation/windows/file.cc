@@ -186,6 +186,18 @@ Exception IOFile::Write(absl::string_view data) {
   return {Exception::kSuccess};
 }
 
+Exception IOFile::Sync() {
+  if (file_ == INVALID_HANDLE_VALUE) {
+    return {Exception::kIo};
+  }
+  if (::FlushFileBuffers(file_) == 0) {
+    LOG(ERROR) << "Failed to sync file: " << path_
+               << " with error: " << ::GetLastError();
+    return {Exception::kIo};
+  }
+  return {Exception::kSuccess};
+}
+
 absl::Time IOFile::GetLastModifiedTime() const {
   if (file_ == INVALID_HANDLE_VALUE) {
     LOG(ERROR) << "Failed to get file modified time for: " << path_;
@@ -49,6 +49,7 @@ class IOFile final : public api::InputFile, public api::OutputFile {
   Exception Close() override;
 
   Exception Write(absl::string_view data) override;
+  Exception Sync() override;
   absl::Time GetLastModifiedTime() const override;
   void SetLastModifiedTime(absl::Time last_modified_time) override;
 
@@ -142,6 +142,14 @@ EnvironmentConfig MediumEnvironment::GetEnvironmentConfig() {
   return config_;
 }
 
+std::optional<LinkModel> MediumEnvironment::GetLinkModel(
+    SimulatedMedium medium) {
+  MutexLock lock(&mutex_);
+  auto it = config_.link_models.find(medium);
+  if (it == config_.link_models.end()) return std::nullopt;
+  return it->second;
+}
+
 void MediumEnvironment::OnBluetoothAdapterChangedState(
     api::BluetoothAdapter& adapter, api::BluetoothDevice& adapter_device,
     std::string name, bool enabled, api::BluetoothAdapter::ScanMode mode) {
@@ -50,6 +50,43 @@
 
 namespace nearby {
 
+// Simulated mediums whose sockets carry data between devices.
+enum class SimulatedMedium {
+  kBluetoothClassic,
+  kBle,
+  kWifiLan,
+  kAwdl,
+  kWifiHotspot,
+  kWifiDirect,
+};
+
+// Model of a data link between two simulated sockets, applied to both
+// directions of a connection. The default model delivers data immediately and
+// without limits, like a plain pipe.
+struct LinkModel {
+  // Rate at which data leaves the sender; 0 means unlimited. Writers block
+  // until their data has been sent.
+  std::int64_t bandwidth_bytes_per_second = 0;
+  // One-way delay added to every packet.
+  absl::Duration latency = absl::ZeroDuration();
+  // Extra delay drawn uniformly from [0, jitter) for every packet. Packets are
+  // never reordered.
+  absl::Duration jitter = absl::ZeroDuration();
+  // Writes are split into packets of at most this many bytes, so a read never
+  // returns more than one packet; 0 means one packet per write.
+  std::int64_t mtu_bytes = 0;
+  // Once this many bytes have been sent, the link carries nothing for
+  // `stall_duration`; 0 disables the stall.
+  std::int64_t stall_after_bytes = 0;
+  absl::Duration stall_duration = absl::ZeroDuration();
+  // A write that would take the link past this many bytes breaks it: the
+  // write and all further reads and writes fail with Exception::kIo; 0 keeps
+  // the link up.
+  std::int64_t disconnect_after_bytes = 0;
+  // Seeds the jitter, so that runs are reproducible.
+  std::uint32_t random_seed = 0;
+};
+
 // Environment config that can control availability of certain mediums for
 // testing.
 struct EnvironmentConfig {
@@ -66,6 +103,11 @@ struct EnvironmentConfig {
   // If true, the app data path will be a temporary directory, instead of the
   // actual app data path, so that we can test the preferences manager under G3.
   bool use_temporary_directory_for_app_path = false;
+
+  // Link models of sockets created for each medium. Mediums without an entry
+  // use plain pipes. When the simulated clock is installed, packets are only
+  // delivered as the test advances it with FastForward().
+  absl::flat_hash_map<SimulatedMedium, LinkModel> link_models;
 };
 
 // MediumEnvironment is a simulated environment which allows multiple instances
@@ -160,6 +202,9 @@ class MediumEnvironment {
   api::BluetoothDevice* FindBluetoothDevice(MacAddress mac_address);
 
   EnvironmentConfig GetEnvironmentConfig();
+
+  // Returns the link model configured for sockets of `medium`, if any.
+  std::optional<LinkModel> GetLinkModel(SimulatedMedium medium);
   // Registers |message_callback| to receive messages sent to device with id
   // |self_id|, and |complete_callback| to notify when signaling is complete.
   void RegisterWebRtcSignalingMessenger(
@@ -0,0 +1,207 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/metrics_registry.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "internal/platform/mutex_lock.h"
+
+namespace nearby {
+namespace {
+
+// Threads are assigned shards round-robin on their first update.
+int GetShardIndex() {
+  static std::atomic<int> next_shard{0};
+  thread_local const int shard =
+      next_shard.fetch_add(1, std::memory_order_relaxed) % kMetricsShardCount;
+  return shard;
+}
+
+template <typename T>
+T& GetOrCreate(absl::flat_hash_map<std::string, std::unique_ptr<T>>& metrics,
+               absl::string_view name) {
+  std::unique_ptr<T>& metric = metrics[name];
+  if (metric == nullptr) metric = std::make_unique<T>();
+  return *metric;
+}
+
+void AppendJsonMembers(std::string& json, absl::string_view key,
+                       const std::map<std::string, std::int64_t>& values) {
+  absl::StrAppend(&json, "\"", key, "\":{");
+  bool first = true;
+  for (const auto& [name, value] : values) {
+    absl::StrAppend(&json, first ? "" : ",", "\"", name, "\":", value);
+    first = false;
+  }
+  absl::StrAppend(&json, "}");
+}
+
+}  // namespace
+
+std::string MetricsSnapshot::ToJson() const {
+  // Metric names are plain identifiers, so they need no escaping.
+  std::string json = "{";
+  AppendJsonMembers(json, "counters", counters);
+  json.append(",");
+  AppendJsonMembers(json, "gauges", gauges);
+  json.append(",\"histograms\":{");
+  bool first = true;
+  for (const auto& [name, histogram] : histograms) {
+    absl::StrAppend(&json, first ? "" : ",", "\"", name,
+                    "\":{\"count\":", histogram.count,
+                    ",\"sum\":", histogram.sum, ",\"max\":", histogram.max,
+                    ",\"p50\":", histogram.p50, ",\"p90\":", histogram.p90,
+                    ",\"p99\":", histogram.p99, "}");
+    first = false;
+  }
+  json.append("}}");
+  return json;
+}
+
+void MetricsCounter::Increment(std::int64_t delta) {
+  shards_[GetShardIndex()].value.fetch_add(delta, std::memory_order_relaxed);
+}
+
+std::int64_t MetricsCounter::Get() const {
+  std::int64_t value = 0;
+  for (const Shard& shard : shards_) {
+    value += shard.value.load(std::memory_order_relaxed);
+  }
+  return value;
+}
+
+void MetricsCounter::Reset() {
+  for (Shard& shard : shards_) shard.value.store(0, std::memory_order_relaxed);
+}
+
+int MetricsHistogram::GetBucketIndex(std::int64_t value) {
+  if (value < 4) return std::max<std::int64_t>(value, 0);
+  int exponent = std::bit_width(static_cast<std::uint64_t>(value)) - 1;
+  if (exponent > kMaxExponent) return kBucketCount - 1;
+  int sub_bucket = (value >> (exponent - 2)) & 3;
+  return 4 * (exponent - 1) + sub_bucket;
+}
+
+std::int64_t MetricsHistogram::GetBucketUpperBound(int index) {
+  if (index < 4) return index;
+  int exponent = index / 4 + 1;
+  std::int64_t width = std::int64_t{1} << (exponent - 2);
+  return (4 + index % 4) * width + width - 1;
+}
+
+void MetricsHistogram::Record(std::int64_t value) {
+  value = std::max<std::int64_t>(value, 0);
+  Shard& shard = shards_[GetShardIndex()];
+  shard.sum.fetch_add(value, std::memory_order_relaxed);
+  shard.buckets[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  std::int64_t max = shard.max.load(std::memory_order_relaxed);
+  while (value > max && !shard.max.compare_exchange_weak(
+                            max, value, std::memory_order_relaxed)) {
+  }
+}
+
+HistogramSnapshot MetricsHistogram::GetSnapshot() const {
+  HistogramSnapshot snapshot;
+  std::array<std::int64_t, kBucketCount> buckets{};
+  for (const Shard& shard : shards_) {
+    snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+    snapshot.max =
+        std::max(snapshot.max, shard.max.load(std::memory_order_relaxed));
+    for (int i = 0; i < kBucketCount; ++i) {
+      buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+    }
+  }
+  // Counted from the buckets, so that the percentiles stay consistent with
+  // concurrent updates.
+  for (std::int64_t bucket : buckets) snapshot.count += bucket;
+  if (snapshot.count == 0) return snapshot;
+
+  auto percentile = [&](int percent) {
+    // The rank of the percentile, rounded up; at least 1.
+    std::int64_t rank =
+        std::max<std::int64_t>((snapshot.count * percent + 99) / 100, 1);
+    std::int64_t seen = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+      seen += buckets[i];
+      if (seen >= rank) return std::min(GetBucketUpperBound(i), snapshot.max);
+    }
+    return snapshot.max;
+  };
+  snapshot.p50 = percentile(50);
+  snapshot.p90 = percentile(90);
+  snapshot.p99 = percentile(99);
+  return snapshot;
+}
+
+void MetricsHistogram::Reset() {
+  for (Shard& shard : shards_) {
+    shard.sum.store(0, std::memory_order_relaxed);
+    shard.max.store(0, std::memory_order_relaxed);
+    for (auto& bucket : shard.buckets) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+MetricsRegistry& MetricsRegistry::GetInstance() {
+  static MetricsRegistry* instance = new MetricsRegistry();
+  return *instance;
+}
+
+MetricsCounter& MetricsRegistry::GetCounter(absl::string_view name) {
+  MutexLock lock(&mutex_);
+  return GetOrCreate(counters_, name);
+}
+
+MetricsGauge& MetricsRegistry::GetGauge(absl::string_view name) {
+  MutexLock lock(&mutex_);
+  return GetOrCreate(gauges_, name);
+}
+
+MetricsHistogram& MetricsRegistry::GetHistogram(absl::string_view name) {
+  MutexLock lock(&mutex_);
+  return GetOrCreate(histograms_, name);
+}
+
+MetricsSnapshot MetricsRegistry::GetSnapshot() const {
+  MetricsSnapshot snapshot;
+  MutexLock lock(&mutex_);
+  for (const auto& [name, counter] : counters_) {
+    snapshot.counters.emplace(name, counter->Get());
+  }
+  for (const auto& [name, gauge] : gauges_) {
+    snapshot.gauges.emplace(name, gauge->Get());
+  }
+  for (const auto& [name, histogram] : histograms_) {
+    snapshot.histograms.emplace(name, histogram->GetSnapshot());
+  }
+  return snapshot;
+}
+
+void MetricsRegistry::ResetForTesting() {
+  MutexLock lock(&mutex_);
+  for (auto& [name, counter] : counters_) counter->Reset();
+  for (auto& [name, histogram] : histograms_) histogram->Reset();
+}
+
+}  // namespace nearby
@@ -0,0 +1,155 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PLATFORM_PUBLIC_METRICS_REGISTRY_H_
+#define PLATFORM_PUBLIC_METRICS_REGISTRY_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "internal/platform/mutex.h"
+
+namespace nearby {
+
+// Number of shards of counters and histograms. Each thread updates one shard,
+// so that threads recording the same metric rarely share a cache line.
+inline constexpr int kMetricsShardCount = 8;
+
+struct HistogramSnapshot {
+  std::int64_t count = 0;
+  std::int64_t sum = 0;
+  std::int64_t max = 0;
+  // Upper bounds of the buckets holding the percentiles; within 25% of the
+  // real value.
+  std::int64_t p50 = 0;
+  std::int64_t p90 = 0;
+  std::int64_t p99 = 0;
+};
+
+struct MetricsSnapshot {
+  std::map<std::string, std::int64_t> counters;
+  std::map<std::string, std::int64_t> gauges;
+  std::map<std::string, HistogramSnapshot> histograms;
+
+  // Returns the snapshot as a JSON object with "counters", "gauges" and
+  // "histograms" members, keyed by metric name.
+  std::string ToJson() const;
+};
+
+// A monotonically increasing value. Increment() is lock-free.
+class MetricsCounter {
+ public:
+  void Increment(std::int64_t delta = 1);
+  std::int64_t Get() const;
+  void Reset();
+
+ private:
+  struct alignas(64) Shard {
+    std::atomic<std::int64_t> value{0};
+  };
+  std::array<Shard, kMetricsShardCount> shards_;
+};
+
+// A value that goes up and down, such as a queue depth.
+class MetricsGauge {
+ public:
+  void Set(std::int64_t value) {
+    value_.store(value, std::memory_order_relaxed);
+  }
+  void Add(std::int64_t delta) {
+    value_.fetch_add(delta, std::memory_order_relaxed);
+  }
+  std::int64_t Get() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<std::int64_t> value_{0};
+};
+
+// A log-linear histogram of non-negative values, typically latencies in
+// microseconds. Every power of two is split into four buckets, so a recorded
+// value is known within 25%. Record() is lock-free.
+class MetricsHistogram {
+ public:
+  // Values up to 2^41 - 1 (25 days in microseconds) have their own bucket;
+  // larger ones are counted in the last bucket.
+  static constexpr int kMaxExponent = 40;
+  static constexpr int kBucketCount = 4 * kMaxExponent;
+
+  void Record(std::int64_t value);
+  void RecordDuration(absl::Duration duration) {
+    Record(absl::ToInt64Microseconds(duration));
+  }
+  HistogramSnapshot GetSnapshot() const;
+  void Reset();
+
+  // Exposed for tests.
+  static int GetBucketIndex(std::int64_t value);
+  static std::int64_t GetBucketUpperBound(int index);
+
+ private:
+  struct alignas(64) Shard {
+    std::atomic<std::int64_t> sum{0};
+    std::atomic<std::int64_t> max{0};
+    std::array<std::atomic<std::int64_t>, kBucketCount> buckets{};
+  };
+  std::array<Shard, kMetricsShardCount> shards_;
+};
+
+// A process-wide registry of named hot-path metrics.
+//
+// Metrics are created on first use and never destroyed, so callers on hot
+// paths look them up once and keep the reference:
+//
+//   static MetricsCounter& bytes_written =
+//       MetricsRegistry::GetInstance().GetCounter("channel.bytes_written");
+//   bytes_written.Increment(size);
+class MetricsRegistry {
+ public:
+  static MetricsRegistry& GetInstance();
+
+  MetricsCounter& GetCounter(absl::string_view name)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  MetricsGauge& GetGauge(absl::string_view name) ABSL_LOCKS_EXCLUDED(mutex_);
+  MetricsHistogram& GetHistogram(absl::string_view name)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  MetricsSnapshot GetSnapshot() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Zeroes all counters and histograms. Gauges are left alone, since they
+  // mirror live state.
+  void ResetForTesting() ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  MetricsRegistry() = default;
+
+  mutable Mutex mutex_;
+  absl::flat_hash_map<std::string, std::unique_ptr<MetricsCounter>> counters_
+      ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, std::unique_ptr<MetricsGauge>> gauges_
+      ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, std::unique_ptr<MetricsHistogram>>
+      histograms_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace nearby
+
+#endif  // PLATFORM_PUBLIC_METRICS_REGISTRY_H_
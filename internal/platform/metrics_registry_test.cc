@@ -0,0 +1,123 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/metrics_registry.h"
+
+#include <cstdint>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+
+namespace nearby {
+namespace {
+
+using ::testing::HasSubstr;
+
+TEST(MetricsRegistryTest, CounterSumsAllThreads) {
+  MetricsCounter counter;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 16; ++i) {
+    threads.emplace_back([&counter]() {
+      for (int j = 0; j < 1000; ++j) counter.Increment();
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  EXPECT_EQ(counter.Get(), 16000);
+  counter.Reset();
+  EXPECT_EQ(counter.Get(), 0);
+}
+
+TEST(MetricsRegistryTest, GaugeGoesUpAndDown) {
+  MetricsGauge gauge;
+  gauge.Add(5);
+  gauge.Add(-2);
+  EXPECT_EQ(gauge.Get(), 3);
+  gauge.Set(10);
+  EXPECT_EQ(gauge.Get(), 10);
+}
+
+TEST(MetricsRegistryTest, BucketsAreLogLinear) {
+  EXPECT_EQ(MetricsHistogram::GetBucketIndex(-5), 0);
+  EXPECT_EQ(MetricsHistogram::GetBucketIndex(3), 3);
+  EXPECT_EQ(MetricsHistogram::GetBucketIndex(4), 4);
+  EXPECT_EQ(MetricsHistogram::GetBucketIndex(7), 7);
+  EXPECT_EQ(MetricsHistogram::GetBucketIndex(8), 8);
+  EXPECT_EQ(MetricsHistogram::GetBucketIndex(9), 8);
+  EXPECT_EQ(MetricsHistogram::GetBucketIndex(10), 9);
+  EXPECT_EQ(MetricsHistogram::GetBucketIndex(INT64_MAX),
+            MetricsHistogram::kBucketCount - 1);
+  for (int i = 0; i < MetricsHistogram::kBucketCount; ++i) {
+    EXPECT_EQ(MetricsHistogram::GetBucketIndex(
+                  MetricsHistogram::GetBucketUpperBound(i)),
+              i);
+  }
+}
+
+TEST(MetricsRegistryTest, HistogramReportsPercentiles) {
+  MetricsHistogram histogram;
+  for (int i = 1; i <= 100; ++i) histogram.Record(i);
+  histogram.RecordDuration(absl::Milliseconds(1));
+
+  HistogramSnapshot snapshot = histogram.GetSnapshot();
+  EXPECT_EQ(snapshot.count, 101);
+  EXPECT_EQ(snapshot.sum, 5050 + 1000);
+  EXPECT_EQ(snapshot.max, 1000);
+  // Within 25% of the exact values.
+  EXPECT_GE(snapshot.p50, 51);
+  EXPECT_LE(snapshot.p50, 64);
+  EXPECT_GE(snapshot.p90, 91);
+  EXPECT_LE(snapshot.p90, 112);
+  EXPECT_GE(snapshot.p99, 100);
+  EXPECT_LE(snapshot.p99, 1000);
+
+  histogram.Reset();
+  EXPECT_EQ(histogram.GetSnapshot().count, 0);
+}
+
+TEST(MetricsRegistryTest, ReturnsSameMetricForSameName) {
+  MetricsRegistry& registry = MetricsRegistry::GetInstance();
+  EXPECT_EQ(&registry.GetCounter("test.counter"),
+            &registry.GetCounter("test.counter"));
+  EXPECT_NE(&registry.GetCounter("test.counter"),
+            &registry.GetCounter("test.other_counter"));
+  EXPECT_EQ(&registry.GetHistogram("test.histogram"),
+            &registry.GetHistogram("test.histogram"));
+}
+
+TEST(MetricsRegistryTest, SnapshotExportsAllMetrics) {
+  MetricsRegistry& registry = MetricsRegistry::GetInstance();
+  registry.ResetForTesting();
+  registry.GetCounter("test.bytes").Increment(42);
+  registry.GetGauge("test.depth").Set(3);
+  registry.GetHistogram("test.latency_us").Record(7);
+
+  MetricsSnapshot snapshot = registry.GetSnapshot();
+  EXPECT_EQ(snapshot.counters["test.bytes"], 42);
+  EXPECT_EQ(snapshot.gauges["test.depth"], 3);
+  EXPECT_EQ(snapshot.histograms["test.latency_us"].count, 1);
+
+  std::string json = snapshot.ToJson();
+  EXPECT_THAT(json, HasSubstr("\"test.bytes\":42"));
+  EXPECT_THAT(json, HasSubstr("\"test.depth\":3"));
+  EXPECT_THAT(json, HasSubstr("\"test.latency_us\":{\"count\":1,\"sum\":7,"
+                              "\"max\":7,\"p50\":7,\"p90\":7,\"p99\":7}"));
+}
+
+}  // namespace
+}  // namespace nearby
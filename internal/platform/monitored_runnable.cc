@@ -21,6 +21,7 @@
 #include "absl/time/time.h"
 #include "internal/platform/implementation/system_clock.h"
 #include "internal/platform/logging.h"
+#include "internal/platform/metrics_registry.h"
 #include "internal/platform/pending_job_registry.h"
 #include "internal/platform/runnable.h"
 
@@ -42,8 +43,13 @@ MonitoredRunnable::MonitoredRunnable(const std::string& name,
 }
 
 void MonitoredRunnable::operator()() {
+  static MetricsHistogram& start_delay_us =
+      MetricsRegistry::GetInstance().GetHistogram("executor.start_delay_us");
+  static MetricsHistogram& task_duration_us =
+      MetricsRegistry::GetInstance().GetHistogram("executor.task_duration_us");
   absl::Time start_time = SystemClock::ElapsedRealtime();
   absl::Duration start_delay = start_time - post_time_;
+  start_delay_us.RecordDuration(start_delay);
   if (start_delay >= kMinReportedStartDelay) {
     LOG(INFO) << "Task: \"" << name_ << "\" started after " << start_delay;
   } else {
@@ -53,6 +59,7 @@ void MonitoredRunnable::operator()() {
   PendingJobRegistry::GetInstance().AddRunningJob(name_, post_time_);
   runnable_();
   absl::Duration task_duration = SystemClock::ElapsedRealtime() - start_time;
+  task_duration_us.RecordDuration(task_duration);
   if (task_duration >= kMinReportedTaskDuration) {
     LOG(INFO) << "Task: \"" << name_ << "\" finished after " << task_duration;
   } else {
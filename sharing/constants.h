@@ -64,6 +64,13 @@ constexpr double kTransferSpeedUpdateInterval = 1.0;
 // Time between successive transfer completion ETA in seconds.
 constexpr double kEstimatedTimeRemainingUpdateInterval = 3.0;
 
+// With small file bundling enabled, files up to this size are sent in file
+// bundles instead of in payloads of their own.
+constexpr int64_t kSmallFileBundlingMaxFileSize = 1024 * 1024;
+
+// Maximum size of a file bundle.
+constexpr int64_t kSmallFileBundlingMaxBundleSize = 64 * 1024 * 1024;
+
 }  // namespace sharing
 }  // namespace nearby
 
@@ -0,0 +1,182 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sharing/content_index.h"
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "internal/base/file_path.h"
+#include "internal/base/files.h"
+#include "internal/crypto_cros/secure_hash.h"
+#include "internal/crypto_cros/sha2.h"
+#include "sharing/file_bundle.h"
+#include "sharing/internal/public/logging.h"
+
+namespace nearby::sharing {
+namespace {
+
+constexpr int64_t kReadBufferSize = 64 * 1024;
+
+}  // namespace
+
+std::optional<std::string> ComputeContentHash(const FilePath& file_path) {
+  std::ifstream in(file_path.GetPath(), std::ios::binary);
+  if (!in) {
+    return std::nullopt;
+  }
+  std::unique_ptr<crypto::SecureHash> hash =
+      crypto::SecureHash::Create(crypto::SecureHash::SHA256);
+  std::array<char, kReadBufferSize> buffer;
+  while (in) {
+    in.read(buffer.data(), buffer.size());
+    hash->Update(buffer.data(), in.gcount());
+  }
+  if (!in.eof()) {
+    return std::nullopt;
+  }
+  std::string content_hash(crypto::kSHA256Length, 0);
+  hash->Finish(content_hash.data(), content_hash.size());
+  return content_hash;
+}
+
+std::optional<FilePath> LinkOrCopyReceivedFile(const FilePath& source,
+                                               const FilePath& directory,
+                                               absl::string_view parent_folder,
+                                               absl::string_view file_name) {
+  std::optional<FilePath> file_path =
+      CreateReceivedFilePath(directory, parent_folder, file_name);
+  if (!file_path.has_value()) {
+    return std::nullopt;
+  }
+  if (Files::CreateHardLink(source, *file_path) ||
+      Files::CopyFileSafely(source, *file_path)) {
+    return file_path;
+  }
+  LOG(WARNING) << "Failed to copy " << source.ToString() << " to "
+               << file_path->ToString();
+  return std::nullopt;
+}
+
+ContentIndex::ContentIndex(FilePath index_path, int max_entries)
+    : index_path_(std::move(index_path)), max_entries_(max_entries) {}
+
+void ContentIndex::Add(absl::string_view sender,
+                       absl::string_view content_hash,
+                       const FilePath& file_path) {
+  std::string path = file_path.ToString();
+  if (sender.empty() || content_hash.empty() || path.empty() ||
+      path.find('\n') != std::string::npos) {
+    return;
+  }
+  absl::MutexLock lock(&mutex_);
+  LoadLocked();
+  Entry new_entry{absl::BytesToHexString(sender),
+                  absl::BytesToHexString(content_hash), std::move(path)};
+  // The newest copy of some contents replaces the older ones.
+  std::erase_if(entries_, [&](const Entry& entry) {
+    return (entry.sender == new_entry.sender &&
+            entry.content_hash == new_entry.content_hash) ||
+           entry.file_path == new_entry.file_path;
+  });
+  entries_.push_back(std::move(new_entry));
+  while (static_cast<int>(entries_.size()) > max_entries_) {
+    entries_.pop_front();
+  }
+  SaveLocked();
+}
+
+std::optional<FilePath> ContentIndex::Find(absl::string_view sender,
+                                           absl::string_view content_hash,
+                                           int64_t size) {
+  if (sender.empty()) {
+    return std::nullopt;
+  }
+  absl::MutexLock lock(&mutex_);
+  LoadLocked();
+  std::string sender_key = absl::BytesToHexString(sender);
+  std::string key = absl::BytesToHexString(content_hash);
+  for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+    if (it->sender != sender_key || it->content_hash != key) {
+      continue;
+    }
+    FilePath file_path(it->file_path);
+    std::optional<uintmax_t> file_size = Files::GetFileSize(file_path);
+    if (file_size.has_value() && static_cast<int64_t>(*file_size) == size &&
+        ComputeContentHash(file_path) == content_hash) {
+      return file_path;
+    }
+    // The file was removed or changed since it was received.
+    entries_.erase(it);
+    SaveLocked();
+    return std::nullopt;
+  }
+  return std::nullopt;
+}
+
+void ContentIndex::LoadLocked() {
+  if (loaded_) {
+    return;
+  }
+  loaded_ = true;
+  std::ifstream in(index_path_.GetPath());
+  std::string line;
+  while (std::getline(in, line)) {
+    // Entries written before they had a sender have only two fields, and are
+    // dropped.
+    size_t first = line.find('\t');
+    size_t second = first == std::string::npos ? std::string::npos
+                                               : line.find('\t', first + 1);
+    if (second == std::string::npos) {
+      continue;
+    }
+    entries_.push_back(Entry{line.substr(0, first),
+                             line.substr(first + 1, second - first - 1),
+                             line.substr(second + 1)});
+  }
+  while (static_cast<int>(entries_.size()) > max_entries_) {
+    entries_.pop_front();
+  }
+}
+
+void ContentIndex::SaveLocked() {
+  Files::CreateDirectories(index_path_.GetParentPath());
+  FilePath temp_path(absl::StrCat(index_path_.ToString(), ".tmp"));
+  {
+    std::ofstream out(temp_path.GetPath(), std::ios::trunc);
+    for (const Entry& entry : entries_) {
+      out << entry.sender << '\t' << entry.content_hash << '\t'
+          << entry.file_path << '\n';
+    }
+    out.close();
+    if (!out) {
+      LOG(WARNING) << "Failed to write content index "
+                   << index_path_.ToString();
+      return;
+    }
+  }
+  Files::Rename(temp_path, index_path_);
+}
+
+}  // namespace nearby::sharing
@@ -0,0 +1,91 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_NEARBY_SHARING_CONTENT_INDEX_H_
+#define THIRD_PARTY_NEARBY_SHARING_CONTENT_INDEX_H_
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "internal/base/file_path.h"
+
+namespace nearby::sharing {
+
+// Returns the SHA-256 of the contents of the file at `file_path`, or nullopt
+// if it can't be read.
+std::optional<std::string> ComputeContentHash(const FilePath& file_path);
+
+// Creates a new file at CreateReceivedFilePath(`directory`, `parent_folder`,
+// `file_name`) with the contents of `source`, as a hard link if possible and
+// as a copy otherwise. Returns the path of the new file, or nullopt on
+// failure.
+std::optional<FilePath> LinkOrCopyReceivedFile(const FilePath& source,
+                                               const FilePath& directory,
+                                               absl::string_view parent_folder,
+                                               absl::string_view file_name);
+
+// Remembers where received files with a given content hash are, so that the
+// same files don't have to be received again.
+//
+// Each entry belongs to the sender the file was received from, identified by
+// an opaque `sender` string, and is only ever returned to that sender: any
+// other sender could otherwise learn which files the receiver holds.
+//
+// Entries are kept in the file at `index_path`, one per line, and only the
+// last `max_entries` are kept. A file found in the index is hashed again
+// before it is returned, since it may have changed since it was received.
+class ContentIndex {
+ public:
+  explicit ContentIndex(FilePath index_path, int max_entries = 1000);
+
+  // Records that the file at `file_path`, received from `sender`, has the
+  // contents `content_hash`.
+  void Add(absl::string_view sender, absl::string_view content_hash,
+           const FilePath& file_path) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the path of a file of `size` bytes with the contents
+  // `content_hash` received from `sender`, if one is known and still has
+  // those contents.
+  std::optional<FilePath> Find(absl::string_view sender,
+                               absl::string_view content_hash, int64_t size)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  struct Entry {
+    // Hex encoded.
+    std::string sender;
+    std::string content_hash;
+    std::string file_path;
+  };
+
+  void LoadLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void SaveLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const FilePath index_path_;
+  const int max_entries_;
+
+  absl::Mutex mutex_;
+  bool loaded_ ABSL_GUARDED_BY(mutex_) = false;
+  // Oldest first.
+  std::deque<Entry> entries_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace nearby::sharing
+
+#endif  // THIRD_PARTY_NEARBY_SHARING_CONTENT_INDEX_H_
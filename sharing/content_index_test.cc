@@ -0,0 +1,172 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sharing/content_index.h"
+
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/string_view.h"
+#include "internal/base/file_path.h"
+#include "internal/base/files.h"
+
+namespace nearby::sharing {
+namespace {
+
+constexpr absl::string_view kSender = "sender";
+
+class ContentIndexTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    directory_ = Files::GetTemporaryDirectory().append(FilePath(
+        ::testing::UnitTest::GetInstance()->current_test_info()->name()));
+    Files::RemoveDirectory(directory_);
+    ASSERT_TRUE(Files::CreateDirectories(directory_));
+    index_path_ = FilePath(directory_).append(FilePath("index"));
+  }
+
+  void TearDown() override { Files::RemoveDirectory(directory_); }
+
+  FilePath WriteFile(absl::string_view name, absl::string_view contents) {
+    FilePath path = FilePath(directory_).append(FilePath(name));
+    std::ofstream out(path.GetPath(), std::ios::binary | std::ios::trunc);
+    out << contents;
+    return path;
+  }
+
+  static std::string ReadFile(const FilePath& path) {
+    std::ifstream in(path.GetPath(), std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+  }
+
+  FilePath directory_;
+  FilePath index_path_;
+};
+
+TEST_F(ContentIndexTest, ComputesContentHash) {
+  FilePath a = WriteFile("a.txt", "hello");
+  FilePath b = WriteFile("b.txt", "hello");
+  FilePath c = WriteFile("c.txt", "world");
+
+  std::optional<std::string> hash = ComputeContentHash(a);
+  ASSERT_TRUE(hash.has_value());
+  EXPECT_EQ(hash->size(), 32);
+  EXPECT_EQ(ComputeContentHash(b), hash);
+  EXPECT_NE(ComputeContentHash(c), hash);
+  EXPECT_FALSE(
+      ComputeContentHash(FilePath(directory_).append(FilePath("x")))
+          .has_value());
+}
+
+TEST_F(ContentIndexTest, FindsAddedFile) {
+  FilePath file = WriteFile("a.txt", "hello");
+  std::string hash = *ComputeContentHash(file);
+  ContentIndex index(index_path_);
+
+  EXPECT_FALSE(index.Find(kSender, hash, 5).has_value());
+  index.Add(kSender, hash, file);
+
+  std::optional<FilePath> found = index.Find(kSender, hash, 5);
+  ASSERT_TRUE(found.has_value());
+  EXPECT_EQ(found->ToString(), file.ToString());
+  EXPECT_FALSE(index.Find(kSender, hash, 4).has_value());
+}
+
+TEST_F(ContentIndexTest, FindsOnlyFilesFromSameSender) {
+  FilePath file = WriteFile("a.txt", "hello");
+  std::string hash = *ComputeContentHash(file);
+  ContentIndex index(index_path_);
+  index.Add(kSender, hash, file);
+
+  EXPECT_FALSE(index.Find("other", hash, 5).has_value());
+  EXPECT_FALSE(index.Find("", hash, 5).has_value());
+  EXPECT_TRUE(index.Find(kSender, hash, 5).has_value());
+}
+
+TEST_F(ContentIndexTest, DropsEntriesWithoutSender) {
+  FilePath file = WriteFile("a.txt", "hello");
+  std::string hash = *ComputeContentHash(file);
+  {
+    std::ofstream out(index_path_.GetPath(), std::ios::binary);
+    out << absl::BytesToHexString(hash) << '\t' << file.ToString() << '\n';
+  }
+
+  ContentIndex index(index_path_);
+  EXPECT_FALSE(index.Find(kSender, hash, 5).has_value());
+}
+
+TEST_F(ContentIndexTest, KeepsEntriesAcrossInstances) {
+  FilePath file = WriteFile("a.txt", "hello");
+  std::string hash = *ComputeContentHash(file);
+  ContentIndex(index_path_).Add(kSender, hash, file);
+
+  ContentIndex index(index_path_);
+  std::optional<FilePath> found = index.Find(kSender, hash, 5);
+  ASSERT_TRUE(found.has_value());
+  EXPECT_EQ(found->ToString(), file.ToString());
+}
+
+TEST_F(ContentIndexTest, DropsChangedFile) {
+  FilePath file = WriteFile("a.txt", "hello");
+  std::string hash = *ComputeContentHash(file);
+  ContentIndex index(index_path_);
+  index.Add(kSender, hash, file);
+
+  WriteFile("a.txt", "jello");
+  EXPECT_FALSE(index.Find(kSender, hash, 5).has_value());
+
+  WriteFile("a.txt", "hello");
+  EXPECT_FALSE(index.Find(kSender, hash, 5).has_value());
+}
+
+TEST_F(ContentIndexTest, KeepsOnlyLatestEntries) {
+  FilePath a = WriteFile("a.txt", "a");
+  FilePath b = WriteFile("b.txt", "b");
+  FilePath c = WriteFile("c.txt", "c");
+  ContentIndex index(index_path_, /*max_entries=*/2);
+  index.Add(kSender, *ComputeContentHash(a), a);
+  index.Add(kSender, *ComputeContentHash(b), b);
+  index.Add(kSender, *ComputeContentHash(c), c);
+
+  EXPECT_FALSE(index.Find(kSender, *ComputeContentHash(a), 1).has_value());
+  EXPECT_TRUE(index.Find(kSender, *ComputeContentHash(b), 1).has_value());
+  EXPECT_TRUE(index.Find(kSender, *ComputeContentHash(c), 1).has_value());
+}
+
+TEST_F(ContentIndexTest, LinksOrCopiesReceivedFile) {
+  FilePath source = WriteFile("a.txt", "hello");
+  FilePath save_path = FilePath(directory_).append(FilePath("received"));
+  ASSERT_TRUE(Files::CreateDirectories(save_path));
+
+  std::optional<FilePath> first =
+      LinkOrCopyReceivedFile(source, save_path, "folder", "a.txt");
+  std::optional<FilePath> second =
+      LinkOrCopyReceivedFile(source, save_path, "folder", "a.txt");
+
+  ASSERT_TRUE(first.has_value());
+  ASSERT_TRUE(second.has_value());
+  EXPECT_NE(first->ToString(), second->ToString());
+  EXPECT_EQ(ReadFile(*first), "hello");
+  EXPECT_EQ(ReadFile(*second), "hello");
+  EXPECT_FALSE(
+      LinkOrCopyReceivedFile(source, save_path, "../escape", "a.txt")
+          .has_value());
+}
+
+}  // namespace
+}  // namespace nearby::sharing
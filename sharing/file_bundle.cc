@@ -0,0 +1,167 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sharing/file_bundle.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <fstream>
+#include <optional>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "internal/base/file_path.h"
+#include "internal/base/files.h"
+#include "sharing/internal/public/logging.h"
+
+namespace nearby::sharing {
+namespace {
+
+constexpr int64_t kCopyBufferSize = 64 * 1024;
+
+// Copies `size` bytes from `in` to `out`. Returns false if `in` ends early.
+bool CopyBytes(std::istream& in, std::ostream& out, int64_t size) {
+  std::array<char, kCopyBufferSize> buffer;
+  while (size > 0) {
+    int64_t chunk_size = std::min(size, kCopyBufferSize);
+    in.read(buffer.data(), chunk_size);
+    if (in.gcount() != chunk_size) {
+      return false;
+    }
+    out.write(buffer.data(), chunk_size);
+    size -= chunk_size;
+  }
+  return static_cast<bool>(out);
+}
+
+// Returns true if `parent_folder` is a relative path without ".." components.
+bool IsSafeParentFolder(absl::string_view parent_folder) {
+  std::filesystem::path path = FilePath(parent_folder).GetPath();
+  if (path.has_root_path()) {
+    return false;
+  }
+  for (const std::filesystem::path& component : path) {
+    if (component == "..") {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns true if `file_name` names a file, and not a path.
+bool IsSafeFileName(absl::string_view file_name) {
+  return !file_name.empty() && file_name != "." && file_name != ".." &&
+         FilePath(file_name).GetFileName().ToString() == file_name;
+}
+
+// Returns `file_path`, or the first "name (n).ext" next to it that does not
+// exist yet.
+FilePath GetUniqueFilePath(const FilePath& file_path) {
+  if (!Files::FileExists(file_path)) {
+    return file_path;
+  }
+  std::string file_name = file_path.GetFileName().ToString();
+  std::string extension = file_path.GetExtension().ToString();
+  std::string stem = file_name.substr(0, file_name.size() - extension.size());
+  for (int count = 1;; ++count) {
+    FilePath candidate = file_path.GetParentPath().append(
+        FilePath(absl::StrCat(stem, " (", count, ")", extension)));
+    if (!Files::FileExists(candidate)) {
+      return candidate;
+    }
+  }
+}
+
+}  // namespace
+
+bool WriteFileBundle(absl::Span<const FilePath> files,
+                     absl::Span<const int64_t> file_sizes,
+                     const FilePath& bundle_path) {
+  if (files.size() != file_sizes.size()) {
+    return false;
+  }
+  std::ofstream out(bundle_path.GetPath(), std::ios::binary | std::ios::trunc);
+  if (!out) {
+    LOG(WARNING) << "Failed to create file bundle " << bundle_path.ToString();
+    return false;
+  }
+  for (int i = 0; i < files.size(); ++i) {
+    std::ifstream in(files[i].GetPath(), std::ios::binary);
+    if (!in || !CopyBytes(in, out, file_sizes[i]) ||
+        in.peek() != std::ifstream::traits_type::eof()) {
+      LOG(WARNING) << "Failed to add " << files[i].ToString()
+                   << " to file bundle " << bundle_path.ToString();
+      return false;
+    }
+  }
+  out.close();
+  return static_cast<bool>(out);
+}
+
+std::optional<FilePath> CreateReceivedFilePath(const FilePath& directory,
+                                               absl::string_view parent_folder,
+                                               absl::string_view file_name) {
+  if (!IsSafeParentFolder(parent_folder) || !IsSafeFileName(file_name)) {
+    LOG(WARNING) << "Invalid received file: parent_folder=" << parent_folder
+                 << ", file_name=" << file_name;
+    return std::nullopt;
+  }
+  FilePath folder = directory;
+  if (!parent_folder.empty()) {
+    folder.append(FilePath(parent_folder));
+    if (!Files::CreateDirectories(folder)) {
+      return std::nullopt;
+    }
+  }
+  return GetUniqueFilePath(FilePath(folder).append(FilePath(file_name)));
+}
+
+std::optional<FilePath> ExtractFileFromBundle(const FilePath& bundle_path,
+                                              int64_t offset, int64_t size,
+                                              const FilePath& directory,
+                                              absl::string_view parent_folder,
+                                              absl::string_view file_name) {
+  if (offset < 0 || size < 0) {
+    LOG(WARNING) << "Invalid file in bundle: offset=" << offset
+                 << ", size=" << size;
+    return std::nullopt;
+  }
+  std::ifstream in(bundle_path.GetPath(), std::ios::binary);
+  if (!in || !in.seekg(offset)) {
+    return std::nullopt;
+  }
+
+  std::optional<FilePath> received_file_path =
+      CreateReceivedFilePath(directory, parent_folder, file_name);
+  if (!received_file_path.has_value()) {
+    return std::nullopt;
+  }
+  const FilePath& file_path = *received_file_path;
+  std::ofstream out(file_path.GetPath(), std::ios::binary);
+  bool copied = out && CopyBytes(in, out, size);
+  out.close();
+  if (!copied || !out) {
+    LOG(WARNING) << "Failed to extract " << file_path.ToString()
+                 << " from file bundle " << bundle_path.ToString();
+    Files::RemoveFile(file_path);
+    return std::nullopt;
+  }
+  return file_path;
+}
+
+}  // namespace nearby::sharing
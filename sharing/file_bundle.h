@@ -0,0 +1,57 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_NEARBY_SHARING_FILE_BUNDLE_H_
+#define THIRD_PARTY_NEARBY_SHARING_FILE_BUNDLE_H_
+
+#include <cstdint>
+#include <optional>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "internal/base/file_path.h"
+
+namespace nearby::sharing {
+
+// A file bundle packs several small files back to back into one file, so that
+// they are sent as a single payload. The bundle has no header of its own; the
+// offset and size of every file in it are sent in the IntroductionFrame.
+
+// Writes `files` one after the other to `bundle_path`. Fails if a file cannot
+// be read, or if its size no longer matches `file_sizes`.
+bool WriteFileBundle(absl::Span<const FilePath> files,
+                     absl::Span<const int64_t> file_sizes,
+                     const FilePath& bundle_path);
+
+// Returns the path of a new file named `file_name` in
+// `directory`/`parent_folder`, creating the folders as needed. `file_name` and
+// `parent_folder` come from the remote device, so names that would escape
+// `directory` are rejected. If the file already exists, a " (n)" suffix is
+// added to its name. Returns nullopt on failure.
+std::optional<FilePath> CreateReceivedFilePath(const FilePath& directory,
+                                               absl::string_view parent_folder,
+                                               absl::string_view file_name);
+
+// Copies the `size` bytes at `offset` in `bundle_path` to a new file at
+// CreateReceivedFilePath(`directory`, `parent_folder`, `file_name`). Returns
+// the path of the new file, or nullopt on failure.
+std::optional<FilePath> ExtractFileFromBundle(const FilePath& bundle_path,
+                                              int64_t offset, int64_t size,
+                                              const FilePath& directory,
+                                              absl::string_view parent_folder,
+                                              absl::string_view file_name);
+
+}  // namespace nearby::sharing
+
+#endif  // THIRD_PARTY_NEARBY_SHARING_FILE_BUNDLE_H_
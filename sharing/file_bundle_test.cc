@@ -0,0 +1,140 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sharing/file_bundle.h"
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/string_view.h"
+#include "internal/base/file_path.h"
+#include "internal/base/files.h"
+
+namespace nearby::sharing {
+namespace {
+
+class FileBundleTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    directory_ = Files::GetTemporaryDirectory().append(FilePath(
+        ::testing::UnitTest::GetInstance()->current_test_info()->name()));
+    Files::RemoveDirectory(directory_);
+    ASSERT_TRUE(Files::CreateDirectories(directory_));
+    bundle_path_ = FilePath(directory_).append(FilePath("bundle"));
+  }
+
+  void TearDown() override { Files::RemoveDirectory(directory_); }
+
+  FilePath WriteFile(absl::string_view name, absl::string_view contents) {
+    FilePath path = FilePath(directory_).append(FilePath(name));
+    std::ofstream out(path.GetPath(), std::ios::binary);
+    out << contents;
+    return path;
+  }
+
+  static std::string ReadFile(const FilePath& path) {
+    std::ifstream in(path.GetPath(), std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+  }
+
+  FilePath directory_;
+  FilePath bundle_path_;
+};
+
+TEST_F(FileBundleTest, WritesFilesBackToBack) {
+  std::vector<FilePath> files = {WriteFile("a.txt", "hello"),
+                                 WriteFile("b.txt", ""),
+                                 WriteFile("c.txt", "world!")};
+
+  ASSERT_TRUE(WriteFileBundle(files, {5, 0, 6}, bundle_path_));
+  EXPECT_EQ(ReadFile(bundle_path_), "helloworld!");
+}
+
+TEST_F(FileBundleTest, WriteFailsIfFileSizeChanged) {
+  std::vector<FilePath> files = {WriteFile("a.txt", "hello")};
+
+  EXPECT_FALSE(WriteFileBundle(files, {4}, bundle_path_));
+  EXPECT_FALSE(WriteFileBundle(files, {6}, bundle_path_));
+}
+
+TEST_F(FileBundleTest, WriteFailsIfFileIsMissing) {
+  std::vector<FilePath> files = {FilePath(directory_).append(FilePath("x"))};
+
+  EXPECT_FALSE(WriteFileBundle(files, {1}, bundle_path_));
+}
+
+TEST_F(FileBundleTest, ExtractsFiles) {
+  WriteFile("bundle", "helloworld!");
+
+  std::optional<FilePath> hello = ExtractFileFromBundle(
+      bundle_path_, 0, 5, directory_, /*parent_folder=*/"", "hello.txt");
+  std::optional<FilePath> world = ExtractFileFromBundle(
+      bundle_path_, 5, 6, directory_, "photos/2026", "world.txt");
+
+  ASSERT_TRUE(hello.has_value());
+  EXPECT_EQ(ReadFile(*hello), "hello");
+  ASSERT_TRUE(world.has_value());
+  EXPECT_EQ(*world, FilePath(directory_)
+                        .append(FilePath("photos/2026"))
+                        .append(FilePath("world.txt")));
+  EXPECT_EQ(ReadFile(*world), "world!");
+}
+
+TEST_F(FileBundleTest, ExtractRenamesExistingFile) {
+  WriteFile("bundle", "new");
+  WriteFile("a.txt", "old");
+
+  std::optional<FilePath> file_path =
+      ExtractFileFromBundle(bundle_path_, 0, 3, directory_, "", "a.txt");
+
+  ASSERT_TRUE(file_path.has_value());
+  EXPECT_EQ(file_path->GetFileName().ToString(), "a (1).txt");
+  EXPECT_EQ(ReadFile(*file_path), "new");
+  EXPECT_EQ(ReadFile(FilePath(directory_).append(FilePath("a.txt"))), "old");
+}
+
+TEST_F(FileBundleTest, ExtractFailsPastEndOfBundle) {
+  WriteFile("bundle", "hello");
+
+  EXPECT_FALSE(
+      ExtractFileFromBundle(bundle_path_, 3, 3, directory_, "", "a.txt")
+          .has_value());
+  EXPECT_FALSE(
+      Files::FileExists(FilePath(directory_).append(FilePath("a.txt"))));
+}
+
+TEST_F(FileBundleTest, ExtractRejectsPathsOutsideDirectory) {
+  WriteFile("bundle", "hello");
+
+  EXPECT_FALSE(
+      ExtractFileFromBundle(bundle_path_, 0, 5, directory_, "", "../a.txt")
+          .has_value());
+  EXPECT_FALSE(
+      ExtractFileFromBundle(bundle_path_, 0, 5, directory_, "..", "a.txt")
+          .has_value());
+  EXPECT_FALSE(
+      ExtractFileFromBundle(bundle_path_, 0, 5, directory_, "a/../..", "a.txt")
+          .has_value());
+  EXPECT_FALSE(
+      ExtractFileFromBundle(bundle_path_, 0, 5, directory_, "/tmp", "a.txt")
+          .has_value());
+}
+
+}  // namespace
+}  // namespace nearby::sharing
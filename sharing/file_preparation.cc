@@ -0,0 +1,88 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sharing/file_preparation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/functional/function_ref.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/types/span.h"
+#include "internal/base/file_path.h"
+#include "internal/base/files.h"
+#include "internal/platform/task_runner_impl.h"
+#include "sharing/content_index.h"
+
+namespace nearby::sharing {
+namespace {
+
+// Runs `task` for each index in [0, count) on up to `max_parallelism`
+// threads, and returns once all have run.
+void RunInParallel(size_t count, int max_parallelism,
+                   absl::FunctionRef<void(size_t)> task) {
+  size_t thread_count =
+      std::min(count, static_cast<size_t>(std::max(max_parallelism, 1)));
+  if (thread_count <= 1) {
+    for (size_t i = 0; i < count; ++i) {
+      task(i);
+    }
+    return;
+  }
+
+  // Each thread takes the next file when it is done with one, so that a slow
+  // file doesn't hold up the files queued behind it.
+  std::atomic<size_t> next_index = 0;
+  absl::BlockingCounter threads_done(thread_count);
+  auto worker = [&]() {
+    for (size_t i = next_index++; i < count; i = next_index++) {
+      task(i);
+    }
+    threads_done.DecrementCount();
+  };
+  TaskRunnerImpl task_runner(thread_count);
+  for (size_t i = 0; i < thread_count; ++i) {
+    if (!task_runner.PostTask(worker)) {
+      worker();
+    }
+  }
+  threads_done.Wait();
+}
+
+}  // namespace
+
+std::vector<std::optional<uintmax_t>> GetFileSizes(
+    absl::Span<const FilePath> file_paths, int max_parallelism) {
+  std::vector<std::optional<uintmax_t>> file_sizes(file_paths.size());
+  RunInParallel(file_paths.size(), max_parallelism, [&](size_t i) {
+    file_sizes[i] = Files::GetFileSize(file_paths[i]);
+  });
+  return file_sizes;
+}
+
+std::vector<std::optional<std::string>> ComputeContentHashes(
+    absl::Span<const FilePath> file_paths, int max_parallelism) {
+  std::vector<std::optional<std::string>> content_hashes(file_paths.size());
+  RunInParallel(file_paths.size(), max_parallelism, [&](size_t i) {
+    content_hashes[i] = ComputeContentHash(file_paths[i]);
+  });
+  return content_hashes;
+}
+
+}  // namespace nearby::sharing
@@ -0,0 +1,44 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_NEARBY_SHARING_FILE_PREPARATION_H_
+#define THIRD_PARTY_NEARBY_SHARING_FILE_PREPARATION_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "internal/base/file_path.h"
+
+namespace nearby::sharing {
+
+// Reads what an outgoing share needs to know about its files before the
+// transfer starts. The files are read on up to `max_parallelism` threads, so
+// that shares of many files on slow file systems don't wait for each file in
+// turn. The calling thread blocks until all files are read. Results are in the
+// order of `file_paths`.
+
+// Returns the size of each file, or nullopt if it can't be read.
+std::vector<std::optional<uintmax_t>> GetFileSizes(
+    absl::Span<const FilePath> file_paths, int max_parallelism);
+
+// Returns ComputeContentHash() of each file.
+std::vector<std::optional<std::string>> ComputeContentHashes(
+    absl::Span<const FilePath> file_paths, int max_parallelism);
+
+}  // namespace nearby::sharing
+
+#endif  // THIRD_PARTY_NEARBY_SHARING_FILE_PREPARATION_H_
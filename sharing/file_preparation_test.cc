@@ -0,0 +1,91 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sharing/file_preparation.h"
+
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "internal/base/file_path.h"
+#include "internal/base/files.h"
+#include "sharing/content_index.h"
+
+namespace nearby::sharing {
+namespace {
+
+class FilePreparationTest : public ::testing::TestWithParam<int> {
+ protected:
+  void SetUp() override {
+    directory_ = Files::GetTemporaryDirectory().append(
+        FilePath(absl::StrCat("FilePreparationTest", GetParam())));
+    Files::RemoveDirectory(directory_);
+    ASSERT_TRUE(Files::CreateDirectories(directory_));
+    // Every third file doesn't exist.
+    for (int i = 0; i < 50; ++i) {
+      FilePath path =
+          FilePath(directory_).append(FilePath(absl::StrCat("file", i)));
+      if (i % 3 != 0) {
+        std::ofstream out(path.GetPath(), std::ios::binary);
+        out << std::string(i * 100, 'a' + i % 26);
+      }
+      file_paths_.push_back(path);
+    }
+  }
+
+  void TearDown() override { Files::RemoveDirectory(directory_); }
+
+  FilePath directory_;
+  std::vector<FilePath> file_paths_;
+};
+
+TEST_P(FilePreparationTest, GetsFileSizesInOrder) {
+  std::vector<std::optional<uintmax_t>> file_sizes =
+      GetFileSizes(file_paths_, /*max_parallelism=*/GetParam());
+
+  ASSERT_EQ(file_sizes.size(), file_paths_.size());
+  for (int i = 0; i < file_paths_.size(); ++i) {
+    if (i % 3 == 0) {
+      EXPECT_FALSE(file_sizes[i].has_value());
+    } else {
+      EXPECT_EQ(file_sizes[i], i * 100);
+    }
+  }
+}
+
+TEST_P(FilePreparationTest, ComputesContentHashesInOrder) {
+  std::vector<std::optional<std::string>> content_hashes =
+      ComputeContentHashes(file_paths_, /*max_parallelism=*/GetParam());
+
+  ASSERT_EQ(content_hashes.size(), file_paths_.size());
+  for (int i = 0; i < file_paths_.size(); ++i) {
+    EXPECT_EQ(content_hashes[i], ComputeContentHash(file_paths_[i]));
+  }
+}
+
+TEST_P(FilePreparationTest, HandlesNoFiles) {
+  EXPECT_TRUE(GetFileSizes({}, /*max_parallelism=*/GetParam()).empty());
+  EXPECT_TRUE(
+      ComputeContentHashes({}, /*max_parallelism=*/GetParam()).empty());
+}
+
+INSTANTIATE_TEST_SUITE_P(FilePreparationTest, FilePreparationTest,
+                         ::testing::Values(0, 1, 4, 100));
+
+}  // namespace
+}  // namespace nearby::sharing
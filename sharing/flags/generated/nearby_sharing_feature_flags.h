@@ -98,6 +98,32 @@ constexpr auto kEnableMiniPulse =
 // When true, enables notifications implemented in native code.
 constexpr auto kEnableNativeNotifications =
     flags::Flag<bool>(kConfigPackage, "45743135", false);
+// When true, small files sent to a receiver that announces support for file
+// bundles are packed into bundles, and each bundle is sent as one payload.
+constexpr auto kEnableSmallFileBundling =
+    flags::Flag<bool>(kConfigPackage, "45790110", false);
+// The maximum number of payloads of an outgoing share that are handed to
+// Nearby Connections before the earlier ones finish, so that the next payload
+// is queued while the current one is written. Nearby Connections still writes
+// the file payloads one at a time.
+constexpr auto kMaxQueuedOutgoingPayloads =
+    flags::Flag<int64_t>(kConfigPackage, "45790111", 1);
+// The maximum number of discovered endpoints whose advertisements are being
+// processed at the same time. Events of the same endpoint are always processed
+// in order.
+constexpr auto kMaxConcurrentEndpointDiscoveryEvents =
+    flags::Flag<int64_t>(kConfigPackage, "45790112", 1);
+// When true, receivers announce in their paired key result that they look up
+// content hashes, senders include the content hash of each file in the
+// introduction for such receivers, and receivers complete the files they
+// already received from the same sender from a local copy instead of receiving
+// them again.
+constexpr auto kEnableContentDeduplication =
+    flags::Flag<bool>(kConfigPackage, "45790113", false);
+// The maximum number of files of an outgoing share that are read at the same
+// time to get their sizes and content hashes before the transfer starts.
+constexpr auto kMaxConcurrentFilePreparations =
+    flags::Flag<int64_t>(kConfigPackage, "45790114", 4);
 
 inline absl::btree_map<int, const flags::Flag<bool>&> GetBoolFlags() {
   return {
@@ -117,6 +143,8 @@ inline absl::btree_map<int, const flags::Flag<bool>&> GetBoolFlags() {
       {45720206, kEnableFlutterHooks},
       {45724244, kEnableMiniPulse},
       {45743135, kEnableNativeNotifications},
+      {45790110, kEnableSmallFileBundling},
+      {45790113, kEnableContentDeduplication},
   };
 }
 
@@ -127,6 +155,9 @@ inline absl::btree_map<int, const flags::Flag<int64_t>&> GetInt64Flags() {
       {45658774, kDiscoveryCacheLostExpiryMs},
       {45663103, kUnregisterTargetDiscoveryCacheLostExpiryMs},
       {45668886, kConflictBannerTimeout},
+      {45790111, kMaxQueuedOutgoingPayloads},
+      {45790112, kMaxConcurrentEndpointDiscoveryEvents},
+      {45790114, kMaxConcurrentFilePreparations},
   };
 }
 
@@ -25,15 +25,20 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/functional/any_invocable.h"
+#include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "internal/base/file_path.h"
+#include "internal/base/files.h"
 #include "internal/platform/clock.h"
 #include "internal/platform/task_runner.h"
 #include "sharing/analytics/analytics_recorder.h"
 #include "sharing/attachment_container.h"
 #include "sharing/constants.h"
+#include "sharing/content_index.h"
 #include "sharing/file_attachment.h"
+#include "sharing/file_bundle.h"
 #include "location/nearby/sharing/lib/sync/sync_manager.h"
 #include "sharing/internal/public/logging.h"
 #include "sharing/nearby_connection.h"
@@ -113,6 +118,15 @@ IncomingShareSession::ProcessIntroduction(
         FileAttachment(file.id(), file.size(), file.name(), file.mime_type(),
                        file.type(), file.parent_folder()));
     SetAttachmentPayloadId(file.id(), file.payload_id());
+    if (file.has_bundle_offset()) {
+      if (file.bundle_offset() < 0) {
+        LOG(WARNING) << "Ignore introduction, due to invalid bundle offset";
+        return TransferMetadata::Status::kUnsupportedAttachmentType;
+      }
+      bundle_offsets_.emplace(file.id(), file.bundle_offset());
+    } else if (!file.content_hash().empty()) {
+      content_hashes_.emplace(file.id(), file.content_hash());
+    }
 
     if (std::numeric_limits<int64_t>::max() - file.size() < file_size_sum) {
       LOG(WARNING) << "Ignoring introduction, total file size overflowed 64 "
@@ -244,6 +258,7 @@ bool IncomingShareSession::AcceptTransfer(
     return false;
   }
   ready_for_accept_ = false;
+  std::vector<int64_t> deduplicated_attachment_ids = DeduplicateFiles();
   InitializePayloadTracker(std::move(payload_transfer_updates_callback));
   const absl::flat_hash_map<int64_t, int64_t>& payload_map =
       attachment_payload_map();
@@ -258,8 +273,10 @@ bool IncomingShareSession::AcceptTransfer(
     VLOG(1) << __func__ << ": Accepted incoming files from share target - "
             << share_target().id;
   }
-  WriteResponseFrame(ConnectionResponseFrame::ACCEPT);
+  WriteResponseFrame(ConnectionResponseFrame::ACCEPT,
+                     deduplicated_attachment_ids);
   VLOG(1) << __func__ << ": Successfully wrote response frame";
+  CompleteDeduplicatedPayloads(deduplicated_attachment_ids);
   // Log analytics event of responding to introduction.
   analytics_recorder().NewRespondToIntroduction(
       ResponseToIntroduction::ACCEPT_INTRODUCTION, session_id());
@@ -309,12 +326,51 @@ bool IncomingShareSession::UpdateFilePayloadPaths() {
     }
 
     FilePath file_path = incoming_payload->content.file_payload.file_path;
+    if (bundle_offsets_.contains(file.id())) {
+      // Bundled files get their own path once they are unpacked.
+      file_bundle_paths_.insert_or_assign(it->second, file_path);
+      continue;
+    }
     VLOG(1) << __func__ << ": Updated file_path=" << file_path.ToString();
     file.set_file_path(file_path);
   }
   return result;
 }
 
+bool IncomingShareSession::UnpackFileBundles() {
+  AttachmentContainer& container = mutable_attachment_container();
+  for (int i = 0; i < container.GetFileAttachments().size(); ++i) {
+    FileAttachment& file = container.GetMutableFileAttachment(i);
+    const auto offset_it = bundle_offsets_.find(file.id());
+    if (offset_it == bundle_offsets_.end() || file.file_path().has_value()) {
+      continue;
+    }
+    const auto bundle_it =
+        file_bundle_paths_.find(attachment_payload_map().at(file.id()));
+    if (bundle_it == file_bundle_paths_.end()) {
+      LOG(WARNING) << "No file bundle found for file attachment: "
+                   << file.id();
+      return false;
+    }
+    // The bundle was received where an unbundled file would have been.
+    std::optional<FilePath> file_path = ExtractFileFromBundle(
+        bundle_it->second, offset_it->second, file.size(),
+        bundle_it->second.GetParentPath(), file.parent_folder(),
+        file.file_name());
+    if (!file_path.has_value()) {
+      LOG(WARNING) << "Failed to unpack file attachment: " << file.id();
+      return false;
+    }
+    VLOG(1) << __func__ << ": Unpacked file_path=" << file_path->ToString();
+    file.set_file_path(*file_path);
+  }
+  for (const auto& [payload_id, bundle_path] : file_bundle_paths_) {
+    Files::RemoveFile(bundle_path);
+  }
+  file_bundle_paths_.clear();
+  return true;
+}
+
 bool IncomingShareSession::UpdatePayloadContents() {
   if (!UpdateFilePayloadPaths()) {
     return false;
@@ -390,11 +446,85 @@ bool IncomingShareSession::UpdatePayloadContents() {
   return true;
 }
 
+void IncomingShareSession::SetContentIndex(ContentIndex* content_index,
+                                           FilePath save_path) {
+  content_index_ = content_index;
+  save_path_ = std::move(save_path);
+}
+
+std::optional<std::string> IncomingShareSession::GetContentIndexSender()
+    const {
+  if (!certificate().has_value()) {
+    return std::nullopt;
+  }
+  const std::string& account =
+      certificate()->unencrypted_metadata().obfuscated_gaia_id();
+  if (!account.empty()) {
+    return absl::StrCat("account:", account);
+  }
+  const std::vector<uint8_t>& id = certificate()->id();
+  if (id.empty()) {
+    return std::nullopt;
+  }
+  return absl::StrCat("certificate:", std::string(id.begin(), id.end()));
+}
+
+std::vector<int64_t> IncomingShareSession::DeduplicateFiles() {
+  std::vector<int64_t> deduplicated_attachment_ids;
+  std::optional<std::string> sender = GetContentIndexSender();
+  if (content_index_ == nullptr || !sender.has_value()) {
+    return deduplicated_attachment_ids;
+  }
+  AttachmentContainer& container = mutable_attachment_container();
+  for (int i = 0; i < container.GetFileAttachments().size(); ++i) {
+    FileAttachment& file = container.GetMutableFileAttachment(i);
+    const auto hash_it = content_hashes_.find(file.id());
+    if (hash_it == content_hashes_.end()) {
+      continue;
+    }
+    std::optional<FilePath> source =
+        content_index_->Find(*sender, hash_it->second, file.size());
+    if (!source.has_value()) {
+      continue;
+    }
+    std::optional<FilePath> file_path = LinkOrCopyReceivedFile(
+        *source, save_path_, file.parent_folder(), file.file_name());
+    if (!file_path.has_value()) {
+      continue;
+    }
+    VLOG(1) << __func__ << ": Copied " << source->ToString() << " to "
+            << file_path->ToString() << " for attachment " << file.id();
+    file.set_file_path(*file_path);
+    deduplicated_attachment_ids_.insert(file.id());
+    deduplicated_attachment_ids.push_back(file.id());
+  }
+  return deduplicated_attachment_ids;
+}
+
+void IncomingShareSession::IndexReceivedFiles() {
+  std::optional<std::string> sender = GetContentIndexSender();
+  if (content_index_ == nullptr || !sender.has_value()) {
+    return;
+  }
+  for (const FileAttachment& file :
+       attachment_container().GetFileAttachments()) {
+    const auto hash_it = content_hashes_.find(file.id());
+    if (hash_it == content_hashes_.end() || !file.file_path().has_value() ||
+        deduplicated_attachment_ids_.contains(file.id())) {
+      continue;
+    }
+    // The index checks the hash before returning a file, so a wrong hash from
+    // the sender only costs a lookup.
+    content_index_->Add(*sender, hash_it->second, *file.file_path());
+  }
+}
+
 bool IncomingShareSession::FinalizePayloads() {
-  if (!UpdatePayloadContents()) {
+  if (!UpdatePayloadContents() || !UnpackFileBundles()) {
     mutable_attachment_container().ClearAttachments();
     return false;
   }
+  IndexReceivedFiles();
   return true;
 }
 
@@ -413,6 +543,10 @@ std::vector<FilePath> IncomingShareSession::GetPayloadFilePaths()
     }
     file_paths.push_back(file_path);
   }
+  // File bundles are left only if the transfer did not complete.
+  for (const auto& [payload_id, bundle_path] : file_bundle_paths_) {
+    file_paths.push_back(bundle_path);
+  }
   return file_paths;
 }
 
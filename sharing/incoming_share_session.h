@@ -15,17 +15,21 @@
 #ifndef THIRD_PARTY_NEARBY_SHARING_INCOMING_SHARE_SESSION_H_
 #define THIRD_PARTY_NEARBY_SHARING_INCOMING_SHARE_SESSION_H_
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/functional/any_invocable.h"
 #include "internal/base/file_path.h"
 #include "internal/platform/clock.h"
 #include "internal/platform/task_runner.h"
 #include "sharing/analytics/analytics_recorder.h"
+#include "sharing/content_index.h"
 #include "sharing/nearby_connection.h"
 #include "sharing/nearby_connections_manager.h"
 #include "sharing/nearby_connections_types.h"
@@ -55,6 +59,18 @@ class IncomingShareSession : public ShareSession {
 
   bool IsIncoming() const override { return true; }
 
+  // Looks up the files of the transfer in `content_index`, and copies the
+  // ones already received before to `save_path` instead of receiving them
+  // again. Received files are added to `content_index`, which must outlive
+  // the session. Must be called before AcceptTransfer().
+  void SetContentIndex(ContentIndex* content_index, FilePath save_path);
+
+  // Returns the sender under which files of this session are looked up in
+  // and added to the content index: the sender's account if its certificate
+  // has one, and otherwise the certificate itself. Returns nullopt if the
+  // sender is unknown, in which case the index is not used.
+  std::optional<std::string> GetContentIndexSender() const;
+
   // Returns nullopt on success.
   // On failure, returns the status that should be used to terminate the
   // connection.
@@ -121,6 +137,18 @@ class IncomingShareSession : public ShareSession {
   // Copy payload contents from the NearbyConnection to the Attachment.
   bool UpdatePayloadContents();
 
+  // Extracts the files received in file bundles next to their bundle, and
+  // deletes the bundles.
+  // Returns true if all bundled files were extracted.
+  bool UnpackFileBundles();
+
+  // Copies the files found in the content index to the save path, and returns
+  // their attachment ids.
+  std::vector<int64_t> DeduplicateFiles();
+
+  // Adds the received files to the content index.
+  void IndexReceivedFiles();
+
   // Once transfer has completed, make payload content available in the
   // corresponding Attachment.
   // Returns true if all payloads were successfully finalized.
@@ -136,6 +164,18 @@ class IncomingShareSession : public ShareSession {
   std::unique_ptr<ThreadTimer> mutual_acceptance_timeout_;
 
   SessionPhase session_phase_ = SessionPhase::kUninitialized;
+
+  // Offset in its file bundle of each bundled file attachment.
+  absl::flat_hash_map<int64_t, int64_t> bundle_offsets_;
+  // Paths of the received file bundles, keyed by payload id.
+  absl::flat_hash_map<int64_t, FilePath> file_bundle_paths_;
+
+  ContentIndex* content_index_ = nullptr;
+  FilePath save_path_;
+  // Content hash sent by the sender for each unbundled file attachment.
+  absl::flat_hash_map<int64_t, std::string> content_hashes_;
+  // File attachments copied from the content index instead of being received.
+  absl::flat_hash_set<int64_t> deduplicated_attachment_ids_;
 };
 
 }  // namespace nearby::sharing
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <fstream>
 #include <limits>
 #include <memory>
 #include <optional>
@@ -34,11 +35,14 @@
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "internal/base/file_path.h"
+#include "internal/base/files.h"
 #include "internal/test/fake_clock.h"
 #include "internal/test/fake_device_info.h"
 #include "internal/test/fake_task_runner.h"
 #include "proto/sharing_enums.pb.h"
 #include "sharing/attachment_compare.h"  // IWYU pragma: keep
+#include "sharing/certificates/test_util.h"
+#include "sharing/content_index.h"
 #include "sharing/fake_nearby_connections_manager.h"
 #include "sharing/file_attachment.h"
 #include "sharing/internal/public/logging.h"
@@ -75,6 +79,7 @@ using ::nearby::sharing::service::proto::WifiCredentials;
 using ::nearby::sharing::service::proto::WifiCredentialsMetadata;
 using ::testing::_;
 using ::testing::AllOf;
+using ::testing::ElementsAre;
 using ::testing::Eq;
 using ::testing::IsEmpty;
 using ::testing::IsFalse;
@@ -1287,6 +1292,121 @@ TEST_F(IncomingShareSessionTest, AcceptTransferSuccess) {
             ConnectionResponseFrame::ACCEPT);
 }
 
+TEST_F(IncomingShareSessionTest, AcceptTransferDeduplicatesKnownFiles) {
+  FilePath directory = Files::GetTemporaryDirectory().append(
+      FilePath("AcceptTransferDeduplicatesKnownFiles"));
+  Files::RemoveDirectory(directory);
+  ASSERT_TRUE(Files::CreateDirectories(directory));
+  FilePath known_file = FilePath(directory).append(FilePath("known"));
+  {
+    std::ofstream out(known_file.GetPath(), std::ios::binary);
+    out << std::string(100, 'a');
+  }
+  std::optional<std::string> content_hash = ComputeContentHash(known_file);
+  ASSERT_TRUE(content_hash.has_value());
+  session_.set_certificate(GetNearbyShareTestDecryptedPublicCertificate());
+  std::optional<std::string> sender = session_.GetContentIndexSender();
+  ASSERT_TRUE(sender.has_value());
+  ContentIndex content_index(FilePath(directory).append(FilePath("index")));
+  content_index.Add(*sender, *content_hash, known_file);
+  introduction_frame_.mutable_file_metadata(0)->set_content_hash(
+      *content_hash);
+  session_.SetContentIndex(&content_index, directory);
+  connections_manager_.AcceptConnection(
+      /*endpoint_info=*/{}, kEndpointId, &connection_);
+  session_.OnConnected(&connection_);
+  EXPECT_THAT(session_.ProcessIntroduction(introduction_frame_),
+              Eq(std::nullopt));
+  EXPECT_THAT(
+      session_.ReadyForTransfer(
+          []() {}, [](bool is_timeout, std::optional<V1Frame> frame) {}),
+      IsFalse());
+  std::queue<std::vector<uint8_t>> frames_data;
+  connections_manager_.set_send_payload_callback(
+      [&](std::unique_ptr<Payload> payload,
+          std::weak_ptr<NearbyConnectionsManager::PayloadStatusListener>
+              listener) {
+        frames_data.push(std::move(payload->content.bytes_payload.bytes));
+      });
+
+  EXPECT_THAT(session_.AcceptTransfer([]() {}), IsTrue());
+
+  std::vector<uint8_t> frame_data = frames_data.front();
+  Frame frame;
+  ASSERT_TRUE(frame.ParseFromArray(frame_data.data(), frame_data.size()));
+  EXPECT_THAT(frame.v1().connection_response().deduplicated_attachment_ids(),
+              ElementsAre(1234));
+  const FileAttachment& file =
+      session_.attachment_container().GetFileAttachments()[0];
+  ASSERT_TRUE(file.file_path().has_value());
+  EXPECT_EQ(file.file_path()->ToString(),
+            FilePath(directory)
+                .append(FilePath("parent_folder1"))
+                .append(FilePath("file_name1"))
+                .ToString());
+  EXPECT_FALSE(session_.attachment_container()
+                   .GetFileAttachments()[1]
+                   .file_path()
+                   .has_value());
+  Files::RemoveDirectory(directory);
+}
+
+TEST_F(IncomingShareSessionTest,
+       AcceptTransferDoesNotDeduplicateFilesFromOtherSenders) {
+  FilePath directory = Files::GetTemporaryDirectory().append(
+      FilePath("AcceptTransferDoesNotDeduplicateFilesFromOtherSenders"));
+  Files::RemoveDirectory(directory);
+  ASSERT_TRUE(Files::CreateDirectories(directory));
+  FilePath known_file = FilePath(directory).append(FilePath("known"));
+  {
+    std::ofstream out(known_file.GetPath(), std::ios::binary);
+    out << std::string(100, 'a');
+  }
+  std::optional<std::string> content_hash = ComputeContentHash(known_file);
+  ASSERT_TRUE(content_hash.has_value());
+  session_.set_certificate(GetNearbyShareTestDecryptedPublicCertificate());
+  ContentIndex content_index(FilePath(directory).append(FilePath("index")));
+  content_index.Add("account:other", *content_hash, known_file);
+  introduction_frame_.mutable_file_metadata(0)->set_content_hash(
+      *content_hash);
+  session_.SetContentIndex(&content_index, directory);
+  connections_manager_.AcceptConnection(
+      /*endpoint_info=*/{}, kEndpointId, &connection_);
+  session_.OnConnected(&connection_);
+  EXPECT_THAT(session_.ProcessIntroduction(introduction_frame_),
+              Eq(std::nullopt));
+  EXPECT_THAT(
+      session_.ReadyForTransfer(
+          []() {}, [](bool is_timeout, std::optional<V1Frame> frame) {}),
+      IsFalse());
+  std::queue<std::vector<uint8_t>> frames_data;
+  connections_manager_.set_send_payload_callback(
+      [&](std::unique_ptr<Payload> payload,
+          std::weak_ptr<NearbyConnectionsManager::PayloadStatusListener>
+              listener) {
+        frames_data.push(std::move(payload->content.bytes_payload.bytes));
+      });
+
+  EXPECT_THAT(session_.AcceptTransfer([]() {}), IsTrue());
+
+  std::vector<uint8_t> frame_data = frames_data.front();
+  Frame frame;
+  ASSERT_TRUE(frame.ParseFromArray(frame_data.data(), frame_data.size()));
+  EXPECT_THAT(frame.v1().connection_response().deduplicated_attachment_ids(),
+              IsEmpty());
+  EXPECT_FALSE(session_.attachment_container()
+                   .GetFileAttachments()[0]
+                   .file_path()
+                   .has_value());
+  Files::RemoveDirectory(directory);
+}
+
+TEST_F(IncomingShareSessionTest, GetContentIndexSenderNeedsCertificate) {
+  EXPECT_THAT(session_.GetContentIndexSender(), Eq(std::nullopt));
+  session_.set_certificate(GetNearbyShareTestDecryptedPublicCertificate());
+  EXPECT_TRUE(session_.GetContentIndexSender().has_value());
+}
+
 TEST_F(IncomingShareSessionTest, TryUpgradeBandwidthNotNeeded) {
   session_.OnConnected(&connection_);
 
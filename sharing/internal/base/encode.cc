@@ -16,26 +16,19 @@
 
 #include <stdint.h>
 
-#include <iomanip>
-#include <ios>
-#include <sstream>
 #include <string>
 
+#include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "internal/encoding/codec.h"
 
 namespace nearby {
 namespace utils {
 
 // Returns uppercase string.
 std::string HexEncode(absl::Span<const uint8_t> data) {
-  std::ostringstream stream;
-  stream << std::hex << std::setfill('0') << std::uppercase;
-
-  for (uint8_t val : data) {
-    stream << std::setw(2) << static_cast<int>(val);
-  }
-
-  return stream.str();
+  return encoding::HexEncode(absl::string_view(
+      reinterpret_cast<const char*>(data.data()), data.size()));
 }
 
 }  // namespace utils
@@ -65,6 +65,7 @@
 #include "sharing/common/nearby_share_enums.h"
 #include "sharing/common/nearby_share_prefs.h"
 #include "sharing/constants.h"
+#include "sharing/content_index.h"
 #include "sharing/fast_initiation/nearby_fast_initiation.h"
 #include "sharing/fast_initiation/nearby_fast_initiation_impl.h"
 #include "sharing/file_attachment.h"
@@ -147,6 +148,7 @@ constexpr absl::Duration kCertificateDownloadDuringDiscoveryPeriod =
 constexpr absl::string_view kConnectionListenerName = "nearby-share-service";
 constexpr absl::string_view kScreenStateListenerName = "nearby-share-service";
 constexpr absl::string_view kProfileRelativePath = "Google/Nearby/Sharing";
+constexpr absl::string_view kContentIndexFileName = "content_index";
 
 // Using the alphanumeric characters below, this provides 36^10 unique device
 // IDs. Note that the uniqueness requirement is not global; the IDs are only
@@ -303,6 +305,8 @@ NearbySharingServiceImpl::NearbySharingServiceImpl(
   certificate_manager_ = NearbyShareCertificateManagerImpl::Factory::Create(
       context_, sharing_platform, local_device_data_manager_.get(),
       profile_path, nearby_identity_client);
+  content_index_ = std::make_unique<ContentIndex>(
+      FilePath(profile_path).append(FilePath(kContentIndexFileName)));
 
   certificate_manager_->AddObserver(this);
   context_->GetConnectivityManager()->RegisterLanListener(
@@ -382,7 +386,9 @@ bool NearbySharingServiceImpl::IsShuttingDown() {
 void NearbySharingServiceImpl::Cleanup() {
   SetInHighVisibility(false);
 
-  endpoint_discovery_events_ = {};
+  endpoint_discovery_events_.clear();
+  waiting_endpoint_discovery_events_.clear();
+  running_endpoint_discovery_events_ = 0;
 
   outgoing_targets_manager_.Cleanup();
   for (auto& it : incoming_share_session_map_) {
@@ -1373,18 +1379,20 @@ void NearbySharingServiceImpl::OnEndpointDiscovered(
       "on_endpoint_discovered",
       [this, start_time, endpoint_id = std::string(endpoint_id),
        endpoint_info_copy = std::move(endpoint_info_copy)]() {
-        AddEndpointDiscoveryEvent([this, start_time, endpoint_id,
-                                   endpoint_info_copy]() {
-          HandleEndpointDiscovered(start_time, endpoint_id, endpoint_info_copy);
-        });
+        AddEndpointDiscoveryEvent(
+            endpoint_id, [this, start_time, endpoint_id, endpoint_info_copy]() {
+              HandleEndpointDiscovered(start_time, endpoint_id,
+                                       endpoint_info_copy);
+            });
       });
 }
 
 void NearbySharingServiceImpl::OnEndpointLost(absl::string_view endpoint_id) {
   RunOnNearbySharingServiceThread(
       "on_endpoint_lost", [this, endpoint_id = std::string(endpoint_id)]() {
-        AddEndpointDiscoveryEvent(
-            [this, endpoint_id]() { HandleEndpointLost(endpoint_id); });
+        AddEndpointDiscoveryEvent(endpoint_id, [this, endpoint_id]() {
+          HandleEndpointLost(endpoint_id);
+        });
       });
 }
 
@@ -1599,19 +1607,51 @@ void NearbySharingServiceImpl::OnStopFastInitiationAdvertising() {
   VLOG(1) << __func__ << ": Stopped fast initiation advertising";
 }
 
-// Processes endpoint discovered/lost events. We queue up the events to ensure
-// each discovered or lost event is fully handled before the next is run. For
-// example, we don't want to start processing an endpoint-lost event before
-// the corresponding endpoint-discovered event is finished. This is especially
-// important because of the asynchronous steps required to process an
-// endpoint-discovered event.
+// Processes endpoint discovered/lost events. We queue up the events of each
+// endpoint to ensure each discovered or lost event is fully handled before the
+// next one of the same endpoint is run. For example, we don't want to start
+// processing an endpoint-lost event before the corresponding
+// endpoint-discovered event is finished. This is especially important because
+// of the asynchronous steps required to process an endpoint-discovered event.
+// Endpoints don't wait for each other, so that a slow certificate decryption
+// doesn't delay other share targets.
 void NearbySharingServiceImpl::AddEndpointDiscoveryEvent(
-    std::function<void()> event) {
-  endpoint_discovery_events_.push(std::move(event));
-  if (endpoint_discovery_events_.size() == 1u) {
-    auto discovery_event = std::move(endpoint_discovery_events_.front());
+    absl::string_view endpoint_id, std::function<void()> event) {
+  EndpointDiscoveryEvents& endpoint_events =
+      endpoint_discovery_events_[endpoint_id];
+  endpoint_events.events.push(std::move(event));
+  if (endpoint_events.events.size() == 1u) {
+    waiting_endpoint_discovery_events_.push_back(std::string(endpoint_id));
+    RunEndpointDiscoveryEvents();
+  }
+}
+
+void NearbySharingServiceImpl::RunEndpointDiscoveryEvents() {
+  if (is_starting_endpoint_discovery_events_) {
+    return;
+  }
+  is_starting_endpoint_discovery_events_ = true;
+  int64_t max_running_events = std::max<int64_t>(
+      1, NearbyFlags::GetInstance().GetInt64Flag(
+             config_package_nearby::nearby_sharing_feature::
+                 kMaxConcurrentEndpointDiscoveryEvents));
+  while (running_endpoint_discovery_events_ < max_running_events &&
+         !waiting_endpoint_discovery_events_.empty()) {
+    std::string endpoint_id =
+        std::move(waiting_endpoint_discovery_events_.front());
+    waiting_endpoint_discovery_events_.pop_front();
+    auto it = endpoint_discovery_events_.find(endpoint_id);
+    if (it == endpoint_discovery_events_.end() || it->second.running ||
+        it->second.events.empty()) {
+      continue;
+    }
+    it->second.running = true;
+    ++running_endpoint_discovery_events_;
+    // The event may finish synchronously and erase the queue.
+    auto discovery_event = std::move(it->second.events.front());
     discovery_event();
   }
+  is_starting_endpoint_discovery_events_ = false;
 }
 
 void NearbySharingServiceImpl::HandleEndpointDiscovered(
@@ -1624,7 +1664,7 @@ void NearbySharingServiceImpl::HandleEndpointDiscovered(
     VLOG(1)
         << __func__
         << ": Ignoring discovered endpoint because we're no longer scanning";
-    FinishEndpointDiscoveryEvent();
+    FinishEndpointDiscoveryEvent(endpoint_id);
     return;
   }
 
@@ -1632,7 +1672,7 @@ void NearbySharingServiceImpl::HandleEndpointDiscovered(
       DecodeAdvertisement(endpoint_info);
   if (!advertisement) {
     LOG(WARNING) << __func__ << ": Failed to parse discovered advertisement.";
-    FinishEndpointDiscoveryEvent();
+    FinishEndpointDiscoveryEvent(endpoint_id);
     return;
   }
 
@@ -1677,7 +1717,7 @@ void NearbySharingServiceImpl::HandleEndpointLost(
   if (!is_scanning_) {
     VLOG(1) << __func__
             << ": Ignoring lost endpoint because we're no longer scanning";
-    FinishEndpointDiscoveryEvent();
+    FinishEndpointDiscoveryEvent(endpoint_id);
     return;
   }
 
@@ -1688,20 +1728,28 @@ void NearbySharingServiceImpl::HandleEndpointLost(
       Milliseconds(NearbyFlags::GetInstance().GetInt64Flag(
           config_package_nearby::nearby_sharing_feature::
               kDiscoveryCacheLostExpiryMs)));
-  FinishEndpointDiscoveryEvent();
+  FinishEndpointDiscoveryEvent(endpoint_id);
 }
 
-void NearbySharingServiceImpl::FinishEndpointDiscoveryEvent() {
-  DCHECK(!endpoint_discovery_events_.empty());
-  DCHECK(endpoint_discovery_events_.front() == nullptr);
-  endpoint_discovery_events_.pop();
+void NearbySharingServiceImpl::FinishEndpointDiscoveryEvent(
+    absl::string_view endpoint_id) {
+  auto it = endpoint_discovery_events_.find(endpoint_id);
+  // The queues are dropped by Cleanup() while events are being processed.
+  if (it == endpoint_discovery_events_.end() || !it->second.running) {
+    return;
+  }
+  it->second.running = false;
+  --running_endpoint_discovery_events_;
+  it->second.events.pop();
 
-  // Handle the next queued up endpoint discovered/lost event.
-  if (!endpoint_discovery_events_.empty()) {
-    DCHECK(endpoint_discovery_events_.front() != nullptr);
-    auto discovery_event = std::move(endpoint_discovery_events_.front());
-    discovery_event();
+  // Queue the next endpoint discovered/lost event of this endpoint behind the
+  // endpoints that are already waiting.
+  if (it->second.events.empty()) {
+    endpoint_discovery_events_.erase(it);
+  } else {
+    waiting_endpoint_discovery_events_.push_back(std::string(endpoint_id));
   }
+  RunEndpointDiscoveryEvents();
 }
 
 void NearbySharingServiceImpl::LogShareTargetDiscovered(
@@ -1763,7 +1811,7 @@ void NearbySharingServiceImpl::OnOutgoingDecryptedCertificate(
           << __func__
           << ": Don't try to download public certificates again for endpoint="
           << endpoint_id;
-      FinishEndpointDiscoveryEvent();
+      FinishEndpointDiscoveryEvent(endpoint_id);
       return;
     }
 
@@ -1775,13 +1823,13 @@ void NearbySharingServiceImpl::OnOutgoingDecryptedCertificate(
                                             endpoint_info.end());
 
     discovered_advertisements_to_retry_map_[endpoint_id] = endpoint_info_data;
-    FinishEndpointDiscoveryEvent();
+    FinishEndpointDiscoveryEvent(endpoint_id);
     return;
   }
   LogShareTargetDiscovered(*share_target);
   outgoing_targets_manager_.OnShareTargetDiscovered(*share_target, endpoint_id,
                                                     std::move(certificate));
-  FinishEndpointDiscoveryEvent();
+  FinishEndpointDiscoveryEvent(endpoint_id);
 }
 
 void NearbySharingServiceImpl::ScheduleCertificateDownloadDuringDiscovery(
@@ -2383,14 +2431,6 @@ void NearbySharingServiceImpl::OnOutgoingTransferUpdate(
     }
   }
 
-  // check whether need to send next payload.
-  if (metadata.in_progress_attachment_transferred_bytes().has_value() &&
-      metadata.in_progress_attachment_total_bytes().has_value() &&
-      *metadata.in_progress_attachment_transferred_bytes() ==
-          *metadata.in_progress_attachment_total_bytes()) {
-    session.SendNextPayload();
-  }
-
   if (has_foreground_send_surface && metadata.is_final_status()) {
     last_outgoing_metadata_ = std::nullopt;
   } else {
@@ -2524,14 +2564,15 @@ void NearbySharingServiceImpl::OnIncomingSessionFrameRead(
 void NearbySharingServiceImpl::OnIncomingConnectionKeyVerificationDone(
     int64_t share_target_id,
     PairedKeyVerificationRunner::PairedKeyVerificationResult result,
-    OSType share_target_os_type) {
+    OSType share_target_os_type,
+    PairedKeyVerificationRunner::RemoteCapabilities share_target_capabilities) {
   IncomingShareSession* session = GetIncomingShareSession(share_target_id);
   if (!session || !session->IsConnected()) {
     VLOG(1) << __func__ << ": Invalid connection or endpoint id";
     return;
   }
-  if (!session->ProcessKeyVerificationResult(
-          result, share_target_os_type)) {
+  if (!session->ProcessKeyVerificationResult(result, share_target_os_type,
+                                             share_target_capabilities)) {
     session->Abort(TransferMetadata::Status::kDeviceAuthenticationFailed);
     return;
   }
@@ -2545,14 +2586,16 @@ void NearbySharingServiceImpl::OnIncomingConnectionKeyVerificationDone(
 void NearbySharingServiceImpl::OnOutgoingConnectionKeyVerificationDone(
     int64_t share_target_id,
     PairedKeyVerificationRunner::PairedKeyVerificationResult result,
-    OSType share_target_os_type) {
+    OSType share_target_os_type,
+    PairedKeyVerificationRunner::RemoteCapabilities share_target_capabilities) {
   OutgoingShareSession* session =
       outgoing_targets_manager_.GetOutgoingShareSession(share_target_id);
   if (!session || !session->IsConnected()) {
     return;
   }
 
-  if (!session->ProcessKeyVerificationResult(result, share_target_os_type)) {
+  if (!session->ProcessKeyVerificationResult(result, share_target_os_type,
+                                             share_target_capabilities)) {
     session->Abort(TransferMetadata::Status::kDeviceAuthenticationFailed);
     return;
   }
@@ -2733,6 +2776,11 @@ void NearbySharingServiceImpl::OnReceivedIntroduction(
   // received.
   nearby_connections_manager_->OverrideSavePath(session.endpoint_id(),
                                                 save_path);
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          sharing::config_package_nearby::nearby_sharing_feature::
+              kEnableContentDeduplication)) {
+    session.SetContentIndex(content_index_.get(), save_path);
+  }
 
   // Log analytics event of receiving introduction.
   analytics_recorder_.NewReceiveIntroduction(
@@ -19,6 +19,7 @@
 #include <stdint.h>
 
 #include <atomic>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -49,6 +50,7 @@
 #include "sharing/certificates/nearby_share_decrypted_public_certificate.h"
 #include "sharing/certificates/nearby_share_private_certificate.h"
 #include "sharing/common/nearby_share_enums.h"
+#include "sharing/content_index.h"
 #include "sharing/fast_initiation/nearby_fast_initiation.h"
 #include "sharing/incoming_share_session.h"
 #include "sharing/internal/api/app_info.h"
@@ -257,18 +259,24 @@ class NearbySharingServiceImpl
   void StopFastInitiationAdvertising();
   void OnStopFastInitiationAdvertising();
 
-  // Processes endpoint discovered/lost events. We queue up the events to ensure
-  // each discovered or lost event is fully handled before the next is run. For
-  // example, we don't want to start processing an endpoint-lost event before
-  // the corresponding endpoint-discovered event is finished. This is especially
-  // important because of the asynchronous steps required to process an
-  // endpoint-discovered event.
-  void AddEndpointDiscoveryEvent(std::function<void()> event);
+  // Processes endpoint discovered/lost events. We queue up the events of each
+  // endpoint to ensure each discovered or lost event is fully handled before
+  // the next one of the same endpoint is run. For example, we don't want to
+  // start processing an endpoint-lost event before the corresponding
+  // endpoint-discovered event is finished. This is especially important
+  // because of the asynchronous steps required to process an
+  // endpoint-discovered event. Events of different endpoints run concurrently,
+  // up to kMaxConcurrentEndpointDiscoveryEvents at a time.
+  void AddEndpointDiscoveryEvent(absl::string_view endpoint_id,
+                                 std::function<void()> event);
   void HandleEndpointDiscovered(absl::Time start_time,
                                 absl::string_view endpoint_id,
                                 absl::Span<const uint8_t> endpoint_info);
   void HandleEndpointLost(absl::string_view endpoint_id);
-  void FinishEndpointDiscoveryEvent();
+  void FinishEndpointDiscoveryEvent(absl::string_view endpoint_id);
+  // Starts the first queued event of waiting endpoints while there are free
+  // slots.
+  void RunEndpointDiscoveryEvents();
   void OnOutgoingDecryptedCertificate(
       absl::string_view endpoint_id, absl::Span<const uint8_t> endpoint_info,
       const Advertisement& advertisement,
@@ -317,11 +325,15 @@ class NearbySharingServiceImpl
   void OnIncomingConnectionKeyVerificationDone(
       int64_t share_target_id,
       PairedKeyVerificationRunner::PairedKeyVerificationResult result,
-      ::location::nearby::proto::sharing::OSType share_target_os_type);
+      ::location::nearby::proto::sharing::OSType share_target_os_type,
+      PairedKeyVerificationRunner::RemoteCapabilities
+          share_target_capabilities);
   void OnOutgoingConnectionKeyVerificationDone(
       int64_t share_target_id,
       PairedKeyVerificationRunner::PairedKeyVerificationResult result,
-      ::location::nearby::proto::sharing::OSType share_target_os_type);
+      ::location::nearby::proto::sharing::OSType share_target_os_type,
+      PairedKeyVerificationRunner::RemoteCapabilities
+          share_target_capabilities);
   void BeginOutgoingTransfer(OutgoingShareSession& session);
   void BeginOutgoingPairing(OutgoingShareSession& session);
   void OnIncomingSessionFrameRead(
@@ -438,6 +450,8 @@ class NearbySharingServiceImpl
       nearby_identity_client_;
   std::unique_ptr<NearbyShareLocalDeviceDataManager> local_device_data_manager_;
   std::unique_ptr<NearbyShareCertificateManager> certificate_manager_;
+  // Files received before, so that they aren't received again.
+  std::unique_ptr<ContentIndex> content_index_;
   std::unique_ptr<NearbyFastInitiation> nearby_fast_initiation_;
 
   // Used to maintain the settings of nearby sharing.
@@ -515,12 +529,24 @@ class NearbySharingServiceImpl
   // Used to debounce OnNetworkChanged processing.
   std::unique_ptr<ThreadTimer> on_network_changed_delay_timer_;
 
-  // A queue of endpoint-discovered and endpoint-lost events that ensures the
-  // events are processed sequentially, in the order received from Nearby
-  // Connections. An event is processed either immediately, if there are no
-  // other events in the queue, or as soon as the previous event processing
-  // finishes. When processing finishes, the event is removed from the queue.
-  std::queue<std::function<void()>> endpoint_discovery_events_;
+  // Queues of endpoint-discovered and endpoint-lost events, by endpoint id,
+  // that ensure the events of an endpoint are processed sequentially, in the
+  // order received from Nearby Connections. The first event of a queue is
+  // processed as soon as a slot is free, and removed from the queue when its
+  // processing finishes.
+  struct EndpointDiscoveryEvents {
+    std::queue<std::function<void()>> events;
+    // True while the first event is being processed.
+    bool running = false;
+  };
+  absl::flat_hash_map<std::string, EndpointDiscoveryEvents>
+      endpoint_discovery_events_;
+  // Endpoints whose first event waits for a slot, in arrival order.
+  std::deque<std::string> waiting_endpoint_discovery_events_;
+  int running_endpoint_discovery_events_ = 0;
+  // True while RunEndpointDiscoveryEvents() is starting events, so that events
+  // finishing synchronously don't start it again recursively.
+  bool is_starting_endpoint_discovery_events_ = false;
 
   // Shouldn't schedule new task after shutting down, and skip task if the
   // object is null.
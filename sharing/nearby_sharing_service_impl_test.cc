@@ -4070,6 +4070,78 @@ TEST_F(NearbySharingServiceImplTest, OrderedEndpointDiscoveryEvents) {
   }
 }
 
+TEST_F(NearbySharingServiceImplTest, ConcurrentEndpointDiscoveryEvents) {
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      config_package_nearby::nearby_sharing_feature::
+          kMaxConcurrentEndpointDiscoveryEvents,
+      2);
+  SetLanIsConnected(true);
+
+  MockTransferUpdateCallback transfer_callback;
+  MockShareTargetDiscoveredCallback discovery_callback;
+  EXPECT_EQ(RegisterSendSurface(&transfer_callback, &discovery_callback,
+                                SendSurfaceState::kForeground),
+            NearbySharingService::StatusCodes::kOk);
+  ScopedSendSurface s(service_.get(), &transfer_callback);
+  EXPECT_TRUE(fake_nearby_connections_manager_->IsDiscovering());
+
+  // Endpoints 1 and 2 are decrypted at the same time. Endpoint 3 waits for a
+  // free slot, and the lost event of endpoint 1 waits for its discovered
+  // event.
+  FindEndpoint(/*endpoint_id=*/"1");
+  FindEndpoint(/*endpoint_id=*/"2");
+  FindEndpoint(/*endpoint_id=*/"3");
+  LoseEndpoint(/*endpoint_id=*/"1");
+  std::vector<
+      FakeNearbyShareCertificateManager::GetDecryptedPublicCertificateCall>&
+      calls = certificate_manager()->get_decrypted_public_certificate_calls();
+  ASSERT_EQ(calls.size(), 2u);
+
+  // Endpoint 2 doesn't wait for the decryption of endpoint 1. Failed
+  // decryptions use the endpoint id as device id.
+  {
+    absl::Notification notification;
+    EXPECT_CALL(discovery_callback, OnShareTargetDiscovered)
+        .WillOnce([&](ShareTarget share_target) {
+          EXPECT_EQ(share_target.device_id, "2");
+          notification.Notify();
+        });
+    auto callback = std::move(calls[1].callback);
+    callback(std::nullopt);
+    FlushTesting();
+    EXPECT_TRUE(notification.WaitForNotificationWithTimeout(kWaitTimeout));
+  }
+  ASSERT_EQ(calls.size(), 3u);
+
+  {
+    absl::Notification notification;
+    EXPECT_CALL(discovery_callback, OnShareTargetDiscovered)
+        .WillOnce([&](ShareTarget share_target) {
+          EXPECT_EQ(share_target.device_id, "1");
+          notification.Notify();
+        });
+    auto callback = std::move(calls[0].callback);
+    callback(std::nullopt);
+    FlushTesting();
+    EXPECT_TRUE(notification.WaitForNotificationWithTimeout(kWaitTimeout));
+  }
+  // The lost event of endpoint 1 doesn't decrypt anything.
+  EXPECT_EQ(calls.size(), 3u);
+
+  {
+    absl::Notification notification;
+    EXPECT_CALL(discovery_callback, OnShareTargetDiscovered)
+        .WillOnce([&](ShareTarget share_target) {
+          EXPECT_EQ(share_target.device_id, "3");
+          notification.Notify();
+        });
+    auto callback = std::move(calls[2].callback);
+    callback(std::nullopt);
+    FlushTesting();
+    EXPECT_TRUE(notification.WaitForNotificationWithTimeout(kWaitTimeout));
+  }
+}
+
 TEST_F(NearbySharingServiceImplTest,
        RetryDiscoveredEndpointsNoDownloadIfDecryption) {
   // Start discovery.
@@ -14,6 +14,7 @@
 
 #include "sharing/outgoing_share_session.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -23,11 +24,15 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/functional/any_invocable.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "internal/base/file_path.h"
 #include "internal/base/files.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/clock.h"
 #include "internal/platform/task_runner.h"
 #include "sharing/analytics/analytics_recorder.h"
@@ -35,6 +40,9 @@
 #include "sharing/certificates/nearby_share_decrypted_public_certificate.h"
 #include "sharing/constants.h"
 #include "sharing/file_attachment.h"
+#include "sharing/file_bundle.h"
+#include "sharing/file_preparation.h"
+#include "sharing/flags/generated/nearby_sharing_feature_flags.h"
 #include "sharing/internal/public/logging.h"
 #include "sharing/nearby_connection.h"
 #include "sharing/nearby_connections_manager.h"
@@ -141,7 +149,7 @@ OutgoingShareSession::OutgoingShareSession(
 
 OutgoingShareSession::OutgoingShareSession(OutgoingShareSession&&) = default;
 
-OutgoingShareSession::~OutgoingShareSession() = default;
+OutgoingShareSession::~OutgoingShareSession() { RemoveFileBundles(); }
 
 void OutgoingShareSession::InvokeTransferUpdateCallback(
     const TransferMetadata& metadata) {
@@ -168,6 +176,10 @@ bool OutgoingShareSession::InitiateSendAttachments(
   text_payloads_.clear();
   wifi_credentials_payloads_.clear();
   file_payloads_.clear();
+  queued_payload_ids_.clear();
+  content_hashes_.clear();
+  deduplicated_attachment_ids_.clear();
+  RemoveFileBundles();
   CreateTextPayloads();
   CreateWifiCredentialsPayloads();
   bool success = CreateFilePayloads();
@@ -243,13 +255,24 @@ bool OutgoingShareSession::CreateFilePayloads() {
   }
   AttachmentContainer& container = mutable_attachment_container();
   file_payloads_.reserve(container.GetFileAttachments().size());
+  int max_parallelism = NearbyFlags::GetInstance().GetInt64Flag(
+      config_package_nearby::nearby_sharing_feature::
+          kMaxConcurrentFilePreparations);
+
+  // All file attachments must have a file path.
+  // That is verified in SendAttachments().
+  std::vector<FilePath> file_paths;
+  file_paths.reserve(container.GetFileAttachments().size());
+  for (const FileAttachment& attachment : container.GetFileAttachments()) {
+    file_paths.push_back(*attachment.file_path());
+  }
+  std::vector<std::optional<uintmax_t>> file_sizes =
+      GetFileSizes(file_paths, max_parallelism);
 
   for (int i = 0; i < container.GetFileAttachments().size(); ++i) {
     FileAttachment& attachment = container.GetMutableFileAttachment(i);
-    // All file attachments must have a file path.
-    // That is verified in SendAttachments().
-    FilePath file_path = *attachment.file_path();
-    std::optional<uintmax_t> file_size = Files::GetFileSize(file_path);
+    const FilePath& file_path = file_paths[i];
+    const std::optional<uintmax_t>& file_size = file_sizes[i];
     if (!file_size.has_value()) {
       LOG(WARNING) << "Failed to get file size for file: "
                    << file_path.ToString();
@@ -263,13 +286,145 @@ bool OutgoingShareSession::CreateFilePayloads() {
   return true;
 }
 
+bool OutgoingShareSession::PrepareFilePayloadsForReceiver() {
+  AttachmentContainer& container = mutable_attachment_container();
+  if (container.GetFileAttachments().empty()) {
+    return true;
+  }
+  if (remote_capabilities().supports_file_bundles &&
+      NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_sharing_feature::
+              kEnableSmallFileBundling)) {
+    std::vector<int> small_file_indices;
+    absl::flat_hash_set<int64_t> small_file_payload_ids;
+    for (int i = 0; i < container.GetFileAttachments().size(); ++i) {
+      const FileAttachment& attachment = container.GetFileAttachments()[i];
+      const auto payload_it = attachment_payload_map().find(attachment.id());
+      if (attachment.size() > kSmallFileBundlingMaxFileSize ||
+          payload_it == attachment_payload_map().end()) {
+        continue;
+      }
+      small_file_indices.push_back(i);
+      small_file_payload_ids.insert(payload_it->second);
+    }
+    // The bundles replace the payloads of the small files.
+    std::erase_if(file_payloads_,
+                  [&small_file_payload_ids](const Payload& payload) {
+                    return small_file_payload_ids.contains(payload.id);
+                  });
+    if (!CreateFileBundlePayloads(small_file_indices)) {
+      return false;
+    }
+  }
+  if (remote_capabilities().supports_content_deduplication &&
+      NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_sharing_feature::
+              kEnableContentDeduplication)) {
+    // Bundled files are cheap to send, and can't be left out of their bundle.
+    std::vector<int64_t> hashed_attachment_ids;
+    std::vector<FilePath> hashed_file_paths;
+    for (const FileAttachment& attachment : container.GetFileAttachments()) {
+      if (bundle_offsets_.contains(attachment.id())) {
+        continue;
+      }
+      hashed_attachment_ids.push_back(attachment.id());
+      hashed_file_paths.push_back(*attachment.file_path());
+    }
+    std::vector<std::optional<std::string>> content_hashes =
+        ComputeContentHashes(hashed_file_paths,
+                             NearbyFlags::GetInstance().GetInt64Flag(
+                                 config_package_nearby::nearby_sharing_feature::
+                                     kMaxConcurrentFilePreparations));
+    for (int i = 0; i < hashed_attachment_ids.size(); ++i) {
+      if (content_hashes[i].has_value()) {
+        content_hashes_.emplace(hashed_attachment_ids[i],
+                                *std::move(content_hashes[i]));
+      }
+    }
+  }
+  return true;
+}
+
+bool OutgoingShareSession::CreateFileBundlePayloads(
+    absl::Span<const int> file_indices) {
+  AttachmentContainer& container = mutable_attachment_container();
+  int begin = 0;
+  while (begin < file_indices.size()) {
+    // Fill the bundle up to its maximum size, in attachment order.
+    int end = begin;
+    int64_t bundle_size = 0;
+    while (end < file_indices.size()) {
+      int64_t file_size =
+          container.GetFileAttachments()[file_indices[end]].size();
+      if (end > begin &&
+          bundle_size + file_size > kSmallFileBundlingMaxBundleSize) {
+        break;
+      }
+      bundle_size += file_size;
+      ++end;
+    }
+
+    if (end - begin == 1) {
+      // Nothing to gain from a bundle of one file.
+      FileAttachment& attachment =
+          container.GetMutableFileAttachment(file_indices[begin]);
+      file_payloads_.push_back(
+          Payload(*attachment.file_path(), attachment.parent_folder()));
+      SetAttachmentPayloadId(attachment.id(), file_payloads_.back().id);
+      begin = end;
+      continue;
+    }
+
+    std::vector<FilePath> files;
+    std::vector<int64_t> file_sizes;
+    for (int i = begin; i < end; ++i) {
+      const FileAttachment& attachment =
+          container.GetFileAttachments()[file_indices[i]];
+      files.push_back(*attachment.file_path());
+      file_sizes.push_back(attachment.size());
+    }
+    FilePath bundle_path = Files::GetTemporaryDirectory().append(
+        FilePath(absl::StrCat("nearby_share_bundle_", session_id(), "_",
+                              file_bundle_paths_.size())));
+    if (!WriteFileBundle(files, file_sizes, bundle_path)) {
+      Files::RemoveFile(bundle_path);
+      return false;
+    }
+    VLOG(1) << "Bundled " << files.size() << " files in "
+            << bundle_path.ToString();
+    file_bundle_paths_.push_back(bundle_path);
+    file_payloads_.push_back(Payload(bundle_path));
+    int64_t offset = 0;
+    for (int i = begin; i < end; ++i) {
+      const FileAttachment& attachment =
+          container.GetFileAttachments()[file_indices[i]];
+      SetAttachmentPayloadId(attachment.id(), file_payloads_.back().id);
+      bundle_offsets_.emplace(attachment.id(), offset);
+      offset += attachment.size();
+    }
+    begin = end;
+  }
+  return true;
+}
+
+void OutgoingShareSession::RemoveFileBundles() {
+  for (const FilePath& bundle_path : file_bundle_paths_) {
+    Files::RemoveFile(bundle_path);
+  }
+  file_bundle_paths_.clear();
+  bundle_offsets_.clear();
+}
+
 bool OutgoingShareSession::FillIntroductionFrame(
     IntroductionFrame* introduction) const {
   const AttachmentContainer& container = attachment_container();
   if (!container.HasAttachments()) {
     return false;
   }
-  if (file_payloads_.size() != container.GetFileAttachments().size() ||
+  // Each file bundle replaces the payloads of the files in it.
+  if (file_payloads_.size() != container.GetFileAttachments().size() -
+                                   bundle_offsets_.size() +
+                                   file_bundle_paths_.size() ||
       text_payloads_.size() != container.GetTextAttachments().size() ||
       wifi_credentials_payloads_.size() !=
           container.GetWifiCredentialsAttachments().size()) {
@@ -280,10 +435,22 @@ bool OutgoingShareSession::FillIntroductionFrame(
       container.GetFileAttachments();
   for (int i = 0; i < file_attachments.size(); ++i) {
     const FileAttachment& file = file_attachments[i];
+    const auto payload_it = attachment_payload_map().find(file.id());
+    if (payload_it == attachment_payload_map().end()) {
+      return false;
+    }
     auto* file_metadata = introduction->add_file_metadata();
     file_metadata->set_id(file.id());
     file_metadata->set_name(file.file_name());
-    file_metadata->set_payload_id(file_payloads_[i].id);
+    file_metadata->set_payload_id(payload_it->second);
+    const auto bundle_it = bundle_offsets_.find(file.id());
+    if (bundle_it != bundle_offsets_.end()) {
+      file_metadata->set_bundle_offset(bundle_it->second);
+    }
+    const auto hash_it = content_hashes_.find(file.id());
+    if (hash_it != content_hashes_.end()) {
+      file_metadata->set_content_hash(hash_it->second);
+    }
     file_metadata->set_type(file.type());
     file_metadata->set_mime_type(file.mime_type());
     file_metadata->set_size(file.size());
@@ -376,26 +543,47 @@ void OutgoingShareSession::SendPayloads(
       advanced_protection_mismatch_);
   VLOG(1) << "The connection was accepted. Payloads are now being sent.";
   InitializePayloadTracker(std::move(payload_transder_update_callback));
-  SendNextPayload();
+  CompleteDeduplicatedPayloads(deduplicated_attachment_ids_);
+  max_queued_payloads_ = static_cast<int>(std::max<int64_t>(
+      1, NearbyFlags::GetInstance().GetInt64Flag(
+             config_package_nearby::nearby_sharing_feature::
+                 kMaxQueuedOutgoingPayloads)));
+  SendPayloadsUpToLimit();
 }
 
 void OutgoingShareSession::SendNextPayload() {
   std::optional<Payload> payload = ExtractNextPayload();
   if (payload.has_value()) {
-    LOG(INFO) << "Send  payload " << payload->id;
-    connections_manager().Send(
-        endpoint_id(), std::make_unique<Payload>(*payload), payload_tracker());
+    SendPayload(*payload);
   } else {
     LOG(WARNING) << "There is no paylaods to send.";
   }
 }
 
+void OutgoingShareSession::SendPayload(const Payload& payload) {
+  LOG(INFO) << "Send  payload " << payload.id;
+  queued_payload_ids_.insert(payload.id);
+  connections_manager().Send(
+      endpoint_id(), std::make_unique<Payload>(payload), payload_tracker());
+}
+
+void OutgoingShareSession::SendPayloadsUpToLimit() {
+  while (queued_payload_ids_.size() < max_queued_payloads_) {
+    std::optional<Payload> payload = ExtractNextPayload();
+    if (!payload.has_value()) {
+      return;
+    }
+    SendPayload(*payload);
+  }
+}
+
 void OutgoingShareSession::SendAttachmentsCompleted(
     const TransferMetadata& metadata) {
   if (!metadata.is_final_status()) {
     LOG(DFATAL) << "SendAttachmentsCompleted called with non-final status: "
                 << static_cast<int>(metadata.status());
   }
+  RemoveFileBundles();
   int64_t sent_bytes = attachment_container().GetTotalAttachmentsSize() *
                        metadata.progress() / 100;
 
@@ -418,7 +606,8 @@ bool OutgoingShareSession::SendIntroduction(
   v1_frame->set_type(V1Frame::INTRODUCTION);
   IntroductionFrame* introduction_frame = v1_frame->mutable_introduction();
   introduction_frame->set_start_transfer(true);
-  if (!FillIntroductionFrame(introduction_frame)) {
+  if (!PrepareFilePayloadsForReceiver() ||
+      !FillIntroductionFrame(introduction_frame)) {
     return false;
   }
   WriteFrame(frame);
@@ -452,6 +641,20 @@ OutgoingShareSession::HandleConnectionResponse(
 
   switch (response->status()) {
     case ConnectionResponseFrame::ACCEPT: {
+      // Only files whose hash was sent can be left out.
+      for (int64_t attachment_id : response->deduplicated_attachment_ids()) {
+        const auto payload_it = attachment_payload_map().find(attachment_id);
+        if (!content_hashes_.contains(attachment_id) ||
+            payload_it == attachment_payload_map().end()) {
+          continue;
+        }
+        int64_t payload_id = payload_it->second;
+        if (std::erase_if(file_payloads_, [payload_id](const Payload& payload) {
+              return payload.id == payload_id;
+            }) > 0) {
+          deduplicated_attachment_ids_.push_back(attachment_id);
+        }
+      }
       UpdateTransferMetadata(
           TransferMetadataBuilder()
               .set_usage(session_usage())
@@ -634,10 +837,23 @@ OutgoingShareSession::ProcessPayloadTransferUpdates() {
   }
 
   std::optional<TransferMetadataBuilder> metadata_builder;
+  bool payload_transferred = false;
   for (; !updates.empty(); updates.pop()) {
+    const PayloadTransferUpdate& update = *updates.front();
+    // The next payload is sent as soon as all bytes of a payload are written,
+    // without waiting for its kSuccess status.
+    if (update.status == PayloadStatus::kSuccess ||
+        (update.status == PayloadStatus::kInProgress &&
+         update.bytes_transferred == update.total_bytes)) {
+      payload_transferred |=
+          queued_payload_ids_.erase(update.payload_id) > 0;
+    }
     metadata_builder =
         get_payload_tracker()->ProcessPayloadUpdate(std::move(updates.front()));
   }
+  if (payload_transferred) {
+    SendPayloadsUpToLimit();
+  }
   return metadata_builder.has_value()
              ? std::make_optional(
                    metadata_builder->set_usage(session_usage()).build())
@@ -23,9 +23,13 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/functional/any_invocable.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "internal/base/file_path.h"
 #include "internal/platform/clock.h"
 #include "internal/platform/task_runner.h"
 #include "sharing/analytics/analytics_recorder.h"
@@ -103,8 +107,8 @@ class OutgoingShareSession : public ShareSession {
                std::optional<nearby::sharing::service::proto::V1Frame> frame)>
           frame_read_callback,
       std::function<void()> payload_transder_update_callback);
-  // Send the next payload to NearbyConnectionManager.
-  // Used only if enable_transfer_cancellation_optimization is true.
+  // Send the next payload to NearbyConnectionManager, regardless of how many
+  // payloads are already queued.
   void SendNextPayload();
 
   // Called when all payloads have been sent.
@@ -139,6 +143,9 @@ class OutgoingShareSession : public ShareSession {
   // Returns true if the connection was successful.
   bool OnConnectResult(NearbyConnection* connection, Status status);
 
+  // Processes the queued payload updates and returns the latest transfer
+  // metadata. Payloads that finished transferring make room for the next ones
+  // to be sent.
   std::optional<TransferMetadata> ProcessPayloadTransferUpdates();
 
   void SetAdvancedProtectionStatus(bool advanced_protection_enabled,
@@ -184,6 +191,10 @@ class OutgoingShareSession : public ShareSession {
   TransportType GetTransportType(bool disable_wifi_hotspot) const;
 
   std::optional<Payload> ExtractNextPayload();
+  void SendPayload(const Payload& payload);
+  // Sends payloads until `max_queued_payloads_` of them are queued in
+  // NearbyConnectionManager, or there are none left.
+  void SendPayloadsUpToLimit();
   bool FillIntroductionFrame(
       nearby::sharing::service::proto::IntroductionFrame* introduction) const;
 
@@ -192,12 +203,36 @@ class OutgoingShareSession : public ShareSession {
   // Create file payloads and update the file size of all file attachments.
   // Returns true if all file payloads are created successfully.
   bool CreateFilePayloads();
+  // Once the receiver's capabilities are known, bundles small files if it
+  // supports file bundles (kEnableSmallFileBundling), and hashes the other
+  // files for content deduplication. Returns false if a bundle can't be
+  // written.
+  bool PrepareFilePayloadsForReceiver();
+  // Packs the file attachments at `file_indices` into file bundles, and
+  // creates a payload for each bundle.
+  bool CreateFileBundlePayloads(absl::Span<const int> file_indices);
+  // Deletes the file bundles written for this session.
+  void RemoveFileBundles();
 
   std::optional<std::string> obfuscated_gaia_id_;
   // All payloads are in the same order as the attachments in the share target.
   std::vector<Payload> text_payloads_;
   std::vector<Payload> file_payloads_;
   std::vector<Payload> wifi_credentials_payloads_;
+  // File bundles written to the temporary directory, and the offset in its
+  // bundle of each bundled file attachment.
+  std::vector<FilePath> file_bundle_paths_;
+  absl::flat_hash_map<int64_t, int64_t> bundle_offsets_;
+  // Content hash of each unbundled file attachment, sent in the introduction
+  // when content deduplication is enabled.
+  absl::flat_hash_map<int64_t, std::string> content_hashes_;
+  // File attachments the receiver already has, which are not sent.
+  std::vector<int64_t> deduplicated_attachment_ids_;
+  // Payloads sent to NearbyConnectionsManager that have not finished
+  // transferring yet. Nearby Connections writes them one at a time per
+  // payload type; the others wait in its queue.
+  absl::flat_hash_set<int64_t> queued_payload_ids_;
+  int max_queued_payloads_ = 1;
   Status connection_layer_status_ = Status::kUnknown;
   absl::AnyInvocable<void(OutgoingShareSession&, const TransferMetadata&)>
       transfer_update_callback_;
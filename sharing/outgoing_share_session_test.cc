@@ -35,19 +35,23 @@
 #include "absl/time/time.h"
 #include "internal/base/file_path.h"
 #include "internal/base/files.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/network/url.h"
 #include "internal/test/fake_clock.h"
 #include "internal/test/fake_device_info.h"
 #include "internal/test/fake_task_runner.h"
+#include "proto/sharing_enums.pb.h"
 #include "sharing/attachment_container.h"
 #include "sharing/certificates/test_util.h"
 #include "sharing/common/nearby_share_enums.h"
 #include "sharing/fake_nearby_connections_manager.h"
 #include "sharing/file_attachment.h"
+#include "sharing/flags/generated/nearby_sharing_feature_flags.h"
 #include "sharing/nearby_connection.h"
 #include "sharing/nearby_connection_impl.h"
 #include "sharing/nearby_connections_manager.h"
 #include "sharing/nearby_connections_types.h"
+#include "sharing/paired_key_verification_runner.h"
 #include "sharing/proto/wire_format.pb.h"
 #include "sharing/share_session_usage.h"
 #include "sharing/share_target.h"
@@ -62,6 +66,7 @@ namespace {
 using ::location::nearby::proto::sharing::EstablishConnectionStatus;
 using ::location::nearby::proto::sharing::EventCategory;
 using ::location::nearby::proto::sharing::EventType;
+using ::location::nearby::proto::sharing::OSType;
 using ::nearby::analytics::HasCategory;
 using ::nearby::analytics::HasEventType;
 using ::nearby::sharing::analytics::proto::SharingLog;
@@ -457,6 +462,133 @@ TEST_F(OutgoingShareSessionTest, SendIntroductionSuccess) {
               Eq(wifi_payloads[0].id));
 }
 
+// Two files that are small enough to be bundled.
+std::unique_ptr<AttachmentContainer> CreateSmallFileAttachmentContainer(
+    const FileAttachment& file1) {
+  constexpr absl::string_view kFile2Name = "someOtherFileName.jpg";
+  CreateTempFile(kFile2Name, kFile1Size);
+  FileAttachment file2(
+      Files::GetTemporaryDirectory().append(FilePath(kFile2Name)),
+      /*mime_type=*/"", /*parent_folder=*/"");
+  return AttachmentContainer::Builder({}, {file1, file2}, {}).Build();
+}
+
+IntroductionFrame SendIntroductionAndGetFrame(
+    OutgoingShareSession& session, FakeNearbyConnectionsManager& manager) {
+  std::vector<uint8_t> frame_data;
+  manager.set_send_payload_callback(
+      [&](std::unique_ptr<Payload> payload,
+          std::weak_ptr<NearbyConnectionsManager::PayloadStatusListener>
+              listener) {
+        frame_data = std::move(payload->content.bytes_payload.bytes);
+      });
+  EXPECT_THAT(session.SendIntroduction([]() {}), IsTrue());
+  Frame frame;
+  EXPECT_THAT(frame.ParseFromArray(frame_data.data(), frame_data.size()),
+              IsTrue());
+  return frame.v1().introduction();
+}
+
+TEST_F(OutgoingShareSessionTest, SendIntroductionBundlesSmallFiles) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_sharing_feature::kEnableSmallFileBundling,
+      true);
+  EXPECT_THAT(InitSendAttachments(CreateSmallFileAttachmentContainer(file1_)),
+              IsTrue());
+  NearbyConnectionImpl connection(device_info_);
+  ConnectionSuccess(&connection);
+  EXPECT_THAT(
+      session_.ProcessKeyVerificationResult(
+          PairedKeyVerificationRunner::PairedKeyVerificationResult::kSuccess,
+          OSType::WINDOWS, {.supports_file_bundles = true}),
+      IsTrue());
+
+  IntroductionFrame intro_frame =
+      SendIntroductionAndGetFrame(session_, connections_manager_);
+
+  ASSERT_THAT(intro_frame.file_metadata_size(), Eq(2));
+  EXPECT_THAT(intro_frame.file_metadata(0).bundle_offset(), Eq(0));
+  EXPECT_THAT(intro_frame.file_metadata(1).bundle_offset(), Eq(kFile1Size));
+  EXPECT_THAT(intro_frame.file_metadata(1).payload_id(),
+              Eq(intro_frame.file_metadata(0).payload_id()));
+  EXPECT_THAT(session_.file_payloads(), SizeIs(1));
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST_F(OutgoingShareSessionTest,
+       SendIntroductionDoesNotBundleFilesIfReceiverDoesNotSupportIt) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_sharing_feature::kEnableSmallFileBundling,
+      true);
+  EXPECT_THAT(InitSendAttachments(CreateSmallFileAttachmentContainer(file1_)),
+              IsTrue());
+  NearbyConnectionImpl connection(device_info_);
+  ConnectionSuccess(&connection);
+  EXPECT_THAT(
+      session_.ProcessKeyVerificationResult(
+          PairedKeyVerificationRunner::PairedKeyVerificationResult::kSuccess,
+          OSType::WINDOWS),
+      IsTrue());
+
+  IntroductionFrame intro_frame =
+      SendIntroductionAndGetFrame(session_, connections_manager_);
+
+  ASSERT_THAT(intro_frame.file_metadata_size(), Eq(2));
+  EXPECT_FALSE(intro_frame.file_metadata(0).has_bundle_offset());
+  EXPECT_FALSE(intro_frame.file_metadata(1).has_bundle_offset());
+  EXPECT_THAT(session_.file_payloads(), SizeIs(2));
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST_F(OutgoingShareSessionTest, SendIntroductionHashesFilesForReceiver) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_sharing_feature::
+          kEnableContentDeduplication,
+      true);
+  EXPECT_THAT(InitSendAttachments(CreateSmallFileAttachmentContainer(file1_)),
+              IsTrue());
+  NearbyConnectionImpl connection(device_info_);
+  ConnectionSuccess(&connection);
+  EXPECT_THAT(
+      session_.ProcessKeyVerificationResult(
+          PairedKeyVerificationRunner::PairedKeyVerificationResult::kSuccess,
+          OSType::WINDOWS, {.supports_content_deduplication = true}),
+      IsTrue());
+
+  IntroductionFrame intro_frame =
+      SendIntroductionAndGetFrame(session_, connections_manager_);
+
+  ASSERT_THAT(intro_frame.file_metadata_size(), Eq(2));
+  EXPECT_TRUE(intro_frame.file_metadata(0).has_content_hash());
+  EXPECT_TRUE(intro_frame.file_metadata(1).has_content_hash());
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
+TEST_F(OutgoingShareSessionTest,
+       SendIntroductionDoesNotHashFilesIfReceiverDoesNotSupportIt) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_sharing_feature::
+          kEnableContentDeduplication,
+      true);
+  EXPECT_THAT(InitSendAttachments(CreateSmallFileAttachmentContainer(file1_)),
+              IsTrue());
+  NearbyConnectionImpl connection(device_info_);
+  ConnectionSuccess(&connection);
+  EXPECT_THAT(
+      session_.ProcessKeyVerificationResult(
+          PairedKeyVerificationRunner::PairedKeyVerificationResult::kSuccess,
+          OSType::WINDOWS),
+      IsTrue());
+
+  IntroductionFrame intro_frame =
+      SendIntroductionAndGetFrame(session_, connections_manager_);
+
+  ASSERT_THAT(intro_frame.file_metadata_size(), Eq(2));
+  EXPECT_FALSE(intro_frame.file_metadata(0).has_content_hash());
+  EXPECT_FALSE(intro_frame.file_metadata(1).has_content_hash());
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
 TEST_F(OutgoingShareSessionTest, SendIntroductionTimeout) {
   auto container =
       AttachmentContainer::Builder(std::vector<TextAttachment>{text1_},
@@ -796,6 +928,48 @@ TEST_F(OutgoingShareSessionTest, SendNextPayload) {
   session_.SendNextPayload();
 }
 
+TEST_F(OutgoingShareSessionTest, SendPayloadsUpToMaxQueuedPayloads) {
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      config_package_nearby::nearby_sharing_feature::
+          kMaxQueuedOutgoingPayloads,
+      2);
+  EXPECT_THAT(InitSendAttachments(CreateDefaultAttachmentContainer()),
+              IsTrue());
+  std::vector<int64_t> sent_payload_ids;
+  connections_manager_.set_send_payload_callback(
+      [&sent_payload_ids](
+          std::unique_ptr<Payload> payload,
+          std::weak_ptr<NearbyConnectionsManager::PayloadStatusListener>) {
+        sent_payload_ids.push_back(payload->id);
+      });
+  EXPECT_CALL(mock_event_logger_,
+              Log(Matcher<const SharingLog&>(
+                  HasEventType(EventType::SEND_ATTACHMENTS_START))));
+  NearbyConnectionImpl connection(device_info_);
+  ConnectionSuccess(&connection);
+
+  session_.SendPayloads([](bool is_timeout, std::optional<V1Frame> frame) {},
+                        []() {});
+  ASSERT_THAT(sent_payload_ids, SizeIs(2));
+
+  // Progress of a queued payload does not make room for another one.
+  session_.payload_tracker().lock()->OnStatusUpdate(
+      std::make_unique<PayloadTransferUpdate>(
+          sent_payload_ids[0], PayloadStatus::kInProgress,
+          /*total_bytes=*/100, /*bytes_transferred=*/50));
+  session_.ProcessPayloadTransferUpdates();
+  EXPECT_THAT(sent_payload_ids, SizeIs(2));
+
+  session_.payload_tracker().lock()->OnStatusUpdate(
+      std::make_unique<PayloadTransferUpdate>(
+          sent_payload_ids[1], PayloadStatus::kSuccess,
+          /*total_bytes=*/100, /*bytes_transferred=*/100));
+  session_.ProcessPayloadTransferUpdates();
+  EXPECT_THAT(sent_payload_ids, SizeIs(3));
+
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
 TEST_F(OutgoingShareSessionTest, DelayCompleteReceiverDisconnect) {
   NearbyConnectionImpl connection(device_info_);
   session_.set_session_id(1234);
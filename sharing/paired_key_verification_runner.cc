@@ -29,12 +29,14 @@
 #include "absl/base/nullability.h"
 #include "absl/functional/any_invocable.h"
 #include "absl/time/time.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/clock.h"
 #include "proto/sharing_enums.pb.h"
 #include "sharing/certificates/common.h"
 #include "sharing/certificates/constants.h"
 #include "sharing/certificates/nearby_share_certificate_manager.h"
 #include "sharing/certificates/nearby_share_decrypted_public_certificate.h"
+#include "sharing/flags/generated/nearby_sharing_feature_flags.h"
 #include "sharing/incoming_frames_reader.h"
 #include "sharing/internal/public/logging.h"
 #include "sharing/proto/enums.pb.h"
@@ -112,7 +114,9 @@ PairedKeyVerificationRunner::PairedKeyVerificationRunner(
 PairedKeyVerificationRunner::~PairedKeyVerificationRunner() = default;
 
 void PairedKeyVerificationRunner::Run(
-    std::function<void(PairedKeyVerificationResult, OSType)> callback) {
+    std::function<void(PairedKeyVerificationResult, OSType,
+                       RemoteCapabilities)>
+        callback) {
   DCHECK(!callback_);
   callback_ = std::move(callback);
   verification_result_ = PairedKeyVerificationResult::kSuccess;
@@ -137,7 +141,7 @@ void PairedKeyVerificationRunner::OnReadPairedKeyEncryptionFrame(
   if (!frame.has_value()) {
     LOG(WARNING) << __func__ << ": Failed to read remote paired key encryption";
     std::move(callback_)(PairedKeyVerificationResult::kFail,
-                         OSType::UNKNOWN_OS_TYPE);
+                         OSType::UNKNOWN_OS_TYPE, RemoteCapabilities());
     return;
   }
 
@@ -202,7 +206,7 @@ void PairedKeyVerificationRunner::OnReadPairedKeyResultFrame(
   if (!frame.has_value()) {
     LOG(WARNING) << __func__ << ": Failed to read remote paired key result";
     std::move(callback_)(PairedKeyVerificationResult::kFail,
-                         OSType::UNKNOWN_OS_TYPE);
+                         OSType::UNKNOWN_OS_TYPE, RemoteCapabilities());
     return;
   }
 
@@ -219,7 +223,13 @@ void PairedKeyVerificationRunner::OnReadPairedKeyResultFrame(
     os_type = frame->paired_key_result().os_type();
   }
 
-  std::move(callback_)(verification_result_, os_type);
+  RemoteCapabilities remote_capabilities;
+  remote_capabilities.supports_file_bundles =
+      frame->paired_key_result().supports_file_bundles();
+  remote_capabilities.supports_content_deduplication =
+      frame->paired_key_result().supports_content_deduplication();
+
+  std::move(callback_)(verification_result_, os_type, remote_capabilities);
 }
 
 void PairedKeyVerificationRunner::SendPairedKeyResultFrame(
@@ -246,6 +256,12 @@ void PairedKeyVerificationRunner::SendPairedKeyResultFrame(
 
   // Set OS type to allow remote device knowns the paring device OS type.
   result_frame->set_os_type(os_type_);
+  result_frame->set_supports_file_bundles(true);
+  // Senders only hash their files for receivers that look the hashes up.
+  result_frame->set_supports_content_deduplication(
+      NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_sharing_feature::
+              kEnableContentDeduplication));
 
   frame_writer_(frame);
 }
@@ -47,6 +47,14 @@ class PairedKeyVerificationRunner
     kUnable,
   };
 
+  // Optional features the remote device announced in its PairedKeyResultFrame.
+  struct RemoteCapabilities {
+    // It can receive files sent in file bundles.
+    bool supports_file_bundles = false;
+    // It looks up the content hashes of the files it receives.
+    bool supports_content_deduplication = false;
+  };
+
   struct VisibilityHistory {
     proto::DeviceVisibility visibility;
     proto::DeviceVisibility last_visibility;
@@ -71,7 +79,8 @@ class PairedKeyVerificationRunner
 
   void Run(std::function<
            void(PairedKeyVerificationResult verification_result,
-                ::location::nearby::proto::sharing::OSType remote_os_type)>
+                ::location::nearby::proto::sharing::OSType remote_os_type,
+                RemoteCapabilities remote_capabilities)>
                callback);
 
   std::weak_ptr<PairedKeyVerificationRunner> GetWeakPtr() {
@@ -108,7 +117,8 @@ class PairedKeyVerificationRunner
   absl::AnyInvocable<void(const nearby::sharing::service::proto::Frame& frame)>
       frame_writer_;
   std::function<void(PairedKeyVerificationResult,
-                     ::location::nearby::proto::sharing::OSType)>
+                     ::location::nearby::proto::sharing::OSType,
+                     RemoteCapabilities)>
       callback_;
   PairedKeyVerificationResult verification_result_;
 };
@@ -30,6 +30,7 @@
 #include "gtest/gtest.h"
 #include "absl/functional/any_invocable.h"
 #include "absl/time/time.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/task_runner.h"
 #include "internal/test/fake_clock.h"
 #include "internal/test/fake_device_info.h"
@@ -39,6 +40,7 @@
 #include "sharing/certificates/nearby_share_decrypted_public_certificate.h"
 #include "sharing/certificates/test_util.h"
 #include "sharing/fake_nearby_connections_manager.h"
+#include "sharing/flags/generated/nearby_sharing_feature_flags.h"
 #include "sharing/incoming_frames_reader.h"
 #include "sharing/internal/public/logging.h"
 #include "sharing/nearby_connection.h"
@@ -210,7 +212,9 @@ class PairedKeyVerificationRunnerTest : public testing::Test {
       bool is_incoming, bool use_valid_public_certificate,
       const PairedKeyVerificationRunner::VisibilityHistory& visibility_history,
       PairedKeyVerificationRunner::PairedKeyVerificationResult expected_result,
-      OSType expected_os_type = OSType::UNKNOWN_OS_TYPE) {
+      OSType expected_os_type = OSType::UNKNOWN_OS_TYPE,
+      PairedKeyVerificationRunner::RemoteCapabilities expected_capabilities =
+          {}) {
     std::optional<NearbyShareDecryptedPublicCertificate> public_certificate =
         use_valid_public_certificate
             ? std::make_optional<NearbyShareDecryptedPublicCertificate>(
@@ -227,11 +231,17 @@ class PairedKeyVerificationRunnerTest : public testing::Test {
         kTimeout);
 
     runner->Run(
-        [&, expected_result, expected_os_type](
+        [&, expected_result, expected_os_type, expected_capabilities](
             PairedKeyVerificationRunner::PairedKeyVerificationResult result,
-            OSType remote_os_type) {
+            OSType remote_os_type,
+            PairedKeyVerificationRunner::RemoteCapabilities
+                remote_capabilities) {
           EXPECT_EQ(expected_result, result);
           EXPECT_EQ(expected_os_type, remote_os_type);
+          EXPECT_EQ(expected_capabilities.supports_file_bundles,
+                    remote_capabilities.supports_file_bundles);
+          EXPECT_EQ(expected_capabilities.supports_content_deduplication,
+                    remote_capabilities.supports_content_deduplication);
         });
   }
 
@@ -297,7 +307,8 @@ class PairedKeyVerificationRunnerTest : public testing::Test {
   void SetUpPairedKeyResultFrame(
       ReturnFrameType frame_type,
       PairedKeyResultFrame::Status status = PairedKeyResultFrame::UNKNOWN,
-      OSType os_type = OSType::UNKNOWN_OS_TYPE) {
+      OSType os_type = OSType::UNKNOWN_OS_TYPE,
+      PairedKeyVerificationRunner::RemoteCapabilities capabilities = {}) {
     EXPECT_CALL(frames_reader_,
                 ReadFrame(testing::Eq(V1Frame::PAIRED_KEY_RESULT), testing::_,
                           testing::Eq(kTimeout)))
@@ -317,6 +328,12 @@ class PairedKeyVerificationRunnerTest : public testing::Test {
 
               result_frame->set_status(status);
               result_frame->set_os_type(os_type);
+              if (capabilities.supports_file_bundles) {
+                result_frame->set_supports_file_bundles(true);
+              }
+              if (capabilities.supports_content_deduplication) {
+                result_frame->set_supports_content_deduplication(true);
+              }
 
               std::move(callback)(/*is_timeout=*/false, std::move(frame));
             }));
@@ -333,11 +350,17 @@ class PairedKeyVerificationRunnerTest : public testing::Test {
     ASSERT_TRUE(frame->v1().has_paired_key_encryption());
   }
 
-  void ExpectPairedKeyResultFrameSent(PairedKeyResultFrame::Status status) {
+  void ExpectPairedKeyResultFrameSent(
+      PairedKeyResultFrame::Status status,
+      bool supports_content_deduplication = false) {
     std::unique_ptr<Frame> frame = GetWrittenFrame();
     ASSERT_TRUE(frame->has_v1());
     ASSERT_TRUE(frame->v1().has_paired_key_result());
     EXPECT_EQ(status, frame->v1().paired_key_result().status());
+    EXPECT_TRUE(frame->v1().paired_key_result().supports_file_bundles());
+    EXPECT_EQ(
+        frame->v1().paired_key_result().supports_content_deduplication(),
+        supports_content_deduplication);
   }
 
   FakeClock* GetFakeClock() { return &fake_clock_; }
@@ -430,6 +453,51 @@ TEST_F(PairedKeyVerificationRunnerTest,
   ExpectPairedKeyResultFrameSent(PairedKeyResultFrame::SUCCESS);
 }
 
+TEST_F(PairedKeyVerificationRunnerTest, PassesRemoteCapabilities) {
+  SetUpPairedKeyEncryptionFrame(ReturnFrameType::kValid);
+  SetUpPairedKeyResultFrame(ReturnFrameType::kValid,
+                            PairedKeyResultFrame::SUCCESS, OSType::ANDROID,
+                            {.supports_file_bundles = true,
+                             .supports_content_deduplication = true});
+
+  RunVerification(
+      true,
+      /*use_valid_public_certificate=*/true,
+      {.visibility = DeviceVisibility::DEVICE_VISIBILITY_ALL_CONTACTS,
+       .last_visibility = DeviceVisibility::DEVICE_VISIBILITY_ALL_CONTACTS,
+       .last_visibility_time = GetFakeClock()->Now()},
+      /*expected_result=*/PairedKeyVerificationResult::kSuccess,
+      OSType::ANDROID,
+      {.supports_file_bundles = true, .supports_content_deduplication = true});
+
+  ExpectPairedKeyEncryptionFrameSent();
+  ExpectPairedKeyResultFrameSent(PairedKeyResultFrame::SUCCESS);
+}
+
+TEST_F(PairedKeyVerificationRunnerTest,
+       AnnouncesContentDeduplicationWhenEnabled) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_sharing_feature::
+          kEnableContentDeduplication,
+      true);
+  SetUpPairedKeyEncryptionFrame(ReturnFrameType::kValid);
+  SetUpPairedKeyResultFrame(ReturnFrameType::kValid,
+                            PairedKeyResultFrame::SUCCESS);
+
+  RunVerification(
+      true,
+      /*use_valid_public_certificate=*/true,
+      {.visibility = DeviceVisibility::DEVICE_VISIBILITY_ALL_CONTACTS,
+       .last_visibility = DeviceVisibility::DEVICE_VISIBILITY_ALL_CONTACTS,
+       .last_visibility_time = GetFakeClock()->Now()},
+      /*expected_result=*/PairedKeyVerificationResult::kSuccess);
+
+  ExpectPairedKeyEncryptionFrameSent();
+  ExpectPairedKeyResultFrameSent(PairedKeyResultFrame::SUCCESS,
+                                 /*supports_content_deduplication=*/true);
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
 struct TestParameters {
   bool is_incoming;
   bool has_valid_certificate;
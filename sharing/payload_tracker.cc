@@ -14,7 +14,9 @@
 
 #include "sharing/payload_tracker.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <memory>
@@ -48,6 +50,7 @@ PayloadTracker::PayloadTracker(
       payload_update_queue_(std::move(payload_queue)) {
   total_transfer_size_ = 0;
   confirmed_transfer_size_ = 0;
+  unconfirmed_transfer_size_ = 0;
 
   for (const auto& file : container.GetFileAttachments()) {
     auto it = attachment_payload_map.find(file.id());
@@ -58,7 +61,18 @@ PayloadTracker::PayloadTracker(
       continue;
     }
 
-    payload_state_.emplace(it->second, State(file.id(), file.size()));
+    auto [state_it, inserted] =
+        payload_state_.try_emplace(it->second, file.id(), file.size());
+    if (!inserted) {
+      // Files share a payload when they are sent in a file bundle.
+      State& state = state_it->second;
+      if (state.bundled_files.empty()) {
+        state.bundled_files.emplace_back(state.attachment_id,
+                                         state.total_size);
+      }
+      state.bundled_files.emplace_back(file.id(), file.size());
+      state.total_size += file.size();
+    }
     ++num_file_attachments_;
     total_transfer_size_ += file.size();
   }
@@ -114,6 +128,8 @@ std::optional<TransferMetadataBuilder> PayloadTracker::ProcessPayloadUpdate(
     return std::nullopt;
   }
   State& state = it->second;
+  bool was_successful = state.status == PayloadStatus::kSuccess;
+  uint64_t previous_amount_transferred = state.amount_transferred;
   if (state.status != update->status) {
     state.status = update->status;
 
@@ -121,24 +137,53 @@ std::optional<TransferMetadataBuilder> PayloadTracker::ProcessPayloadUpdate(
             << " had status change: " << update->status;
   }
 
-  if (state.status == PayloadStatus::kSuccess) {
-    LOG(INFO) << __func__ << ": Completed transfer of payload "
-              << update->payload_id << " with attachment id "
-              << state.attachment_id;
-    transferred_attachments_count_++;
-    confirmed_transfer_size_ += update->bytes_transferred;
-  }
-
   // The number of bytes transferred should never go down. That said, some
   // status updates like cancellation might send a value of 0. In that case, we
   // retain the last known value for use in metrics.
   if (update->bytes_transferred > state.amount_transferred) {
     state.amount_transferred = update->bytes_transferred;
   }
+  AdvanceBundledFiles(state);
+
+  if (was_successful) {
+    // A completed payload is only counted once.
+    return OnTransferUpdate(state);
+  }
+  if (state.status == PayloadStatus::kSuccess) {
+    LOG(INFO) << __func__ << ": Completed transfer of payload "
+              << update->payload_id << " with attachment id "
+              << state.attachment_id;
+    // The files of a bundle not counted yet complete with it.
+    transferred_attachments_count_ +=
+        state.bundled_files.empty()
+            ? 1
+            : state.bundled_files.size() - state.current_bundled_file;
+    confirmed_transfer_size_ += update->bytes_transferred;
+    unconfirmed_transfer_size_ -= previous_amount_transferred;
+  } else {
+    // Several payloads may progress at once (payloads of different types are
+    // written in parallel); their progress adds up.
+    unconfirmed_transfer_size_ +=
+        state.amount_transferred - previous_amount_transferred;
+  }
 
   return OnTransferUpdate(state);
 }
 
+void PayloadTracker::AdvanceBundledFiles(State& state) {
+  while (state.current_bundled_file + 1 < state.bundled_files.size() &&
+         state.amount_transferred >=
+             state.current_bundled_file_offset +
+                 state.bundled_files[state.current_bundled_file].second) {
+    VLOG(1) << __func__ << ": Completed transfer of bundled attachment id "
+            << state.bundled_files[state.current_bundled_file].first;
+    state.current_bundled_file_offset +=
+        state.bundled_files[state.current_bundled_file].second;
+    ++state.current_bundled_file;
+    ++transferred_attachments_count_;
+  }
+}
+
 std::optional<TransferMetadataBuilder> PayloadTracker::OnTransferUpdate(
     const State& state) {
   if (IsComplete()) {
@@ -146,7 +191,7 @@ std::optional<TransferMetadataBuilder> PayloadTracker::OnTransferUpdate(
     return std::move(TransferMetadataBuilder()
         .set_status(TransferMetadata::Status::kComplete)
         .set_progress(100)
-        .set_total_attachments_count(payload_state_.size())
+        .set_total_attachments_count(GetTotalAttachmentsCount())
         .set_transferred_attachments_count(transferred_attachments_count_));
   }
 
@@ -154,7 +199,7 @@ std::optional<TransferMetadataBuilder> PayloadTracker::OnTransferUpdate(
     VLOG(1) << __func__ << ": Payloads cancelled.";
     return std::move(TransferMetadataBuilder()
         .set_status(TransferMetadata::Status::kCancelled)
-        .set_total_attachments_count(payload_state_.size())
+        .set_total_attachments_count(GetTotalAttachmentsCount())
         .set_transferred_attachments_count(transferred_attachments_count_));
   }
 
@@ -162,14 +207,14 @@ std::optional<TransferMetadataBuilder> PayloadTracker::OnTransferUpdate(
     VLOG(1) << __func__ << ": Payloads failed.";
     return std::move(TransferMetadataBuilder()
         .set_status(TransferMetadata::Status::kFailed)
-        .set_total_attachments_count(payload_state_.size())
+        .set_total_attachments_count(GetTotalAttachmentsCount())
         .set_transferred_attachments_count(transferred_attachments_count_));
   }
 
-  double percent = CalculateProgressPercent(state);
+  double percent = CalculateProgressPercent();
   int current_progress = static_cast<int>(percent);
   absl::Time current_time = clock_->Now();
-  uint64_t current_transferred_size = GetTotalTransferred(state);
+  uint64_t current_transferred_size = GetTotalTransferred();
 
   if (current_progress == last_update_progress_ &&
       state.status != PayloadStatus::kSuccess) {
@@ -217,21 +262,40 @@ std::optional<TransferMetadataBuilder> PayloadTracker::OnTransferUpdate(
 
   last_update_progress_ = current_progress;
 
+  int64_t in_progress_attachment_id = state.attachment_id;
+  uint64_t in_progress_attachment_total_bytes = state.total_size;
+  uint64_t in_progress_attachment_transferred_bytes = state.amount_transferred;
+  if (!state.bundled_files.empty()) {
+    const auto& [attachment_id, size] =
+        state.bundled_files[state.current_bundled_file];
+    in_progress_attachment_id = attachment_id;
+    in_progress_attachment_total_bytes = size;
+    in_progress_attachment_transferred_bytes = std::min(
+        size, state.amount_transferred - state.current_bundled_file_offset);
+  }
+
   return std::move(TransferMetadataBuilder()
       .set_status(TransferMetadata::Status::kInProgress)
       .set_progress(percent)
       .set_transferred_bytes(current_transferred_size)
       .set_transfer_speed(static_cast<uint64_t>(current_speed_))
       .set_estimated_time_remaining(std::llround(estimated_time_remaining_))
-      .set_total_attachments_count(payload_state_.size())
+      .set_total_attachments_count(GetTotalAttachmentsCount())
       .set_transferred_attachments_count(transferred_attachments_count_)
-      .set_in_progress_attachment_id(state.attachment_id)
-      .set_in_progress_attachment_total_bytes(state.total_size)
-      .set_in_progress_attachment_transferred_bytes(state.amount_transferred));
+      .set_in_progress_attachment_id(in_progress_attachment_id)
+      .set_in_progress_attachment_total_bytes(
+          in_progress_attachment_total_bytes)
+      .set_in_progress_attachment_transferred_bytes(
+          in_progress_attachment_transferred_bytes));
+}
+
+size_t PayloadTracker::GetTotalAttachmentsCount() const {
+  return num_file_attachments_ + num_text_attachments_ +
+         num_wifi_credentials_attachments_;
 }
 
 bool PayloadTracker::IsComplete() const {
-  return transferred_attachments_count_ == payload_state_.size();
+  return transferred_attachments_count_ == GetTotalAttachmentsCount();
 }
 
 bool PayloadTracker::IsCancelled(const State& state) const {
@@ -242,20 +306,17 @@ bool PayloadTracker::HasFailed(const State& state) const {
   return state.status == PayloadStatus::kFailure;
 }
 
-uint64_t PayloadTracker::GetTotalTransferred(const State& state) const {
-  if (state.status == PayloadStatus::kSuccess) {
-    return confirmed_transfer_size_;
-  }
-  return confirmed_transfer_size_ + state.amount_transferred;
+uint64_t PayloadTracker::GetTotalTransferred() const {
+  return confirmed_transfer_size_ + unconfirmed_transfer_size_;
 }
 
-double PayloadTracker::CalculateProgressPercent(const State& state) const {
+double PayloadTracker::CalculateProgressPercent() const {
   if (!total_transfer_size_) {
     LOG(WARNING) << __func__ << ": Total attachment size is 0";
     return 100.0;
   }
 
-  return (100.0 * GetTotalTransferred(state)) / total_transfer_size_;
+  return (100.0 * GetTotalTransferred()) / total_transfer_size_;
 }
 
 }  // namespace sharing
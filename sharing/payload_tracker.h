@@ -20,6 +20,8 @@
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/time/time.h"
@@ -60,18 +62,31 @@ class PayloadTracker : public NearbyConnectionsManager::PayloadStatusListener {
 
     int64_t attachment_id = 0;
     uint64_t amount_transferred = 0;
-    const uint64_t total_size;
+    uint64_t total_size;
     PayloadStatus status = PayloadStatus::kInProgress;
+    // For a file bundle, the attachment id and size of each of its files, in
+    // bundle order. Empty for other payloads.
+    std::vector<std::pair<int64_t, uint64_t>> bundled_files;
+    // For a file bundle, the index in `bundled_files` of the file being
+    // transferred, and the offset of that file in the bundle.
+    int current_bundled_file = 0;
+    uint64_t current_bundled_file_offset = 0;
   };
 
+  // Moves past the files of a bundle whose bytes have all been transferred,
+  // so that progress is reported per file. The last file is complete only
+  // when the whole payload is.
+  void AdvanceBundledFiles(State& state);
+
   std::optional<TransferMetadataBuilder> OnTransferUpdate(const State& state);
 
+  size_t GetTotalAttachmentsCount() const;
   bool IsComplete() const;
   bool IsCancelled(const State& state) const;
   bool HasFailed(const State& state) const;
 
-  uint64_t GetTotalTransferred(const State& state) const;
-  double CalculateProgressPercent(const State& state) const;
+  uint64_t GetTotalTransferred() const;
+  double CalculateProgressPercent() const;
 
   Clock* const clock_;
   const int64_t share_target_id_;
@@ -82,6 +97,8 @@ class PayloadTracker : public NearbyConnectionsManager::PayloadStatusListener {
 
   uint64_t total_transfer_size_;
   uint64_t confirmed_transfer_size_;
+  // Bytes transferred so far of the payloads that are not complete yet.
+  uint64_t unconfirmed_transfer_size_;
 
   int last_update_progress_ = 0;  // progress percentage
   absl::Time last_transfer_speed_update_timestamp_;
@@ -109,5 +109,105 @@ TEST_F(PayloadTrackerTest, StatusUpdateWithTimeUpdate) {
   EXPECT_EQ(metadata->progress(), 3.0);
 }
 
+TEST(PayloadTrackerBundleTest, ReportsProgressOfEachBundledFile) {
+  constexpr int64_t kBundlePayloadId = 7;
+  FakeClock fake_clock;
+  FakeTaskRunner task_runner{&fake_clock, 1};
+  auto file = [](int64_t id, int64_t size) {
+    return FileAttachment(id, size, std::to_string(id), std::string(kMimeType),
+                          service::proto::FileMetadata::IMAGE);
+  };
+  std::unique_ptr<AttachmentContainer> container =
+      AttachmentContainer::Builder()
+          .AddFileAttachment(file(1, 100))
+          .AddFileAttachment(file(2, 200))
+          .AddFileAttachment(file(3, 300))
+          .Build();
+  absl::flat_hash_map<int64_t, int64_t> attachment_payload_map = {
+      {1, kBundlePayloadId}, {2, kBundlePayloadId}, {3, kBundlePayloadId}};
+  PayloadTracker payload_tracker(
+      &fake_clock, kShareTargetId, *container, attachment_payload_map,
+      std::make_unique<PayloadTracker::PayloadUpdateQueue>(&task_runner));
+  auto update = [&](PayloadStatus status, int64_t bytes_transferred) {
+    std::optional<TransferMetadataBuilder> builder =
+        payload_tracker.ProcessPayloadUpdate(
+            std::make_unique<PayloadTransferUpdate>(
+                kBundlePayloadId, status, /*total_bytes=*/600,
+                bytes_transferred));
+    EXPECT_TRUE(builder.has_value());
+    return builder->build();
+  };
+
+  TransferMetadata metadata = update(PayloadStatus::kInProgress, 50);
+  EXPECT_EQ(metadata.total_attachments_count(), 3);
+  EXPECT_EQ(metadata.transferred_attachments_count(), 0);
+  EXPECT_EQ(metadata.in_progress_attachment_id(), 1);
+  EXPECT_EQ(metadata.in_progress_attachment_transferred_bytes(), 50);
+  EXPECT_EQ(metadata.in_progress_attachment_total_bytes(), 100);
+
+  metadata = update(PayloadStatus::kInProgress, 150);
+  EXPECT_EQ(metadata.transferred_attachments_count(), 1);
+  EXPECT_EQ(metadata.in_progress_attachment_id(), 2);
+  EXPECT_EQ(metadata.in_progress_attachment_transferred_bytes(), 50);
+  EXPECT_EQ(metadata.in_progress_attachment_total_bytes(), 200);
+
+  metadata = update(PayloadStatus::kInProgress, 600);
+  EXPECT_EQ(metadata.status(), TransferMetadata::Status::kInProgress);
+  EXPECT_EQ(metadata.transferred_attachments_count(), 2);
+  EXPECT_EQ(metadata.in_progress_attachment_id(), 3);
+  EXPECT_EQ(metadata.in_progress_attachment_transferred_bytes(), 300);
+  EXPECT_EQ(metadata.in_progress_attachment_total_bytes(), 300);
+
+  metadata = update(PayloadStatus::kSuccess, 600);
+  EXPECT_EQ(metadata.status(), TransferMetadata::Status::kComplete);
+  EXPECT_EQ(metadata.transferred_attachments_count(), 3);
+}
+
+TEST(PayloadTrackerConcurrentTest, AddsUpProgressOfConcurrentPayloads) {
+  FakeClock fake_clock;
+  FakeTaskRunner task_runner{&fake_clock, 1};
+  auto file = [](int64_t id, int64_t size) {
+    return FileAttachment(id, size, std::to_string(id), std::string(kMimeType),
+                          service::proto::FileMetadata::IMAGE);
+  };
+  std::unique_ptr<AttachmentContainer> container =
+      AttachmentContainer::Builder()
+          .AddFileAttachment(file(1, 100))
+          .AddFileAttachment(file(2, 100))
+          .Build();
+  absl::flat_hash_map<int64_t, int64_t> attachment_payload_map = {{1, 11},
+                                                                    {2, 12}};
+  PayloadTracker payload_tracker(
+      &fake_clock, kShareTargetId, *container, attachment_payload_map,
+      std::make_unique<PayloadTracker::PayloadUpdateQueue>(&task_runner));
+  auto update = [&](int64_t payload_id, PayloadStatus status,
+                    int64_t bytes_transferred) {
+    std::optional<TransferMetadataBuilder> builder =
+        payload_tracker.ProcessPayloadUpdate(
+            std::make_unique<PayloadTransferUpdate>(
+                payload_id, status, /*total_bytes=*/100, bytes_transferred));
+    EXPECT_TRUE(builder.has_value());
+    return builder->build();
+  };
+
+  EXPECT_EQ(update(11, PayloadStatus::kInProgress, 30).progress(), 15.0);
+  EXPECT_EQ(update(12, PayloadStatus::kInProgress, 50).progress(), 40.0);
+  EXPECT_EQ(update(11, PayloadStatus::kInProgress, 60).progress(), 55.0);
+
+  TransferMetadata metadata = update(12, PayloadStatus::kSuccess, 100);
+  EXPECT_EQ(metadata.progress(), 80.0);
+  EXPECT_EQ(metadata.transferred_attachments_count(), 1);
+
+  // A repeated success is not counted twice.
+  metadata = update(12, PayloadStatus::kSuccess, 100);
+  EXPECT_EQ(metadata.progress(), 80.0);
+  EXPECT_EQ(metadata.transferred_attachments_count(), 1);
+
+  metadata = update(11, PayloadStatus::kSuccess, 100);
+  EXPECT_EQ(metadata.status(), TransferMetadata::Status::kComplete);
+  EXPECT_EQ(metadata.progress(), 100.0);
+  EXPECT_EQ(metadata.transferred_attachments_count(), 2);
+}
+
 }  // namespace
 }  // namespace nearby::sharing
@@ -14,6 +14,7 @@
 
 #include "sharing/share_session.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <functional>
@@ -26,11 +27,13 @@
 #include "absl/functional/any_invocable.h"
 #include "absl/functional/bind_front.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "internal/platform/clock.h"
 #include "internal/platform/task_runner.h"
 #include "sharing/analytics/analytics_recorder.h"
 #include "sharing/certificates/nearby_share_certificate_manager.h"
 #include "sharing/constants.h"
+#include "sharing/file_attachment.h"
 #include "sharing/incoming_frames_reader.h"
 #include "sharing/internal/public/logging.h"
 #include "sharing/nearby_connection.h"
@@ -188,7 +191,7 @@ void ShareSession::RunPairedKeyVerification(
     const PairedKeyVerificationRunner::VisibilityHistory& visibility_history,
     NearbyShareCertificateManager* certificate_manager,
     std::function<void(PairedKeyVerificationRunner::PairedKeyVerificationResult,
-                       OSType)>
+                       OSType, PairedKeyVerificationRunner::RemoteCapabilities)>
         callback) {
   std::optional<std::vector<uint8_t>> token =
       connections_manager_.GetRawAuthenticationToken(endpoint_id());
@@ -208,8 +211,10 @@ void ShareSession::RunPairedKeyVerification(
 
 bool ShareSession::ProcessKeyVerificationResult(
     PairedKeyVerificationRunner::PairedKeyVerificationResult result,
-    OSType share_target_os_type) {
+    OSType share_target_os_type,
+    PairedKeyVerificationRunner::RemoteCapabilities share_target_capabilities) {
   os_type_ = share_target_os_type;
+  remote_capabilities_ = share_target_capabilities;
 
   switch (result) {
     case PairedKeyVerificationRunner::PairedKeyVerificationResult::kFail:
@@ -285,12 +290,17 @@ void ShareSession::WriteFrame(const Frame& frame) {
 }
 
 void ShareSession::WriteResponseFrame(
-    ConnectionResponseFrame::Status response_status) {
+    ConnectionResponseFrame::Status response_status,
+    absl::Span<const int64_t> deduplicated_attachment_ids) {
   Frame frame;
   frame.set_version(Frame::V1);
   V1Frame* v1_frame = frame.mutable_v1();
   v1_frame->set_type(V1Frame::RESPONSE);
-  v1_frame->mutable_connection_response()->set_status(response_status);
+  ConnectionResponseFrame* response = v1_frame->mutable_connection_response();
+  response->set_status(response_status);
+  for (int64_t attachment_id : deduplicated_attachment_ids) {
+    response->add_deduplicated_attachment_ids(attachment_id);
+  }
 
   WriteFrame(frame);
 }
@@ -317,4 +327,25 @@ void ShareSession::InitializePayloadTracker(
   payload_updates_queue_->Start(std::move(payload_transfer_updates_callback));
 }
 
+void ShareSession::CompleteDeduplicatedPayloads(
+    absl::Span<const int64_t> attachment_ids) {
+  for (int64_t attachment_id : attachment_ids) {
+    const auto payload_it = attachment_payload_map_.find(attachment_id);
+    const std::vector<FileAttachment>& files =
+        attachment_container_.GetFileAttachments();
+    const auto file_it = std::find_if(
+        files.begin(), files.end(),
+        [&](const FileAttachment& file) { return file.id() == attachment_id; });
+    if (payload_it == attachment_payload_map_.end() || file_it == files.end()) {
+      LOG(WARNING) << "Unknown deduplicated attachment: " << attachment_id;
+      continue;
+    }
+    VLOG(1) << "Skipping payload " << payload_it->second
+            << " of deduplicated attachment " << attachment_id;
+    payload_tracker_->OnStatusUpdate(std::make_unique<PayloadTransferUpdate>(
+        payload_it->second, PayloadStatus::kSuccess, file_it->size(),
+        file_it->size()));
+  }
+}
+
 }  // namespace nearby::sharing
@@ -25,6 +25,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/any_invocable.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "internal/platform/clock.h"
 #include "internal/platform/task_runner.h"
 #include "proto/sharing_enums.pb.h"
@@ -93,6 +94,11 @@ class ShareSession {
 
   location::nearby::proto::sharing::OSType os_type() const { return os_type_; }
 
+  const PairedKeyVerificationRunner::RemoteCapabilities& remote_capabilities()
+      const {
+    return remote_capabilities_;
+  }
+
   bool self_share() const { return self_share_; }
 
   const ShareTarget& share_target() const { return share_target_; }
@@ -121,13 +127,16 @@ class ShareSession {
       NearbyShareCertificateManager* certificate_manager,
       std::function<
           void(PairedKeyVerificationRunner::PairedKeyVerificationResult,
-               location::nearby::proto::sharing::OSType)>
+               location::nearby::proto::sharing::OSType,
+               PairedKeyVerificationRunner::RemoteCapabilities)>
           callback);
   // Processes the PairedKeyVerificationResult.
   // Returns true if verification was successful.
   bool ProcessKeyVerificationResult(
       PairedKeyVerificationRunner::PairedKeyVerificationResult result,
-      location::nearby::proto::sharing::OSType share_target_os_type);
+      location::nearby::proto::sharing::OSType share_target_os_type,
+      PairedKeyVerificationRunner::RemoteCapabilities
+          share_target_capabilities = {});
 
   void OnDisconnect();
   const AttachmentContainer& attachment_container() const {
@@ -141,9 +150,12 @@ class ShareSession {
     return attachment_payload_map_;
   }
 
+  // `deduplicated_attachment_ids` are the file attachments the receiver
+  // already has, which the sender must not send.
   void WriteResponseFrame(
       nearby::sharing::service::proto::ConnectionResponseFrame::Status
-          response_status);
+          response_status,
+      absl::Span<const int64_t> deduplicated_attachment_ids = {});
   void WriteCancelFrame();
 
   void SetTokenForTests(std::string token) { token_ = std::move(token); }
@@ -199,6 +211,11 @@ class ShareSession {
   void InitializePayloadTracker(
       absl::AnyInvocable<void()> payload_transfer_updates_callback);
 
+  // Reports the payloads of the file attachments `attachment_ids` as
+  // transferred, for files that are not sent because the receiver already has
+  // them. Must be called after InitializePayloadTracker().
+  void CompleteDeduplicatedPayloads(absl::Span<const int64_t> attachment_ids);
+
  private:
   Clock& clock_;
   TaskRunner& service_thread_;
@@ -216,6 +233,7 @@ class ShareSession {
   int64_t session_id_ = 0;
   ::location::nearby::proto::sharing::OSType os_type_ =
       ::location::nearby::proto::sharing::OSType::UNKNOWN_OS_TYPE;
+  PairedKeyVerificationRunner::RemoteCapabilities remote_capabilities_;
   bool self_share_ = false;
   ShareTarget share_target_;
   bool got_final_status_ = false;
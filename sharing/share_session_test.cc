@@ -182,7 +182,8 @@ TEST(ShareSessionTest, IncomingRunPairedKeyVerificationSuccess) {
       &certificate_manager,
       [&notification, &verification_result](
           PairedKeyVerificationRunner::PairedKeyVerificationResult result,
-          location::nearby::proto::sharing::OSType) {
+          location::nearby::proto::sharing::OSType,
+          PairedKeyVerificationRunner::RemoteCapabilities) {
         verification_result = result;
         notification.Notify();
       });